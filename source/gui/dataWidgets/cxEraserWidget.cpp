@@ -203,7 +203,7 @@ void EraserWidget::saveSlot()
 
 
 template <class TYPE>
-void EraserWidget::eraseVolume(TYPE* volumePointer)
+IntBoundingBox3D EraserWidget::eraseVolume(TYPE* volumePointer)
 {
 	ImagePtr image = mActiveData->getActive<Image>();
 	vtkImageDataPtr img = image->getBaseVtkImageData();
@@ -237,6 +237,11 @@ void EraserWidget::eraseVolume(TYPE* volumePointer)
 				if ((Vector3D((x-c(0))*spacing[0], (y-c(1))*spacing[1], (z-c(2))*spacing[2])).length() < r)
 					volumePointer[index] = replaceVal;
 			}
+
+	Eigen::Array3i offset = IntBoundingBox3D(img->GetExtent()).bottomLeft().array();
+	lowVoxIdx += offset;
+	highVoxIdx += offset - 1;
+	return IntBoundingBox3D(lowVoxIdx(0), highVoxIdx(0), lowVoxIdx(1), highVoxIdx(1), lowVoxIdx(2), highVoxIdx(2));
 }
 
 //#define VTK_VOID            0
@@ -265,34 +270,32 @@ void EraserWidget::removeSlot()
 
 	vtkImageDataPtr img = image->getBaseVtkImageData();
 	int vtkScalarType = img->GetScalarType();
+	IntBoundingBox3D erased;
 
 	if (vtkScalarType==VTK_CHAR)
-		this->eraseVolume(static_cast<char*> (img->GetScalarPointer()));
+		erased = this->eraseVolume(static_cast<char*> (img->GetScalarPointer()));
 	else if (vtkScalarType==VTK_UNSIGNED_CHAR)
-		this->eraseVolume(static_cast<unsigned char*> (img->GetScalarPointer()));
+		erased = this->eraseVolume(static_cast<unsigned char*> (img->GetScalarPointer()));
 	else if (vtkScalarType==VTK_SIGNED_CHAR)
-		this->eraseVolume(static_cast<signed char*> (img->GetScalarPointer()));
+		erased = this->eraseVolume(static_cast<signed char*> (img->GetScalarPointer()));
 	else if (vtkScalarType==VTK_UNSIGNED_SHORT)
-		this->eraseVolume(static_cast<unsigned short*> (img->GetScalarPointer()));
+		erased = this->eraseVolume(static_cast<unsigned short*> (img->GetScalarPointer()));
 	else if (vtkScalarType==VTK_SHORT)
-		this->eraseVolume(static_cast<short*> (img->GetScalarPointer()));
+		erased = this->eraseVolume(static_cast<short*> (img->GetScalarPointer()));
 	else if (vtkScalarType==VTK_UNSIGNED_INT)
-		this->eraseVolume(static_cast<unsigned int*> (img->GetScalarPointer()));
+		erased = this->eraseVolume(static_cast<unsigned int*> (img->GetScalarPointer()));
 	else if (vtkScalarType==VTK_INT)
-		this->eraseVolume(static_cast<int*> (img->GetScalarPointer()));
+		erased = this->eraseVolume(static_cast<int*> (img->GetScalarPointer()));
 	else
+	{
 		reportError(QString("Unknown VTK ScalarType: %1").arg(vtkScalarType));
+		return;
+	}
 
-	ImageLUT2DPtr tf2D = image->getLookupTable2D();
-	ImageTF3DPtr tf3D = image->getTransferFunctions3D();
-
-//	img->Modified();
+	// only the voxels inside the sphere are changed: keeps transfer functions,
+	// and lets statistics and views update the erased extent only
 	setDeepModified(img);
-	image->setVtkImageData(img);
-
-	// keep existing transfer functions
-	image->setLookupTable2D(tf2D);
-	image->setTransferFunctions3D(tf3D);
+	image->setVtkImageDataModified(erased);
 }
 
 void EraserWidget::toggleShowEraser(bool on)
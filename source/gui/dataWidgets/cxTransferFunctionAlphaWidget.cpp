@@ -27,6 +27,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "cxTypeConversions.h"
 #include "vtkDataArray.h"
 #include "cxReporter.h"
+#include "cxImageStatistics.h"
 
 namespace cx
 {
@@ -263,20 +264,19 @@ void TransferFunctionAlphaWidget::paintHistogram(QPainter& painter)
 	// Draw histogram
 	// with log compression
 
-	vtkImageAccumulatePtr histogram = mImage->getHistogram();
-	int histogramSize = histogram->GetComponentExtent()[1] -
-						histogram->GetComponentExtent()[0];
+	ImageStatisticsPtr statistics = mImage->getStatistics();
+	int histogramSize = mImage->getRange();
 
 	painter.setPen(QColor(140, 140, 210));
 
-	double numElementsInBinWithMostElements = log(histogram->GetOutput()->GetPointData()->GetScalars()->GetRange()[1]+1);
+	double numElementsInBinWithMostElements = log(double(statistics->getMaxHistogramCount())+1);
 	double barHeightMult = (this->height() - mBorder*2) / numElementsInBinWithMostElements;
 
 	double posMult = (this->width() - mBorder*2) / double(histogramSize);
 	for (int i = mImage->getMin(); i <= mImage->getMax(); i++)
 	{
 		int x = int(std::lround(((i- mImage->getMin()) * posMult))); //Offset with min value
-		int y = int(std::lround(log(double(static_cast<int*>(histogram->GetOutput()->GetScalarPointer(i - mImage->getMin(), 0, 0))[0]+1)) * barHeightMult));
+		int y = int(std::lround(log(double(statistics->getHistogramCount(i))+1) * barHeightMult));
 	  if (y > 0)
 	  {
 		painter.drawLine(x + mBorder, height() - mBorder,
@@ -155,6 +155,8 @@ void USAcquisition::recordStarted()
 
 	ToolPtr tool = this->getServices()->tracking()->getFirstProbe();
 	mCore->setWriteColor(this->getWriteColor());
+	// record in the saved format, letting the save copy the recorded frames
+	mCore->setCompressImages(settings()->value("Ultrasound/CompressAcquisition", true).toBool());
 	mCore->startRecord(mBase->getLatestSession(),
 										 tool,
 										 this->getServices()->tracking()->getReferenceTool(),
@@ -32,7 +32,7 @@ namespace cx
 {
 
 
-USSavingRecorder::USSavingRecorder() : mDoWriteColor(true), m_rMpr(Transform3D::Identity())
+USSavingRecorder::USSavingRecorder() : mDoWriteColor(true), mCompressImages(true), m_rMpr(Transform3D::Identity()), mCopiedImages(0)
 {
 
 }
@@ -51,14 +51,22 @@ void USSavingRecorder::setWriteColor(bool on)
 	mDoWriteColor = on;
 }
 
+void USSavingRecorder::setCompressImages(bool on)
+{
+	mCompressImages = on;
+}
+
 void USSavingRecorder::set_rMpr(Transform3D rMpr)
 {
+	if (!similar(m_rMpr, rMpr))
+		mStreamData.clear(); // frame positions depend on rMpr
 	m_rMpr = rMpr;
 }
 
 void USSavingRecorder::startRecord(RecordSessionPtr session, ToolPtr tool, ToolPtr reference, std::vector<VideoSourcePtr> video, FileManagerServicePtr filemanager)
 {
 	this->clearRecording(); // clear previous data if any
+	mCopiedImages = 0;
 
 	mRecordingTool = tool;
 	mReference = reference;
@@ -74,7 +82,7 @@ void USSavingRecorder::startRecord(RecordSessionPtr session, ToolPtr tool, ToolP
 								 video[i],
 								 cacheFolder,
 								 QString("%1_%2").arg(session->getDescription()).arg(video[i]->getUid()),
-								 false, // no compression when saving to cache
+								 mCompressImages,
 								 mDoWriteColor,
 								filemanager
 								));
@@ -96,6 +104,7 @@ void USSavingRecorder::stopRecord()
 		// complete writing of images to temporary storage. Do this before using the image data.
 		mVideoRecorder[i]->completeSave();
 	}
+	mStreamData.clear();
 }
 
 void USSavingRecorder::cancelRecord()
@@ -121,6 +130,15 @@ USReconstructInputData USSavingRecorder::getDataForStream(unsigned videoRecorder
 	if (videoRecorderIndex>=mVideoRecorder.size())
 		return USReconstructInputData();
 
+	std::map<unsigned, USReconstructInputData>::iterator iter = mStreamData.find(videoRecorderIndex);
+	if (iter == mStreamData.end())
+		iter = mStreamData.insert(std::make_pair(videoRecorderIndex, this->createDataForStream(videoRecorderIndex))).first;
+	return iter->second;
+}
+
+USReconstructInputData USSavingRecorder::createDataForStream(unsigned videoRecorderIndex)
+{
+
 	SavingVideoRecorderPtr videoRecorder = mVideoRecorder[videoRecorderIndex];
 	videoRecorder->completeSave(); // just in case - should have been done earlier.
 	TimedTransformMap trackerRecordedData = RecordSession::getToolHistory_prMt(mRecordingTool, mSession, true);
@@ -165,6 +183,7 @@ void USSavingRecorder::startSaveData(QString baseFolder, bool compressImages)
 
 void USSavingRecorder::clearRecording()
 {
+	mStreamData.clear();
 	mVideoRecorder.clear();
 	mSession.reset();
 	mRecordingTool.reset();
@@ -185,7 +204,8 @@ void USSavingRecorder::saveStreamSession(USReconstructInputData reconstructData,
 	// now start saving of data to the patient folder, compressed version:
 	QFuture<QString> fileMakerFuture =
 			QtConcurrent::run(boost::bind(
-								  &UsReconstructionFileMaker::writeToNewFolder,
+								  &USSavingRecorder::writeStreamSession,
+								  this,
 								  fileMaker,
 								  saveFolder,
 								  compress
@@ -197,6 +217,26 @@ void USSavingRecorder::saveStreamSession(USReconstructInputData reconstructData,
 	fileMaker.reset(); // filemaker is now stored in the mSaveThreads queue, clear as current.
 }
 
+QString USSavingRecorder::writeStreamSession(UsReconstructionFileMakerPtr fileMaker, QString saveFolder, bool compress)
+{
+	QString retval = fileMaker->writeToNewFolder(saveFolder, compress);
+	mCopiedImages.fetchAndAddOrdered(fileMaker->getNumberOfCopiedImages());
+	return retval;
+}
+
+int USSavingRecorder::getNumberOfCopiedImages() const
+{
+	return mCopiedImages.load();
+}
+
+int USSavingRecorder::getNumberOfDroppedFrames() const
+{
+	int retval = 0;
+	for (unsigned i=0; i<mVideoRecorder.size(); ++i)
+		retval += mVideoRecorder[i]->getNumberOfDroppedFrames();
+	return retval;
+}
+
 void USSavingRecorder::fileMakerWriteFinished()
 {
 	std::list<QFutureWatcher<QString>*>::iterator iter;
@@ -14,14 +14,12 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "org_custusx_acquisition_Export.h"
 
 #include <vector>
+#include <map>
 #include <QFutureWatcher>
+#include <QAtomicInt>
 #include "cxForwardDeclarations.h"
 #include "cxTransform3D.h"
-
-namespace cx
-{
-struct USReconstructInputData;
-}
+#include "cxUSReconstructInputData.h"
 namespace cx
 {
 typedef boost::shared_ptr<class UsReconstructionFileMaker> UsReconstructionFileMakerPtr;
@@ -42,9 +40,14 @@ typedef boost::shared_ptr<class RecordSession> RecordSessionPtr;
  * Use the start/stop pair to record video from the input streams
  * during that period. A cancel instead of stop will clear the recording.
  *
+ * Frames are written to a temporary folder as they arrive, compressed
+ * unless setCompressImages(false) is called.
+ *
  * After stopping, use
- *    - getDataForStream() to get unsaved reconstruct data.
+ *    - getDataForStream() to get unsaved reconstruct data. The frames
+ *      are read from the temporary files on demand.
  *    - startSaveData() to launch save threads, emitting signals for each completed save.
+ *      Frames already written in the requested format are copied, not decoded.
  *
  * Use clearRecording() to free memory and temporary files (this can be a lot of disk space).
  *
@@ -67,9 +70,11 @@ public:
 	void cancelRecord();
 
 	void setWriteColor(bool on);
+	void setCompressImages(bool on); ///< compress frames when writing them during recording, default on. Set before startRecord().
 	void set_rMpr(Transform3D rMpr);
 	/**
-	  * Retrieve an in-memory data set for the given stream uid.
+	  * Retrieve a data set for the given stream uid, with frames backed by the recorded files.
+	  * The data set is assembled once per recording and shared with startSaveData().
 	  */
 	USReconstructInputData getDataForStream(QString streamUid);
 	/**
@@ -79,6 +84,8 @@ public:
 	  */
 	void startSaveData(QString baseFolder, bool compressImages);
 	size_t getNumberOfSavingThreads() const;
+	int getNumberOfCopiedImages() const; ///< frames copied instead of converted by the completed saves of the last recording
+	int getNumberOfDroppedFrames() const; ///< frames lost in the last recording because a write queue was full
 	void clearRecording();
 
 signals:
@@ -89,7 +96,9 @@ private slots:
 private:
 //	std::map<double, Transform3D> getToolHistory(ToolPtr tool, RecordSessionPtr session);
 	void saveStreamSession(USReconstructInputData reconstructData, QString saveFolder, QString streamSessionName, bool compress);
+	QString writeStreamSession(UsReconstructionFileMakerPtr fileMaker, QString saveFolder, bool compress);
 	USReconstructInputData getDataForStream(unsigned videoRecorderIndex);
+	USReconstructInputData createDataForStream(unsigned videoRecorderIndex);
 
 	RecordSessionPtr mSession;
 	std::list<QFutureWatcher<QString>*> mSaveThreads;
@@ -98,7 +107,10 @@ private:
 	ToolPtr mRecordingTool;
 	ToolPtr mReference;
 	bool mDoWriteColor;
+	bool mCompressImages;
 	Transform3D m_rMpr;
+	std::map<unsigned, USReconstructInputData> mStreamData; ///< data sets assembled after stop, per video recorder
+	QAtomicInt mCopiedImages; ///< updated from the save threads
 };
 typedef boost::shared_ptr<USSavingRecorder> USSavingRecorderPtr;
 
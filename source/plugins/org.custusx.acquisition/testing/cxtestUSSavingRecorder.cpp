@@ -62,6 +62,44 @@ TEST_CASE_METHOD(cxtest::USSavingRecorderFixture, "USSavingRecorder: Use one Vid
 	this->verifySaveData();
 }
 
+TEST_CASE_METHOD(cxtest::USSavingRecorderFixture, "USSavingRecorder: Copy recorded frames when saving with default settings", "[integration][modules][Acquisition]")
+{
+	cx::DummyToolPtr tool = cx::DummyToolTestUtilities::createDummyTool(cx::DummyToolTestUtilities::createProbeDefinitionLinear());
+	this->setTool(tool);
+	this->addVideoSource(80, 40);
+
+	this->addOperation(boost::bind(&cxtest::USSavingRecorderFixture::startRecord, this));
+	this->addOperation(boost::bind(&cxtest::USSavingRecorderFixture::wait, this, 1000));
+	this->addOperation(boost::bind(&cxtest::USSavingRecorderFixture::stopRecord, this));
+	this->addOperation(boost::bind(&cxtest::USSavingRecorderFixture::saveAndWaitForCompleted, this));
+
+	qApp->exec();
+
+	this->verifySaveData();
+	this->verifyAllFramesCopied();
+}
+
+TEST_CASE_METHOD(cxtest::USSavingRecorderFixture, "USSavingRecorder: Save frames compressed during recording", "[integration][modules][Acquisition]")
+{
+	cx::DummyToolPtr tool = cx::DummyToolTestUtilities::createDummyTool(cx::DummyToolTestUtilities::createProbeDefinitionLinear());
+	this->setTool(tool);
+	this->addVideoSource(80, 40);
+
+	SECTION("Copy recorded frames")
+		this->setCompressImages(true, true);
+	SECTION("Convert recorded frames")
+		this->setCompressImages(false, true);
+
+	this->addOperation(boost::bind(&cxtest::USSavingRecorderFixture::startRecord, this));
+	this->addOperation(boost::bind(&cxtest::USSavingRecorderFixture::wait, this, 1000));
+	this->addOperation(boost::bind(&cxtest::USSavingRecorderFixture::stopRecord, this));
+	this->addOperation(boost::bind(&cxtest::USSavingRecorderFixture::saveAndWaitForCompleted, this));
+
+	qApp->exec();
+
+	this->verifySaveData();
+}
+
 TEST_CASE_METHOD(cxtest::USSavingRecorderFixture, "USSavingRecorder: Use 4 VideoSources", "[integration][modules][Acquisition][unstable]")
 {
 	this->setTool(cx::ToolPtr());
@@ -46,7 +46,7 @@ void USSavingRecorderFixture::tearDown()
 	cx::LogicManager::shutdown();
 }
 
-USSavingRecorderFixture::USSavingRecorderFixture(QObject* parent) : QObject(parent)
+USSavingRecorderFixture::USSavingRecorderFixture(QObject* parent) : QObject(parent), mCompressSavedImages(true)
 {
 	this->setUp();
 
@@ -83,6 +83,12 @@ void USSavingRecorderFixture::setTool(cx::ToolPtr tool)
 	mTool = tool;
 }
 
+void USSavingRecorderFixture::setCompressImages(bool recording, bool saving)
+{
+	mRecorder->setCompressImages(recording);
+	mCompressSavedImages = saving;
+}
+
 void USSavingRecorderFixture::addVideoSource(int width, int height)
 {
 	size_t index = mVideo.size();
@@ -122,9 +128,8 @@ void USSavingRecorderFixture::wait(int time)
 
 void USSavingRecorderFixture::saveAndWaitForCompleted()
 {
-	bool compressImages = true;
 	QString baseFolder = this->getDataPath();
-	mRecorder->startSaveData(baseFolder, compressImages);
+	mRecorder->startSaveData(baseFolder, mCompressSavedImages);
 
 	while (mRecorder->getNumberOfSavingThreads() > 0)
 	{
@@ -171,6 +176,17 @@ void USSavingRecorderFixture::verifySaveData()
 		this->verifySaveData(mSavedData[i]);
 }
 
+void USSavingRecorderFixture::verifyAllFramesCopied()
+{
+	int frames = 0;
+	for (unsigned i=0; i<mVideo.size(); ++i)
+		frames += mRecorder->getDataForStream(mVideo[i]->getUid()).mFrames.size();
+
+	CHECK(frames > 0);
+	CHECK(mRecorder->getNumberOfDroppedFrames() == 0);
+	CHECK(mRecorder->getNumberOfCopiedImages() == frames);
+}
+
 void USSavingRecorderFixture::verifySaveData(QString filename)
 {
 	ctkPluginContext* pluginContext = cx::logicManager()->getPluginContext();
@@ -42,6 +42,7 @@ public:
 
 	void setTool(cx::ToolPtr tool);
 	void addVideoSource(int width, int height);
+	void setCompressImages(bool recording, bool saving);
 
 	void startRecord();
 	void wait(int time);
@@ -49,6 +50,7 @@ public:
 	void saveAndWaitForCompleted();
 	void verifyMemData(QString uid);
 	void verifySaveData();
+	void verifyAllFramesCopied();
 
 	static QString getDataPath();
 
@@ -68,6 +70,7 @@ private:
 	QStringList mSavedData;
 
 	cx::USSavingRecorderPtr mRecorder;
+	bool mCompressSavedImages;
 	std::vector<boost::function0<void> > mOperations;
 };
 
@@ -19,6 +19,9 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include <vtkImageData.h>
 #include "cxErrorObserver.h"
 #include "cxCustomMetaImage.h"
+#include "cxMetaImageHeader.h"
+#include "cxMetaImageIO.h"
+#include "cxEnumConversion.h"
 #include "cxImage.h"
 #include "cxLogger.h"
 #include "cxRegistrationTransform.h"
@@ -29,6 +32,20 @@ namespace cx {
 
 vtkImageDataPtr MetaImageReader::loadVtkImageData(QString filename)
 {
+	MetaImageHeader header;
+	if (!header.read(filename))
+		return vtkImageDataPtr();
+	return this->loadVtkImageData(filename, header);
+}
+
+/** Read the image data using the native reader,
+ *  fall back to vtkMetaImageReader for files it does not support.
+ */
+vtkImageDataPtr MetaImageReader::loadVtkImageData(QString filename, const MetaImageHeader& header)
+{
+	if (MetaImageIO::canRead(header))
+		return MetaImageIO().read(filename, header);
+
 	//load the image from file
 	vtkMetaImageReaderPtr reader = vtkMetaImageReaderPtr::New();
 	reader->SetFileName(cstring_cast(filename));
@@ -75,9 +92,10 @@ bool MetaImageReader::readInto(ImagePtr image, QString filename)
 		return false;
 
 	CustomMetaImagePtr customReader = CustomMetaImage::create(filename);
+	MetaImageHeader header = customReader->getHeader();
 	Transform3D rMd = customReader->readTransform();
 
-	vtkImageDataPtr raw = this->loadVtkImageData(filename);
+	vtkImageDataPtr raw = this->loadVtkImageData(filename, header);
 	if(!raw)
 		return false;
 
@@ -116,34 +134,9 @@ std::vector<DataPtr> MetaImageReader::read(const QString &filename)
 	std::vector<DataPtr> retval;
 
 	ImagePtr image = boost::dynamic_pointer_cast<Image>(this->createData(Image::getTypeName(), filename));
-
-	CustomMetaImagePtr customReader = CustomMetaImage::create(filename);
-	Transform3D rMd = customReader->readTransform();
-
-	vtkImageDataPtr raw = this->loadVtkImageData(filename);
-	if(!raw)
+	if (!this->readInto(image, filename))
 		return retval;
 
-	image->setVtkImageData(raw);
-//	ImagePtr image(new Image(uid, raw));
-
-	//  RegistrationTransform regTrans(rMd, QFileInfo(filename).lastModified(), "From MHD file");
-	//  image->get_rMd_History()->addRegistration(regTrans);
-	image->get_rMd_History()->setRegistration(rMd);
-	image->setModality(customReader->readModality());
-	image->setImageType(customReader->readImageType());
-
-	bool ok1 = true;
-	bool ok2 = true;
-	double level = customReader->readKey("WindowLevel").toDouble(&ok1);
-	double window = customReader->readKey("WindowWidth").toDouble(&ok2);
-
-	if (ok1 && ok2)
-	{
-		image->setInitialWindowLevel(window, level);
-		image->resetTransferFunctions();
-	}
-
 	retval.push_back(image);
 	return retval;
 
@@ -153,30 +146,41 @@ void MetaImageReader::write(DataPtr data, const QString& filename)
 {
 	ImagePtr image = boost::dynamic_pointer_cast<Image>(data);
 	if(!image)
+	{
 		reportError("Could not cast data to image");
-	vtkMetaImageWriterPtr writer = vtkMetaImageWriterPtr::New();
-	writer->SetInputData(image->getBaseVtkImageData());
-	writer->SetFileDimensionality(3);
-	writer->SetFileName(cstring_cast(filename));
-	QDir().mkpath(QFileInfo(filename).path());
-
-//	std::cout << "SAVING MHD COMPRESSED " << filename << std::endl;
-//	writer->SetCompression(true);
-	writer->SetCompression(false);
-//	writer->Update(); // caused writing of (null).0 files - not necessary
-	writer->Write();
-
-	writer = 0;
+		return;
+	}
 
-	CustomMetaImagePtr customReader = CustomMetaImage::create(filename);
-	customReader->setTransform(image->get_rMd());
-	customReader->setModality(image->getModality());
-	customReader->setImageType(image->getImageType());
-	customReader->setKey("WindowLevel", qstring_cast(image->getInitialWindowLevel()));
-	customReader->setKey("WindowWidth", qstring_cast(image->getInitialWindowWidth()));
-	customReader->setKey("Creator", QString("CustusX_%1").arg(CustusX_VERSION_STRING));
-}
+	// write all custom keys together with the image in one pass
+	MetaImageHeader keys;
+	keys.setTransform(image->get_rMd());
+	keys.setValue("Modality", enum2string(image->getModality()));
+	keys.setValue("ImageType3", enum2string(image->getImageType()));
+	keys.setValue("WindowLevel", qstring_cast(image->getInitialWindowLevel()));
+	keys.setValue("WindowWidth", qstring_cast(image->getInitialWindowWidth()));
+	keys.setValue("Creator", QString("CustusX_%1").arg(CustusX_VERSION_STRING));
+
+	MetaImageIO writer;
+	writer.setCompression(false);
+	if (MetaImageIO::canWrite(image->getBaseVtkImageData()))
+	{
+		writer.write(image->getBaseVtkImageData(), filename, keys);
+		return;
+	}
 
+	vtkMetaImageWriterPtr vtkWriter = vtkMetaImageWriterPtr::New();
+	vtkWriter->SetInputData(image->getBaseVtkImageData());
+	vtkWriter->SetFileDimensionality(3);
+	vtkWriter->SetFileName(cstring_cast(filename));
+	QDir().mkpath(QFileInfo(filename).path());
+	vtkWriter->SetCompression(false);
+	vtkWriter->Write();
+	vtkWriter = 0;
+
+	CustomMetaImagePtr customWriter = CustomMetaImage::create(filename);
+	std::vector<std::pair<QString, QString> > entries = keys.getEntries();
+	for (unsigned i = 0; i < entries.size(); ++i)
+		customWriter->setKey(entries[i].first, entries[i].second);
 }
 
 QString cx::MetaImageReader::canWriteDataType() const
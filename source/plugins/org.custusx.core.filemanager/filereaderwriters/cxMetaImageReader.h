@@ -15,6 +15,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "cxFileReaderWriterService.h"
 #include "org_custusx_core_filemanager_Export.h"
 #include <QFileInfo>
+#include "cxMetaImageHeader.h"
 
 class ctkPluginContext;
 
@@ -41,6 +42,9 @@ public:
 	QString canWriteDataType() const;
 	bool canWrite(const QString &type, const QString &filename) const;
 	virtual void write(DataPtr data, const QString& filename);
+
+private:
+	vtkImageDataPtr loadVtkImageData(QString filename, const MetaImageHeader& header);
 };
 
 }
@@ -72,7 +72,7 @@ ProbePtr OpenIGTLinkTool::getProbe() const
 
 double OpenIGTLinkTool::getTimestamp() const
 {
-    return mTimestamp;
+	return this->getTrackingTimestamp(); // matches get_prMt()
 }
 
 bool OpenIGTLinkTool::getVisible() const
@@ -162,9 +162,7 @@ void OpenIGTLinkTool::toolTransformAndTimestampSlot(Transform3D prMs, double tim
         prMt_filtered = mTrackingPositionFilter->getFilteredPosition();
     }
 
-    (*mPositionHistory)[mTimestamp] = prMt; // store original in history
-    m_prMt = prMt_filtered;
-    emit toolTransformAndTimestamp(m_prMt, mTimestamp);
+    this->addTrackingSample(prMt, prMt_filtered, mTimestamp, true); // store original in history
 }
 
 void OpenIGTLinkTool::checkTimestampMismatch()
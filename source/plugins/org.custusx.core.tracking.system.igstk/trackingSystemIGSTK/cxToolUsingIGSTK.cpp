@@ -30,7 +30,6 @@ ToolUsingIGSTK::ToolUsingIGSTK(IgstkToolPtr igstkTool) :
 				mTool(igstkTool),
 				mValid(false), mConfigured(false), mTracked(false)
 {
-	mTimestamp = 0;
 	Tool::mUid = getToolFileToolStructure()->mUid;
 	Tool::mName = getToolFileToolStructure()->mName;
 	mValid = igstkTool->isValid();
@@ -172,14 +171,10 @@ void ToolUsingIGSTK::toolTransformAndTimestampSlot(Transform3D matrix, double ti
 		prMt_filtered = mTrackingPositionFilter->getFilteredPosition();
 	}
 
-	mTimestamp = timestamp;
 	mMetadata[timestamp] = metadata;
 
 	// Store positions in history, but only if visible - the history has no concept of visibility
-	if (this->getVisible())
-		(*mPositionHistory)[timestamp] = matrix;
-	m_prMt = prMt_filtered;
-	emit toolTransformAndTimestamp(m_prMt, timestamp);
+	this->addTrackingSample(matrix, prMt_filtered, timestamp, this->getVisible());
 
 //	ToolImpl::set_prMt(matrix, timestamp);
 }
@@ -36,7 +36,8 @@ namespace cx
 IGTLinkClientStreamer::IGTLinkClientStreamer() :
 	mHeadingReceived(false),
 	mAddress(""),
-	mPort(0)
+	mPort(0),
+	mCompression(false)
 {
 }
 
@@ -78,6 +79,20 @@ void IGTLinkClientStreamer::startStreaming(SenderPtr sender)
 
 	// Create a message buffer to receive header
 	mHeaderMsg = igtl::MessageHeader::New();
+
+	if (mCompression)
+		this->requestCompression();
+}
+
+/** Ask the server to send compressed images. Servers not supporting
+ *  compression ignore the request and send uncompressed images.
+ */
+void IGTLinkClientStreamer::requestCompression()
+{
+	mDecoder = IGTLinkImageStreamDecoder();
+	igtl::StatusMessage::Pointer msg = IGTLinkImageStreamEncoder::createCompressionRequest();
+	msg->Pack();
+	mSocket->write(reinterpret_cast<const char*>(msg->GetPackPointer()), msg->GetPackSize());
 }
 
 bool IGTLinkClientStreamer::multipleTryConnectToHost()
@@ -206,6 +221,10 @@ bool IGTLinkClientStreamer::readOneMessage()
 		{
 			success = this->ReceiveImage(mSocket.get(), mHeaderMsg);
 		}
+		else if (QString(mHeaderMsg->GetDeviceType()) == "CX_ZIMAGE")
+		{
+			success = this->ReceiveCompressedImage(mSocket.get(), mHeaderMsg);
+		}
 		else if (QString(mHeaderMsg->GetDeviceType()) == "CX_US_ST")
 		{
 			success = this->ReceiveSonixStatus(mSocket.get(), mHeaderMsg);
@@ -314,6 +333,31 @@ bool IGTLinkClientStreamer::ReceiveImage(QTcpSocket* socket, igtl::MessageHeader
 	return true;
 }
 
+bool IGTLinkClientStreamer::ReceiveCompressedImage(QTcpSocket* socket, igtl::MessageHeader::Pointer& header)
+{
+	IGTLinkCompressedImageMessage::Pointer msg = IGTLinkCompressedImageMessage::New();
+	msg->SetMessageHeader(header);
+	msg->AllocatePack();
+
+	if (socket->bytesAvailable() < msg->GetPackBodySize())
+		return false;
+	socket->read(reinterpret_cast<char*>(msg->GetPackBodyPointer()), msg->GetPackBodySize());
+
+	int c = msg->Unpack();
+	if (!(c & (igtl::MessageHeader::UNPACK_BODY | igtl::MessageHeader::UNPACK_UNDEF)))
+	{
+		std::cout << "body crc failed!" << std::endl;
+		return true;
+	}
+
+	igtl::ImageMessage::Pointer imgMsg = mDecoder.decode(msg);
+	if (imgMsg)
+		this->addToQueue(imgMsg);
+	else
+		CX_LOG_WARNING() << "Failed to decode compressed image from " << msg->GetDeviceName() << ", waiting for next key frame.";
+	return true;
+}
+
 void IGTLinkClientStreamer::addToQueue(IGTLinkUSStatusMessage::Pointer msg)
 {
 	// set temporary, then assume the image adder will pass this message on.
@@ -16,6 +16,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include <QAbstractSocket>
 #include "cxIGTLinkImageMessage.h"
 #include "cxIGTLinkUSStatusMessage.h"
+#include "cxIGTLinkImageStreamCodec.h"
 #include "cxStreamedTimestampSynchronizer.h"
 
 class QTcpSocket;
@@ -40,6 +41,7 @@ public:
 	virtual ~IGTLinkClientStreamer();
 
 	void setAddress(QString address, int port);
+	void setCompression(bool on) { mCompression = on; } ///< request a compressed image stream from the server
 
 	virtual void startStreaming(SenderPtr sender);
 	virtual void stopStreaming();
@@ -62,6 +64,8 @@ private:
 	virtual QString hostDescription() const; // threadsafe
 	bool ReceiveImage(QTcpSocket* socket, igtl::MessageHeader::Pointer& header);
 	bool ReceiveSonixStatus(QTcpSocket* socket, igtl::MessageHeader::Pointer& header);
+	bool ReceiveCompressedImage(QTcpSocket* socket, igtl::MessageHeader::Pointer& header);
+	void requestCompression();
 	bool readOneMessage();
 	void addToQueue(IGTLinkUSStatusMessage::Pointer msg);
 	void addToQueue(igtl::ImageMessage::Pointer msg);
@@ -71,6 +75,8 @@ private:
 	bool mHeadingReceived;
 	QString mAddress;
 	int mPort;
+	bool mCompression;
+	IGTLinkImageStreamDecoder mDecoder;
     StreamedTimestampSynchronizer mStreamSynchronizer;
     boost::shared_ptr<QTcpSocket> mSocket;
 	igtl::MessageHeader::Pointer mHeaderMsg;
@@ -12,6 +12,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 
 #include "cxStringProperty.h"
 #include "cxDoubleProperty.h"
+#include "cxBoolProperty.h"
 #include "cxIGTLinkClientStreamer.h"
 
 namespace cx
@@ -32,6 +33,7 @@ std::vector<PropertyPtr> IGTLinkStreamerService::getSettings(QDomElement root)
 	std::vector<PropertyPtr> retval;
 	retval.push_back(this->getIPOption(root));
 	retval.push_back(this->getStreamPortOption(root));
+	retval.push_back(this->getCompressionOption(root));
 	return retval;
 }
 
@@ -40,6 +42,7 @@ StreamerPtr IGTLinkStreamerService::createStreamer(QDomElement root)
 	boost::shared_ptr<IGTLinkClientStreamer> streamer(new IGTLinkClientStreamer());
 	streamer->setAddress(this->getIPOption(root)->getValue(),
 						 this->getStreamPortOption(root)->getValue());
+	streamer->setCompression(this->getCompressionOption(root)->getValue());
 	return streamer;
 
 }
@@ -67,4 +70,16 @@ DoublePropertyBasePtr IGTLinkStreamerService::getStreamPortOption(QDomElement ro
 	return retval;
 }
 
+BoolPropertyBasePtr IGTLinkStreamerService::getCompressionOption(QDomElement root)
+{
+	BoolPropertyPtr retval;
+	retval = BoolProperty::initialize("compress_stream", "Compress stream",
+									  "Request lossless compression of the image stream from the server.\n"
+									  "Reduces network load, at the cost of some CPU time on both sides.",
+									  false, root);
+	retval->setAdvanced(true);
+	retval->setGroup("Connection");
+	return retval;
+}
+
 } // namespace cx
@@ -19,6 +19,7 @@ namespace cx
 {
 typedef boost::shared_ptr<class StringPropertyBase> StringPropertyBasePtr;
 typedef boost::shared_ptr<class DoublePropertyBase> DoublePropertyBasePtr;
+typedef boost::shared_ptr<class BoolPropertyBase> BoolPropertyBasePtr;
 
 /**
  * \ingroup org_custusx_core_video
@@ -40,6 +41,7 @@ public:
 private:
 	StringPropertyBasePtr getIPOption(QDomElement root);
 	DoublePropertyBasePtr getStreamPortOption(QDomElement root);
+	BoolPropertyBasePtr getCompressionOption(QDomElement root);
 };
 
 } //end namespace cx
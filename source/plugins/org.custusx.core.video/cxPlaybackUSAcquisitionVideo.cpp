@@ -12,6 +12,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "cxPlaybackUSAcquisitionVideo.h"
 #include <QStringList>
 #include <QDir>
+#include <algorithm>
 #include <QtCore>
 #include <boost/bind.hpp>
 #include "vtkImageImport.h"
@@ -30,6 +31,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "cxImageDataContainer.h"
 #include "cxVideoServiceBackend.h"
 #include "cxFileHelpers.h"
+#include "cxFileManagerService.h"
 #include <QtConcurrent>
 #include "cxTool.h"
 
@@ -85,6 +87,50 @@ void USAcquisitionVideoPlayback::setRoot(const QString path)
 {
 	mRoot = path;
 	mEvents = this->getEvents();
+	this->indexEvents();
+}
+
+namespace
+{
+bool startsBefore(const TimelineEvent& lhs, const TimelineEvent& rhs)
+{
+	return lhs.mStartTime < rhs.mStartTime;
+}
+}
+
+/** Sort events on start time, and create the lookup tables used by findEvent().
+ */
+void USAcquisitionVideoPlayback::indexEvents()
+{
+	std::stable_sort(mEvents.begin(), mEvents.end(), &startsBefore);
+
+	mEventStartTimes.clear();
+	mEventMaxEndTimes.clear();
+	for (unsigned i=0; i<mEvents.size(); ++i)
+	{
+		mEventStartTimes.push_back(mEvents[i].mStartTime);
+		double maxEnd = mEvents[i].mEndTime;
+		if (i>0)
+			maxEnd = std::max(maxEnd, mEventMaxEndTimes.back());
+		mEventMaxEndTimes.push_back(maxEnd);
+	}
+}
+
+/** Find the event containing time. If several events overlap,
+ *  the one starting last is used.
+ */
+TimelineEvent USAcquisitionVideoPlayback::findEvent(double time) const
+{
+	// last event starting at or before time
+	std::vector<double>::const_iterator iter = std::upper_bound(mEventStartTimes.begin(), mEventStartTimes.end(), time);
+	for (int i = int(std::distance(mEventStartTimes.begin(), iter)) - 1; i >= 0; --i)
+	{
+		if (mEventMaxEndTimes[i] < time)
+			break; // no earlier event reaches time
+		if (mEvents[i].isInside(time))
+			return mEvents[i];
+	}
+	return TimelineEvent();
 }
 
 std::vector<TimelineEvent> USAcquisitionVideoPlayback::getEvents()
@@ -129,15 +175,7 @@ QString USAcquisitionVideoPlayback::getType() const
 
 void USAcquisitionVideoPlayback::timerChangedSlot()
 {
-    TimelineEvent event;
-    for (unsigned i=0; i<mEvents.size(); ++i)
-    {
-        if (mEvents[i].isInside(mTimer->getTime().toMSecsSinceEpoch()))
-		{
-			event = mEvents[i];
-			break;
-		}
-	}
+	TimelineEvent event = this->findEvent(mTimer->getTime().toMSecsSinceEpoch());
 
 	this->loadFullData(event.mUid);
 	this->updateFrame(event.mUid);
@@ -159,6 +197,7 @@ void USAcquisitionVideoPlayback::loadFullData(QString filename)
 
 	// clear data
 	mCurrentData = USReconstructInputData();
+	mFrameCache.reset();
 
 	// if no new data, return
 	if (filename.isEmpty())
@@ -169,7 +208,7 @@ void USAcquisitionVideoPlayback::loadFullData(QString filename)
 	if (!mUSImageDataReader)
 	{
 		mUSImageDataReader.reset(new UsReconstructionFileReader(mBackend->file()));
-		mUSImageDataFutureResult = QtConcurrent::run(boost::bind(&UsReconstructionFileReader::readAllFiles, mUSImageDataReader, filename, ""));
+		mUSImageDataFutureResult = QtConcurrent::run(boost::bind(&UsReconstructionFileReader::readFramesAndProbe, mUSImageDataReader, filename, ""));
 		mUSImageDataFutureWatcher.setFuture(mUSImageDataFutureResult);
 	}
 }
@@ -198,6 +237,14 @@ void USAcquisitionVideoPlayback::usDataLoadFinishedSlot()
 	for (unsigned i=0; i<mCurrentData.mFrames.size(); ++i)
 		mCurrentTimestamps.push_back(mCurrentData.mFrames[i].mTime);
 
+	mFrameCache.reset();
+	if (mCurrentData.mUsRaw)
+	{
+		ImageDataContainerPtr frames = mCurrentData.mUsRaw->getImageContainer();
+		mFrameCache.reset(new USAcquisitionFrameCache(boost::bind(&USAcquisitionVideoPlayback::loadFrame, frames, mBackend->file(), _1),
+													  frames->size()));
+	}
+
 	this->updateFrame(mCurrentData.mFilename);
 }
 
@@ -211,7 +258,7 @@ void  USAcquisitionVideoPlayback::updateFrame(QString filename)
 		return;
 	}
 
-	if (mCurrentData.mFilename.isEmpty() || !mCurrentData.mUsRaw || filename!=mCurrentData.mFilename)
+	if (mCurrentData.mFilename.isEmpty() || !mCurrentData.mUsRaw || !mFrameCache || filename!=mCurrentData.mFilename)
 	{
 		mVideoSource->setInfoString(QString(""));
 		mVideoSource->setStatusString(QString("No US Acquisition"));
@@ -234,7 +281,7 @@ void  USAcquisitionVideoPlayback::updateFrame(QString filename)
 	int timeout = 1000; // invalidate data if timestamp differ from time too much
 	mVideoSource->overrideTimeout(fabs(timestamp-*iter)>timeout);
 
-	ImagePtr image(new Image(mVideoSourceUid, mCurrentData.mUsRaw->getImageContainer()->get(index)));
+	ImagePtr image(new Image(mVideoSourceUid, mFrameCache->getFrame(index)));
 	image->setAcquisitionTime(QDateTime::fromMSecsSinceEpoch(timestamp));
 
 	mVideoSource->setInfoString(QString("%1 - Frame %2").arg(mCurrentData.mUsRaw->getName()).arg(index));
@@ -246,6 +293,17 @@ void  USAcquisitionVideoPlayback::updateFrame(QString filename)
 	mVideoSource->setInput(image);
 }
 
+/** Decode one frame. Frames stored in separate files are read directly from file,
+ *  bypassing the container cache, so that only the frame cache keeps decoded frames.
+ */
+vtkImageDataPtr USAcquisitionVideoPlayback::loadFrame(ImageDataContainerPtr frames, FileManagerServicePtr fileManager, int index)
+{
+	CachedImageDataContainerPtr cached = boost::dynamic_pointer_cast<CachedImageDataContainer>(frames);
+	if (cached)
+		return fileManager->loadVtkImageData(cached->getFilename(index));
+	return frames->get(index);
+}
+
 
 
 } // cx
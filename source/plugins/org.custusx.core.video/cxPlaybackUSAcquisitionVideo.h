@@ -21,11 +21,13 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "cxUSReconstructInputData.h"
 #include "cxPlaybackTime.h"
 #include "cxForwardDeclarations.h"
+#include "cxUSAcquisitionFrameCache.h"
 
 namespace cx
 {
 typedef boost::shared_ptr<class BasicVideoSource> BasicVideoSourcePtr;
 typedef boost::shared_ptr<class VideoServiceBackend> VideoServiceBackendPtr;
+typedef boost::shared_ptr<class ImageDataContainer> ImageDataContainerPtr;
 
 /**
  * \file
@@ -36,6 +38,10 @@ typedef boost::shared_ptr<class VideoServiceBackend> VideoServiceBackendPtr;
 /**\brief Handler for playback of US image data
  * from a US recording session.
  *
+ * The recordings are indexed by timestamp when the root is set. Only the
+ * frames near the playhead of the active recording are decoded, through a
+ * bounded frame cache that reads ahead in the playback direction.
+ *
  * \ingroup org_custusx_core_video
  * \date Apr 11, 2012
  * \author Christian Askeland, SINTEF
@@ -63,12 +69,18 @@ private:
     void updateFrame(QString filename);
 	void loadFullData(QString filename);
 	QStringList getAbsolutePathToFtsFiles(QString folder);
+	void indexEvents();
+	TimelineEvent findEvent(double time) const;
+	static vtkImageDataPtr loadFrame(ImageDataContainerPtr frames, FileManagerServicePtr fileManager, int index);
 	QString mRoot;
     QString mType;
     PlaybackTimePtr mTimer;
 	BasicVideoSourcePtr mVideoSource;
-	std::vector<TimelineEvent> mEvents;
+	std::vector<TimelineEvent> mEvents; ///< sorted on start time
+	std::vector<double> mEventStartTimes;
+	std::vector<double> mEventMaxEndTimes; ///< max end time of events [0..i]
     const QString mVideoSourceUid;
+	USAcquisitionFrameCachePtr mFrameCache;
 
 	USReconstructInputData mCurrentData;
 	std::vector<double> mCurrentTimestamps; // copy of time frame timestamps from mCurrentData.
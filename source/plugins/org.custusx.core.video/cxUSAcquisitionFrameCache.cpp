@@ -0,0 +1,160 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "cxUSAcquisitionFrameCache.h"
+
+#include <algorithm>
+#include <QtConcurrent>
+#include <boost/bind.hpp>
+#include "vtkImageData.h"
+
+namespace cx
+{
+
+USAcquisitionFrameCache::USAcquisitionFrameCache(FrameLoader loader, int frameCount, int capacity, int readAhead) :
+	mLoader(loader),
+	mFrameCount(frameCount),
+	mCapacity(std::max(capacity, readAhead+1)),
+	mReadAhead(readAhead),
+	mPlayhead(-1),
+	mDirection(1),
+	mReadAheadRunning(false),
+	mStopped(false)
+{
+}
+
+USAcquisitionFrameCache::~USAcquisitionFrameCache()
+{
+	{
+		QMutexLocker lock(&mMutex);
+		mStopped = true;
+	}
+	mReadAheadFuture.waitForFinished();
+}
+
+vtkImageDataPtr USAcquisitionFrameCache::getFrame(int index)
+{
+	if (index < 0 || index >= mFrameCount)
+		return vtkImageDataPtr();
+
+	vtkImageDataPtr retval;
+	bool found = false;
+	{
+		QMutexLocker lock(&mMutex);
+		if (mPlayhead >= 0 && index != mPlayhead)
+			mDirection = (index > mPlayhead) ? 1 : -1;
+		mPlayhead = index;
+
+		std::map<int, std::pair<vtkImageDataPtr, LruList::iterator> >::iterator iter = mFrames.find(index);
+		if (iter != mFrames.end())
+		{
+			mLru.splice(mLru.begin(), mLru, iter->second.second);
+			retval = iter->second.first;
+			found = true;
+		}
+	}
+
+	if (!found)
+	{
+		retval = mLoader(index);
+		this->insert(index, retval);
+	}
+
+	QMutexLocker lock(&mMutex);
+	if (!mReadAheadRunning && !mStopped && this->getNextReadAheadIndex() >= 0)
+	{
+		mReadAheadRunning = true;
+		mReadAheadFuture = QtConcurrent::run(boost::bind(&USAcquisitionFrameCache::readAheadLoop, this));
+	}
+
+	return retval;
+}
+
+bool USAcquisitionFrameCache::isCached(int index) const
+{
+	QMutexLocker lock(&mMutex);
+	return mFrames.count(index) > 0;
+}
+
+int USAcquisitionFrameCache::getNumberOfCachedFrames() const
+{
+	QMutexLocker lock(&mMutex);
+	return mFrames.size();
+}
+
+void USAcquisitionFrameCache::waitForReadAhead()
+{
+	mReadAheadFuture.waitForFinished();
+}
+
+/** Decode frames ahead of the playhead until the window is filled.
+ *  The window follows the playhead if it moves while decoding.
+ */
+void USAcquisitionFrameCache::readAheadLoop()
+{
+	while (true)
+	{
+		int index = -1;
+		{
+			QMutexLocker lock(&mMutex);
+			if (!mStopped)
+				index = this->getNextReadAheadIndex();
+			if (index < 0)
+			{
+				mReadAheadRunning = false;
+				return;
+			}
+		}
+
+		vtkImageDataPtr image = mLoader(index);
+		this->insert(index, image);
+	}
+}
+
+/** Return the first frame in the read-ahead window that is not cached, -1 if none.
+ *  Call with mMutex locked.
+ */
+int USAcquisitionFrameCache::getNextReadAheadIndex() const
+{
+	if (mPlayhead < 0)
+		return -1;
+	for (int k = 1; k <= mReadAhead; ++k)
+	{
+		int index = mPlayhead + k * mDirection;
+		if (index < 0 || index >= mFrameCount)
+			break;
+		if (!mFrames.count(index))
+			return index;
+	}
+	return -1;
+}
+
+void USAcquisitionFrameCache::insert(int index, vtkImageDataPtr image)
+{
+	QMutexLocker lock(&mMutex);
+	std::map<int, std::pair<vtkImageDataPtr, LruList::iterator> >::iterator iter = mFrames.find(index);
+	if (iter != mFrames.end())
+	{
+		iter->second.first = image;
+		return;
+	}
+
+	mLru.push_front(index);
+	mFrames[index] = std::make_pair(image, mLru.begin());
+
+	while (int(mFrames.size()) > mCapacity)
+	{
+		mFrames.erase(mLru.back());
+		mLru.pop_back();
+	}
+}
+
+} // namespace cx
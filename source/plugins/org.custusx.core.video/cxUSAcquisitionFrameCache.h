@@ -0,0 +1,87 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#ifndef CXUSACQUISITIONFRAMECACHE_H_
+#define CXUSACQUISITIONFRAMECACHE_H_
+
+#include "org_custusx_core_video_Export.h"
+
+#include <list>
+#include <map>
+#include <QMutex>
+#include <QFuture>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include "vtkForwardDeclarations.h"
+
+namespace cx
+{
+
+/**
+ * \file
+ * \addtogroup org_custusx_core_video
+ * @{
+ */
+
+/**\brief Bounded cache of decoded frames from a US recording.
+ *
+ * Frames are decoded by the loader on demand. At most capacity frames are
+ * kept, the least recently used are dropped first. After each getFrame(),
+ * the next frames in the current playback direction are decoded in a
+ * background thread.
+ *
+ * The loader is called from both the calling thread and the background
+ * thread, and must be thread-safe.
+ *
+ * \ingroup org_custusx_core_video
+ * \date Oct 19, 2026
+ */
+class org_custusx_core_video_EXPORT USAcquisitionFrameCache
+{
+public:
+	typedef boost::function<vtkImageDataPtr(int)> FrameLoader;
+
+	USAcquisitionFrameCache(FrameLoader loader, int frameCount, int capacity = 64, int readAhead = 8);
+	~USAcquisitionFrameCache(); ///< waits for the background decoding to stop
+
+	vtkImageDataPtr getFrame(int index); ///< return frame, decode now if not cached.
+	bool isCached(int index) const;
+	int getNumberOfCachedFrames() const;
+	int getFrameCount() const { return mFrameCount; }
+	void waitForReadAhead(); ///< block until background decoding is idle
+
+private:
+	void readAheadLoop();
+	int getNextReadAheadIndex() const;
+	void insert(int index, vtkImageDataPtr image);
+
+	FrameLoader mLoader;
+	int mFrameCount;
+	int mCapacity;
+	int mReadAhead;
+
+	mutable QMutex mMutex;
+	typedef std::list<int> LruList; ///< most recently used first
+	LruList mLru;
+	std::map<int, std::pair<vtkImageDataPtr, LruList::iterator> > mFrames;
+	int mPlayhead;
+	int mDirection;
+	bool mReadAheadRunning;
+	bool mStopped;
+	QFuture<void> mReadAheadFuture;
+};
+typedef boost::shared_ptr<USAcquisitionFrameCache> USAcquisitionFrameCachePtr;
+
+/**
+ * @}
+ */
+} // namespace cx
+
+#endif /* CXUSACQUISITIONFRAMECACHE_H_ */
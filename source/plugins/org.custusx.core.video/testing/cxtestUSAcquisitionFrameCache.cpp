@@ -0,0 +1,88 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "catch.hpp"
+#include <QAtomicInt>
+#include <boost/bind.hpp>
+#include "vtkImageData.h"
+#include "cxUSAcquisitionFrameCache.h"
+#include "cxVolumeHelpers.h"
+
+namespace cxtest
+{
+
+namespace
+{
+/** Create a frame containing its own index, count the calls. */
+vtkImageDataPtr createFrame(QAtomicInt* loadCount, int index)
+{
+	loadCount->fetchAndAddOrdered(1);
+	return cx::generateVtkImageData(Eigen::Array3i(4, 4, 1), cx::Vector3D(1, 1, 1), index);
+}
+
+int getFrameValue(vtkImageDataPtr frame)
+{
+	return *static_cast<unsigned char*>(frame->GetScalarPointer());
+}
+}
+
+TEST_CASE("USAcquisitionFrameCache: Returns requested frames", "[unit][plugins][org.custusx.core.video]")
+{
+	QAtomicInt loadCount(0);
+	cx::USAcquisitionFrameCache cache(boost::bind(&createFrame, &loadCount, _1), 20, 10, 0);
+
+	REQUIRE(cache.getFrame(3));
+	CHECK(getFrameValue(cache.getFrame(3)) == 3);
+	CHECK(getFrameValue(cache.getFrame(7)) == 7);
+	CHECK(loadCount.load() == 2);
+	CHECK_FALSE(cache.getFrame(20));
+	CHECK_FALSE(cache.getFrame(-1));
+}
+
+TEST_CASE("USAcquisitionFrameCache: Keeps at most capacity frames", "[unit][plugins][org.custusx.core.video]")
+{
+	QAtomicInt loadCount(0);
+	cx::USAcquisitionFrameCache cache(boost::bind(&createFrame, &loadCount, _1), 100, 5, 0);
+
+	for (int i = 0; i < 20; ++i)
+		cache.getFrame(i);
+
+	CHECK(cache.getNumberOfCachedFrames() == 5);
+	CHECK(cache.isCached(19));
+	CHECK(cache.isCached(15));
+	CHECK_FALSE(cache.isCached(14));
+}
+
+TEST_CASE("USAcquisitionFrameCache: Reads ahead in playback direction", "[unit][plugins][org.custusx.core.video]")
+{
+	QAtomicInt loadCount(0);
+	cx::USAcquisitionFrameCache cache(boost::bind(&createFrame, &loadCount, _1), 100, 20, 4);
+
+	cache.getFrame(50);
+	cache.waitForReadAhead();
+	for (int i = 51; i <= 54; ++i)
+		CHECK(cache.isCached(i));
+	CHECK_FALSE(cache.isCached(55));
+
+	cache.getFrame(40);
+	cache.waitForReadAhead();
+	for (int i = 36; i < 40; ++i)
+		CHECK(cache.isCached(i));
+	CHECK_FALSE(cache.isCached(35));
+	CHECK_FALSE(cache.isCached(41));
+
+	int loadsBefore = loadCount.load();
+	CHECK(getFrameValue(cache.getFrame(39)) == 39);
+	cache.waitForReadAhead();
+	CHECK(loadCount.load() == loadsBefore + 1); // only frame 35 is new
+}
+
+} // namespace cxtest
@@ -0,0 +1,270 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#include "cxBranchPointIndex.h"
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include "cxBranchList.h"
+#include "cxBranch.h"
+
+namespace cx
+{
+
+namespace
+{
+const int MAX_CELLS_PER_DIMENSION = 128;
+const double POINTS_PER_CELL = 4.0;
+}
+
+BranchPointIndex::BranchPointIndex() :
+	mCellSize(1)
+{
+	for (int i = 0; i < 3; ++i)
+	{
+		mOrigin[i] = 0;
+		mDim[i] = 0;
+	}
+}
+
+void BranchPointIndex::clear()
+{
+	mBranches.clear();
+	mCoords.clear();
+	mBranchIndex.clear();
+	mPositionIndex.clear();
+	mOrder.clear();
+	mCellStart.clear();
+	for (int i = 0; i < 3; ++i)
+		mDim[i] = 0;
+}
+
+bool BranchPointIndex::isEmpty() const
+{
+	return mOrder.empty();
+}
+
+int BranchPointIndex::getNumberOfPoints() const
+{
+	return mOrder.size();
+}
+
+void BranchPointIndex::build(BranchListPtr branchList, int minGeneration)
+{
+	this->clear();
+	if (!branchList)
+		return;
+
+	std::vector<BranchPtr> branches = branchList->getBranches();
+
+	std::vector<double> coords;
+	std::vector<int> branchIndex;
+	std::vector<int> positionIndex;
+	for (unsigned i = 0; i < branches.size(); ++i)
+	{
+		if (minGeneration > 0 && branches[i]->findGenerationNumber() < minGeneration)
+			continue;
+		Eigen::MatrixXd positions = branches[i]->getPositions();
+		if (positions.cols() == 0)
+			continue;
+
+		int localBranchIndex = mBranches.size();
+		mBranches.push_back(branches[i]);
+		for (int j = 0; j < positions.cols(); ++j)
+		{
+			coords.push_back(positions(0, j));
+			coords.push_back(positions(1, j));
+			coords.push_back(positions(2, j));
+			branchIndex.push_back(localBranchIndex);
+			positionIndex.push_back(j);
+		}
+	}
+
+	if (!branchIndex.empty())
+		this->bucketPoints(coords, branchIndex, positionIndex);
+}
+
+void BranchPointIndex::bucketPoints(const std::vector<double>& coords, const std::vector<int>& branchIndex, const std::vector<int>& positionIndex)
+{
+	int N = branchIndex.size();
+
+	double minPos[3];
+	double maxPos[3];
+	for (int a = 0; a < 3; ++a)
+	{
+		minPos[a] = coords[a];
+		maxPos[a] = coords[a];
+	}
+	for (int i = 1; i < N; ++i)
+		for (int a = 0; a < 3; ++a)
+		{
+			minPos[a] = std::min(minPos[a], coords[3*i+a]);
+			maxPos[a] = std::max(maxPos[a], coords[3*i+a]);
+		}
+
+	// Cells are sized for a few points each, but never more than
+	// MAX_CELLS_PER_DIMENSION along the longest axis.
+	double maxExtent = 0;
+	for (int a = 0; a < 3; ++a)
+		maxExtent = std::max(maxExtent, maxPos[a] - minPos[a]);
+
+	if (maxExtent > 0)
+	{
+		double minCellSize = maxExtent / MAX_CELLS_PER_DIMENSION;
+		double volume = 1;
+		for (int a = 0; a < 3; ++a)
+			volume *= std::max(maxPos[a] - minPos[a], minCellSize);
+		mCellSize = std::max(std::cbrt(volume * POINTS_PER_CELL / N), minCellSize);
+	}
+	else
+	{
+		mCellSize = 1;
+	}
+
+	for (int a = 0; a < 3; ++a)
+	{
+		mOrigin[a] = minPos[a];
+		mDim[a] = int((maxPos[a] - minPos[a]) / mCellSize) + 1;
+	}
+
+	// counting sort of the points by cell, stable so that scan order is kept within each cell
+	int numberOfCells = mDim[0] * mDim[1] * mDim[2];
+	std::vector<int> cellOfPoint(N);
+	mCellStart.assign(numberOfCells + 1, 0);
+	for (int i = 0; i < N; ++i)
+	{
+		int cell = this->getCellIndex(this->getCellCoordinate(coords[3*i+0], 0),
+									  this->getCellCoordinate(coords[3*i+1], 1),
+									  this->getCellCoordinate(coords[3*i+2], 2));
+		cellOfPoint[i] = cell;
+		++mCellStart[cell + 1];
+	}
+	for (int c = 0; c < numberOfCells; ++c)
+		mCellStart[c + 1] += mCellStart[c];
+
+	mCoords.resize(3 * N);
+	mBranchIndex.resize(N);
+	mPositionIndex.resize(N);
+	mOrder.resize(N);
+	std::vector<int> next(mCellStart.begin(), mCellStart.end() - 1);
+	for (int i = 0; i < N; ++i)
+	{
+		int k = next[cellOfPoint[i]]++;
+		for (int a = 0; a < 3; ++a)
+			mCoords[3*k+a] = coords[3*i+a];
+		mBranchIndex[k] = branchIndex[i];
+		mPositionIndex[k] = positionIndex[i];
+		mOrder[k] = i;
+	}
+}
+
+int BranchPointIndex::getCellCoordinate(double value, int axis) const
+{
+	double c = std::floor((value - mOrigin[axis]) / mCellSize);
+	if (c < 0)
+		return 0;
+	if (c >= mDim[axis])
+		return mDim[axis] - 1;
+	return int(c);
+}
+
+int BranchPointIndex::getCellIndex(int x, int y, int z) const
+{
+	return (z * mDim[1] + y) * mDim[0] + x;
+}
+
+void BranchPointIndex::searchCell(int cell, const Vector3D& point, double* bestDistance2, int* bestPoint) const
+{
+	for (int k = mCellStart[cell]; k < mCellStart[cell + 1]; ++k)
+	{
+		double d0 = mCoords[3*k+0] - point[0];
+		double d1 = mCoords[3*k+1] - point[1];
+		double d2 = mCoords[3*k+2] - point[2];
+		double D2 = d0*d0 + d1*d1 + d2*d2;
+		if (*bestPoint < 0 || D2 < *bestDistance2 || (D2 == *bestDistance2 && mOrder[k] < mOrder[*bestPoint]))
+		{
+			*bestDistance2 = D2;
+			*bestPoint = k;
+		}
+	}
+}
+
+/** Lower bound for the distance from point to any cell outside the
+ *  cube of cells within radius of center.
+ */
+double BranchPointIndex::getDistanceToUnvisitedCells(const Vector3D& point, const int* center, int radius) const
+{
+	double retval = std::numeric_limits<double>::max();
+	for (int a = 0; a < 3; ++a)
+	{
+		if (center[a] - radius > 0)
+			retval = std::min(retval, point[a] - (mOrigin[a] + (center[a] - radius) * mCellSize));
+		if (center[a] + radius < mDim[a] - 1)
+			retval = std::min(retval, (mOrigin[a] + (center[a] + radius + 1) * mCellSize) - point[a]);
+	}
+	return retval;
+}
+
+BranchPointIndex::ClosestPoint BranchPointIndex::findClosest(const Vector3D& point) const
+{
+	ClosestPoint retval;
+	if (this->isEmpty())
+		return retval;
+
+	int center[3];
+	for (int a = 0; a < 3; ++a)
+		center[a] = this->getCellCoordinate(point[a], a);
+	int maxRadius = std::max(mDim[0], std::max(mDim[1], mDim[2]));
+
+	double bestDistance2 = std::numeric_limits<double>::max();
+	int bestPoint = -1;
+
+	for (int r = 0; r < maxRadius; ++r)
+	{
+		int z0 = std::max(center[2] - r, 0);
+		int z1 = std::min(center[2] + r, mDim[2] - 1);
+		int y0 = std::max(center[1] - r, 0);
+		int y1 = std::min(center[1] + r, mDim[1] - 1);
+		for (int z = z0; z <= z1; ++z)
+			for (int y = y0; y <= y1; ++y)
+			{
+				bool onShell = (std::abs(z - center[2]) == r) || (std::abs(y - center[1]) == r);
+				if (onShell)
+				{
+					int x0 = std::max(center[0] - r, 0);
+					int x1 = std::min(center[0] + r, mDim[0] - 1);
+					for (int x = x0; x <= x1; ++x)
+						this->searchCell(this->getCellIndex(x, y, z), point, &bestDistance2, &bestPoint);
+				}
+				else
+				{
+					if (center[0] - r >= 0)
+						this->searchCell(this->getCellIndex(center[0] - r, y, z), point, &bestDistance2, &bestPoint);
+					if (r > 0 && center[0] + r < mDim[0])
+						this->searchCell(this->getCellIndex(center[0] + r, y, z), point, &bestDistance2, &bestPoint);
+				}
+			}
+
+		if (bestPoint < 0)
+			continue;
+		// strict comparison: an unvisited position at the same distance might come first in scan order
+		double bound = this->getDistanceToUnvisitedCells(point, center, r);
+		if (bound > 0 && bestDistance2 < bound * bound)
+			break;
+	}
+
+	retval.branch = mBranches[mBranchIndex[bestPoint]];
+	retval.positionIndex = mPositionIndex[bestPoint];
+	retval.distance = std::sqrt(bestDistance2);
+	return retval;
+}
+
+} /* namespace cx */
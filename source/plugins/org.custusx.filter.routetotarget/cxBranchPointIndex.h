@@ -0,0 +1,87 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#ifndef CXBRANCHPOINTINDEX_H
+#define CXBRANCHPOINTINDEX_H
+
+#include "org_custusx_filter_routetotarget_Export.h"
+
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include "cxVector3D.h"
+
+namespace cx
+{
+
+typedef boost::shared_ptr<class BranchList> BranchListPtr;
+typedef boost::shared_ptr<class Branch> BranchPtr;
+typedef boost::shared_ptr<class BranchPointIndex> BranchPointIndexPtr;
+
+/** Spatial index over all centerline positions in a BranchList.
+ *
+ * The positions are bucketed in a uniform grid, and closest point queries
+ * search outwards from the cell containing the query point until no
+ * unvisited cell can contain a closer position.
+ *
+ * Ties are resolved as in a linear scan over all branches and positions in
+ * BranchList order: the first position with the smallest distance is returned.
+ * The index is a snapshot: rebuild it if the branches are changed.
+ * findClosest() is const and can be called from several threads at once.
+ *
+ * \ingroup cx_module_algorithm
+ * \date Oct 19, 2026
+ */
+class org_custusx_filter_routetotarget_EXPORT BranchPointIndex
+{
+public:
+	struct ClosestPoint
+	{
+		ClosestPoint() : positionIndex(-1), distance(-1) {}
+		BranchPtr branch; ///< empty if the index is empty
+		int positionIndex; ///< column in branch->getPositions()
+		double distance;
+	};
+
+	static BranchPointIndexPtr create() { return BranchPointIndexPtr(new BranchPointIndex()); }
+	BranchPointIndex();
+
+	/** Index all positions in branches with findGenerationNumber() >= minGeneration.
+	 */
+	void build(BranchListPtr branches, int minGeneration = 0);
+	void clear();
+	bool isEmpty() const;
+	int getNumberOfPoints() const;
+
+	ClosestPoint findClosest(const Vector3D& point) const;
+
+private:
+	void bucketPoints(const std::vector<double>& coords, const std::vector<int>& branchIndex, const std::vector<int>& positionIndex);
+	int getCellCoordinate(double value, int axis) const;
+	int getCellIndex(int x, int y, int z) const;
+	void searchCell(int cell, const Vector3D& point, double* bestDistance2, int* bestPoint) const;
+	double getDistanceToUnvisitedCells(const Vector3D& point, const int* center, int radius) const;
+
+	std::vector<BranchPtr> mBranches;
+
+	// points sorted by grid cell, points in cell c are in [mCellStart[c], mCellStart[c+1])
+	std::vector<double> mCoords;
+	std::vector<int> mBranchIndex;
+	std::vector<int> mPositionIndex;
+	std::vector<int> mOrder; ///< position in the original BranchList scan order, used to break ties
+	std::vector<int> mCellStart;
+
+	double mOrigin[3];
+	double mCellSize;
+	int mDim[3];
+};
+
+} /* namespace cx */
+
+#endif // CXBRANCHPOINTINDEX_H
@@ -19,6 +19,8 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QList>
+#include <boost/bind.hpp>
+#include "cxParallelFor.h"
 
 #define PI 3.1415926535897
 
@@ -31,7 +33,10 @@ RouteToTarget::RouteToTarget():
 	mBranchListPtr(new BranchList),
 	mProjectedIndex(0),
 	mBloodVesselBranchListPtr(new BranchList),
-	mProjectedBloodVesselIndex(0)
+	mProjectedBloodVesselIndex(0),
+	mBranchPointIndex(BranchPointIndex::create()),
+	mDeepBranchPointIndex(BranchPointIndex::create()),
+	mBloodVesselBranchPointIndex(BranchPointIndex::create())
 {
 }
 
@@ -76,6 +81,9 @@ void RouteToTarget::processCenterline(MeshPtr mesh)
 	mBranchListPtr->smoothOrientations();
 	//mBranchListPtr->smoothBranchPositions(40);
 
+	mBranchPointIndex->build(mBranchListPtr);
+	mDeepBranchPointIndex->build(mBranchListPtr, 3);
+
 	std::cout << "Number of branches in CT centerline: " << mBranchListPtr->getBranches().size() << std::endl;
 }
 
@@ -123,58 +131,29 @@ void RouteToTarget::processBloodVesselCenterline(Eigen::MatrixXd positions)
 		mBloodVesselBranchListPtr->smoothRadius();
 	}
 
+	mBloodVesselBranchPointIndex->build(mBloodVesselBranchListPtr);
 
 	CX_LOG_INFO() << "Number of branches in CT blood vessel centerline: " << mBloodVesselBranchListPtr->getBranches().size();
 }
 
 void RouteToTarget::findClosestPointInBranches(Vector3D targetCoordinate_r)
 {
-	double minDistance = 100000;
-	int minDistancePositionIndex;
-	BranchPtr minDistanceBranch;
-	std::vector<BranchPtr> branches = mBranchListPtr->getBranches();
-	for (int i = 0; i < branches.size(); i++)
-	{
-		Eigen::MatrixXd positions = branches[i]->getPositions();
-		for (int j = 0; j < positions.cols(); j++)
-		{
-			double D = findDistance(positions.col(j), targetCoordinate_r);
-			if (D < minDistance)
-			{
-				minDistance = D;
-				minDistanceBranch = branches[i];
-				minDistancePositionIndex = j;
-			}
-		}
-	}
+	if (mBranchPointIndex->isEmpty())
+		mBranchPointIndex->build(mBranchListPtr);
 
-		mProjectedBranchPtr = minDistanceBranch;
-		mProjectedIndex = minDistancePositionIndex;
+	BranchPointIndex::ClosestPoint closest = mBranchPointIndex->findClosest(targetCoordinate_r);
+	mProjectedBranchPtr = closest.branch;
+	mProjectedIndex = closest.positionIndex;
 }
 
 void RouteToTarget::findClosestPointInBloodVesselBranches(Vector3D targetCoordinate_r)
 {
-	double minDistance = 100000;
-	int minDistancePositionIndex;
-	BranchPtr minDistanceBranch;
-	std::vector<BranchPtr> branches = mBloodVesselBranchListPtr->getBranches();
-	for (int i = 0; i < branches.size(); i++)
-	{
-		Eigen::MatrixXd positions = branches[i]->getPositions();
-		for (int j = 0; j < positions.cols(); j++)
-		{
-			double D = findDistance(positions.col(j), targetCoordinate_r);
-			if (D < minDistance)
-			{
-				minDistance = D;
-				minDistanceBranch = branches[i];
-				minDistancePositionIndex = j;
-			}
-		}
-	}
+	if (mBloodVesselBranchPointIndex->isEmpty())
+		mBloodVesselBranchPointIndex->build(mBloodVesselBranchListPtr);
 
-		mProjectedBloodVesselBranchPtr = minDistanceBranch;
-		mProjectedBloodVesselIndex = minDistancePositionIndex;
+	BranchPointIndex::ClosestPoint closest = mBloodVesselBranchPointIndex->findClosest(targetCoordinate_r);
+	mProjectedBloodVesselBranchPtr = closest.branch;
+	mProjectedBloodVesselIndex = closest.positionIndex;
 }
 
 
@@ -200,20 +179,23 @@ void RouteToTarget::findRoutePositionsInBloodVessels()
 */
 void RouteToTarget::searchBranchUp(BranchPtr searchBranchPtr, int startIndex)
 {
-	if (!searchBranchPtr)
-		return;
-
-	//std::vector< Eigen::Vector3d > positions = smoothBranch(searchBranchPtr, startIndex, searchBranchPtr->getPositions().col(startIndex));
-	std::vector< Eigen::Vector3d > positions = getBranchPositions(searchBranchPtr, startIndex);
+	collectRoutePositions(searchBranchPtr, startIndex, &mRoutePositions, &mBranchingIndex);
+}
 
-	for (int i = 0; i<=startIndex && i<positions.size(); i++)
-		mRoutePositions.push_back(positions[i]);
+void RouteToTarget::collectRoutePositions(BranchPtr searchBranchPtr, int startIndex, std::vector< Eigen::Vector3d >* routePositions, std::vector< int >* branchingIndex)
+{
+	while (searchBranchPtr)
+	{
+		Eigen::MatrixXd branchPositions = searchBranchPtr->getPositions();
+		for (int i = std::min<int>(startIndex, branchPositions.cols()-1); i >= 0; i--)
+			routePositions->push_back(branchPositions.col(i));
 
-	mBranchingIndex.push_back(mRoutePositions.size()-1);
+		branchingIndex->push_back(routePositions->size()-1);
 
-	BranchPtr parentBranchPtr = searchBranchPtr->getParentBranch();
-	if (parentBranchPtr)
-		searchBranchUp(parentBranchPtr, parentBranchPtr->getPositions().cols()-1);
+		searchBranchPtr = searchBranchPtr->getParentBranch();
+		if (searchBranchPtr)
+			startIndex = searchBranchPtr->getPositions().cols()-1;
+	}
 }
 
 void RouteToTarget::searchBloodVesselBranchUp(BranchPtr searchBranchPtr, int startIndex)
@@ -242,7 +224,12 @@ void RouteToTarget::searchBloodVesselBranchUp(BranchPtr searchBranchPtr, int sta
 
 vtkPolyDataPtr RouteToTarget::findRouteToTarget(PointMetricPtr targetPoint)
 {
-	mTargetPosition = targetPoint->getCoordinate();
+	return this->findRouteToTarget(targetPoint->getCoordinate());
+}
+
+vtkPolyDataPtr RouteToTarget::findRouteToTarget(Vector3D targetCoordinate_r)
+{
+	mTargetPosition = targetCoordinate_r;
 
 	findClosestPointInBranches(mTargetPosition);
 	findRoutePositions();
@@ -252,6 +239,38 @@ vtkPolyDataPtr RouteToTarget::findRouteToTarget(PointMetricPtr targetPoint)
 	return retval;
 }
 
+/*
+    RouteToTarget::findRoutesToTargets finds the route-to-target for each of the given targets,
+    equivalent to calling RouteToTarget::findRouteToTarget for each target in turn.
+    The closest point and route positions for the targets are found in parallel, and the
+    current route (mRoutePositions etc.) is not changed.
+*/
+std::vector<vtkPolyDataPtr> RouteToTarget::findRoutesToTargets(std::vector<Vector3D> targetCoordinates_r)
+{
+	if (mBranchPointIndex->isEmpty())
+		mBranchPointIndex->build(mBranchListPtr);
+
+	int numberOfTargets = targetCoordinates_r.size();
+	std::vector< std::vector< Eigen::Vector3d > > routes(numberOfTargets);
+	std::vector< std::vector< int > > branchingIndices(numberOfTargets);
+
+	parallelFor(0, numberOfTargets, boost::bind(&RouteToTarget::findRoutesInRange, mBranchPointIndex, boost::cref(targetCoordinates_r), &routes, &branchingIndices, _1, _2));
+
+	std::vector<vtkPolyDataPtr> retval;
+	for (int i = 0; i < numberOfTargets; ++i)
+		retval.push_back(addVTKPoints(routes[i]));
+	return retval;
+}
+
+void RouteToTarget::findRoutesInRange(BranchPointIndexPtr index, const std::vector<Vector3D>& targets, std::vector< std::vector< Eigen::Vector3d > >* routes, std::vector< std::vector< int > >* branchingIndices, int begin, int end)
+{
+	for (int i = begin; i < end; ++i)
+	{
+		BranchPointIndex::ClosestPoint closest = index->findClosest(targets[i]);
+		collectRoutePositions(closest.branch, closest.positionIndex, &(*routes)[i], &(*branchingIndices)[i]);
+	}
+}
+
 
 vtkPolyDataPtr RouteToTarget::findExtendedRoute(PointMetricPtr targetPoint)
 {
@@ -312,6 +331,7 @@ vtkPolyDataPtr RouteToTarget::generateAirwaysFromBloodVesselCenterlines()
 	AirwaysFromCenterlinePtr airwaysFromBVCenterlinePtr = AirwaysFromCenterlinePtr(new AirwaysFromCenterline());
 	airwaysFromBVCenterlinePtr->setTypeToBloodVessel(true);
 	mBloodVesselBranchListPtr->interpolateBranchPositions(5);
+	mBloodVesselBranchPointIndex->clear();
 	airwaysFromBVCenterlinePtr->setBranches(mBloodVesselBranchListPtr);
 
 	airwayMesh = airwaysFromBVCenterlinePtr->generateTubes(2);
@@ -339,32 +359,33 @@ bool RouteToTarget::makeConnectedAirwayAndBloodVesselRoute()
 		return false;
 	}
 
-	std::vector<BranchPtr> branches = mBranchListPtr->getBranches();
 	double minDistance = ( mRoutePositions[0] - mBloodVesselRoutePositions[mBloodVesselRoutePositions.size()-1] ).norm();
 	int connectionIndexBloodVesselRoute = mBloodVesselRoutePositions.size()-1;
 	bool closerAirwayFound = false;
 	Vector3D closestPosition;
-	for (int i = 0; i<branches.size(); i++) //check for closer airway branch to blood vessel route
+	//check for closer airway branch to blood vessel route: closest deep airway position to each blood vessel route position
+	if (mDeepBranchPointIndex->isEmpty())
+		mDeepBranchPointIndex->build(mBranchListPtr, 3);
+	BranchPointIndex::ClosestPoint closestAirway;
+	for (int i = 0; i<mBloodVesselRoutePositions.size(); i++)
 	{
-		if ( branches[i]->findGenerationNumber() > 2 )//Needs to be deeper branch
+		BranchPointIndex::ClosestPoint candidate = mDeepBranchPointIndex->findClosest(mBloodVesselRoutePositions[i]);
+		if (candidate.branch && minDistance > candidate.distance)
 		{
-			Eigen::MatrixXd branchPositinos = branches[i]->getPositions();
-			for (int j = 0; j<branchPositinos.cols(); j++)
-			{
-				double distance = findDistanceToLine(branchPositinos.col(j), mBloodVesselRoutePositions).second;
-				if (minDistance > distance)
-				{
-					minDistance = distance;
-					closestPosition = branchPositinos.col(j);
-					closerAirwayFound = true;
-					mProjectedBranchPtr = branches[i];
-					mProjectedIndex = j;
-					connectionIndexBloodVesselRoute = findDistanceToLine(branchPositinos.col(j), mBloodVesselRoutePositions).first;
-				}
-			}
+			minDistance = candidate.distance;
+			closestAirway = candidate;
+			closerAirwayFound = true;
 		}
 	}
 
+	if (closerAirwayFound)
+	{
+		closestPosition = closestAirway.branch->getPositions().col(closestAirway.positionIndex);
+		mProjectedBranchPtr = closestAirway.branch;
+		mProjectedIndex = closestAirway.positionIndex;
+		connectionIndexBloodVesselRoute = findDistanceToLine(closestPosition, mBloodVesselRoutePositions).first;
+	}
+
 	if (closerAirwayFound) //calculating new route
 	{
 		findClosestPointInBranches(closestPosition);
@@ -4,6 +4,7 @@
 #include "org_custusx_filter_routetotarget_Export.h"
 
 #include "cxMesh.h"
+#include "cxBranchPointIndex.h"
 #include <QDomElement>
 
 
@@ -33,6 +34,8 @@ public:
 	void searchBranchUp(BranchPtr searchBranchPtr, int startIndex);
 	void searchBloodVesselBranchUp(BranchPtr searchBranchPtr, int startIndex);
 	vtkPolyDataPtr findRouteToTarget(PointMetricPtr targetPoint);
+	vtkPolyDataPtr findRouteToTarget(Vector3D targetCoordinate_r);
+	std::vector<vtkPolyDataPtr> findRoutesToTargets(std::vector<Vector3D> targetCoordinates_r);
 	vtkPolyDataPtr findExtendedRoute(PointMetricPtr targetPoint);
 	vtkPolyDataPtr findRouteToTargetAlongBloodVesselCenterlines(MeshPtr bloodVesselCenterlineMesh, PointMetricPtr targetPoint);
 	vtkPolyDataPtr generateAirwaysFromBloodVesselCenterlines();
@@ -67,6 +70,11 @@ private:
 	std::vector<BranchPtr> mSearchBranchPtrVector;
 	std::vector<int> mSearchIndexVector;
 	Eigen::MatrixXd mConnectedPointsInBVCL;
+	BranchPointIndexPtr mBranchPointIndex;
+	BranchPointIndexPtr mDeepBranchPointIndex; ///< branches deeper than generation 2, used to connect to blood vessel routes
+	BranchPointIndexPtr mBloodVesselBranchPointIndex;
+	static void collectRoutePositions(BranchPtr searchBranchPtr, int startIndex, std::vector< Eigen::Vector3d >* routePositions, std::vector< int >* branchingIndex);
+	static void findRoutesInRange(BranchPointIndexPtr index, const std::vector<Vector3D>& targets, std::vector< std::vector< Eigen::Vector3d > >* routes, std::vector< std::vector< int > >* branchingIndices, int begin, int end);
 	std::vector<Eigen::Vector3d> smoothBranch(BranchPtr branchPtr, int startIndex, Eigen::MatrixXd startPosition);
 	bool checkIfRouteToTargetEndsAtEndOfLastBranch();
 	bool mPathToBloodVesselsFound = false;
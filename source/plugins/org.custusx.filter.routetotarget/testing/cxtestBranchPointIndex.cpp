@@ -0,0 +1,154 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "catch.hpp"
+
+#include <cmath>
+#include <random>
+#include "cxBranchPointIndex.h"
+#include "cxBranchList.h"
+#include "cxBranch.h"
+
+namespace cxtest
+{
+
+namespace
+{
+
+/** Create a random tree of branches. Each branch is a random walk starting
+ *  at a random position in its parent. Some positions are copies of
+ *  positions in earlier branches, giving ties in the closest point search.
+ */
+cx::BranchListPtr createRandomBranchList(int numberOfBranches, int positionsPerBranch, unsigned seed)
+{
+	std::mt19937 generator(seed);
+	std::uniform_real_distribution<double> start(0, 100);
+	std::uniform_real_distribution<double> step(-1, 1);
+
+	cx::BranchListPtr retval(new cx::BranchList());
+	std::vector<cx::BranchPtr> branches;
+	for (int i = 0; i < numberOfBranches; ++i)
+	{
+		cx::BranchPtr branch(new cx::Branch());
+		Eigen::MatrixXd positions(3, positionsPerBranch);
+		Eigen::Vector3d current(start(generator), start(generator), start(generator));
+		if (i > 0)
+		{
+			cx::BranchPtr parent = branches[generator() % branches.size()];
+			Eigen::MatrixXd parentPositions = parent->getPositions();
+			current = parentPositions.col(generator() % parentPositions.cols());
+			branch->setParentBranch(parent);
+			parent->addChildBranch(branch);
+		}
+		for (int j = 0; j < positionsPerBranch; ++j)
+		{
+			current += Eigen::Vector3d(step(generator), step(generator), step(generator));
+			positions.col(j) = current;
+		}
+		if (i > 0)
+			positions.col(positionsPerBranch/2) = branches[i-1]->getPositions().col(0);
+
+		branch->setPositions(positions);
+		branches.push_back(branch);
+		retval->addBranch(branch);
+	}
+	return retval;
+}
+
+/** The first position with the smallest distance, scanning all positions in BranchList order.
+ */
+cx::BranchPointIndex::ClosestPoint findClosestByLinearScan(cx::BranchListPtr branchList, const cx::Vector3D& point, int minGeneration)
+{
+	cx::BranchPointIndex::ClosestPoint retval;
+	double bestDistance2 = 0;
+	std::vector<cx::BranchPtr> branches = branchList->getBranches();
+	for (unsigned i = 0; i < branches.size(); ++i)
+	{
+		if (minGeneration > 0 && branches[i]->findGenerationNumber() < minGeneration)
+			continue;
+		Eigen::MatrixXd positions = branches[i]->getPositions();
+		for (int j = 0; j < positions.cols(); ++j)
+		{
+			double d0 = positions(0, j) - point[0];
+			double d1 = positions(1, j) - point[1];
+			double d2 = positions(2, j) - point[2];
+			double D2 = d0*d0 + d1*d1 + d2*d2;
+			if (!retval.branch || D2 < bestDistance2)
+			{
+				bestDistance2 = D2;
+				retval.branch = branches[i];
+				retval.positionIndex = j;
+			}
+		}
+	}
+	retval.distance = std::sqrt(bestDistance2);
+	return retval;
+}
+
+void checkIndexMatchesLinearScan(cx::BranchListPtr branchList, int minGeneration, const std::vector<cx::Vector3D>& points)
+{
+	cx::BranchPointIndexPtr index = cx::BranchPointIndex::create();
+	index->build(branchList, minGeneration);
+	REQUIRE(!index->isEmpty());
+
+	int mismatches = 0;
+	for (unsigned i = 0; i < points.size(); ++i)
+	{
+		cx::BranchPointIndex::ClosestPoint expected = findClosestByLinearScan(branchList, points[i], minGeneration);
+		cx::BranchPointIndex::ClosestPoint result = index->findClosest(points[i]);
+		if (result.branch != expected.branch || result.positionIndex != expected.positionIndex)
+			++mismatches;
+		CHECK(result.distance == Approx(expected.distance));
+	}
+	CHECK(mismatches == 0);
+}
+
+} // namespace
+
+TEST_CASE("BranchPointIndex: Closest point is the same as a linear scan", "[unit][routetotarget]")
+{
+	cx::BranchListPtr branchList = createRandomBranchList(40, 50, 42);
+
+	std::mt19937 generator(7);
+	std::uniform_real_distribution<double> coordinate(-20, 120);
+	std::vector<cx::Vector3D> points;
+	for (int i = 0; i < 2000; ++i)
+		points.push_back(cx::Vector3D(coordinate(generator), coordinate(generator), coordinate(generator)));
+
+	// query exactly at indexed positions, including the duplicated ones
+	std::vector<cx::BranchPtr> branches = branchList->getBranches();
+	for (unsigned i = 0; i < branches.size(); ++i)
+		for (int j = 0; j < branches[i]->getPositions().cols(); j += 5)
+			points.push_back(branches[i]->getPositions().col(j));
+
+	SECTION("All branches")
+	{
+		checkIndexMatchesLinearScan(branchList, 0, points);
+	}
+	SECTION("Branches from generation 2")
+	{
+		checkIndexMatchesLinearScan(branchList, 2, points);
+	}
+}
+
+TEST_CASE("BranchPointIndex: Empty index finds nothing", "[unit][routetotarget]")
+{
+	cx::BranchPointIndexPtr index = cx::BranchPointIndex::create();
+	index->build(cx::BranchListPtr(new cx::BranchList()));
+
+	CHECK(index->isEmpty());
+	CHECK(index->getNumberOfPoints() == 0);
+	cx::BranchPointIndex::ClosestPoint result = index->findClosest(cx::Vector3D(1, 2, 3));
+	CHECK(!result.branch);
+	CHECK(result.positionIndex == -1);
+}
+
+} // namespace cxtest
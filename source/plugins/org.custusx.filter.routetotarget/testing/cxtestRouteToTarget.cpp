@@ -0,0 +1,61 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "catch.hpp"
+
+#include <random>
+#include <vtkPolyData.h>
+#include "cxRouteToTarget.h"
+#include "cxMesh.h"
+#include "cxtestVtkPolyDataTree.h"
+
+namespace cxtest
+{
+
+TEST_CASE("RouteToTarget: Routes to many targets are the same as one at a time", "[unit][routetotarget]")
+{
+	cx::MeshPtr centerline = cx::Mesh::create("centerline");
+	centerline->setVtkPolyData(makeDummyCenterLine());
+
+	cx::RouteToTargetPtr routeToTarget(new cx::RouteToTarget());
+	routeToTarget->processCenterline(centerline);
+
+	std::mt19937 generator(3);
+	std::uniform_real_distribution<double> x(-2, 12);
+	std::uniform_real_distribution<double> yz(-6, 6);
+	std::vector<cx::Vector3D> targets;
+	for (int i = 0; i < 200; ++i)
+		targets.push_back(cx::Vector3D(x(generator), yz(generator), yz(generator)));
+
+	std::vector<vtkPolyDataPtr> routes = routeToTarget->findRoutesToTargets(targets);
+	REQUIRE(routes.size() == targets.size());
+
+	int mismatches = 0;
+	for (unsigned i = 0; i < targets.size(); ++i)
+	{
+		vtkPolyDataPtr expected = routeToTarget->findRouteToTarget(targets[i]);
+		REQUIRE(expected->GetNumberOfPoints() > 0);
+		if (routes[i]->GetNumberOfPoints() != expected->GetNumberOfPoints() || routes[i]->GetNumberOfLines() != expected->GetNumberOfLines())
+		{
+			++mismatches;
+			continue;
+		}
+		for (vtkIdType j = 0; j < expected->GetNumberOfPoints(); ++j)
+			if (!cx::similar(cx::Vector3D(routes[i]->GetPoint(j)), cx::Vector3D(expected->GetPoint(j))))
+			{
+				++mismatches;
+				break;
+			}
+	}
+	CHECK(mismatches == 0);
+}
+
+} // namespace cxtest
@@ -0,0 +1,116 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "cxCenterlineClosestPointMetric.h"
+
+#include <boost/bind.hpp>
+#include "cxParallelFor.h"
+
+namespace cx
+{
+
+CenterlineClosestPointMetric::CenterlineClosestPointMetric()
+{
+}
+
+void CenterlineClosestPointMetric::Initialize(void) throw (itk::ExceptionObject)
+{
+	Superclass::Initialize();
+
+	std::vector<Vector3D> fixedPoints;
+	FixedPointSetType::PointsContainer::ConstPointer fixed = m_FixedPointSet->GetPoints();
+	fixedPoints.reserve(fixed->Size());
+	for (FixedPointSetType::PointsContainer::ConstIterator iter = fixed->Begin(); iter != fixed->End(); ++iter)
+		fixedPoints.push_back(Vector3D(iter.Value()[0], iter.Value()[1], iter.Value()[2]));
+	mFixedTree.build(fixedPoints);
+
+	if (mFixedTree.isEmpty())
+		itkExceptionMacro(<<"Fixed point set is empty");
+
+	mMovingPoints.clear();
+	MovingPointSetType::PointsContainer::ConstPointer moving = m_MovingPointSet->GetPoints();
+	mMovingPoints.reserve(moving->Size());
+	for (MovingPointSetType::PointsContainer::ConstIterator iter = moving->Begin(); iter != moving->End(); ++iter)
+		mMovingPoints.push_back(Vector3D(iter.Value()[0], iter.Value()[1], iter.Value()[2]));
+}
+
+unsigned int CenterlineClosestPointMetric::GetNumberOfValues() const
+{
+	return mMovingPoints.size();
+}
+
+CenterlineClosestPointMetric::MeasureType CenterlineClosestPointMetric::GetValue(const TransformParametersType& parameters) const
+{
+	MeasureType value;
+	this->evaluate(parameters, &value, NULL);
+	return value;
+}
+
+void CenterlineClosestPointMetric::GetDerivative(const TransformParametersType& parameters, DerivativeType& derivative) const
+{
+	this->evaluate(parameters, NULL, &derivative);
+}
+
+void CenterlineClosestPointMetric::GetValueAndDerivative(const TransformParametersType& parameters, MeasureType& value, DerivativeType& derivative) const
+{
+	this->evaluate(parameters, &value, &derivative);
+}
+
+void CenterlineClosestPointMetric::evaluate(const TransformParametersType& parameters, MeasureType* value, DerivativeType* derivative) const
+{
+	this->SetTransformParameters(parameters);
+
+	int numberOfValues = mMovingPoints.size();
+	if (value)
+		value->SetSize(numberOfValues);
+	if (derivative)
+		derivative->SetSize(m_Transform->GetNumberOfParameters(), numberOfValues);
+
+	parallelFor(0, numberOfValues, boost::bind(&CenterlineClosestPointMetric::evaluateRange, this, _1, _2, value, derivative), 64);
+}
+
+/** Evaluate values and/or derivative columns for moving points [begin, end).
+ *  The derivative of |T(p)-q| is n*dT(p)/dparameters, n being the unit vector from the
+ *  closest fixed point q to T(p).
+ */
+void CenterlineClosestPointMetric::evaluateRange(int begin, int end, MeasureType* value, DerivativeType* derivative) const
+{
+	TransformJacobianType jacobian;
+	int numberOfParameters = m_Transform->GetNumberOfParameters();
+
+	for (int i = begin; i < end; ++i)
+	{
+		TransformType::InputPointType inputPoint;
+		for (int k = 0; k < 3; ++k)
+			inputPoint[k] = mMovingPoints[i][k];
+		TransformType::OutputPointType transformedPoint = m_Transform->TransformPoint(inputPoint);
+		Vector3D point(transformedPoint[0], transformedPoint[1], transformedPoint[2]);
+
+		double distance = 0;
+		int closest = mFixedTree.findClosest(point, &distance);
+
+		if (value)
+			(*value)[i] = distance;
+
+		if (derivative)
+		{
+			Vector3D normal = Vector3D::Zero();
+			if (distance > 0)
+				normal = (point - mFixedTree.getPoint(closest)) / distance;
+
+			m_Transform->ComputeJacobianWithRespectToParameters(inputPoint, jacobian);
+			for (int p = 0; p < numberOfParameters; ++p)
+				(*derivative)(p, i) = normal[0]*jacobian(0, p) + normal[1]*jacobian(1, p) + normal[2]*jacobian(2, p);
+		}
+	}
+}
+
+} // namespace cx
@@ -0,0 +1,80 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#ifndef CXCENTERLINECLOSESTPOINTMETRIC_H_
+#define CXCENTERLINECLOSESTPOINTMETRIC_H_
+
+#include "org_custusx_registration_method_centerline_Export.h"
+
+#include <vector>
+#include <itkPointSet.h>
+#include <itkPointSetToPointSetMetric.h>
+#include "cxVector3D.h"
+#include "cxPointKdTree.h"
+
+namespace cx
+{
+
+/**
+ * \brief Closest point distance metric for centerline registration.
+ *
+ * Gives the same measure as itk::EuclideanDistancePointMetric: one value per
+ * moving point, the distance from the transformed point to the closest fixed
+ * point. The fixed points are put in a kd-tree in Initialize(), and values
+ * are evaluated in parallel.
+ *
+ * The derivative is computed analytically from the transform Jacobian,
+ * keeping the closest fixed point constant, so that optimizers can use
+ * the cost function gradient instead of finite differences.
+ *
+ * \ingroup org_custusx_registration_method_centerline
+ * \date Oct 19, 2026
+ */
+class org_custusx_registration_method_centerline_EXPORT CenterlineClosestPointMetric :
+		public itk::PointSetToPointSetMetric<itk::PointSet<float, 3>, itk::PointSet<float, 3> >
+{
+public:
+	typedef CenterlineClosestPointMetric Self;
+	typedef itk::PointSetToPointSetMetric<itk::PointSet<float, 3>, itk::PointSet<float, 3> > Superclass;
+	typedef itk::SmartPointer<Self> Pointer;
+	typedef itk::SmartPointer<const Self> ConstPointer;
+
+	itkNewMacro(Self);
+	itkTypeMacro(CenterlineClosestPointMetric, PointSetToPointSetMetric);
+
+	typedef Superclass::MeasureType MeasureType;
+	typedef Superclass::DerivativeType DerivativeType;
+	typedef Superclass::TransformParametersType TransformParametersType;
+	typedef Superclass::TransformJacobianType TransformJacobianType;
+
+	virtual void Initialize(void) throw (itk::ExceptionObject); ///< build the kd-tree from the fixed points
+	virtual unsigned int GetNumberOfValues() const;
+	virtual MeasureType GetValue(const TransformParametersType& parameters) const;
+	virtual void GetDerivative(const TransformParametersType& parameters, DerivativeType& derivative) const;
+	virtual void GetValueAndDerivative(const TransformParametersType& parameters, MeasureType& value, DerivativeType& derivative) const;
+
+protected:
+	CenterlineClosestPointMetric();
+	virtual ~CenterlineClosestPointMetric() {}
+
+private:
+	CenterlineClosestPointMetric(const Self&); // not implemented
+	void operator=(const Self&); // not implemented
+
+	void evaluate(const TransformParametersType& parameters, MeasureType* value, DerivativeType* derivative) const;
+	void evaluateRange(int begin, int end, MeasureType* value, DerivativeType* derivative) const;
+
+	PointKdTree mFixedTree;
+	std::vector<Vector3D> mMovingPoints;
+};
+
+} // namespace cx
+
+#endif /* CXCENTERLINECLOSESTPOINTMETRIC_H_ */
@@ -36,7 +36,7 @@ CenterlineRegistration::CenterlineRegistration()
     mTransform = TransformType::New();
     MetricType::Pointer         metric = MetricType::New();
     mOptimizer = OptimizerType::New();
-    mOptimizer->SetUseCostFunctionGradient(false);
+    mOptimizer->SetUseCostFunctionGradient(true);
     OptimizerType::ScalesType   scales(mTransform->GetNumberOfParameters());
 
     unsigned long   numberOfIterations = 2000;
@@ -24,10 +24,10 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include <vtkLandmarkTransform.h>
 
 #include <itkEuler3DTransform.h>
-#include <itkEuclideanDistancePointMetric.h>
 #include <itkLevenbergMarquardtOptimizer.h>
 #include <itkPointSetToPointSetRegistrationMethod.h>
 #include <itkPointSet.h>
+#include "cxCenterlineClosestPointMetric.h"
 
 
 typedef std::vector< Eigen::Matrix4d > M4Vector;
@@ -51,10 +51,7 @@ public:
     typedef PointSetType::PointsContainerPointer        PointsContainerPtr;
     typedef PointsContainer::Iterator                   PointsIterator;
 
-    typedef itk::EuclideanDistancePointMetric<
-                                      PointSetType,
-                                      PointSetType>
-                                                        MetricType;
+    typedef CenterlineClosestPointMetric                MetricType;
     typedef itk::Euler3DTransform< double >             TransformType;
     typedef itk::LevenbergMarquardtOptimizer            OptimizerType;
 
@@ -0,0 +1,146 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "cxPointKdTree.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace cx
+{
+
+namespace
+{
+struct AxisLess
+{
+	AxisLess(const std::vector<Vector3D>& points, int axis) : mPoints(points), mAxis(axis) {}
+	bool operator()(int a, int b) const
+	{
+		if (mPoints[a][mAxis] != mPoints[b][mAxis])
+			return mPoints[a][mAxis] < mPoints[b][mAxis];
+		return a < b;
+	}
+	const std::vector<Vector3D>& mPoints;
+	int mAxis;
+};
+}
+
+PointKdTree::PointKdTree()
+{
+}
+
+void PointKdTree::clear()
+{
+	mPoints.clear();
+	mIndex.clear();
+	mAxis.clear();
+	mTreePosition.clear();
+}
+
+void PointKdTree::build(const std::vector<Vector3D>& points)
+{
+	mPoints = points;
+	mIndex.resize(points.size());
+	for (unsigned i = 0; i < mIndex.size(); ++i)
+		mIndex[i] = i;
+	mAxis.assign(points.size(), 0);
+
+	this->buildRange(0, mIndex.size());
+
+	std::vector<Vector3D> sorted(points.size());
+	mTreePosition.resize(points.size());
+	for (unsigned i = 0; i < mIndex.size(); ++i)
+	{
+		sorted[i] = points[mIndex[i]];
+		mTreePosition[mIndex[i]] = i;
+	}
+	mPoints.swap(sorted);
+}
+
+/** Split [begin,end) of mIndex at the median along the axis of largest extent.
+ *  mPoints is still in input order while building.
+ */
+void PointKdTree::buildRange(int begin, int end)
+{
+	if (end - begin < 1)
+		return;
+
+	Vector3D lo = mPoints[mIndex[begin]];
+	Vector3D hi = lo;
+	for (int i = begin + 1; i < end; ++i)
+	{
+		lo = lo.cwiseMin(mPoints[mIndex[i]]);
+		hi = hi.cwiseMax(mPoints[mIndex[i]]);
+	}
+	int axis;
+	(hi - lo).maxCoeff(&axis);
+
+	int mid = (begin + end) / 2;
+	std::nth_element(mIndex.begin() + begin, mIndex.begin() + mid, mIndex.begin() + end, AxisLess(mPoints, axis));
+	mAxis[mid] = axis;
+
+	this->buildRange(begin, mid);
+	this->buildRange(mid + 1, end);
+}
+
+int PointKdTree::findClosest(const Vector3D& point, double* distance) const
+{
+	int best = -1;
+	double bestDistance2 = std::numeric_limits<double>::max();
+	this->searchRange(0, mPoints.size(), point, &bestDistance2, &best);
+
+	if (distance)
+		*distance = (best < 0) ? -1 : sqrt(bestDistance2);
+	return (best < 0) ? -1 : mIndex[best];
+}
+
+Vector3D PointKdTree::getPoint(int index) const
+{
+	return mPoints[mTreePosition[index]];
+}
+
+void PointKdTree::searchRange(int begin, int end, const Vector3D& point, double* bestDistance2, int* best) const
+{
+	while (end - begin > 0)
+	{
+		int mid = (begin + end) / 2;
+		const Vector3D& node = mPoints[mid];
+		double d2 = (point - node).squaredNorm();
+		if (d2 < *bestDistance2 || (d2 == *bestDistance2 && *best >= 0 && mIndex[mid] < mIndex[*best]))
+		{
+			*bestDistance2 = d2;
+			*best = mid;
+		}
+
+		int axis = mAxis[mid];
+		double delta = point[axis] - node[axis];
+
+		// search the near side first, then the far side only if it can hold
+		// a point at least as close as the best so far.
+		if (delta < 0)
+		{
+			this->searchRange(begin, mid, point, bestDistance2, best);
+			if (delta*delta > *bestDistance2)
+				return;
+			begin = mid + 1;
+		}
+		else
+		{
+			this->searchRange(mid + 1, end, point, bestDistance2, best);
+			if (delta*delta > *bestDistance2)
+				return;
+			end = mid;
+		}
+	}
+}
+
+} // namespace cx
@@ -0,0 +1,61 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#ifndef CXPOINTKDTREE_H_
+#define CXPOINTKDTREE_H_
+
+#include "org_custusx_registration_method_centerline_Export.h"
+
+#include <vector>
+#include "cxVector3D.h"
+
+namespace cx
+{
+
+/**
+ * \brief Balanced kd-tree for closest point queries in a static point set.
+ *
+ * The tree is stored implicitly: the points are reordered so that the
+ * median of each range is the node splitting that range.
+ * Ties are resolved by returning the point with the lowest input index,
+ * giving the same result as a linear scan.
+ * findClosest() is const and can be called from several threads at once.
+ *
+ * \ingroup org_custusx_registration_method_centerline
+ * \date Oct 19, 2026
+ */
+class org_custusx_registration_method_centerline_EXPORT PointKdTree
+{
+public:
+	PointKdTree();
+	void build(const std::vector<Vector3D>& points);
+	void clear();
+	bool isEmpty() const { return mPoints.empty(); }
+	int getNumberOfPoints() const { return mPoints.size(); }
+
+	/** Return the input index of the point closest to point, -1 if empty.
+	 *  The distance is written to distance if given.
+	 */
+	int findClosest(const Vector3D& point, double* distance = NULL) const;
+	Vector3D getPoint(int index) const; ///< point with the given input index
+
+private:
+	void buildRange(int begin, int end);
+	void searchRange(int begin, int end, const Vector3D& point, double* bestDistance2, int* best) const;
+
+	std::vector<Vector3D> mPoints; ///< in tree order
+	std::vector<int> mIndex; ///< input index of each point in mPoints
+	std::vector<unsigned char> mAxis; ///< split axis of the node at each position
+	std::vector<int> mTreePosition; ///< position in mPoints of each input index
+};
+
+} // namespace cx
+
+#endif /* CXPOINTKDTREE_H_ */
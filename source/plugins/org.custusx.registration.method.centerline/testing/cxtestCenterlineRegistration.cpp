@@ -17,12 +17,238 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "cxCenterlineRegistration.h"
 #include "cxtestSessionStorageTestFixture.h"
 #include "cxVisServices.h"
+#include "cxCenterlineClosestPointMetric.h"
+#include "cxPointKdTree.h"
+#include <itkEuclideanDistancePointMetric.h>
+#include <vtkPoints.h>
+#include <limits>
 
 typedef boost::shared_ptr<cx::CenterlineRegistration> CenterlineRegistrationPtr;
 
 
 namespace cxtest {
 
+namespace
+{
+typedef cx::CenterlineRegistration::PointSetType PointSetType;
+
+PointSetType::Pointer createHelix(int numberOfPoints, double phase)
+{
+	PointSetType::Pointer retval = PointSetType::New();
+	PointSetType::PointsContainerPointer points = PointSetType::PointsContainer::New();
+	for (int i = 0; i < numberOfPoints; ++i)
+	{
+		double t = phase + 0.05 * i;
+		PointSetType::PointType p;
+		p[0] = 20 * cos(t);
+		p[1] = 15 * sin(t);
+		p[2] = 3 * t;
+		points->InsertElement(i, p);
+	}
+	retval->SetPoints(points);
+	return retval;
+}
+
+cx::CenterlineRegistration::TransformType::ParametersType createTestParameters()
+{
+	cx::CenterlineRegistration::TransformType::ParametersType parameters(6);
+	parameters[0] = 0.05;
+	parameters[1] = -0.03;
+	parameters[2] = 0.1;
+	parameters[3] = 2.0;
+	parameters[4] = -1.5;
+	parameters[5] = 0.7;
+	return parameters;
+}
+
+Eigen::MatrixXd getPointMatrix(vtkPointsPtr points)
+{
+	Eigen::MatrixXd retval(3, points->GetNumberOfPoints());
+	for (int i = 0; i < points->GetNumberOfPoints(); ++i)
+	{
+		double p[3];
+		points->GetPoint(i, p);
+		retval.col(i) = cx::Vector3D(p);
+	}
+	return retval;
+}
+}
+
+TEST_CASE("PointKdTree: closest point equals linear scan", "[unit][org.custusx.registration.method.centerline]")
+{
+	std::vector<cx::Vector3D> points;
+	for (int i = 0; i < 500; ++i)
+		points.push_back(cx::Vector3D(rand() % 20, rand() % 20, rand() % 4) * 0.5); // many ties
+
+	cx::PointKdTree tree;
+	CHECK(tree.findClosest(cx::Vector3D::Zero()) == -1);
+	tree.build(points);
+	REQUIRE(tree.getNumberOfPoints() == 500);
+
+	for (int q = 0; q < 1000; ++q)
+	{
+		cx::Vector3D query = cx::Vector3D::Random() * 6 + cx::Vector3D(5, 5, 1);
+		int expected = -1;
+		double expectedDistance2 = std::numeric_limits<double>::max();
+		for (unsigned i = 0; i < points.size(); ++i)
+		{
+			double d2 = (points[i] - query).squaredNorm();
+			if (d2 < expectedDistance2)
+			{
+				expectedDistance2 = d2;
+				expected = i;
+			}
+		}
+
+		double distance = 0;
+		int found = tree.findClosest(query, &distance);
+		REQUIRE(found == expected);
+		CHECK(distance == Approx(sqrt(expectedDistance2)));
+		CHECK(tree.getPoint(found) == points[expected]);
+	}
+}
+
+TEST_CASE("CenterlineClosestPointMetric: value equals EuclideanDistancePointMetric", "[unit][org.custusx.registration.method.centerline]")
+{
+	typedef itk::EuclideanDistancePointMetric<PointSetType, PointSetType> ReferenceMetricType;
+
+	PointSetType::Pointer fixed = createHelix(400, 0);
+	PointSetType::Pointer moving = createHelix(150, 0.37);
+	cx::CenterlineRegistration::TransformType::ParametersType parameters = createTestParameters();
+
+	cx::CenterlineClosestPointMetric::Pointer metric = cx::CenterlineClosestPointMetric::New();
+	metric->SetFixedPointSet(fixed);
+	metric->SetMovingPointSet(moving);
+	metric->SetTransform(cx::CenterlineRegistration::TransformType::New());
+	metric->Initialize();
+
+	ReferenceMetricType::Pointer reference = ReferenceMetricType::New();
+	reference->SetFixedPointSet(fixed);
+	reference->SetMovingPointSet(moving);
+	reference->SetTransform(cx::CenterlineRegistration::TransformType::New());
+	reference->Initialize();
+
+	cx::CenterlineClosestPointMetric::MeasureType value = metric->GetValue(parameters);
+	ReferenceMetricType::MeasureType expected = reference->GetValue(parameters);
+	REQUIRE(metric->GetNumberOfValues() == 150);
+	REQUIRE(value.Size() == expected.Size());
+	for (unsigned i = 0; i < value.Size(); ++i)
+		CHECK(value[i] == Approx(expected[i]));
+}
+
+TEST_CASE("CenterlineClosestPointMetric: analytic derivative equals finite differences", "[unit][org.custusx.registration.method.centerline]")
+{
+	cx::CenterlineClosestPointMetric::Pointer metric = cx::CenterlineClosestPointMetric::New();
+	metric->SetFixedPointSet(createHelix(400, 0));
+	metric->SetMovingPointSet(createHelix(150, 0.37));
+	metric->SetTransform(cx::CenterlineRegistration::TransformType::New());
+	metric->Initialize();
+
+	cx::CenterlineRegistration::TransformType::ParametersType parameters = createTestParameters();
+	cx::CenterlineClosestPointMetric::MeasureType value;
+	cx::CenterlineClosestPointMetric::DerivativeType derivative;
+	metric->GetValueAndDerivative(parameters, value, derivative);
+	REQUIRE(derivative.rows() == 6);
+	REQUIRE(derivative.cols() == 150);
+
+	// the closest fixed point is constant for small steps, except at a few switching points
+	double step = 1e-6;
+	int mismatches = 0;
+	for (unsigned p = 0; p < 6; ++p)
+	{
+		cx::CenterlineRegistration::TransformType::ParametersType shifted = parameters;
+		shifted[p] += step;
+		cx::CenterlineClosestPointMetric::MeasureType shiftedValue = metric->GetValue(shifted);
+		for (unsigned i = 0; i < value.Size(); ++i)
+		{
+			double numeric = (shiftedValue[i] - value[i]) / step;
+			if (fabs(numeric - derivative(p, i)) > 1e-3 * std::max(1.0, fabs(numeric)))
+				++mismatches;
+		}
+	}
+	CHECK(mismatches < 6);
+}
+
+// Compare against the previous setup: brute force metric and finite difference derivatives.
+TEST_CASE("CenterlineRegistration: same result as EuclideanDistancePointMetric", "[integration][org.custusx.registration.method.centerline]")
+{
+	typedef itk::EuclideanDistancePointMetric<PointSetType, PointSetType> ReferenceMetricType;
+
+	cxtest::SessionStorageTestFixture storageFixture;
+	storageFixture.loadSession1();
+
+	QString filenameCenterline1 = cx::DataLocations::getTestDataPath()+"/testing/Centerline/US_aneurism_cl_size0.vtk";
+	QString filenameCenterline2 = cx::DataLocations::getTestDataPath()+"/testing/Centerline/US_aneurism_cl_size1.vtk";
+	QString info;
+	cx::MeshPtr mesh1 = boost::dynamic_pointer_cast<cx::Mesh>(storageFixture.mServices->patient()->importData(filenameCenterline1, info));
+	cx::MeshPtr mesh2 = boost::dynamic_pointer_cast<cx::Mesh>(storageFixture.mServices->patient()->importData(filenameCenterline2, info));
+	REQUIRE(mesh1);
+	REQUIRE(mesh2);
+
+	cx::CenterlineRegistration centerlineRegistration;
+	vtkPointsPtr fixedPoints = centerlineRegistration.processCenterline(mesh1->getVtkPolyData(), cx::Transform3D::Identity());
+	vtkPointsPtr movingPoints = centerlineRegistration.processCenterline(mesh2->getVtkPolyData(), cx::Transform3D::Identity());
+	centerlineRegistration.SetFixedPoints(fixedPoints);
+	centerlineRegistration.SetMovingPoints(movingPoints);
+	cx::Transform3D result = centerlineRegistration.FullRegisterMoving(cx::Transform3D::Identity());
+
+	// reference registration, set up as CenterlineRegistration used to
+	cx::CenterlineRegistration::TransformType::Pointer transform = cx::CenterlineRegistration::TransformType::New();
+	transform->SetIdentity();
+	cx::CenterlineRegistration::OptimizerType::Pointer optimizer = cx::CenterlineRegistration::OptimizerType::New();
+	optimizer->SetUseCostFunctionGradient(false);
+	cx::CenterlineRegistration::OptimizerType::ScalesType scales(6);
+	for (int i = 0; i < 3; ++i)
+	{
+		scales[i] = 1.0 / 0.3;
+		scales[i+3] = 1.0 / 40.0;
+	}
+	optimizer->SetScales(scales);
+	optimizer->SetNumberOfIterations(2000);
+	optimizer->SetValueTolerance(1e-4);
+	optimizer->SetGradientTolerance(1e-4);
+	optimizer->SetEpsilonFunction(1e-5);
+
+	cx::CenterlineRegistration::RegistrationType::Pointer registration = cx::CenterlineRegistration::RegistrationType::New();
+	registration->SetMetric(ReferenceMetricType::New());
+	registration->SetOptimizer(optimizer);
+	registration->SetTransform(transform);
+	registration->SetInitialTransformParameters(transform->GetParameters());
+	cx::CenterlineRegistration::PointSetType::Pointer fixedSet = cx::CenterlineRegistration::PointSetType::New();
+	cx::CenterlineRegistration::PointSetType::Pointer movingSet = cx::CenterlineRegistration::PointSetType::New();
+	for (int i = 0; i < fixedPoints->GetNumberOfPoints(); ++i)
+	{
+		double* p = fixedPoints->GetPoint(i);
+		cx::CenterlineRegistration::PointType point;
+		point[0] = p[0]; point[1] = p[1]; point[2] = p[2];
+		fixedSet->SetPoint(i, point);
+	}
+	for (int i = 0; i < movingPoints->GetNumberOfPoints(); ++i)
+	{
+		double* p = movingPoints->GetPoint(i);
+		cx::CenterlineRegistration::PointType point;
+		point[0] = p[0]; point[1] = p[1]; point[2] = p[2];
+		movingSet->SetPoint(i, point);
+	}
+	registration->SetFixedPointSet(fixedSet);
+	registration->SetMovingPointSet(movingSet);
+	registration->Update();
+
+	cx::CenterlineRegistration::TransformType::ParametersType expected = registration->GetLastTransformParameters();
+	transform->SetParameters(expected);
+
+	// compare the mapped moving points rather than parameters
+	Eigen::MatrixXd moving = getPointMatrix(movingPoints);
+	for (int i = 0; i < moving.cols(); ++i)
+	{
+		cx::CenterlineRegistration::TransformType::InputPointType p;
+		p[0] = moving(0, i); p[1] = moving(1, i); p[2] = moving(2, i);
+		cx::CenterlineRegistration::TransformType::OutputPointType q = transform->TransformPoint(p);
+		cx::Vector3D mapped = result.coord(cx::Vector3D(moving.col(i)));
+		CHECK((mapped - cx::Vector3D(q[0], q[1], q[2])).norm() < 0.5);
+	}
+}
+
 
 // This test just use two random centerlines and register them to each other.
 // The test only verifies that the code is running without crashing, and that all objects are created.
@@ -20,6 +20,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 namespace cx
 {
 typedef boost::shared_ptr<class Data> DataPtr;
+typedef boost::shared_ptr<class FrameGraph> FrameGraphPtr;
 
 /**
  * Algorithms for applying registration to backend
@@ -33,13 +34,15 @@ class org_custusx_registration_EXPORT RegistrationApplicator
 {
 public:
 
-  RegistrationApplicator(const std::map<QString, DataPtr>& source);
+  /** Keep frameGraph between registrations to update it incrementally. */
+  RegistrationApplicator(const std::map<QString, DataPtr>& source, FrameGraphPtr frameGraph = FrameGraphPtr());
   ~RegistrationApplicator();
 
   virtual void updateRegistration(QDateTime oldTime, RegistrationTransform deltaTransform);
 
 private:
   std::map<QString, DataPtr> mSource;
+  FrameGraphPtr mFrameGraph;
   void changeParentSpace(QDateTime oldTime, std::vector<DataPtr> data, QString oldParentSpace, ParentSpace newParentSpace);
   void updateTransform(QDateTime oldTime, std::vector<DataPtr> data, RegistrationTransform delta_pre_rMd);
   void changeParentSpace(QDateTime oldTime, DataPtr data, ParentSpace newParentSpace);
@@ -445,7 +445,9 @@ void RegistrationImplService::performPatientRegistration(Transform3D rMpr_new, Q
  */
 void RegistrationImplService::updateRegistration_rMd(QDateTime oldTime, RegistrationTransform dMd, DataPtr data)
 {
-	RegistrationApplicator applicator(mPatientModelService->getDatas());
+	if (!mFrameGraph)
+		mFrameGraph = FrameGraph::create();
+	RegistrationApplicator applicator(mPatientModelService->getDatas(), mFrameGraph);
 	dMd.mMoving = data->getUid();
 	applicator.updateRegistration(oldTime, dMd);
 
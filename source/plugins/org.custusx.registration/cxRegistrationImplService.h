@@ -27,6 +27,7 @@ class RegistrationTransform;
 class PatientModelService;
 typedef boost::shared_ptr<class PatientModelService> PatientModelServicePtr;
 typedef boost::shared_ptr<class SessionStorageService> SessionStorageServicePtr;
+typedef boost::shared_ptr<class FrameGraph> FrameGraphPtr;
 
 
 /**
@@ -93,6 +94,7 @@ private:
 	ctkPluginContext* mContext;
 	PatientModelServicePtr mPatientModelService;
 	SessionStorageServicePtr mSession;
+	FrameGraphPtr mFrameGraph; ///< kept between registrations, updated with the changes only
 	void performImage2ImageRegistration(Transform3D dMd, QString description, bool temporaryRegistration = false);
 	void performPatientRegistration(Transform3D rMpr_new, QString description, bool temporaryRegistration = false);
 };
@@ -25,6 +25,63 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include <QDir>
 #include "cxFileManagerServiceProxy.h"
 #include "cxLogicManager.h"
+#include "cxVolumeHelpers.h"
+#include "cxImage.h"
+#include <vtkImageData.h>
+
+namespace
+{
+
+std::vector<cx::Vector3D> extractNeighboredVoxelsBruteForce(vtkImageDataPtr image, int radius, cx::Transform3D rMd)
+{
+	std::vector<cx::Vector3D> retval;
+	int* dim = image->GetDimensions();
+	double* spacing = image->GetSpacing();
+	unsigned char* ptr = static_cast<unsigned char*>(image->GetScalarPointer());
+	for (int k = 0; k < dim[2]; ++k)
+		for (int j = 0; j < dim[1]; ++j)
+			for (int i = 0; i < dim[0]; ++i)
+			{
+				if (!ptr[(k*dim[1] + j)*dim[0] + i])
+					continue;
+				bool found = false;
+				for (int kk = std::max(0, k-radius); kk <= std::min(dim[2]-1, k+radius); ++kk)
+					for (int jj = std::max(0, j-radius); jj <= std::min(dim[1]-1, j+radius); ++jj)
+						for (int ii = std::max(0, i-radius); ii <= std::min(dim[0]-1, i+radius); ++ii)
+							if ((ii != i || jj != j || kk != k) && ptr[(kk*dim[1] + jj)*dim[0] + ii])
+								found = true;
+				if (found)
+					retval.push_back(rMd.coord(cx::Vector3D(i*spacing[0], j*spacing[1], k*spacing[2])));
+			}
+	return retval;
+}
+
+} // namespace
+
+TEST_CASE("SeansVesselReg: extractPolyData keeps voxels with neighbors", "[unit][modules][registration]")
+{
+	Eigen::Array3i dim(23, 17, 11);
+	vtkImageDataPtr imageData = cx::generateVtkImageData(dim, cx::Vector3D(0.5, 0.7, 1.1), 0);
+	unsigned char* ptr = static_cast<unsigned char*>(imageData->GetScalarPointer());
+	for (int i = 0; i < dim.prod(); ++i)
+		ptr[i] = ((i*7919) % 97 == 0) ? 255 : 0;
+	cx::setDeepModified(imageData);
+
+	cx::ImagePtr image(new cx::Image("test", imageData));
+	cx::Transform3D rMd = cx::createTransformTranslate(cx::Vector3D(10, -5, 3)) * cx::createTransformRotateZ(0.3);
+	image->get_rMd_History()->setRegistration(rMd);
+
+	for (int radius = 0; radius <= 3; ++radius)
+	{
+		std::vector<cx::Vector3D> expected = extractNeighboredVoxelsBruteForce(imageData, radius, rMd);
+		vtkPolyDataPtr polyData = cx::SeansVesselReg::extractPolyData(image, radius, 0);
+
+		REQUIRE(polyData->GetNumberOfPoints() == vtkIdType(expected.size()));
+		CHECK(polyData->GetNumberOfVerts() == vtkIdType(expected.size()));
+		for (unsigned i = 0; i < expected.size(); ++i)
+			CHECK(cx::similar(cx::Vector3D(polyData->GetPoint(i)), expected[i]));
+	}
+}
 
 
 TEST_CASE_METHOD(cxtest::SeansVesselRegFixture, "SeansVesselReg: V2V syntectic data", "[integration][modules][registration][not_win32]")
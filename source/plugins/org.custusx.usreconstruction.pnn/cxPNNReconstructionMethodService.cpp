@@ -64,6 +64,7 @@ void optimizedCoordTransform(Vector3D* p, boost::array<double, 16> tt)
 bool PNNReconstructionMethodService::reconstruct(ProcessedUSInputDataPtr input,
 		vtkImageDataPtr outputData, QDomElement settings)
 {
+	mLastStageTimings.clear();
 	input->validate();
 
 	std::vector<TimedPosition> frameInfo = input->getFrames();
@@ -71,6 +72,11 @@ bool PNNReconstructionMethodService::reconstruct(ProcessedUSInputDataPtr input,
 		return false;
 	if (input->getDimensions()[2]==0)
 		return false;
+	if (!input->getMaskSpans())
+	{
+		reportError("PNN reconstruction requires a mask");
+		return false;
+	}
 
 	vtkImageDataPtr target = outputData;
 
@@ -95,7 +101,11 @@ bool PNNReconstructionMethodService::reconstruct(ProcessedUSInputDataPtr input,
 
 	//Get raw data pointers
 	unsigned char *outputPointer = static_cast<unsigned char*> (tempOutput->GetScalarPointer());
-	unsigned char* maskPointer = static_cast<unsigned char*> (input->getMask()->GetScalarPointer());
+	// spans along the beams: iterate over valid samples only
+	MaskSpansPtr beamSpans = input->getMaskSpans()->createTransposed();
+	int beamCount = std::min(inputDims[0], beamSpans->getHeight());
+
+	TimeKeeper timer;
 
 	// Traverse all input pixels
 	for (int record = 0; record < inputDims[2]; record++)
@@ -103,37 +113,42 @@ bool PNNReconstructionMethodService::reconstruct(ProcessedUSInputDataPtr input,
 		unsigned char *inputPointer = input->getFrame(record);
 		boost::array<double, 16> recordTransform = frameInfo[record].mPos.flatten();
 
-		for (int beam = 0; beam < inputDims[0]; beam++)
+		for (int beam = 0; beam < beamCount; beam++)
 		{
-			for (int sample = 0; sample < inputDims[1]; sample++)
+			for (const MaskSpans::Span* span = beamSpans->rowBegin(beam); span != beamSpans->rowEnd(beam); ++span)
 			{
-				if (!validPixel(beam, sample, inputDims, maskPointer))
-					continue;
-				Vector3D inputPoint(beam * inputSpacing[0], sample * inputSpacing[1], 0.0);
-				Vector3D outputPoint = inputPoint;
-				optimizedCoordTransform(&outputPoint, recordTransform);
-				int outputVoxelX = static_cast<int> ((outputPoint[0] / outputSpacing[0]) + 0.5);
-				int outputVoxelY = static_cast<int> ((outputPoint[1] / outputSpacing[1]) + 0.5);
-				int outputVoxelZ = static_cast<int> ((outputPoint[2] / outputSpacing[2]) + 0.5);
-
-				if (validVoxel(outputVoxelX, outputVoxelY, outputVoxelZ, outputDims))
+				int sampleEnd = std::min(span->end, inputDims[1]);
+				for (int sample = span->begin; sample < sampleEnd; sample++)
 				{
-					int outputIndex = outputVoxelX + outputVoxelY * outputDims[0] + outputVoxelZ * outputDims[0]
-						* outputDims[1];
-					int inputIndex = beam + sample * inputDims[0];
-
-					// assign the max value found from all frames hitting this voxel. This removes black areas where (some of) multiple sweeps contains shadows.
-					outputPointer[outputIndex] = std::max<unsigned char>(inputPointer[inputIndex], outputPointer[outputIndex]);
-					// set minimum intensity value to 1. This separates "zero intensity" from "no intensity".
-					outputPointer[outputIndex] = std::max<unsigned char>(inputPointer[inputIndex], 1); //
-				}//validVoxel
-
-			}//sample
+					Vector3D inputPoint(beam * inputSpacing[0], sample * inputSpacing[1], 0.0);
+					Vector3D outputPoint = inputPoint;
+					optimizedCoordTransform(&outputPoint, recordTransform);
+					int outputVoxelX = static_cast<int> ((outputPoint[0] / outputSpacing[0]) + 0.5);
+					int outputVoxelY = static_cast<int> ((outputPoint[1] / outputSpacing[1]) + 0.5);
+					int outputVoxelZ = static_cast<int> ((outputPoint[2] / outputSpacing[2]) + 0.5);
+
+					if (validVoxel(outputVoxelX, outputVoxelY, outputVoxelZ, outputDims))
+					{
+						int outputIndex = outputVoxelX + outputVoxelY * outputDims[0] + outputVoxelZ * outputDims[0]
+							* outputDims[1];
+						int inputIndex = beam + sample * inputDims[0];
+
+						// assign the max value found from all frames hitting this voxel. This removes black areas where (some of) multiple sweeps contains shadows.
+						outputPointer[outputIndex] = std::max<unsigned char>(inputPointer[inputIndex], outputPointer[outputIndex]);
+						// set minimum intensity value to 1. This separates "zero intensity" from "no intensity".
+						outputPointer[outputIndex] = std::max<unsigned char>(inputPointer[inputIndex], 1); //
+					}//validVoxel
+
+				}//sample
+			}//span
 		}//beam
 	}//record
+	mLastStageTimings["forward"] = timer.getElapsedms();
 
 	// Fill holes
+	timer.reset();
 	this->interpolate(tempOutputData, outputData, settings);
+	mLastStageTimings["holefill"] = timer.getElapsedms();
 
 	setDeepModified(outputData);
 	return true;
@@ -42,15 +42,11 @@ public:
 
 	virtual std::vector<PropertyPtr> getSettings(QDomElement root);
 	virtual bool reconstruct(ProcessedUSInputDataPtr input, vtkImageDataPtr outputData, QDomElement settings);
+	virtual std::map<QString, double> getLastStageTimings() const { return mLastStageTimings; }
 
 
 private:
 	DoublePropertyPtr getInterpolationStepsOption(QDomElement root);
-	bool validPixel(int x, int y, const Eigen::Array3i& dims, unsigned char* rawPointer)
-	{
-		return (x >= 0) && (x < dims[0]) && (y >= 0) && (y < dims[1]) && (rawPointer[x + y * dims[0]] != 0);
-	}
-
 	bool validVoxel(int x, int y, int z, const int* dims)
 	{
 		return (x >= 0) && (x < dims[0]) && (y >= 0) && (y < dims[1]) && (z >= 0) && (z < dims[2]);
@@ -60,6 +56,7 @@ private:
 	vtkImageDataPtr createMask(vtkImageDataPtr inputData);
 	void fillHole(unsigned char *inputPointer, unsigned char *outputPointer, int x, int y, int z, const Eigen::Array3i& dim, int interpolationSteps);
 
+	std::map<QString, double> mLastStageTimings;
 
 };
 //typedef boost::shared_ptr<PNNReconstructionMethodService> PNNReconstructionMethodService*;
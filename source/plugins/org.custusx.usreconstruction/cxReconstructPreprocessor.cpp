@@ -29,7 +29,10 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "cxMathUtils.h"
 #include "cxPositionFilter.h"
 
+#include "cxParallelFor.h"
+
 #include <QThread>
+#include <boost/bind.hpp>
 
 namespace cx
 {
@@ -174,13 +177,79 @@ void ReconstructPreprocessor::applyTimeCalibration()
 }
 
 
-struct RemoveDataType
+namespace
+{
+/** Interpolated pose of frames [begin, end). Frames too far from the positions
+ *  are marked in remove, with the time difference in error.
+ */
+void interpolateFramePositions(const std::vector<TimedPosition>* positions, std::vector<TimedPosition>* frames,
+							   double maxTimeDiff, std::vector<char>* remove, std::vector<double>* error, int begin, int end)
+{
+	unsigned lastPos = unsigned(positions->size()) - 2;
+
+	for (int i_frame = begin; i_frame < end; ++i_frame)
+	{
+		TimedPosition& frame = (*frames)[i_frame];
+		std::vector<TimedPosition>::const_iterator posIter = lower_bound(positions->begin(), positions->end(), frame);
+
+		unsigned i_pos = unsigned(distance(positions->begin(), posIter));
+		if (i_pos != 0)
+			i_pos--;
+		i_pos = std::min(i_pos, lastPos);
+
+		const TimedPosition& pos1 = (*positions)[i_pos];
+		const TimedPosition& pos2 = (*positions)[i_pos+1];
+
+		// Remove frames too far from the positions
+		double timeToPos1 = fabs(frame.mTime - pos1.mTime);
+		double timeToPos2 = fabs(frame.mTime - pos2.mTime);
+		if ((timeToPos1 > maxTimeDiff) || (timeToPos2 > maxTimeDiff))
+		{
+			(*remove)[i_frame] = true;
+			(*error)[i_frame] = std::max(timeToPos1, timeToPos2);
+			continue;
+		}
+
+		double t_delta_tracking = pos2.mTime - pos1.mTime;
+		double t = 0;
+		if (!similar(t_delta_tracking, 0))
+			t = (frame.mTime - pos1.mTime) / t_delta_tracking;
+		frame.mPos = cx::USReconstructInputDataAlgorithm::slerpInterpolate(pos1.mPos, pos2.mPos, t);
+	}
+}
+
+void transformFramePositions(std::vector<TimedPosition>* frames, const Transform3D* M, int begin, int end)
+{
+	for (int i = begin; i < end; ++i)
+		(*frames)[i].mPos = (*M) * (*frames)[i].mPos;
+}
+
+/** Bounding box of the input rectangle in frames of the blocks [begin, end).
+ */
+void findFrameBlockBounds(const std::vector<TimedPosition>* frames, const std::vector<Vector3D>* inputRect, int blockSize,
+						  std::vector<DoubleBoundingBox3D>* blockBounds, int begin, int end)
 {
-	RemoveDataType() : count(0), err(-1) {}
-	void add(double _err) { ++count; err=((err<0)?_err:std::min(_err, err)); }
-	unsigned count;
-	double err;
-};
+	for (int block = begin; block < end; ++block)
+	{
+		int first = block*blockSize;
+		int last = std::min<int>(first + blockSize, frames->size());
+
+		Vector3D a = (*frames)[first].mPos.coord((*inputRect)[0]); // min
+		Vector3D b = a; // max
+		for (int slice = first; slice < last; ++slice)
+		{
+			const Transform3D& dMu = (*frames)[slice].mPos;
+			for (unsigned i = 0; i < inputRect->size(); ++i)
+			{
+				Vector3D p = dMu.coord((*inputRect)[i]);
+				a = a.cwiseMin(p);
+				b = b.cwiseMax(p);
+			}
+		}
+		(*blockBounds)[block] = DoubleBoundingBox3D(a, b);
+	}
+}
+}
 
 void ReconstructPreprocessor::filterPositions()
 {
@@ -209,51 +278,41 @@ void ReconstructPreprocessor::interpolatePositions()
 	mFileData.mUsRaw->resetRemovedFrames();
 	unsigned long startFrames = mFileData.mFrames.size();
 
-	std::map<unsigned,RemoveDataType> removedData;
-
-	for (unsigned i_frame = 0; i_frame < mFileData.mFrames.size();)
+	std::vector<char> remove(startFrames, false);
+	std::vector<double> error(startFrames, 0);
+	if (mFileData.mPositions.size() < 2)
 	{
-		std::vector<TimedPosition>::iterator posIter;
-		posIter = lower_bound(mFileData.mPositions.begin(), mFileData.mPositions.end(), mFileData.mFrames[i_frame]);
-
-		unsigned i_pos = unsigned(distance(mFileData.mPositions.begin(), posIter));
-		if (i_pos != 0)
-			i_pos--;
-
-		if (i_pos >= mFileData.mPositions.size() - 1)
-			i_pos = unsigned(mFileData.mPositions.size()) - 2;
-
-		// Remove frames too far from the positions
-		// Don't increment frame index since the index now points to the next element
-		double timeToPos1 = timeToPosition(i_frame, unsigned(i_pos));
-		double timeToPos2 = timeToPosition(i_frame, i_pos+1);
-		if ((timeToPos1 > mMaxTimeDiff) || (timeToPos2 > mMaxTimeDiff))
-		{
-			removedData[i_frame].add(std::max(timeToPos1, timeToPos2));
+		reportWarning("Need at least two tracking positions to interpolate frame positions.");
+		std::fill(remove.begin(), remove.end(), true);
+	}
+	else
+	{
+		parallelFor(0, startFrames,
+					boost::bind(&interpolateFramePositions, &mFileData.mPositions, &mFileData.mFrames, mMaxTimeDiff, &remove, &error, _1, _2),
+					256);
+	}
 
-			mFileData.mFrames.erase(mFileData.mFrames.begin() + i_frame);
-			mFileData.mUsRaw->removeFrame(i_frame);
-		}
-		else
+	// report runs of removed frames, and compact the frame list in one pass
+	std::vector<TimedPosition> frames;
+	frames.reserve(startFrames);
+	std::vector<bool> removeFromRaw(remove.begin(), remove.end());
+	for (unsigned i = 0; i < startFrames;)
+	{
+		if (!remove[i])
 		{
-			double t_delta_tracking = mFileData.mPositions[i_pos + 1].mTime - mFileData.mPositions[i_pos].mTime;
-			double t = 0;
-			if (!similar(t_delta_tracking, 0))
-				t = (mFileData.mFrames[i_frame].mTime - mFileData.mPositions[i_pos].mTime) / t_delta_tracking;
-			//			mFileData.mFrames[i_frame].mPos = interpolate(mFileData.mPositions[i_pos].mPos, mFileData.mPositions[i_pos + 1].mPos, t);
-			mFileData.mFrames[i_frame].mPos = cx::USReconstructInputDataAlgorithm::slerpInterpolate(mFileData.mPositions[i_pos].mPos, mFileData.mPositions[i_pos + 1].mPos, t);
-			i_frame++;// Only increment if we didn't delete the frame
+			frames.push_back(mFileData.mFrames[i]);
+			++i;
+			continue;
 		}
-	}
 
-	unsigned removeCount=0;
-	for (std::map<unsigned,RemoveDataType>::iterator iter=removedData.begin(); iter!=removedData.end(); ++iter)
-	{
-		unsigned first = iter->first+removeCount;
-		unsigned last = first + iter->second.count-1;
-		report(QString("Removed input frame [%1-%2]. Time diff=%3").arg(first).arg(last).arg(iter->second.err, 0, 'f', 1));
-		removeCount += iter->second.count;
+		unsigned first = i;
+		double err = error[i];
+		for (; i < startFrames && remove[i]; ++i)
+			err = std::min(err, error[i]);
+		report(QString("Removed input frame [%1-%2]. Time diff=%3").arg(first).arg(i-1).arg(err, 0, 'f', 1));
 	}
+	mFileData.mFrames.swap(frames);
+	mFileData.mUsRaw->removeFrames(removeFromRaw);
 
 	double removed = double(startFrames - mFileData.mFrames.size()) / double(startFrames);
 	if (removed > 0.02)
@@ -271,18 +330,13 @@ void ReconstructPreprocessor::interpolatePositions()
 }
 
 
-double ReconstructPreprocessor::timeToPosition(unsigned i_frame, unsigned i_pos)
-{
-		return fabs(mFileData.mFrames[i_frame].mTime - mFileData.mPositions[i_pos].mTime);
-}
-
 /**
  * Generate a rectangle (2D) defining ROI in input image space
  */
 std::vector<Vector3D> ReconstructPreprocessor::generateInputRectangle()
 {
 	std::vector<Vector3D> retval(4);
-	vtkImageDataPtr mask = mFileData.getMask();
+	MaskSpansPtr mask = mFileData.getMaskSpans();
 	if (!mask)
 	{
 		reportError("Reconstructer::generateInputRectangle() + requires mask");
@@ -291,7 +345,7 @@ std::vector<Vector3D> ReconstructPreprocessor::generateInputRectangle()
 	Eigen::Array3i dims = mFileData.mUsRaw->getDimensions();
 	Vector3D spacing = mFileData.mUsRaw->getSpacing();
 
-	Eigen::Array3i maskDims(mask->GetDimensions());
+	Eigen::Array3i maskDims(mask->getWidth(), mask->getHeight(), 1);
 
 	if (( maskDims[0]<dims[0] )||( maskDims[1]<dims[1] ))
 		reportError(QString("input data (%1) and mask (%2) dim mimatch")
@@ -302,20 +356,7 @@ std::vector<Vector3D> ReconstructPreprocessor::generateInputRectangle()
 	int xmax = 0;
 	int ymin = maskDims[1];
 	int ymax = 0;
-
-	unsigned char* ptr = static_cast<unsigned char*> (mask->GetScalarPointer());
-	for (int x = 0; x < maskDims[0]; x++)
-		for (int y = 0; y < maskDims[1]; y++)
-		{
-			unsigned char val = ptr[x + y * maskDims[0]];
-			if (val != 0)
-			{
-				xmin = std::min(xmin, x);
-				ymin = std::min(ymin, y);
-				xmax = std::max(xmax, x);
-				ymax = std::max(ymax, y);
-			}
-		}
+	mask->getBounds(&xmin, &xmax, &ymin, &ymax);
 
 	//Reduce the output volume by reducing the mask when determining output volume size
 	double red = mInput.mMaskReduce;
@@ -359,13 +400,9 @@ Transform3D ReconstructPreprocessor::applyOutputOrientation()
 	}
 
 	// apply the selected orientation to the frames.
+	// mPos = prMu -> mPos = ddMu
 	Transform3D ddMpr = prMdd.inv();
-	for (unsigned i = 0; i < mFileData.mFrames.size(); i++)
-	{
-		// mPos = prMu
-		mFileData.mFrames[i].mPos = ddMpr * mFileData.mFrames[i].mPos;
-		// mPos = ddMu
-	}
+	parallelFor(0, mFileData.mFrames.size(), boost::bind(&transformFramePositions, &mFileData.mFrames, &ddMpr, _1, _2), 256);
 
 	return prMdd;
 }
@@ -387,27 +424,26 @@ void ReconstructPreprocessor::findExtentAndOutputTransform()
 	Transform3D prMdd = this->applyOutputOrientation();
 	//mFrames[i].mPos = d'Mu, d' = only rotation
 
-	// Find extent of all frames as a point cloud
+	// Find extent of all frames as a point cloud, reduced in blocks of frames
 	std::vector<Vector3D> inputRect = this->generateInputRectangle();
-	std::vector<Vector3D> outputRect;
-	for (unsigned slice = 0; slice < mFileData.mFrames.size(); slice++)
+	int blockSize = 256;
+	int blockCount = (mFileData.mFrames.size() + blockSize - 1) / blockSize;
+	std::vector<DoubleBoundingBox3D> blockBounds(blockCount, DoubleBoundingBox3D::zero());
+	parallelFor(0, blockCount, boost::bind(&findFrameBlockBounds, &mFileData.mFrames, &inputRect, blockSize, &blockBounds, _1, _2));
+
+	std::vector<Vector3D> blockCorners;
+	for (unsigned i = 0; i < blockBounds.size(); i++)
 	{
-		Transform3D dMu = mFileData.mFrames[slice].mPos;
-		for (unsigned i = 0; i < inputRect.size(); i++)
-		{
-			outputRect.push_back(dMu.coord(inputRect[i]));
-		}
+		blockCorners.push_back(blockBounds[i].bottomLeft());
+		blockCorners.push_back(blockBounds[i].topRight());
 	}
-
-	DoubleBoundingBox3D extent = DoubleBoundingBox3D::fromCloud(outputRect);
+	DoubleBoundingBox3D extent = DoubleBoundingBox3D::fromCloud(blockCorners);
 
 	// Translate dMu to output volume origo
 	Transform3D T_origo = createTransformTranslate(extent.corner(0, 0, 0));
 	Transform3D prMd = prMdd * T_origo; // transform from output space to patref, use when storing volume.
-	for (unsigned i = 0; i < mFileData.mFrames.size(); i++)
-	{
-		mFileData.mFrames[i].mPos = T_origo.inv() * mFileData.mFrames[i].mPos;
-	}
+	Transform3D T_origo_inv = T_origo.inv();
+	parallelFor(0, mFileData.mFrames.size(), boost::bind(&transformFramePositions, &mFileData.mFrames, &T_origo_inv, _1, _2), 256);
 
 	// Calculate optimal output image spacing and dimensions based on US frame spacing
 	double inputSpacing = std::min(mFileData.mUsRaw->getSpacing()[0], mFileData.mUsRaw->getSpacing()[1]);
@@ -51,7 +51,6 @@ private:
 	Transform3D applyOutputOrientation();
 	std::vector<Vector3D> generateInputRectangle();
 	void interpolatePositions();
-	double timeToPosition(unsigned i_frame, unsigned i_pos);
 	void filterPositions(); // Noise-supressing position filter, averaging filter, configurable length
 	void positionThinning(); // If enabled, try to remove "suspect" data (large jumps etc.)
 	void applyTimeCalibration();
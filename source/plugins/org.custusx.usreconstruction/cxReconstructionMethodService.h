@@ -20,6 +20,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include <vtkSmartPointer.h>
 #include "cxProperty.h"
 #include  "boost/shared_ptr.hpp"
+#include <map>
 
 
 class QDomElement;
@@ -69,6 +70,11 @@ public:
 	 * \param settings Reference to settings file containing algorithm-specific settings
 	 */
 	virtual bool reconstruct(ProcessedUSInputDataPtr input, vtkImageDataPtr outputData, QDomElement settings) = 0;
+	/**
+	 * Time in ms spent in each stage of the last call to reconstruct(),
+	 * keyed on stage name. Empty if the algorithm does not record this.
+	 */
+	virtual std::map<QString, double> getLastStageTimings() const { return std::map<QString, double>(); }
 };
 
 /**
@@ -0,0 +1,311 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "cxtestReconstructionBenchmark.h"
+
+#include <QDomDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QFile>
+#include <QThread>
+#include <QTextStream>
+#include <ctkServiceTracker.h>
+#include "vtkImageData.h"
+#include "cxReconstructionMethodService.h"
+#include "cxReconstructPreprocessor.h"
+#include "cxPatientModelService.h"
+#include "cxtestSyntheticReconstructInput.h"
+#include "cxtestSyntheticVolumeComparer.h"
+#include "cxtestJenkinsMeasurement.h"
+#include "cxDummyTool.h"
+#include "cxImage.h"
+#include "cxVolumeHelpers.h"
+#include "cxRegistrationTransform.h"
+#include "cxTimeKeeper.h"
+#include "cxUSFrameData.h"
+#include "cxLogger.h"
+
+#if defined(Q_OS_MAC)
+#include <sys/resource.h>
+#endif
+
+namespace cxtest
+{
+
+ReconstructionBenchmarkCase::ReconstructionBenchmarkCase() :
+	mName("base"),
+	mFrameCount(100),
+	mFrameSize(200, 200),
+	mOutputSpacing(1),
+	mSize(100),
+	mProbeType(cx::ProbeDefinition::tLINEAR),
+	mSectorAngle(M_PI/2)
+{
+}
+
+ReconstructionBenchmarkResult::ReconstructionBenchmarkResult() :
+	mSuccess(false),
+	mInputPixels(0),
+	mOutputVoxels(0),
+	mInputGenerationMs(0),
+	mPreprocessMs(0),
+	mReconstructMs(0),
+	mVoxelsPerSecond(0),
+	mPeakMemoryMB(-1),
+	mPeakMemoryPerCase(false),
+	mRMS(0)
+{
+}
+
+ReconstructionBenchmark::ReconstructionBenchmark() :
+	mVerbose(false)
+{
+}
+
+void ReconstructionBenchmark::addCase(ReconstructionBenchmarkCase benchmarkCase)
+{
+	mCases.push_back(benchmarkCase);
+}
+
+void ReconstructionBenchmark::addDefaultSweep()
+{
+	ReconstructionBenchmarkCase base;
+	this->addCase(base);
+
+	ReconstructionBenchmarkCase manyFrames = base;
+	manyFrames.mName = "frames_400";
+	manyFrames.mFrameCount = 400;
+	this->addCase(manyFrames);
+
+	ReconstructionBenchmarkCase largeFrames = base;
+	largeFrames.mName = "framesize_500";
+	largeFrames.mFrameSize = Eigen::Array2i(500, 500);
+	this->addCase(largeFrames);
+
+	ReconstructionBenchmarkCase fineOutput = base;
+	fineOutput.mName = "spacing_0.5";
+	fineOutput.mOutputSpacing = 0.5;
+	this->addCase(fineOutput);
+
+	ReconstructionBenchmarkCase sector = base;
+	sector.mName = "sector_90";
+	sector.mProbeType = cx::ProbeDefinition::tSECTOR;
+	sector.mSectorAngle = M_PI/2;
+	this->addCase(sector);
+}
+
+std::vector<cx::ReconstructionMethodService*> ReconstructionBenchmark::getCPUAlgorithms(ctkPluginContext* context)
+{
+	std::vector<cx::ReconstructionMethodService*> retval;
+	ctkServiceTracker<cx::ReconstructionMethodService*> tracker(context);
+	tracker.open();
+	QList<cx::ReconstructionMethodService*> services = tracker.getServices();
+	for (int i = 0; i < services.size(); ++i)
+	{
+		// OpenCL based algorithms are named *_cl
+		if (services[i]->getName().endsWith("_cl"))
+			continue;
+		retval.push_back(services[i]);
+	}
+	return retval;
+}
+
+double ReconstructionBenchmark::getPeakMemoryMB()
+{
+#if defined(Q_OS_LINUX)
+	QFile file("/proc/self/status");
+	if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+		return -1;
+	QTextStream stream(&file);
+	for (QString line = stream.readLine(); !line.isNull(); line = stream.readLine())
+	{
+		if (line.startsWith("VmHWM:"))
+			return line.split(" ", QString::SkipEmptyParts)[1].toDouble() / 1024.0; // kB
+	}
+	return -1;
+#elif defined(Q_OS_MAC)
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return -1;
+	return usage.ru_maxrss / (1024.0 * 1024.0); // bytes
+#else
+	return -1;
+#endif
+}
+
+bool ReconstructionBenchmark::resetPeakMemory()
+{
+#if defined(Q_OS_LINUX)
+	// resets VmHWM to the current resident size (Linux 4.0 and later)
+	QFile file("/proc/self/clear_refs");
+	if (!file.open(QIODevice::WriteOnly))
+		return false;
+	return file.write("5") == 1;
+#else
+	return false;
+#endif
+}
+
+cx::ProbeDefinition ReconstructionBenchmark::createProbe(ReconstructionBenchmarkCase benchmarkCase) const
+{
+	double depth = benchmarkCase.mSize;
+	if (benchmarkCase.mProbeType != cx::ProbeDefinition::tSECTOR)
+		return cx::DummyToolTestUtilities::createProbeDefinitionLinear(depth, benchmarkCase.mSize, benchmarkCase.mFrameSize);
+
+	// width is the sector angle for sector probes: set spacing to cover the sector
+	cx::ProbeDefinition retval = cx::DummyToolTestUtilities::createProbeDefinition(cx::ProbeDefinition::tSECTOR, depth, benchmarkCase.mSectorAngle, benchmarkCase.mFrameSize);
+	Eigen::Array2i extent = benchmarkCase.mFrameSize - 1;
+	double width = 2 * depth * sin(benchmarkCase.mSectorAngle/2);
+	retval.setSpacing(cx::Vector3D(width/extent[0], depth/extent[1], 1.0));
+	return retval;
+}
+
+ReconstructionBenchmarkResult ReconstructionBenchmark::runCase(cx::ReconstructionMethodService* algorithm, ReconstructionBenchmarkCase benchmarkCase)
+{
+	ReconstructionBenchmarkResult retval;
+	retval.mAlgorithm = algorithm->getName();
+	retval.mCase = benchmarkCase;
+
+	SyntheticReconstructInput generator;
+	generator.setOverallBoundsAndSpacing(benchmarkCase.mSize, benchmarkCase.mOutputSpacing);
+	generator.defineProbe(this->createProbe(benchmarkCase));
+	generator.defineProbeMovementSteps(benchmarkCase.mFrameCount);
+	generator.defineProbeMovementNormalizedTranslationRange(0.8);
+	generator.defineProbeMovementAngleRange(M_PI/6);
+	generator.setSpherePhantom();
+
+	retval.mPeakMemoryPerCase = resetPeakMemory();
+	cx::TimeKeeper timer;
+	cx::USReconstructInputData rawInput = generator.generateSynthetic_USReconstructInputData();
+	retval.mInputGenerationMs = timer.getElapsedms();
+
+	timer.reset();
+	cx::ReconstructPreprocessor preprocessor(cx::PatientModelService::getNullObject());
+	preprocessor.initialize(cx::ReconstructCore::InputParams(), rawInput);
+	std::vector<cx::ProcessedUSInputDataPtr> processedInput = preprocessor.createProcessedInput(std::vector<bool>(1, false));
+	retval.mPreprocessMs = timer.getElapsedms();
+	cx::ProcessedUSInputDataPtr input = processedInput[0];
+	Eigen::Array3i inputDim = input->getDimensions();
+	retval.mInputPixels = double(inputDim.prod());
+
+	// output volume around the frames as found by the preprocessor, with the spacing of the case
+	cx::OutputVolumeParams outputParams = preprocessor.getOutputVolumeParams();
+	outputParams.setSpacing(benchmarkCase.mOutputSpacing);
+	cx::Vector3D spacing = cx::Vector3D::Ones() * outputParams.getSpacing();
+	Eigen::Array3i dim = outputParams.getDim();
+	cx::ImagePtr output(new cx::Image("output", cx::generateVtkImageData(dim, spacing, 0)));
+	output->get_rMd_History()->setRegistration(outputParams.get_rMd());
+	retval.mOutputVoxels = double(dim.prod());
+
+	QDomDocument domdoc;
+	QDomElement settings = domdoc.createElement(algorithm->getName());
+	algorithm->getSettings(settings);
+
+	timer.reset();
+	retval.mSuccess = algorithm->reconstruct(input, output->getBaseVtkImageData(), settings);
+	retval.mReconstructMs = timer.getElapsedms();
+	retval.mStageMs = algorithm->getLastStageTimings();
+	retval.mPeakMemoryMB = getPeakMemoryMB();
+	if (retval.mReconstructMs > 0)
+		retval.mVoxelsPerSecond = retval.mOutputVoxels / (retval.mReconstructMs / 1000.0);
+
+	SyntheticVolumeComparer comparer;
+	comparer.setPhantom(generator.getPhantom());
+	comparer.setTestImage(output);
+	retval.mRMS = comparer.getRMS();
+
+	if (mVerbose)
+		CX_LOG_INFO() << QString("Reconstruction benchmark %1 %2: %3 ms, RMS %4")
+						 .arg(retval.mAlgorithm)
+						 .arg(benchmarkCase.mName)
+						 .arg(retval.mReconstructMs)
+						 .arg(retval.mRMS);
+
+	return retval;
+}
+
+void ReconstructionBenchmark::run(std::vector<cx::ReconstructionMethodService*> algorithms)
+{
+	for (unsigned i = 0; i < algorithms.size(); ++i)
+		for (unsigned j = 0; j < mCases.size(); ++j)
+			mResults.push_back(this->runCase(algorithms[i], mCases[j]));
+}
+
+QJsonDocument ReconstructionBenchmark::toJson() const
+{
+	QJsonArray results;
+	for (unsigned i = 0; i < mResults.size(); ++i)
+	{
+		const ReconstructionBenchmarkResult& result = mResults[i];
+
+		QJsonObject parameters;
+		parameters["frameCount"] = result.mCase.mFrameCount;
+		parameters["frameWidth"] = result.mCase.mFrameSize[0];
+		parameters["frameHeight"] = result.mCase.mFrameSize[1];
+		parameters["outputSpacing"] = result.mCase.mOutputSpacing;
+		parameters["size"] = result.mCase.mSize;
+		parameters["probeType"] = (result.mCase.mProbeType == cx::ProbeDefinition::tSECTOR) ? "sector" : "linear";
+		if (result.mCase.mProbeType == cx::ProbeDefinition::tSECTOR)
+			parameters["sectorAngle"] = result.mCase.mSectorAngle;
+
+		QJsonObject timings;
+		timings["preprocess"] = result.mPreprocessMs;
+		timings["reconstruct"] = result.mReconstructMs;
+		for (std::map<QString, double>::const_iterator iter = result.mStageMs.begin(); iter != result.mStageMs.end(); ++iter)
+			timings[iter->first] = iter->second;
+
+		QJsonObject entry;
+		entry["algorithm"] = result.mAlgorithm;
+		entry["case"] = result.mCase.mName;
+		entry["parameters"] = parameters;
+		entry["success"] = result.mSuccess;
+		entry["inputPixels"] = result.mInputPixels;
+		entry["outputVoxels"] = result.mOutputVoxels;
+		entry["inputGenerationMs"] = result.mInputGenerationMs;
+		entry["timings_ms"] = timings;
+		entry["voxelsPerSecond"] = result.mVoxelsPerSecond;
+		entry[result.mPeakMemoryPerCase ? "peakMemoryMB" : "processPeakMemoryMB"] = result.mPeakMemoryMB;
+		entry["rms"] = result.mRMS;
+		results.append(entry);
+	}
+
+	QJsonObject root;
+	root["threadCount"] = QThread::idealThreadCount();
+	root["results"] = results;
+	return QJsonDocument(root);
+}
+
+bool ReconstructionBenchmark::saveJson(QString filename) const
+{
+	QFile file(filename);
+	if (!file.open(QIODevice::WriteOnly))
+	{
+		CX_LOG_ERROR() << "Failed to write reconstruction benchmark to " << filename;
+		return false;
+	}
+	file.write(this->toJson().toJson());
+	return true;
+}
+
+void ReconstructionBenchmark::reportJenkinsMeasurements() const
+{
+	JenkinsMeasurement jenkins;
+	for (unsigned i = 0; i < mResults.size(); ++i)
+	{
+		const ReconstructionBenchmarkResult& result = mResults[i];
+		QString prefix = QString("USReconstruction_%1_%2_").arg(result.mAlgorithm).arg(result.mCase.mName);
+		jenkins.createOutput(prefix + "ms", QString::number(result.mReconstructMs));
+		jenkins.createOutput(prefix + "voxelsPerSecond", QString::number(result.mVoxelsPerSecond, 'f', 0));
+		jenkins.createOutput(prefix + "rms", QString::number(result.mRMS));
+	}
+}
+
+} // namespace cxtest
@@ -0,0 +1,103 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#ifndef CXTESTRECONSTRUCTIONBENCHMARK_H
+#define CXTESTRECONSTRUCTIONBENCHMARK_H
+
+#include "cxtest_org_custusx_usreconstruction_export.h"
+
+#include <vector>
+#include <map>
+#include <QString>
+#include <QJsonDocument>
+#include "cxProbeDefinition.h"
+
+class ctkPluginContext;
+
+namespace cx
+{
+class ReconstructionMethodService;
+}
+
+namespace cxtest
+{
+
+/** One configuration of synthetic input and output volume.
+ */
+struct CXTEST_ORG_CUSTUSX_USRECONSTRUCTION_EXPORT ReconstructionBenchmarkCase
+{
+	ReconstructionBenchmarkCase();
+	QString mName;
+	int mFrameCount;
+	Eigen::Array2i mFrameSize;
+	double mOutputSpacing; ///< mm
+	double mSize; ///< side length of phantom and output volume, mm
+	cx::ProbeDefinition::TYPE mProbeType;
+	double mSectorAngle; ///< radians, used for sector probes only
+};
+
+struct CXTEST_ORG_CUSTUSX_USRECONSTRUCTION_EXPORT ReconstructionBenchmarkResult
+{
+	ReconstructionBenchmarkResult();
+	QString mAlgorithm;
+	ReconstructionBenchmarkCase mCase;
+	bool mSuccess;
+	double mInputPixels;
+	double mOutputVoxels;
+	double mInputGenerationMs; ///< generation of the synthetic raw input data, not a reconstruction stage
+	double mPreprocessMs; ///< ReconstructPreprocessor, from raw input data to processed input data
+	double mReconstructMs; ///< total time in ReconstructionMethodService::reconstruct()
+	std::map<QString, double> mStageMs; ///< as reported by the algorithm
+	double mVoxelsPerSecond;
+	double mPeakMemoryMB; ///< peak during this case if mPeakMemoryPerCase, otherwise process peak so far. -1 if unknown
+	bool mPeakMemoryPerCase;
+	double mRMS;
+};
+
+/** Run CPU reconstruction algorithms on parametrised synthetic data
+ *  and collect timings, memory use and error against the nominal phantom.
+ *
+ *  Results can be written as JSON and as Jenkins measurements.
+ *
+ * \ingroup cx
+ * \date Oct 19, 2026
+ */
+class CXTEST_ORG_CUSTUSX_USRECONSTRUCTION_EXPORT ReconstructionBenchmark
+{
+public:
+	ReconstructionBenchmark();
+	void addCase(ReconstructionBenchmarkCase benchmarkCase);
+	void addDefaultSweep(); ///< vary frame count, frame size, output spacing and sector shape around a base case
+	void setVerbose(bool val) { mVerbose = val; }
+
+	void run(std::vector<cx::ReconstructionMethodService*> algorithms);
+	std::vector<ReconstructionBenchmarkResult> getResults() const { return mResults; }
+
+	QJsonDocument toJson() const;
+	bool saveJson(QString filename) const;
+	void reportJenkinsMeasurements() const;
+
+	static std::vector<cx::ReconstructionMethodService*> getCPUAlgorithms(ctkPluginContext* context);
+	static double getPeakMemoryMB();
+	static bool resetPeakMemory(); ///< start a new peak measurement, false if not supported
+
+private:
+	ReconstructionBenchmarkResult runCase(cx::ReconstructionMethodService* algorithm, ReconstructionBenchmarkCase benchmarkCase);
+	cx::ProbeDefinition createProbe(ReconstructionBenchmarkCase benchmarkCase) const;
+
+	std::vector<ReconstructionBenchmarkCase> mCases;
+	std::vector<ReconstructionBenchmarkResult> mResults;
+	bool mVerbose;
+};
+
+} // namespace cxtest
+
+#endif // CXTESTRECONSTRUCTIONBENCHMARK_H
@@ -198,6 +198,32 @@ TEST_CASE("ReconstructManager: Preprocessor handles too large clip rect","[integ
 	}
 }
 
+TEST_CASE("ReconstructManager: Preprocessor removes frames far from tracking positions","[unit][usreconstruction][synthetic][not_win32]")
+{
+	SyntheticReconstructInputPtr generator(new SyntheticReconstructInput);
+	Eigen::Array2i frameSize = Eigen::Array2i(150,150);
+	generator->defineProbe(cx::DummyToolTestUtilities::createProbeDefinitionLinear(100, 100, frameSize));
+	generator->setSpherePhantom();
+
+	cx::USReconstructInputData inputData = generator->generateSynthetic_USReconstructInputData();
+	unsigned frameCount = inputData.mFrames.size();
+	REQUIRE(frameCount > 10);
+
+	// one frame before and a run of frames after all positions
+	inputData.mFrames[0].mTime -= 10000;
+	for (unsigned i=5; i<10; ++i)
+		inputData.mFrames[i].mTime += 10000;
+
+	cx::ReconstructPreprocessorPtr preprocessor(new cx::ReconstructPreprocessor(cx::PatientModelService::getNullObject()));
+	cx::ReconstructCore::InputParams par;
+	preprocessor->initialize(par, inputData);
+
+	std::vector<cx::ProcessedUSInputDataPtr> processedInput = preprocessor->createProcessedInput(std::vector<bool>(1, false));
+	REQUIRE(processedInput.size() == 1);
+	CHECK(processedInput[0]->getDimensions()[2] == int(frameCount - 6));
+	CHECK(processedInput[0]->getFrames().size() == frameCount - 6);
+}
+
 } // namespace cxtest
 
 
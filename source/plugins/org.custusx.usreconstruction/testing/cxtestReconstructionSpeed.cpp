@@ -0,0 +1,44 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "catch.hpp"
+#include "cxtestReconstructionBenchmark.h"
+#include "cxLogicManager.h"
+#include "cxDataLocations.h"
+
+namespace cxtest
+{
+
+TEST_CASE("Speed: US reconstruction benchmark on synthetic data", "[speed][usreconstruction][synthetic][integration]")
+{
+	cx::DataLocations::setTestMode();
+	cx::LogicManager::initialize();
+
+	std::vector<cx::ReconstructionMethodService*> algorithms = ReconstructionBenchmark::getCPUAlgorithms(cx::logicManager()->getPluginContext());
+	REQUIRE(!algorithms.empty());
+
+	ReconstructionBenchmark benchmark;
+	benchmark.setVerbose(true);
+	benchmark.addDefaultSweep();
+	benchmark.run(algorithms);
+
+	std::vector<ReconstructionBenchmarkResult> results = benchmark.getResults();
+	REQUIRE(results.size() == 5*algorithms.size());
+	for (unsigned i = 0; i < results.size(); ++i)
+		CHECK(results[i].mSuccess);
+
+	CHECK(benchmark.saveJson(cx::DataLocations::getTestDataPath() + "/temp/USReconstructionBenchmark.json"));
+	benchmark.reportJenkinsMeasurements();
+
+	cx::LogicManager::shutdown();
+}
+
+} // namespace cxtest
@@ -0,0 +1,82 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#include "cxIGTLinkCompressedImageMessage.h"
+
+#include <string.h>
+
+namespace cx
+{
+
+namespace
+{
+const int gHeaderSize = 8;
+
+void writeUint32(unsigned char* ptr, igtlUint32 value)
+{
+	ptr[0] = (value >> 24) & 0xFF;
+	ptr[1] = (value >> 16) & 0xFF;
+	ptr[2] = (value >> 8) & 0xFF;
+	ptr[3] = value & 0xFF;
+}
+
+igtlUint32 readUint32(const unsigned char* ptr)
+{
+	return (igtlUint32(ptr[0])<<24) | (igtlUint32(ptr[1])<<16) | (igtlUint32(ptr[2])<<8) | igtlUint32(ptr[3]);
+}
+}
+
+IGTLinkCompressedImageMessage::IGTLinkCompressedImageMessage() :
+	igtl::MessageBase(),
+	mKeyFrame(true),
+	mRawSize(0)
+{
+	m_SendMessageType = "CX_ZIMAGE";
+}
+
+IGTLinkCompressedImageMessage::~IGTLinkCompressedImageMessage()
+{}
+
+int IGTLinkCompressedImageMessage::GetBodyPackSize()
+{
+	return gHeaderSize + mData.size();
+}
+
+int IGTLinkCompressedImageMessage::PackBody()
+{
+	AllocatePack();
+	unsigned char* body = reinterpret_cast<unsigned char*>(this->m_Body);
+
+	body[0] = mKeyFrame ? 1 : 0;
+	body[1] = 1;
+	body[2] = 0;
+	body[3] = 0;
+	writeUint32(body + 4, mRawSize);
+	if (!mData.isEmpty())
+		memcpy(body + gHeaderSize, mData.constData(), mData.size());
+
+	return 1;
+}
+
+int IGTLinkCompressedImageMessage::UnpackContent()
+{
+	const unsigned char* body = reinterpret_cast<const unsigned char*>(this->m_Body);
+	int bodySize = this->m_BodySizeToRead;
+	if (bodySize < gHeaderSize || body[1] != 1)
+		return 0;
+
+	mKeyFrame = body[0] != 0;
+	mRawSize = readUint32(body + 4);
+	mData = QByteArray(reinterpret_cast<const char*>(body + gHeaderSize), bodySize - gHeaderSize);
+
+	return 1;
+}
+
+}
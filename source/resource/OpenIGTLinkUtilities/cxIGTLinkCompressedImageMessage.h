@@ -0,0 +1,71 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#ifndef CXIGTLINKCOMPRESSEDIMAGEMESSAGE_H_
+#define CXIGTLINKCOMPRESSEDIMAGEMESSAGE_H_
+
+#include "cxOpenIGTLinkUtilitiesExport.h"
+
+#include <QByteArray>
+#include "igtlMessageBase.h"
+
+namespace cx
+{
+
+/**
+ * \ingroup cx_resource_OpenIGTLinkUtilities
+ * \date Oct 19, 2026
+ * \brief Losslessly compressed IMAGE message.
+ *
+ * Created by IGTLinkImageStreamEncoder, see that class for the compression.
+
+IGTLink Message content (big endian):
+
+uint8 KeyFrame: 1 if the frame does not depend on the previous frame
+uint8 Version: codec version, currently 1
+uint16 Reserved
+uint32 RawSize: size of the decompressed data
+uint8[] Data: compressed data, the rest of the body
+
+ */
+class cxOpenIGTLinkUtilities_EXPORT IGTLinkCompressedImageMessage : public igtl::MessageBase
+{
+public:
+	typedef IGTLinkCompressedImageMessage Self;
+	typedef igtl::MessageBase Superclass;
+	typedef igtl::SmartPointer<Self> Pointer;
+	typedef igtl::SmartPointer<const Self> ConstPointer;
+
+	igtlTypeMacro(IGTLinkCompressedImageMessage, igtl::MessageBase)
+	igtlNewMacro(IGTLinkCompressedImageMessage)
+
+	void SetKeyFrame(bool on) { mKeyFrame = on; }
+	bool GetKeyFrame() const { return mKeyFrame; }
+	void SetRawSize(igtlUint32 size) { mRawSize = size; }
+	igtlUint32 GetRawSize() const { return mRawSize; }
+	void SetData(QByteArray data) { mData = data; }
+	QByteArray GetData() const { return mData; }
+
+protected:
+	IGTLinkCompressedImageMessage();
+	virtual ~IGTLinkCompressedImageMessage();
+
+	virtual int GetBodyPackSize();
+	virtual int PackBody();
+	virtual int UnpackContent();
+
+	bool mKeyFrame;
+	igtlUint32 mRawSize;
+	QByteArray mData;
+};
+
+}
+
+#endif /* CXIGTLINKCOMPRESSEDIMAGEMESSAGE_H_ */
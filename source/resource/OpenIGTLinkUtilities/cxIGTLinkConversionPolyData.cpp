@@ -41,6 +41,9 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include <vtkDataSetAttributes.h>
 #include <vtkPointData.h>
 #include <vtkCellData.h>
+#include <vtkIdTypeArray.h>
+#include <vector>
+#include <cstring>
 
 // CX includes
 #include "cxMesh.h"
@@ -51,6 +54,173 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 namespace cx
 {
 
+namespace
+{
+
+igtlUint32 readUint32(const unsigned char* ptr)
+{
+	// OpenIGTLink data are big endian
+	return (igtlUint32(ptr[0])<<24) | (igtlUint32(ptr[1])<<16) | (igtlUint32(ptr[2])<<8) | igtlUint32(ptr[3]);
+}
+
+igtlFloat32 readFloat32(const unsigned char* ptr)
+{
+	igtlUint32 bits = readUint32(ptr);
+	igtlFloat32 retval;
+	memcpy(&retval, &bits, sizeof(retval));
+	return retval;
+}
+
+igtlUint32 getNumberOfCells(igtl::PolyDataCellArray::Pointer cells)
+{
+	return cells.IsNotNull() ? cells->GetNumberOfCells() : 0;
+}
+
+/** Location of the points and cells in the packed body of a POLYDATA message.
+ *  The body starts with 10 uint32 counts, followed by the points and the
+ *  vertex, line, polygon and triangle strip cells. See igtl_polydata.h.
+ */
+struct PackedPolyData
+{
+	PackedPolyData() : points(NULL), npoints(0)
+	{
+		for (int i=0; i<4; ++i)
+		{
+			cells[i] = NULL;
+			ncells[i] = 0;
+			cellBytes[i] = 0;
+		}
+	}
+	const unsigned char* points;
+	igtlUint32 npoints;
+	const unsigned char* cells[4]; ///< vertices, lines, polygons, triangle strips
+	igtlUint32 ncells[4];
+	igtlUint32 cellBytes[4];
+};
+
+/** Find points and cells in the packed body of msg. The body is only used if
+ *  it is consistent with the unpacked content, otherwise an empty
+ *  PackedPolyData is returned.
+ */
+PackedPolyData findPackedPolyData(igtl::PolyDataMessage* msg)
+{
+	const int headerSize = 10*sizeof(igtlUint32);
+	long long bodySize = msg->GetPackBodySize();
+	if (bodySize < headerSize || !msg->GetPackBodyPointer())
+		return PackedPolyData();
+	const unsigned char* body = static_cast<const unsigned char*>(msg->GetPackBodyPointer());
+
+	igtlUint32 header[10];
+	for (int i=0; i<10; ++i)
+		header[i] = readUint32(body + i*sizeof(igtlUint32));
+
+	igtl::PolyDataPointArray::Pointer pointsArray = msg->GetPoints();
+	igtlUint32 npoints = pointsArray.IsNotNull() ? pointsArray->GetNumberOfPoints() : 0;
+	if (header[0] != npoints)
+		return PackedPolyData();
+
+	PackedPolyData retval;
+	retval.points = body + headerSize;
+	retval.npoints = npoints;
+	long long offset = headerSize + (long long)(npoints)*3*sizeof(igtlFloat32);
+
+	igtl::PolyDataCellArray::Pointer cellArrays[4] = { msg->GetVertices(), msg->GetLines(), msg->GetPolygons(), msg->GetTriangleStrips() };
+	for (int i=0; i<4; ++i)
+	{
+		retval.ncells[i] = header[1+2*i];
+		retval.cellBytes[i] = header[2+2*i];
+		if (retval.ncells[i] != getNumberOfCells(cellArrays[i]))
+			return PackedPolyData();
+		retval.cells[i] = body + size_t(offset);
+		offset += retval.cellBytes[i];
+	}
+
+	if (offset > bodySize)
+		return PackedPolyData();
+	return retval;
+}
+
+/** Create cells from packed cell data: for each cell the number of ids, then the ids.
+ *  This is also the layout of vtkCellArray, so the ids are copied in one pass.
+ */
+vtkCellArrayPtr decodePackedCells(const unsigned char* data, igtlUint32 ncells, igtlUint32 bytes)
+{
+	vtkIdType count = bytes/sizeof(igtlUint32);
+	vtkSmartPointer<vtkIdTypeArray> connectivity = vtkSmartPointer<vtkIdTypeArray>::New();
+	connectivity->SetNumberOfTuples(count);
+	vtkIdType* ids = connectivity->GetPointer(0);
+	for (vtkIdType i=0; i<count; ++i)
+		ids[i] = readUint32(data + i*sizeof(igtlUint32));
+
+	vtkIdType pos = 0;
+	for (igtlUint32 i=0; i<ncells; ++i)
+	{
+		if (pos >= count)
+			return vtkCellArrayPtr();
+		pos += ids[pos]+1;
+	}
+	if (pos != count)
+		return vtkCellArrayPtr();
+
+	vtkCellArrayPtr retval = vtkCellArrayPtr::New();
+	retval->SetCells(ncells, connectivity);
+	return retval;
+}
+
+vtkCellArrayPtr decodeCells(igtl::PolyDataCellArray* cells)
+{
+	vtkCellArrayPtr retval = vtkCellArrayPtr::New();
+	igtlUint32 ncells = cells->GetNumberOfCells();
+	std::vector<igtlUint32> cell;
+	std::vector<vtkIdType> ids;
+	for (igtlUint32 i=0; i<ncells; ++i)
+	{
+		igtlUint32 n = cells->GetCellSize(i);
+		cell.resize(n);
+		ids.resize(n);
+		if (n)
+			cells->GetCell(i, &cell[0]);
+		std::copy(cell.begin(), cell.end(), ids.begin());
+		retval->InsertNextCell(n, ids.data());
+	}
+	return retval;
+}
+
+vtkFloatArrayPtr decodeAttribute(igtl::PolyDataAttribute* attribute)
+{
+	vtkFloatArrayPtr data = vtkFloatArrayPtr::New();
+	data->SetName(attribute->GetName());
+
+	switch (attribute->GetType() & 0x0F)
+	{
+	case igtl::PolyDataAttribute::POINT_SCALAR:
+		data->SetNumberOfComponents(1);
+		break;
+	case igtl::PolyDataAttribute::POINT_VECTOR:
+	case igtl::PolyDataAttribute::POINT_NORMAL:
+		data->SetNumberOfComponents(3);
+		break;
+	case igtl::PolyDataAttribute::POINT_TENSOR:
+		data->SetNumberOfComponents(9);
+		break;
+	case igtl::PolyDataAttribute::POINT_RGBA:
+		data->SetNumberOfComponents(4);
+		break;
+	default:
+		break;
+	}
+	data->SetNumberOfTuples(attribute->GetSize());
+	attribute->GetData(static_cast<igtl_float32*>(data->GetPointer(0)));
+	return data;
+}
+
+} // namespace
+
+IGTLinkConversionPolyData::IGTLinkConversionPolyData() :
+	mUseBulkCodec(true)
+{
+}
+
 igtl::PolyDataMessage::Pointer IGTLinkConversionPolyData::encode(MeshPtr in, PATIENT_COORDINATE_SYSTEM externalSpace)
 {
 	igtl::PolyDataMessage::Pointer retval = igtl::PolyDataMessage::New();
@@ -60,14 +230,17 @@ igtl::PolyDataMessage::Pointer IGTLinkConversionPolyData::encode(MeshPtr in, PAT
 	baseConverter.encode_timestamp(in->getAcquisitionTime(), retval);
 	vtkPolyDataPtr polyData = in->getVtkPolyData();
 	polyData = this->encodeCoordinateSystem(in, externalSpace);
-	this->encode_vtkPolyData(polyData, retval);
+	if (mUseBulkCodec)
+		this->encodeBulk_vtkPolyData(polyData, retval);
+	else
+		this->encode_vtkPolyData(polyData, retval);
 
 	return retval;
 }
 
 MeshPtr IGTLinkConversionPolyData::decode(igtl::PolyDataMessage *in, PATIENT_COORDINATE_SYSTEM externalSpace)
 {
-	vtkPolyDataPtr polyData = this->decode_vtkPolyData(in);
+	vtkPolyDataPtr polyData = mUseBulkCodec ? this->decodeBulk_vtkPolyData(in) : this->decode_vtkPolyData(in);
 	polyData = this->decodeCoordinateSystem(polyData, externalSpace);
 	QDateTime timestamp = IGTLinkConversionBase().decode_timestamp(in);
 	QString deviceName = in->GetDeviceName();
@@ -492,4 +665,200 @@ int IGTLinkConversionPolyData::VTKToIGTLAttribute(vtkDataSetAttributes* src, int
 }
 
 
+//---------------------------------------------------------------------------
+vtkPolyDataPtr IGTLinkConversionPolyData::decodeBulk_vtkPolyData(igtl::PolyDataMessage* msg)
+{
+	vtkPolyDataPtr poly = vtkPolyDataPtr::New();
+	PackedPolyData packed = findPackedPolyData(msg);
+
+	// Points
+	igtl::PolyDataPointArray::Pointer pointsArray = msg->GetPoints();
+	int npoints = pointsArray.IsNotNull() ? pointsArray->GetNumberOfPoints() : 0;
+	if (npoints > 0)
+	{
+		vtkFloatArrayPtr coords = vtkFloatArrayPtr::New();
+		coords->SetNumberOfComponents(3);
+		coords->SetNumberOfTuples(npoints);
+		igtlFloat32* dst = coords->GetPointer(0);
+		if (packed.points)
+		{
+			for (int i = 0; i < 3*npoints; ++i)
+				dst[i] = readFloat32(packed.points + i*sizeof(igtlFloat32));
+		}
+		else
+		{
+			for (int i = 0; i < npoints; ++i)
+				pointsArray->GetPoint(i, dst + 3*i);
+		}
+		vtkPointsPtr points = vtkPointsPtr::New();
+		points->SetData(coords);
+		poly->SetPoints(points);
+	}
+
+	// Vertices, lines, polygons and triangle strips
+	igtl::PolyDataCellArray::Pointer cellArrays[4] = { msg->GetVertices(), msg->GetLines(), msg->GetPolygons(), msg->GetTriangleStrips() };
+	for (int i = 0; i < 4; ++i)
+	{
+		if (getNumberOfCells(cellArrays[i]) == 0)
+			continue;
+		vtkCellArrayPtr cells;
+		if (packed.cells[i])
+			cells = decodePackedCells(packed.cells[i], packed.ncells[i], packed.cellBytes[i]);
+		if (!cells)
+			cells = decodeCells(cellArrays[i]);
+
+		if (i == 0)
+			poly->SetVerts(cells);
+		else if (i == 1)
+			poly->SetLines(cells);
+		else if (i == 2)
+			poly->SetPolys(cells);
+		else
+			poly->SetStrips(cells);
+	}
+
+	// Attributes
+	int nAttributes = msg->GetNumberOfAttributes();
+	for (int i = 0; i < nAttributes; ++i)
+	{
+		igtl::PolyDataAttribute::Pointer attribute = msg->GetAttribute(i);
+		vtkFloatArrayPtr data = decodeAttribute(attribute);
+		if ((attribute->GetType() & 0xF0) == 0) // POINT
+			poly->GetPointData()->AddArray(data);
+		else // CELL
+			poly->GetCellData()->AddArray(data);
+	}
+
+	poly->Modified();
+	return poly;
+}
+
+//---------------------------------------------------------------------------
+void IGTLinkConversionPolyData::encodeBulk_vtkPolyData(vtkPolyDataPtr in, igtl::PolyDataMessage* outMsg)
+{
+	vtkPolyDataPtr poly = in;
+
+	// Points
+	vtkPoints* points = poly->GetPoints();
+	int npoints = points ? points->GetNumberOfPoints() : 0;
+	if (npoints > 0)
+	{
+		igtl::PolyDataPointArray::Pointer pointArray = igtl::PolyDataPointArray::New();
+		pointArray->SetNumberOfPoints(npoints);
+		if (points->GetDataType() == VTK_FLOAT)
+		{
+			igtlFloat32* src = static_cast<igtlFloat32*>(points->GetVoidPointer(0));
+			for (int i = 0; i < npoints; ++i)
+				pointArray->SetPoint(i, src + 3*i);
+		}
+		else
+		{
+			for (int i = 0; i < npoints; ++i)
+			{
+				double* p = points->GetPoint(i);
+				pointArray->SetPoint(i, static_cast<igtlFloat32>(p[0]), static_cast<igtlFloat32>(p[1]), static_cast<igtlFloat32>(p[2]));
+			}
+		}
+		outMsg->SetPoints(pointArray);
+	}
+
+	// Vertices
+	igtl::PolyDataCellArray::Pointer verticesArray = igtl::PolyDataCellArray::New();
+	if (this->VTKToIGTLCellArrayBulk(poly->GetVerts(), verticesArray) > 0)
+		outMsg->SetVertices(verticesArray);
+
+	// Lines
+	igtl::PolyDataCellArray::Pointer linesArray = igtl::PolyDataCellArray::New();
+	if (this->VTKToIGTLCellArrayBulk(poly->GetLines(), linesArray) > 0)
+		outMsg->SetLines(linesArray);
+
+	// Polygons
+	igtl::PolyDataCellArray::Pointer polygonsArray = igtl::PolyDataCellArray::New();
+	if (this->VTKToIGTLCellArrayBulk(poly->GetPolys(), polygonsArray) > 0)
+		outMsg->SetPolygons(polygonsArray);
+
+	// Triangle strips
+	igtl::PolyDataCellArray::Pointer triangleStripsArray = igtl::PolyDataCellArray::New();
+	if (this->VTKToIGTLCellArrayBulk(poly->GetStrips(), triangleStripsArray) > 0)
+		outMsg->SetTriangleStrips(triangleStripsArray);
+
+	// Attributes for points, then cells
+	vtkDataSetAttributes* attributeSets[2] = { poly->GetPointData(), poly->GetCellData() };
+	for (int set = 0; set < 2; ++set)
+	{
+		for (int i = 0; i < attributeSets[set]->GetNumberOfArrays(); ++i)
+		{
+			igtl::PolyDataAttribute::Pointer attribute = igtl::PolyDataAttribute::New();
+			if (this->VTKToIGTLAttributeBulk(attributeSets[set], i, attribute) > 0)
+				outMsg->AddAttribute(attribute);
+		}
+	}
+}
+
+//---------------------------------------------------------------------------
+int IGTLinkConversionPolyData::VTKToIGTLCellArrayBulk(vtkCellArray* src, igtl::PolyDataCellArray* dest)
+{
+	if (!src || !dest)
+		return 0;
+
+	// connectivity is stored as the number of ids followed by the ids, for each cell
+	vtkIdType ncells = src->GetNumberOfCells();
+	const vtkIdType* ids = src->GetPointer();
+	std::vector<igtlUint32> cell;
+	vtkIdType pos = 0;
+	for (vtkIdType i = 0; i < ncells; ++i)
+	{
+		vtkIdType n = ids[pos];
+		cell.resize(n);
+		std::copy(ids + pos + 1, ids + pos + 1 + n, cell.begin());
+		dest->AddCell(n, cell.data());
+		pos += n + 1;
+	}
+	return ncells;
+}
+
+//---------------------------------------------------------------------------
+int IGTLinkConversionPolyData::VTKToIGTLAttributeBulk(vtkDataSetAttributes* src, int i, igtl::PolyDataAttribute* dest)
+{
+	if (!src || !dest || i < 0 || i >= src->GetNumberOfArrays())
+		return 0;
+
+	// See VTKToIGTLAttribute() for the attribute types
+	int attrTypeBit = src->IsTypeOf("vtkCellData") ? 0x10 : 0x00;
+
+	vtkDataArray* array = src->GetArray(i);
+	int ncomps = array->GetNumberOfComponents();
+	if (ncomps == 1)
+		dest->SetType(igtl::PolyDataAttribute::POINT_SCALAR | attrTypeBit);
+	else if (ncomps == 3)
+		dest->SetType(igtl::PolyDataAttribute::POINT_NORMAL | attrTypeBit);
+	else if (ncomps == 9)
+		dest->SetType(igtl::PolyDataAttribute::POINT_TENSOR | attrTypeBit);
+	else if (ncomps == 4)
+		dest->SetType(igtl::PolyDataAttribute::POINT_RGBA | attrTypeBit);
+	else
+		return 0; // not representable in OpenIGTLink
+
+	dest->SetName((array->GetName() ? array->GetName() : ""));
+	vtkIdType ntuples = array->GetNumberOfTuples();
+	dest->SetSize(ntuples);
+
+	std::vector<igtlFloat32> values(ntuples*ncomps);
+	if (array->GetDataType() == VTK_FLOAT)
+	{
+		if (!values.empty())
+			memcpy(&values[0], array->GetVoidPointer(0), values.size()*sizeof(igtlFloat32));
+	}
+	else
+	{
+		for (vtkIdType j = 0; j < ntuples; ++j)
+			for (int k = 0; k < ncomps; ++k)
+				values[j*ncomps+k] = static_cast<igtlFloat32>(array->GetComponent(j, k));
+	}
+	if (!values.empty())
+		dest->SetData(&values[0]);
+
+	return 1;
+}
+
 } //namespace cx
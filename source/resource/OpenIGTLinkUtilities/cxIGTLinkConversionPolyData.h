@@ -42,23 +42,37 @@ namespace cx
  *
  * decode methods assume Unpack() has been called.
  * encode methods assume Pack() will be called.
+ *
+ * The bulk codec (default) converts whole arrays at a time: When decoding a
+ * received message, points and cells are read directly from the packed body
+ * into vtk arrays, and cells are encoded from the vtkCellArray connectivity
+ * without creating intermediate cell objects. The output is identical to the
+ * Slicer based codec, which is kept for reference.
  */
 class cxOpenIGTLinkUtilities_EXPORT IGTLinkConversionPolyData
 {
 public:
+	IGTLinkConversionPolyData();
+	void setUseBulkCodec(bool on) { mUseBulkCodec = on; }
+
 	igtl::PolyDataMessage::Pointer encode(MeshPtr in, PATIENT_COORDINATE_SYSTEM externalSpace);
 	MeshPtr decode(igtl::PolyDataMessage *in, PATIENT_COORDINATE_SYSTEM externalSpace);
 
 private:
 	vtkPolyDataPtr decode_vtkPolyData(igtl::PolyDataMessage* msg);
 	void encode_vtkPolyData(vtkPolyDataPtr in, igtl::PolyDataMessage* outMsg);
+	vtkPolyDataPtr decodeBulk_vtkPolyData(igtl::PolyDataMessage* msg);
+	void encodeBulk_vtkPolyData(vtkPolyDataPtr in, igtl::PolyDataMessage* outMsg);
 	vtkPolyDataPtr decodeCoordinateSystem(vtkPolyDataPtr polyData, PATIENT_COORDINATE_SYSTEM externalSpace);
 	vtkPolyDataPtr encodeCoordinateSystem(MeshPtr mesh, PATIENT_COORDINATE_SYSTEM externalSpace);
 
 private:
 	int VTKToIGTLCellArray(vtkCellArray* src, igtl::PolyDataCellArray* dest);
 	int VTKToIGTLAttribute(vtkDataSetAttributes* src, int i, igtl::PolyDataAttribute* dest);
+	int VTKToIGTLCellArrayBulk(vtkCellArray* src, igtl::PolyDataCellArray* dest);
+	int VTKToIGTLAttributeBulk(vtkDataSetAttributes* src, int i, igtl::PolyDataAttribute* dest);
 
+	bool mUseBulkCodec;
 };
 
 } //namespace cx
@@ -0,0 +1,222 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#include "cxIGTLinkImageStreamCodec.h"
+
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include <QStringList>
+#include "igtlMessageHeader.h"
+#include "igtl_header.h"
+
+namespace cx
+{
+
+namespace
+{
+
+/** Run length encoding. Each token starts with a control byte c:
+ *  c < 128: c+1 literal bytes follow.
+ *  c >= 128: the next byte is repeated (c-128)+3 times.
+ */
+const int gMaxLiteral = 128;
+const int gMinRun = 3;
+const int gMaxRun = 127 + gMinRun;
+
+unsigned char* writeLiterals(const unsigned char* src, int n, unsigned char* dst)
+{
+	while (n > 0)
+	{
+		int count = std::min(n, gMaxLiteral);
+		*dst++ = count-1;
+		memcpy(dst, src, count);
+		dst += count;
+		src += count;
+		n -= count;
+	}
+	return dst;
+}
+
+QByteArray runLengthEncode(const unsigned char* src, int n)
+{
+	std::vector<unsigned char> buffer(n + n/gMaxLiteral + 1);
+	unsigned char* dst = &buffer[0];
+
+	int literalStart = 0;
+	int i = 0;
+	while (i < n)
+	{
+		int j = i+1;
+		while (j < n && j-i < gMaxRun && src[j] == src[i])
+			++j;
+
+		if (j-i >= gMinRun)
+		{
+			dst = writeLiterals(src+literalStart, i-literalStart, dst);
+			*dst++ = 0x80 | (j-i-gMinRun);
+			*dst++ = src[i];
+			literalStart = j;
+		}
+		i = j;
+	}
+	dst = writeLiterals(src+literalStart, n-literalStart, dst);
+
+	return QByteArray(reinterpret_cast<const char*>(&buffer[0]), dst-&buffer[0]);
+}
+
+bool runLengthDecode(const unsigned char* src, int n, unsigned char* dst, int size)
+{
+	int pos = 0;
+	int out = 0;
+	while (pos < n)
+	{
+		int c = src[pos++];
+		if (c < 0x80)
+		{
+			int count = c+1;
+			if (pos+count > n || out+count > size)
+				return false;
+			memcpy(dst+out, src+pos, count);
+			pos += count;
+			out += count;
+		}
+		else
+		{
+			int count = (c & 0x7F) + gMinRun;
+			if (pos >= n || out+count > size)
+				return false;
+			memset(dst+out, src[pos++], count);
+			out += count;
+		}
+	}
+	return out == size;
+}
+
+} // namespace
+
+IGTLinkImageStreamEncoder::IGTLinkImageStreamEncoder(int keyFrameInterval) :
+	mKeyFrameInterval(keyFrameInterval),
+	mRawBytes(0),
+	mEncodedBytes(0)
+{
+}
+
+QString IGTLinkImageStreamEncoder::getCodecName()
+{
+	return "cx-delta-rle-1";
+}
+
+igtl::StatusMessage::Pointer IGTLinkImageStreamEncoder::createCompressionRequest()
+{
+	igtl::StatusMessage::Pointer retval = igtl::StatusMessage::New();
+	retval->SetDeviceName("CX_CAPABILITIES");
+	retval->SetCode(igtl::StatusMessage::STATUS_OK);
+	retval->SetStatusString(getCodecName().toStdString().c_str());
+	return retval;
+}
+
+bool IGTLinkImageStreamEncoder::isCompressionRequest(igtl::StatusMessage* msg)
+{
+	if (!msg || QString(msg->GetDeviceName()) != "CX_CAPABILITIES")
+		return false;
+	return QString(msg->GetStatusString()).split(" ").contains(getCodecName());
+}
+
+IGTLinkCompressedImageMessage::Pointer IGTLinkImageStreamEncoder::encode(igtl::ImageMessage::Pointer msg)
+{
+	if (!msg)
+		return IGTLinkCompressedImageMessage::Pointer();
+
+	msg->Pack();
+	const unsigned char* raw = static_cast<const unsigned char*>(msg->GetPackPointer());
+	int size = msg->GetPackSize();
+
+	Stream& stream = mStreams[QString(msg->GetDeviceName())];
+	bool keyFrame = (stream.previous.size() != size) || (stream.framesSinceKeyFrame+1 >= mKeyFrameInterval);
+
+	QByteArray data;
+	if (keyFrame)
+	{
+		data = runLengthEncode(raw, size);
+		stream.framesSinceKeyFrame = 0;
+	}
+	else
+	{
+		std::vector<unsigned char> diff(size);
+		const unsigned char* previous = reinterpret_cast<const unsigned char*>(stream.previous.constData());
+		for (int i=0; i<size; ++i)
+			diff[i] = raw[i] - previous[i];
+		data = runLengthEncode(&diff[0], size);
+		++stream.framesSinceKeyFrame;
+	}
+	stream.previous = QByteArray(reinterpret_cast<const char*>(raw), size);
+
+	IGTLinkCompressedImageMessage::Pointer retval = IGTLinkCompressedImageMessage::New();
+	retval->SetDeviceName(msg->GetDeviceName());
+	igtl::TimeStamp::Pointer timestamp = igtl::TimeStamp::New();
+	msg->GetTimeStamp(timestamp);
+	retval->SetTimeStamp(timestamp);
+	retval->SetKeyFrame(keyFrame);
+	retval->SetRawSize(size);
+	retval->SetData(data);
+
+	mRawBytes += size;
+	mEncodedBytes += data.size();
+	return retval;
+}
+
+igtl::ImageMessage::Pointer IGTLinkImageStreamDecoder::decode(IGTLinkCompressedImageMessage::Pointer msg)
+{
+	if (!msg)
+		return igtl::ImageMessage::Pointer();
+
+	QByteArray& previous = mPrevious[QString(msg->GetDeviceName())];
+	int size = msg->GetRawSize();
+	if (!msg->GetKeyFrame() && previous.size() != size)
+		return igtl::ImageMessage::Pointer(); // reference frame missing
+
+	QByteArray raw(size, 0);
+	unsigned char* dst = reinterpret_cast<unsigned char*>(raw.data());
+	QByteArray data = msg->GetData();
+	if (!runLengthDecode(reinterpret_cast<const unsigned char*>(data.constData()), data.size(), dst, size))
+	{
+		previous.clear();
+		return igtl::ImageMessage::Pointer();
+	}
+
+	if (!msg->GetKeyFrame())
+	{
+		const unsigned char* ref = reinterpret_cast<const unsigned char*>(previous.constData());
+		for (int i=0; i<size; ++i)
+			dst[i] += ref[i];
+	}
+	previous = raw;
+
+	if (size < IGTL_HEADER_SIZE)
+		return igtl::ImageMessage::Pointer();
+
+	igtl::MessageHeader::Pointer header = igtl::MessageHeader::New();
+	header->InitPack();
+	memcpy(header->GetPackPointer(), raw.constData(), IGTL_HEADER_SIZE);
+	header->Unpack();
+
+	igtl::ImageMessage::Pointer retval = igtl::ImageMessage::New();
+	retval->SetMessageHeader(header);
+	retval->AllocatePack();
+	if (retval->GetPackBodySize() != size - IGTL_HEADER_SIZE)
+		return igtl::ImageMessage::Pointer();
+	memcpy(retval->GetPackBodyPointer(), raw.constData() + IGTL_HEADER_SIZE, retval->GetPackBodySize());
+	retval->Unpack();
+
+	return retval;
+}
+
+} // namespace cx
@@ -0,0 +1,89 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#ifndef CXIGTLINKIMAGESTREAMCODEC_H_
+#define CXIGTLINKIMAGESTREAMCODEC_H_
+
+#include "cxOpenIGTLinkUtilitiesExport.h"
+
+#include <map>
+#include <QString>
+#include <QByteArray>
+#include "igtlImageMessage.h"
+#include "igtlStatusMessage.h"
+#include "cxIGTLinkCompressedImageMessage.h"
+
+namespace cx
+{
+
+/** Lossless compression of a stream of IMAGE messages.
+ *
+ * The packed IMAGE message (header and body) is compressed as a byte
+ * stream: Each byte is replaced by its difference to the same byte in the
+ * previous frame of the same stream (device name), and the result is run
+ * length encoded. Unchanged regions and uniform backgrounds, common in
+ * US video, then collapse into short runs.
+ *
+ * A key frame, which does not depend on the previous frame, is sent for the
+ * first frame of a stream, when the frame size changes, and at regular
+ * intervals.
+ *
+ * Compression is negotiated by the client sending the message created by
+ * createCompressionRequest() to the server.
+ *
+ * \ingroup cx_resource_OpenIGTLinkUtilities
+ * \date Oct 19, 2026
+ */
+class cxOpenIGTLinkUtilities_EXPORT IGTLinkImageStreamEncoder
+{
+public:
+	explicit IGTLinkImageStreamEncoder(int keyFrameInterval = 30);
+	IGTLinkCompressedImageMessage::Pointer encode(igtl::ImageMessage::Pointer msg); ///< msg is packed by this call
+
+	qint64 getRawBytes() const { return mRawBytes; } ///< total size of encoded messages
+	qint64 getEncodedBytes() const { return mEncodedBytes; } ///< total size after compression
+
+	static QString getCodecName();
+	static igtl::StatusMessage::Pointer createCompressionRequest();
+	static bool isCompressionRequest(igtl::StatusMessage* msg);
+
+private:
+	struct Stream
+	{
+		Stream() : framesSinceKeyFrame(0) {}
+		QByteArray previous;
+		int framesSinceKeyFrame;
+	};
+	int mKeyFrameInterval;
+	std::map<QString, Stream> mStreams;
+	qint64 mRawBytes;
+	qint64 mEncodedBytes;
+};
+
+/** Decompress messages created by IGTLinkImageStreamEncoder.
+ *
+ * \ingroup cx_resource_OpenIGTLinkUtilities
+ * \date Oct 19, 2026
+ */
+class cxOpenIGTLinkUtilities_EXPORT IGTLinkImageStreamDecoder
+{
+public:
+	/** Return the unpacked IMAGE message, or null if msg is corrupt or
+	 *  depends on a frame that was not received.
+	 */
+	igtl::ImageMessage::Pointer decode(IGTLinkCompressedImageMessage::Pointer msg);
+
+private:
+	std::map<QString, QByteArray> mPrevious;
+};
+
+} // namespace cx
+
+#endif /* CXIGTLINKIMAGESTREAMCODEC_H_ */
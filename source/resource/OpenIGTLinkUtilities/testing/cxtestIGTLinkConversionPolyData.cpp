@@ -0,0 +1,196 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "catch.hpp"
+
+#include <cstring>
+#include <vector>
+#include <igtlMessageHeader.h>
+#include <vtkPolyData.h>
+#include <vtkPoints.h>
+#include <vtkCellArray.h>
+#include <vtkFloatArray.h>
+#include <vtkPointData.h>
+#include <vtkCellData.h>
+#include "cxIGTLinkConversionPolyData.h"
+#include "cxMesh.h"
+
+namespace
+{
+
+vtkPolyDataPtr createTestPolyData()
+{
+	vtkPolyDataPtr poly = vtkPolyDataPtr::New();
+
+	vtkPointsPtr points = vtkPointsPtr::New();
+	for (int i=0; i<20; ++i)
+		points->InsertNextPoint(i, 2*i+0.5, -i);
+	poly->SetPoints(points);
+
+	// The Slicer based decoder only handles a single vertex cell
+	vtkCellArrayPtr verts = vtkCellArrayPtr::New();
+	vtkIdType vert[1] = {3};
+	verts->InsertNextCell(1, vert);
+	poly->SetVerts(verts);
+
+	vtkCellArrayPtr lines = vtkCellArrayPtr::New();
+	vtkIdType line[5] = {0, 1, 2, 3, 4};
+	lines->InsertNextCell(5, line);
+	vtkIdType line2[2] = {7, 19};
+	lines->InsertNextCell(2, line2);
+	poly->SetLines(lines);
+
+	vtkCellArrayPtr polys = vtkCellArrayPtr::New();
+	vtkIdType tri[3] = {5, 6, 7};
+	polys->InsertNextCell(3, tri);
+	vtkIdType quad[4] = {8, 9, 10, 11};
+	polys->InsertNextCell(4, quad);
+	poly->SetPolys(polys);
+
+	vtkCellArrayPtr strips = vtkCellArrayPtr::New();
+	vtkIdType strip[6] = {12, 13, 14, 15, 16, 17};
+	strips->InsertNextCell(6, strip);
+	poly->SetStrips(strips);
+
+	vtkFloatArrayPtr scalars = vtkFloatArrayPtr::New();
+	scalars->SetName("scalars");
+	scalars->SetNumberOfComponents(1);
+	scalars->SetNumberOfTuples(poly->GetNumberOfPoints());
+	for (int i=0; i<poly->GetNumberOfPoints(); ++i)
+		scalars->SetValue(i, 0.25*i);
+	poly->GetPointData()->AddArray(scalars);
+
+	vtkFloatArrayPtr normals = vtkFloatArrayPtr::New();
+	normals->SetName("normals");
+	normals->SetNumberOfComponents(3);
+	normals->SetNumberOfTuples(poly->GetNumberOfCells());
+	for (int i=0; i<poly->GetNumberOfCells(); ++i)
+		normals->SetTuple3(i, i, 0, -1);
+	poly->GetCellData()->AddArray(normals);
+
+	return poly;
+}
+
+std::vector<vtkIdType> getCellIds(vtkCellArray* cells)
+{
+	std::vector<vtkIdType> retval;
+	vtkIdType npts;
+	vtkIdType* pts;
+	cells->InitTraversal();
+	while (cells->GetNextCell(npts, pts))
+	{
+		retval.push_back(npts);
+		retval.insert(retval.end(), pts, pts+npts);
+	}
+	return retval;
+}
+
+void checkArraysEqual(vtkDataSetAttributes* a, vtkDataSetAttributes* b)
+{
+	REQUIRE(a->GetNumberOfArrays() == b->GetNumberOfArrays());
+	for (int i=0; i<a->GetNumberOfArrays(); ++i)
+	{
+		vtkDataArray* arrayA = a->GetArray(i);
+		vtkDataArray* arrayB = b->GetArray(i);
+		CHECK(QString(arrayA->GetName()) == QString(arrayB->GetName()));
+		REQUIRE(arrayA->GetNumberOfComponents() == arrayB->GetNumberOfComponents());
+		REQUIRE(arrayA->GetNumberOfTuples() == arrayB->GetNumberOfTuples());
+		for (vtkIdType j=0; j<arrayA->GetNumberOfTuples(); ++j)
+			for (int k=0; k<arrayA->GetNumberOfComponents(); ++k)
+				CHECK(arrayA->GetComponent(j, k) == Approx(arrayB->GetComponent(j, k)));
+	}
+}
+
+void checkPolyDataEqual(vtkPolyDataPtr a, vtkPolyDataPtr b)
+{
+	REQUIRE(a->GetNumberOfPoints() == b->GetNumberOfPoints());
+	for (vtkIdType i=0; i<a->GetNumberOfPoints(); ++i)
+		CHECK(cx::similar(cx::Vector3D(a->GetPoint(i)), cx::Vector3D(b->GetPoint(i)), 1.0E-4));
+
+	CHECK(getCellIds(a->GetVerts()) == getCellIds(b->GetVerts()));
+	CHECK(getCellIds(a->GetLines()) == getCellIds(b->GetLines()));
+	CHECK(getCellIds(a->GetPolys()) == getCellIds(b->GetPolys()));
+	CHECK(getCellIds(a->GetStrips()) == getCellIds(b->GetStrips()));
+
+	checkArraysEqual(a->GetPointData(), b->GetPointData());
+	checkArraysEqual(a->GetCellData(), b->GetCellData());
+}
+
+/** Pack msg and unpack it into a new message, as done when sending over the network.
+ */
+igtl::PolyDataMessage::Pointer transmit(igtl::PolyDataMessage::Pointer msg)
+{
+	msg->Pack();
+
+	igtl::MessageHeader::Pointer header = igtl::MessageHeader::New();
+	header->InitPack();
+	memcpy(header->GetPackPointer(), msg->GetPackPointer(), IGTL_HEADER_SIZE);
+	header->Unpack();
+
+	igtl::PolyDataMessage::Pointer retval = igtl::PolyDataMessage::New();
+	retval->SetMessageHeader(header);
+	retval->AllocatePack();
+	REQUIRE(retval->GetPackBodySize() == msg->GetPackBodySize());
+	memcpy(retval->GetPackBodyPointer(), msg->GetPackBodyPointer(), retval->GetPackBodySize());
+	retval->Unpack();
+	return retval;
+}
+
+cx::MeshPtr createTestMesh()
+{
+	cx::MeshPtr retval(new cx::Mesh("mesh_uid", "mesh", createTestPolyData()));
+	retval->setAcquisitionTime(QDateTime::currentDateTime());
+	return retval;
+}
+
+} // namespace
+
+TEST_CASE("IGTLinkConversionPolyData: Bulk encode gives same message as Slicer based encode", "[unit][resource][OpenIGTLinkUtilities]")
+{
+	cx::MeshPtr mesh = createTestMesh();
+
+	cx::IGTLinkConversionPolyData reference;
+	reference.setUseBulkCodec(false);
+	igtl::PolyDataMessage::Pointer expected = reference.encode(mesh, cx::pcsLPS);
+	igtl::PolyDataMessage::Pointer actual = cx::IGTLinkConversionPolyData().encode(mesh, cx::pcsLPS);
+
+	expected->Pack();
+	actual->Pack();
+	REQUIRE(actual->GetPackBodySize() == expected->GetPackBodySize());
+	CHECK(memcmp(actual->GetPackBodyPointer(), expected->GetPackBodyPointer(), actual->GetPackBodySize()) == 0);
+}
+
+TEST_CASE("IGTLinkConversionPolyData: Bulk decode of received message equals Slicer based decode", "[unit][resource][OpenIGTLinkUtilities]")
+{
+	cx::MeshPtr mesh = createTestMesh();
+
+	cx::IGTLinkConversionPolyData reference;
+	reference.setUseBulkCodec(false);
+	igtl::PolyDataMessage::Pointer msg = transmit(reference.encode(mesh, cx::pcsRAS));
+
+	cx::MeshPtr expected = reference.decode(msg, cx::pcsRAS);
+	cx::MeshPtr actual = cx::IGTLinkConversionPolyData().decode(msg, cx::pcsRAS);
+
+	CHECK(actual->getName() == mesh->getName());
+	checkPolyDataEqual(actual->getVtkPolyData(), expected->getVtkPolyData());
+	checkPolyDataEqual(actual->getVtkPolyData(), mesh->getVtkPolyData());
+}
+
+TEST_CASE("IGTLinkConversionPolyData: Bulk decode of message that is not packed", "[unit][resource][OpenIGTLinkUtilities]")
+{
+	cx::MeshPtr mesh = createTestMesh();
+
+	cx::IGTLinkConversionPolyData converter;
+	igtl::PolyDataMessage::Pointer msg = converter.encode(mesh, cx::pcsLPS);
+	cx::MeshPtr output = converter.decode(msg, cx::pcsLPS);
+
+	checkPolyDataEqual(output->getVtkPolyData(), mesh->getVtkPolyData());
+}
@@ -0,0 +1,186 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "catch.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <QElapsedTimer>
+#include <igtlMessageHeader.h>
+#include "cxIGTLinkImageStreamCodec.h"
+
+namespace
+{
+
+/** Create an RGB frame with a static background and a moving square,
+ *  similar to US video where most of the frame is unchanged.
+ */
+igtl::ImageMessage::Pointer createFrame(int index, int width=64, int height=48, const char* name="cx_video")
+{
+	igtl::ImageMessage::Pointer retval = igtl::ImageMessage::New();
+	retval->SetDimensions(width, height, 1);
+	retval->SetScalarTypeToUint8();
+	retval->SetNumComponents(3);
+	retval->SetDeviceName(name);
+	igtl::TimeStamp::Pointer timestamp = igtl::TimeStamp::New();
+	timestamp->SetTime(1000.0 + index*0.04);
+	retval->SetTimeStamp(timestamp);
+	retval->AllocateScalars();
+
+	unsigned char* ptr = static_cast<unsigned char*>(retval->GetScalarPointer());
+	for (int y=0; y<height; ++y)
+	{
+		for (int x=0; x<width; ++x)
+		{
+			unsigned char value = (x > width/4 && x < 3*width/4) ? (x*y) % 251 : 0;
+			if (x/8 == index % (width/8) && y/8 == (index/3) % (height/8))
+				value = 255 - index;
+			for (int c=0; c<3; ++c)
+				*ptr++ = value;
+		}
+	}
+	return retval;
+}
+
+template<class MESSAGE>
+typename MESSAGE::Pointer transmit(typename MESSAGE::Pointer msg)
+{
+	msg->Pack();
+
+	igtl::MessageHeader::Pointer header = igtl::MessageHeader::New();
+	header->InitPack();
+	memcpy(header->GetPackPointer(), msg->GetPackPointer(), IGTL_HEADER_SIZE);
+	header->Unpack();
+
+	typename MESSAGE::Pointer retval = MESSAGE::New();
+	retval->SetMessageHeader(header);
+	retval->AllocatePack();
+	REQUIRE(retval->GetPackBodySize() == msg->GetPackBodySize());
+	memcpy(retval->GetPackBodyPointer(), msg->GetPackBodyPointer(), retval->GetPackBodySize());
+	retval->Unpack();
+	return retval;
+}
+
+void checkImagesEqual(igtl::ImageMessage::Pointer actual, igtl::ImageMessage::Pointer expected)
+{
+	REQUIRE(actual.IsNotNull());
+	CHECK(QString(actual->GetDeviceName()) == QString(expected->GetDeviceName()));
+	int actualDim[3], expectedDim[3];
+	actual->GetDimensions(actualDim);
+	expected->GetDimensions(expectedDim);
+	CHECK(std::equal(actualDim, actualDim+3, expectedDim));
+	REQUIRE(actual->GetImageSize() == expected->GetImageSize());
+	CHECK(memcmp(actual->GetScalarPointer(), expected->GetScalarPointer(), expected->GetImageSize()) == 0);
+
+	igtl::TimeStamp::Pointer actualTs = igtl::TimeStamp::New();
+	igtl::TimeStamp::Pointer expectedTs = igtl::TimeStamp::New();
+	actual->GetTimeStamp(actualTs);
+	expected->GetTimeStamp(expectedTs);
+	CHECK(actualTs->GetTimeStamp() == Approx(expectedTs->GetTimeStamp()));
+}
+
+} // namespace
+
+TEST_CASE("IGTLinkImageStreamCodec: Round trip of frame sequence is lossless", "[unit][resource][OpenIGTLinkUtilities]")
+{
+	cx::IGTLinkImageStreamEncoder encoder(5);
+	cx::IGTLinkImageStreamDecoder decoder;
+
+	for (int i=0; i<12; ++i)
+	{
+		igtl::ImageMessage::Pointer frame = createFrame(i);
+		cx::IGTLinkCompressedImageMessage::Pointer compressed = encoder.encode(frame);
+		REQUIRE(compressed.IsNotNull());
+		CHECK(compressed->GetKeyFrame() == (i%5 == 0));
+
+		compressed = transmit<cx::IGTLinkCompressedImageMessage>(compressed);
+		checkImagesEqual(decoder.decode(compressed), createFrame(i));
+	}
+
+	CHECK(encoder.getEncodedBytes() < encoder.getRawBytes());
+}
+
+TEST_CASE("IGTLinkImageStreamCodec: Streams with different device names are independent", "[unit][resource][OpenIGTLinkUtilities]")
+{
+	cx::IGTLinkImageStreamEncoder encoder;
+	cx::IGTLinkImageStreamDecoder decoder;
+
+	for (int i=0; i<4; ++i)
+	{
+		igtl::ImageMessage::Pointer first = createFrame(i, 64, 48, "first");
+		igtl::ImageMessage::Pointer second = createFrame(2*i, 32, 16, "second");
+		checkImagesEqual(decoder.decode(encoder.encode(first)), first);
+		checkImagesEqual(decoder.decode(encoder.encode(second)), second);
+	}
+}
+
+TEST_CASE("IGTLinkImageStreamCodec: Size change forces key frame", "[unit][resource][OpenIGTLinkUtilities]")
+{
+	cx::IGTLinkImageStreamEncoder encoder;
+	CHECK(encoder.encode(createFrame(0, 64, 48))->GetKeyFrame());
+	CHECK_FALSE(encoder.encode(createFrame(1, 64, 48))->GetKeyFrame());
+	CHECK(encoder.encode(createFrame(2, 32, 48))->GetKeyFrame());
+}
+
+TEST_CASE("IGTLinkImageStreamCodec: Delta frame without reference is rejected", "[unit][resource][OpenIGTLinkUtilities]")
+{
+	cx::IGTLinkImageStreamEncoder encoder;
+	encoder.encode(createFrame(0));
+	cx::IGTLinkCompressedImageMessage::Pointer delta = encoder.encode(createFrame(1));
+	REQUIRE_FALSE(delta->GetKeyFrame());
+
+	cx::IGTLinkImageStreamDecoder decoder;
+	CHECK(decoder.decode(delta).IsNull());
+}
+
+TEST_CASE("IGTLinkImageStreamCodec: Compression request", "[unit][resource][OpenIGTLinkUtilities]")
+{
+	igtl::StatusMessage::Pointer request = cx::IGTLinkImageStreamEncoder::createCompressionRequest();
+	request = transmit<igtl::StatusMessage>(request);
+	CHECK(cx::IGTLinkImageStreamEncoder::isCompressionRequest(request));
+
+	igtl::StatusMessage::Pointer other = igtl::StatusMessage::New();
+	other->SetDeviceName("status");
+	other->SetStatusString(cx::IGTLinkImageStreamEncoder::getCodecName().toStdString().c_str());
+	CHECK_FALSE(cx::IGTLinkImageStreamEncoder::isCompressionRequest(other));
+}
+
+TEST_CASE("Speed: IGTLinkImageStreamCodec loopback", "[speed][resource][OpenIGTLinkUtilities]")
+{
+	int frames = 60;
+	std::vector<igtl::ImageMessage::Pointer> input;
+	for (int i=0; i<frames; ++i)
+		input.push_back(createFrame(i, 1024, 768));
+
+	cx::IGTLinkImageStreamEncoder encoder;
+	cx::IGTLinkImageStreamDecoder decoder;
+	std::vector<cx::IGTLinkCompressedImageMessage::Pointer> compressed;
+
+	QElapsedTimer timer;
+	timer.start();
+	for (int i=0; i<frames; ++i)
+	{
+		compressed.push_back(encoder.encode(input[i]));
+		compressed.back()->Pack();
+	}
+	double encodeTime = timer.restart();
+	for (int i=0; i<frames; ++i)
+		REQUIRE(decoder.decode(compressed[i]).IsNotNull());
+	double decodeTime = timer.restart();
+
+	double ratio = double(encoder.getRawBytes())/double(encoder.getEncodedBytes());
+	std::cout << "IGTLinkImageStreamCodec: " << encoder.getRawBytes()/frames/1024 << " kB/frame raw, "
+			  << encoder.getEncodedBytes()/frames/1024 << " kB/frame compressed, ratio " << ratio << std::endl;
+	std::cout << "IGTLinkImageStreamCodec: encode " << encodeTime/frames << " ms/frame, "
+			  << "decode " << decodeTime/frames << " ms/frame" << std::endl;
+	CHECK(ratio > 1);
+}
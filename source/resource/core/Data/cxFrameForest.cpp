@@ -19,45 +19,90 @@ namespace cx
 /**Create a forest representing all Data objects and their spatial relationships.
  *
  */
-FrameForest::FrameForest(const std::map<QString, DataPtr> &source) : mSource(source)
+FrameForest::FrameForest(const std::map<QString, DataPtr> &source) :
+	mGraph(FrameGraph::create()),
+	mSource(source)
 {
-//  std::cout << "Forrest doc2:" << std::endl;
-//	DataManager::DataMap allData = mDataManager->getData();
-	mDocument.appendChild(mDocument.createElement("root"));
+	mGraph->update(source);
+}
 
-	for (std::map<QString, DataPtr>::const_iterator iter = source.begin(); iter != source.end(); ++iter)
-	{
-		this->insertFrame(iter->second);
-	}
+/**As FrameForest(source), but reuse the graph from a previous forest,
+ * thus only changes since then are applied.
+ */
+FrameForest::FrameForest(const std::map<QString, DataPtr>& source, FrameGraphPtr graph) :
+	mGraph(graph ? graph : FrameGraph::create()),
+	mSource(source)
+{
+	mGraph->update(source);
+}
 
-//  std::cout << "Forrest doc:" << std::endl;
-//  std::cout << mDocument.toString(4) << std::endl;
+/** Find the oldest ancestor of frame.
+ */
+QString FrameForest::getOldestAncestor(QString frame)
+{
+	return mGraph->getFrame(mGraph->getOldestAncestor(mGraph->getNode(frame)));
 }
 
-QDomDocument FrameForest::getDocument()
+/** Find the oldest ancestor of frame, that is not also an ancestor of ref.
+ *  Return empty if frame is an ancestor of ref.
+ */
+QString FrameForest::getOldestAncestorNotCommonToRef(QString frame, QString ref)
 {
-	return mDocument;
+	int node = mGraph->getNode(frame);
+	int refNode = mGraph->getNode(ref);
+	if (node < 0)
+		return QString();
+	if (mGraph->isAncestorOf(refNode, node))
+		return QString();
+
+	for (int parent = mGraph->getParent(node); parent >= 0; parent = mGraph->getParent(node))
+	{
+		if (mGraph->isAncestorOf(refNode, parent))
+			break;
+		node = parent;
+	}
+	return mGraph->getFrame(node);
 }
 
-/** Insert one data in the correct position in the tree
+/** Return the frame and all its children recursively in one flat vector.
  */
-void FrameForest::insertFrame(DataPtr data)
+std::vector<QString> FrameForest::getDescendantsAndSelf(QString frame)
 {
-	QString parentFrame = data->getParentSpace();
-	QString currentFrame = data->getSpace();
+	std::vector<int> nodes = mGraph->getDescendantsAndSelf(mGraph->getNode(frame));
+	std::vector<QString> retval(nodes.size());
+	for (unsigned i = 0; i < nodes.size(); ++i)
+		retval[i] = mGraph->getFrame(nodes[i]);
+	return retval;
+}
 
-//    if (parentFrame.isEmpty() || currentFrame.isEmpty())
-//    	return;
+/** As getDescendantsAndSelf(), but return the frames as data objects.
+ *  Those frames not representing data are discarded.
+ */
+std::vector<DataPtr> FrameForest::getDataFromDescendantsAndSelf(QString frame)
+{
+	std::vector<QString> frames = this->getDescendantsAndSelf(frame);
+	std::vector<DataPtr> retval;
 
-	QDomNode parentNode = this->getNodeAnyway(parentFrame);
-	QDomNode currentNode = this->getNodeAnyway(currentFrame);
+	for (unsigned i = 0; i < frames.size(); ++i)
+	{
+		std::map<QString, DataPtr>::iterator iter = mSource.find(frames[i]);
+		if (iter != mSource.end() && iter->second)
+			retval.push_back(iter->second);
+	}
+	return retval;
+}
 
-	if (parentNode.isNull())
-		return;
+/** Return true if ancestor is frame or an ancestor of frame
+ */
+bool FrameForest::isAncestorOf(QString frame, QString ancestor)
+{
+	return mGraph->isAncestorOf(mGraph->getNode(frame), mGraph->getNode(ancestor));
+}
 
-	// move currentNode to child of parentNode
-	currentNode = currentNode.parentNode().removeChild(currentNode);
-	parentNode.appendChild(currentNode);
+QDomDocument FrameForest::getDocument()
+{
+	this->createDocument();
+	return mDocument;
 }
 
 /** Given a frame uid, return the QDomNode representing that frame.
@@ -65,111 +110,65 @@ void FrameForest::insertFrame(DataPtr data)
  */
 QDomNode FrameForest::getNode(QString frame)
 {
+	if (frame.isEmpty() || mGraph->getNode(frame) < 0)
+		return QDomNode();
+	this->createDocument();
 	QDomNodeList list = mDocument.elementsByTagName(frame);
 	if (list.isEmpty())
 		return QDomNode();
 	return list.item(0);
 }
 
-/** As getNode(), but create the node if if doesn't exist.
- */
-QDomNode FrameForest::getNodeAnyway(QString frame)
+QDomNode FrameForest::getOldestAncestor(QDomNode node)
 {
-	QDomNode retval = this->getNode(frame);
-	if (retval.isNull())
-	{
-		retval = mDocument.createElement(frame);
-		mDocument.documentElement().appendChild(retval);
-	}
-	return retval;
+	if (node == mDocument.documentElement())
+		return node;
+	return this->getNode(this->getOldestAncestor(this->getFrame(node)));
 }
 
-/** Return true if ancestor is an ancestor of node
- */
-bool FrameForest::isAncestorOf(QDomNode node, QDomNode ancestor)
+QDomNode FrameForest::getOldestAncestorNotCommonToRef(QDomNode child, QDomNode ref)
 {
-	//std::cout << "isAncestorOf : " << node.toElement().tagName() << "---"  << ancestor.toElement().tagName() << std::endl;
-
-	while (!this->isRootNode(node))
-	{
-		if (node == ancestor)
-		{
-			//std::cout << "return true" << std::endl;;
-			return true;
-		}
-		node = node.parentNode();
-	}
-	//std::cout << "return false" << std::endl;;
-	return false;
+	return this->getNode(this->getOldestAncestorNotCommonToRef(this->getFrame(child), this->getFrame(ref)));
 }
 
-bool FrameForest::isRootNode(QDomNode node)
+std::vector<QDomNode> FrameForest::getDescendantsAndSelf(QDomNode node)
 {
-	return node == mDocument.documentElement();
+	std::vector<QString> frames = this->getDescendantsAndSelf(this->getFrame(node));
+	std::vector<QDomNode> retval(frames.size());
+	for (unsigned i = 0; i < frames.size(); ++i)
+		retval[i] = this->getNode(frames[i]);
+	return retval;
 }
 
-/** Find the oldest ancestor of node.
- */
-QDomNode FrameForest::getOldestAncestor(QDomNode node)
+std::vector<DataPtr> FrameForest::getDataFromDescendantsAndSelf(QDomNode node)
 {
-	if (this->isRootNode(node))
-		return node;
-	while (!this->isRootNode(node.parentNode()))
-		node = node.parentNode();
-	return node;
+	return this->getDataFromDescendantsAndSelf(this->getFrame(node));
 }
 
-/** Find the oldest ancestor of child, that is not also an ancestor of ref.
- */
-QDomNode FrameForest::getOldestAncestorNotCommonToRef(QDomNode node, QDomNode ref)
+QString FrameForest::getFrame(QDomNode node)
 {
-	//std::cout << "getOldestAncestorNotCommonToRef " << node.toElement().tagName() << " - " << ref.toElement().tagName() << std::endl;
-	if (this->isAncestorOf(ref, node))
-		return QDomNode();
-
-	while (!this->isRootNode(node.parentNode()))
-	{
-		//std::cout << "getOldestAncestorNotCommonToRef iterate start: " << node.toElement().tagName()  << std::endl;
-		if (this->isAncestorOf(ref, node.parentNode()))
-			break;
-		node = node.parentNode();
-		//std::cout << "getOldestAncestorNotCommonToRef iterate stop: " << node.toElement().tagName()  << std::endl;
-	}
-	//std::cout << std::endl;
-	return node;
+	return node.toElement().tagName();
 }
 
-/** Return the node and all its children recursively in one flat vector.
+/** Create the QDomDocument representation of the graph, if not already done.
  */
-std::vector<QDomNode> FrameForest::getDescendantsAndSelf(QDomNode node)
+void FrameForest::createDocument()
 {
-	std::vector<QDomNode> retval;
-	retval.push_back(node);
+	if (!mDocument.documentElement().isNull())
+		return;
 
-	for (QDomNode child = node.firstChild(); !child.isNull(); child = child.nextSibling())
-	{
-		std::vector<QDomNode> subnodes = this->getDescendantsAndSelf(child);
-		std::copy(subnodes.begin(), subnodes.end(), back_inserter(retval));
-	}
-	return retval;
+	mDocument.appendChild(mDocument.createElement("root"));
+	std::vector<int> roots = mGraph->getRoots();
+	for (unsigned i = 0; i < roots.size(); ++i)
+		this->appendToDocument(mDocument.documentElement(), roots[i]);
 }
 
-/** As getAllNodesFor(QDomNode), but return the nodes as data objects.
- *  Those frames not representing data are discarded.
- */
-std::vector<DataPtr> FrameForest::getDataFromDescendantsAndSelf(QDomNode node)
+void FrameForest::appendToDocument(QDomNode parent, int node)
 {
-	std::vector<QDomNode> nodes = this->getDescendantsAndSelf(node);
-	std::vector<DataPtr> retval;
-
-	for (unsigned i = 0; i < nodes.size(); ++i)
-	{
-		DataPtr data = mSource[nodes[i].toElement().tagName()];
-//		DataPtr data = mDataManager->getData(nodes[i].toElement().tagName());
-		if (data)
-			retval.push_back(data);
-	}
-	return retval;
+	QDomNode element = parent.appendChild(mDocument.createElement(mGraph->getFrame(node)));
+	const std::vector<int>& children = mGraph->getChildren(node);
+	for (unsigned i = 0; i < children.size(); ++i)
+		this->appendToDocument(element, children[i]);
 }
 
 }
@@ -18,6 +18,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 
 #include <QDomDocument>
 #include "cxTypeConversions.h"
+#include "cxFrameGraph.h"
 
 /*
 
@@ -58,6 +59,11 @@ namespace cx
  *
  * The graph consists of several directed acyclic graphs.
  *
+ * Queries are answered by an indexed FrameGraph. Pass a FrameGraph that
+ * is kept between uses in order to update it incrementally. The
+ * QDomDocument representation is only created if the QDomNode
+ * interface is used.
+ *
  *  \date   Sep 23, 2010
  *  \author christiana
  */
@@ -65,18 +71,26 @@ class cxResource_EXPORT FrameForest
 {
 public:
 	explicit FrameForest(const std::map<QString, DataPtr>& source);
+	FrameForest(const std::map<QString, DataPtr>& source, FrameGraphPtr graph); ///< update and use graph
+
+	QString getOldestAncestor(QString frame);
+	QString getOldestAncestorNotCommonToRef(QString frame, QString ref);
+	std::vector<QString> getDescendantsAndSelf(QString frame);
+	std::vector<DataPtr> getDataFromDescendantsAndSelf(QString frame);
+	bool isAncestorOf(QString frame, QString ancestor);
+	FrameGraphPtr getGraph() { return mGraph; }
+
 	QDomNode getNode(QString frame);
 	QDomNode getOldestAncestor(QDomNode node);
-
 	QDomNode getOldestAncestorNotCommonToRef(QDomNode child, QDomNode ref);
 	std::vector<QDomNode> getDescendantsAndSelf(QDomNode node);
 	std::vector<DataPtr> getDataFromDescendantsAndSelf(QDomNode node);
 	QDomDocument getDocument();
 private:
-	bool isRootNode(QDomNode node);
-	QDomNode getNodeAnyway(QString frame);
-	bool isAncestorOf(QDomNode node, QDomNode ancestor);
-	void insertFrame(DataPtr data);
+	QString getFrame(QDomNode node);
+	void createDocument();
+	void appendToDocument(QDomNode parent, int node);
+	FrameGraphPtr mGraph;
 	QDomDocument mDocument;
 
 	std::map<QString, DataPtr> mSource;
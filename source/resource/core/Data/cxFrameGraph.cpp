@@ -0,0 +1,295 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#include "cxFrameGraph.h"
+
+#include <algorithm>
+#include "cxData.h"
+
+namespace cx
+{
+
+FrameGraph::FrameGraph() :
+	mIntervalsModified(true)
+{
+}
+
+/** Apply the changes in source since the last call: Data that are
+ *  added, removed or have changed parent space.
+ */
+void FrameGraph::update(const std::map<QString, DataPtr>& source)
+{
+	std::vector<QString> removed;
+	for (std::map<QString, QString>::iterator iter = mDataParents.begin(); iter != mDataParents.end(); ++iter)
+		if (!source.count(iter->first))
+			removed.push_back(iter->first);
+
+	for (unsigned i = 0; i < removed.size(); ++i)
+	{
+		mDataParents.erase(removed[i]);
+		int node = this->getNode(removed[i]);
+		if (node < 0)
+			continue;
+		// keep as a pure space if other frames refer to it
+		int oldParent = mNodes[node].parent;
+		mNodes[node].isData = false;
+		this->detach(node);
+		mRoots.push_back(node);
+		this->prune(node);
+		this->prune(oldParent);
+		mIntervalsModified = true;
+	}
+
+	for (std::map<QString, DataPtr>::const_iterator iter = source.begin(); iter != source.end(); ++iter)
+	{
+		DataPtr data = iter->second;
+		if (!data)
+			continue;
+		QString frame = data->getSpace();
+		QString parentFrame = data->getParentSpace();
+		if (frame.isEmpty())
+			continue;
+
+		std::map<QString, QString>::iterator found = mDataParents.find(frame);
+		if (found != mDataParents.end() && found->second == parentFrame)
+			continue;
+
+		int node = this->getNodeAnyway(frame);
+		mNodes[node].isData = true;
+		if (this->setParent(frame, parentFrame))
+		{
+			mDataParents[frame] = parentFrame;
+		}
+		else
+		{
+			// cycle: record the parent kept in the graph, retry in the next update
+			mDataParents[frame] = this->getFrame(mNodes[node].parent);
+		}
+	}
+}
+
+bool FrameGraph::setParent(QString frame, QString parentFrame)
+{
+	if (frame.isEmpty())
+		return false;
+
+	if (parentFrame.isEmpty())
+	{
+		int node = this->getNodeAnyway(frame);
+		int oldParent = mNodes[node].parent;
+		if (oldParent < 0)
+			return true;
+		this->detach(node);
+		mRoots.push_back(node);
+		this->prune(oldParent);
+		mIntervalsModified = true;
+		return true;
+	}
+
+	int parent = this->getNodeAnyway(parentFrame);
+	int node = this->getNodeAnyway(frame);
+	if (mNodes[node].parent == parent)
+		return true;
+
+	for (int p = parent; p >= 0; p = mNodes[p].parent)
+	{
+		if (p == node)
+			return false;
+	}
+
+	int oldParent = mNodes[node].parent;
+	this->detach(node);
+	mNodes[parent].children.push_back(node);
+	mNodes[node].parent = parent;
+	this->prune(oldParent);
+	mIntervalsModified = true;
+	return true;
+}
+
+void FrameGraph::remove(QString frame)
+{
+	int node = this->getNode(frame);
+	if (node < 0)
+		return;
+
+	std::vector<int> children = mNodes[node].children;
+	for (unsigned i = 0; i < children.size(); ++i)
+	{
+		this->detach(children[i]);
+		mRoots.push_back(children[i]);
+	}
+
+	int oldParent = mNodes[node].parent;
+	mDataParents.erase(frame);
+	mNodes[node].isData = false;
+	this->detach(node);
+	mRoots.push_back(node);
+	this->prune(node);
+	this->prune(oldParent);
+	mIntervalsModified = true;
+}
+
+int FrameGraph::getNode(QString frame) const
+{
+	std::map<QString, int>::const_iterator iter = mFrameToNode.find(frame);
+	if (iter == mFrameToNode.end())
+		return -1;
+	return iter->second;
+}
+
+QString FrameGraph::getFrame(int node) const
+{
+	if (!this->isValid(node))
+		return QString();
+	return mNodes[node].frame;
+}
+
+int FrameGraph::getParent(int node) const
+{
+	if (!this->isValid(node))
+		return -1;
+	return mNodes[node].parent;
+}
+
+const std::vector<int>& FrameGraph::getChildren(int node) const
+{
+	static const std::vector<int> empty;
+	if (!this->isValid(node))
+		return empty;
+	return mNodes[node].children;
+}
+
+std::vector<int> FrameGraph::getRoots() const
+{
+	return mRoots;
+}
+
+bool FrameGraph::isAncestorOf(int node, int ancestor)
+{
+	if (!this->isValid(node) || !this->isValid(ancestor))
+		return false;
+	this->updateIntervals();
+	return (mBegin[ancestor] <= mBegin[node]) && (mEnd[node] <= mEnd[ancestor]);
+}
+
+int FrameGraph::getOldestAncestor(int node)
+{
+	if (!this->isValid(node))
+		return -1;
+	this->updateIntervals();
+	return mRootOf[node];
+}
+
+std::vector<int> FrameGraph::getDescendantsAndSelf(int node)
+{
+	if (!this->isValid(node))
+		return std::vector<int>();
+	this->updateIntervals();
+	return std::vector<int>(mPreorder.begin() + mBegin[node], mPreorder.begin() + mEnd[node]);
+}
+
+int FrameGraph::getNodeAnyway(QString frame)
+{
+	int node = this->getNode(frame);
+	if (node >= 0)
+		return node;
+
+	if (mFreeNodes.empty())
+	{
+		node = int(mNodes.size());
+		mNodes.push_back(Node());
+	}
+	else
+	{
+		node = mFreeNodes.back();
+		mFreeNodes.pop_back();
+		mNodes[node] = Node();
+	}
+
+	mNodes[node].frame = frame;
+	mNodes[node].inUse = true;
+	mFrameToNode[frame] = node;
+	mRoots.push_back(node);
+	mIntervalsModified = true;
+	return node;
+}
+
+/** Remove node from its parent or from the roots. */
+void FrameGraph::detach(int node)
+{
+	int parent = mNodes[node].parent;
+	std::vector<int>& siblings = (parent < 0) ? mRoots : mNodes[parent].children;
+	siblings.erase(std::remove(siblings.begin(), siblings.end(), node), siblings.end());
+	mNodes[node].parent = -1;
+}
+
+/** Delete node and its ancestors as long as they are unused pure spaces. */
+void FrameGraph::prune(int node)
+{
+	while (this->isValid(node) && !mNodes[node].isData && mNodes[node].children.empty())
+	{
+		int parent = mNodes[node].parent;
+		this->detach(node);
+		mFrameToNode.erase(mNodes[node].frame);
+		mNodes[node] = Node();
+		mFreeNodes.push_back(node);
+		mIntervalsModified = true;
+		node = parent;
+	}
+}
+
+void FrameGraph::updateIntervals()
+{
+	if (!mIntervalsModified)
+		return;
+
+	mPreorder.clear();
+	mBegin.assign(mNodes.size(), 0);
+	mEnd.assign(mNodes.size(), 0);
+	mRootOf.assign(mNodes.size(), -1);
+
+	std::vector<std::pair<int, unsigned> > stack; // node, next child
+	for (unsigned i = 0; i < mRoots.size(); ++i)
+	{
+		int root = mRoots[i];
+		mBegin[root] = int(mPreorder.size());
+		mPreorder.push_back(root);
+		mRootOf[root] = root;
+		stack.push_back(std::make_pair(root, 0u));
+
+		while (!stack.empty())
+		{
+			std::pair<int, unsigned>& top = stack.back();
+			const std::vector<int>& children = mNodes[top.first].children;
+			if (top.second < children.size())
+			{
+				int child = children[top.second++];
+				mBegin[child] = int(mPreorder.size());
+				mPreorder.push_back(child);
+				mRootOf[child] = root;
+				stack.push_back(std::make_pair(child, 0u));
+			}
+			else
+			{
+				mEnd[top.first] = int(mPreorder.size());
+				stack.pop_back();
+			}
+		}
+	}
+
+	mIntervalsModified = false;
+}
+
+bool FrameGraph::isValid(int node) const
+{
+	return (node >= 0) && (node < int(mNodes.size())) && mNodes[node].inUse;
+}
+
+} // namespace cx
@@ -0,0 +1,110 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#ifndef CXFRAMEGRAPH_H_
+#define CXFRAMEGRAPH_H_
+
+#include "cxResourceExport.h"
+
+#include <map>
+#include <vector>
+#include <QString>
+#include <boost/shared_ptr.hpp>
+#include "cxForwardDeclarations.h"
+
+namespace cx
+{
+
+/**
+* \file
+* \addtogroup cx_resource_core_data
+* @{
+*/
+
+typedef boost::shared_ptr<class FrameGraph> FrameGraphPtr;
+
+/**
+ * \brief Indexed graph of the Space dependencies between all Data.
+ * \ingroup cx_resource_core_data
+ *
+ * Each frame (a data uid or a pure space) is a node with an integer id,
+ * linked to its parent frame. Frames without parent are roots.
+ *
+ * update() applies only the changes since the previous update: added,
+ * removed and reparented data. Keep the graph between calls to benefit
+ * from this. Pure spaces are kept as long as some frame refers to them.
+ *
+ * Ancestor queries use preorder intervals recomputed after topology
+ * changes: isAncestorOf() and getOldestAncestor() are O(1), and
+ * getDescendantsAndSelf() is a contiguous range of the preorder.
+ *
+ *  \date Oct 19, 2026
+ */
+class cxResource_EXPORT FrameGraph
+{
+public:
+	static FrameGraphPtr create() { return FrameGraphPtr(new FrameGraph()); }
+	FrameGraph();
+
+	void update(const std::map<QString, DataPtr>& source);
+
+	/** Set parent of frame, creating the frames if needed. An empty parent makes frame a root.
+	 *  Return false if this would create a cycle.
+	 */
+	bool setParent(QString frame, QString parentFrame);
+	void remove(QString frame); ///< remove frame, its children are kept as roots
+
+	int getNode(QString frame) const; ///< node id of frame, -1 if not present
+	QString getFrame(int node) const;
+	int getParent(int node) const; ///< -1 for roots
+	const std::vector<int>& getChildren(int node) const;
+	std::vector<int> getRoots() const;
+	int getNumberOfNodes() const { return int(mFrameToNode.size()); }
+
+	bool isAncestorOf(int node, int ancestor); ///< true if ancestor is node or one of its ancestors
+	int getOldestAncestor(int node); ///< root of the tree containing node
+	std::vector<int> getDescendantsAndSelf(int node); ///< node and all descendants, in preorder
+
+private:
+	struct Node
+	{
+		Node() : parent(-1), isData(false), inUse(false) {}
+		QString frame;
+		int parent;
+		std::vector<int> children;
+		bool isData; ///< frame of a data in the last update()
+		bool inUse;
+	};
+
+	int getNodeAnyway(QString frame);
+	void detach(int node);
+	void prune(int node);
+	void updateIntervals();
+	bool isValid(int node) const;
+
+	std::vector<Node> mNodes;
+	std::vector<int> mFreeNodes;
+	std::map<QString, int> mFrameToNode;
+	std::vector<int> mRoots;
+	std::map<QString, QString> mDataParents; ///< parent frame of each data, as applied to the graph
+
+	bool mIntervalsModified;
+	std::vector<int> mPreorder; ///< all nodes, trees and children in insertion order
+	std::vector<int> mBegin; ///< position of node in mPreorder
+	std::vector<int> mEnd; ///< one past the last descendant of node in mPreorder
+	std::vector<int> mRootOf;
+};
+
+/**
+* @}
+*/
+}
+
+#endif /* CXFRAMEGRAPH_H_ */
@@ -14,13 +14,13 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 
 #include <QDomDocument>
 #include <QDir>
+#include <algorithm>
 #include <vtkImageAccumulate.h>
 #include <vtkImageReslice.h>
 #include <vtkImageData.h>
 #include <vtkMatrix4x4.h>
 #include <vtkPlane.h>
 #include <vtkPlanes.h>
-#include <vtkImageResample.h>
 #include <vtkImageChangeInformation.h>
 #include <vtkImageClip.h>
 #include <vtkImageIterator.h>
@@ -42,6 +42,9 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "cxUnsignedDerivedImage.h"
 #include "cxEnumConversion.h"
 #include "cxCustomMetaImage.h"
+#include "cxImageStatistics.h"
+#include "cxImageResampler.h"
+#include "cxGrayScaleImageConverter.h"
 
 typedef vtkSmartPointer<vtkImageChangeInformation> vtkImageChangeInformationPtr;
 
@@ -104,7 +107,8 @@ Image::~Image()
 }
 
 Image::Image(const QString& uid, const vtkImageDataPtr& data, const QString& name) :
-	Data(uid, name), mBaseImageData(data), mMaxRGBIntensity(-1), mThresholdPreview(false)
+	Data(uid, name), mBaseImageData(data), mMaxRGBIntensity(-1), mThresholdPreview(false),
+	mPartiallyModified(false)
 {
 	mInitialWindowWidth = -1;
 	mInitialWindowLevel = -1;
@@ -270,12 +274,57 @@ void Image::setVtkImageData(const vtkImageDataPtr& data, bool resetTransferFunct
 	mBaseImageData = data;
 	mBaseGrayScaleImageData = NULL;
 	mHistogramPtr = NULL;
+	mStatistics.reset();
 
 	if (resetTransferFunctions)
 		this->resetTransferFunctions();
 	emit vtkImageDataChanged(mUid);
 }
 
+void Image::setVtkImageDataModified(const IntBoundingBox3D& extent)
+{
+	if (!mBaseImageData)
+		return;
+
+	IntBoundingBox3D whole(mBaseImageData->GetExtent());
+	IntBoundingBox3D clipped = extent;
+	for (int i=0; i<6; i+=2)
+	{
+		clipped[i] = std::max(extent[i], whole[i]);
+		clipped[i+1] = std::min(extent[i+1], whole[i+1]);
+		if (clipped[i] > clipped[i+1])
+			return;
+	}
+
+	mBaseImageData->Modified();
+	mHistogramPtr = NULL;
+
+	if (mBaseGrayScaleImageData == mBaseImageData)
+	{
+		if (mStatistics)
+			mStatistics->updateExtent(mBaseImageData, clipped);
+	}
+	else
+	{
+		// grayscale is a converted copy: recreate on demand
+		mBaseGrayScaleImageData = NULL;
+		mStatistics.reset();
+		mMaxRGBIntensity = -1;
+	}
+
+	mModifiedExtent = clipped;
+	mPartiallyModified = true;
+	emit vtkImageDataChanged(mUid);
+	mPartiallyModified = false;
+}
+
+IntBoundingBox3D Image::getModifiedExtent() const
+{
+	if (!mPartiallyModified && mBaseImageData)
+		return IntBoundingBox3D(mBaseImageData->GetExtent());
+	return mModifiedExtent;
+}
+
 vtkImageDataPtr Image::get8bitGrayScaleVtkImageData()
 {
 	double windowWidth = this->getUnmodifiedLookupTable2D()->getWindow();
@@ -365,32 +414,17 @@ vtkImageAccumulatePtr Image::getHistogram()
 	return mHistogramPtr;
 }
 
-template<typename scalartype> static int getRGBMax(vtkImageDataPtr image)
+ImageStatisticsPtr Image::getStatistics()
 {
-	int max = 0;
-	vtkImageIterator<scalartype> iter(image, image->GetExtent());
-	while (!iter.IsAtEnd())
+	if (!mStatistics)
 	{
-		typename vtkImageIterator<scalartype>::SpanIterator siter = iter.BeginSpan();
-		while (siter != iter.EndSpan())
-		{
-			int value = *siter;
-			++siter;
-			value += *siter;
-			++siter;
-			value += *siter;
-			++siter;
-			if (value > max)
-			{
-				max = value;
-			}
-		}
-		iter.NextSpan();
+		mStatistics = ImageStatistics::create();
+		mStatistics->setIgnoreZeroInHistogram(true); // as in getHistogram()
 	}
-	return max/3;
+	mStatistics->update(this->getGrayScaleVtkImageData());
+	return mStatistics;
 }
 
-
 int Image::getMax()
 {
 	// Alternatively create max from histogram
@@ -404,21 +438,17 @@ int Image::getMax()
 			return mMaxRGBIntensity;
 		}
 		double max = 0.0;
-		switch (mBaseImageData->GetScalarType())
-		{
-		case VTK_UNSIGNED_CHAR:
-			max = getRGBMax<unsigned char>(mBaseImageData);
-			break;
-		case VTK_UNSIGNED_SHORT:
-			max = getRGBMax<unsigned short>(mBaseImageData);
-			break;
-		default:
+		if (GrayScaleImageConverter::canConvert(mBaseImageData))
+			max = GrayScaleImageConverter::findRGBMax(mBaseImageData);
+		else
 			CX_LOG_ERROR() << "Unhandled RGB data type in image " << this->getUid();
-			break;
-		}
 		mMaxRGBIntensity = max;
 		return (int)mMaxRGBIntensity;
 	}
+	else if (mBaseImageData->GetNumberOfScalarComponents() == 1)
+	{
+		return this->getStatistics()->getMax();
+	}
 	else
 	{
 //		return (int) this->getTransferFunctions3D()->getScalarMax();
@@ -431,6 +461,8 @@ int Image::getMin()
 	// Alternatively create min from histogram
 	//IntIntMap::iterator iter = this->getHistogram()->begin();
 	//return (*iter).first;
+	if (mBaseImageData->GetNumberOfScalarComponents() == 1)
+		return this->getStatistics()->getMin();
 	return mBaseImageData->GetScalarRange()[0];
 //	return (int) this->getTransferFunctions3D()->getScalarMin();
 }
@@ -876,16 +908,15 @@ vtkImageDataPtr Image::resample(long maxVoxels)
 
 	if (fabs(1.0-factor)>0.01) // resampling
 	{
-		vtkImageResamplePtr resampler = vtkImageResamplePtr::New();
-		resampler->SetInterpolationModeToLinear();
-		resampler->SetAxisMagnificationFactor(0, factor);
-		resampler->SetAxisMagnificationFactor(1, factor);
-		resampler->SetAxisMagnificationFactor(2, factor);
-		resampler->SetInputData(retval);
-//		resampler->GetOutput()->Update();
-		resampler->Update();
-		resampler->GetOutput()->GetScalarRange();
-		retval = resampler->GetOutput();
+		ImageResampler resampler;
+		resampler.setInterpolation(ImageResampler::iLINEAR);
+		resampler.setMagnificationFactor(factor);
+		vtkImageDataPtr resampled = resampler.execute(retval);
+		if (resampled)
+		{
+			resampled->GetScalarRange();
+			retval = resampled;
+		}
 
 //		long voxelsDown = retval->GetNumberOfPoints();
 //		long voxelsOrig = this->getBaseVtkImageData()->GetNumberOfPoints();
@@ -73,6 +73,13 @@ public:
 	 */
 	virtual void intitializeFromParentImage(ImagePtr parentImage);
 	virtual void setVtkImageData(const vtkImageDataPtr& data, bool resetTransferFunctions = true);
+	/** Notify that the voxels inside extent of the current vtkImageData have been
+	 *  changed in place. Cached derived data are updated for that part only, and
+	 *  vtkImageDataChanged is emitted with isPartiallyModified() set.
+	 */
+	virtual void setVtkImageDataModified(const IntBoundingBox3D& extent);
+	bool isPartiallyModified() const { return mPartiallyModified; } ///< true while vtkImageDataChanged is emitted from setVtkImageDataModified()
+	IntBoundingBox3D getModifiedExtent() const; ///< voxels changed by the current vtkImageDataChanged, the whole extent if not partial
 
 	virtual vtkImageDataPtr getBaseVtkImageData(); ///< \return the vtkimagedata in the data coordinate space
 	virtual vtkImageDataPtr getGrayScaleVtkImageData(); ///< as getBaseVtkImageData(), but constrained to 1 component if multicolor.
@@ -99,6 +106,7 @@ public:
 	virtual DoubleBoundingBox3D boundingBox() const; ///< bounding box in image space
 	virtual Eigen::Array3d getSpacing() const;
 	virtual vtkImageAccumulatePtr getHistogram();///< \return The histogram for the image
+	virtual ImageStatisticsPtr getStatistics();///< \return Histogram, range and percentiles of the grayscale image, updated if the image has changed.
 	virtual int getMax();	///< \return Return highest used value in the image
 	virtual int getMin();	///< \return Return lowest used value in the image
 	virtual int getRange();///< For convenience: getMax() - getMin()
@@ -159,7 +167,7 @@ public:
 	bool is2D();
 
 signals:
-	void vtkImageDataChanged(QString uid = QString()); ///< emitted when the vktimagedata are invalidated and must be retrieved anew.
+	void vtkImageDataChanged(QString uid = QString()); ///< emitted when the vktimagedata are invalidated and must be retrieved anew. Check isPartiallyModified() to update only the changed part.
 	void transferFunctionsChanged(); ///< emitted when image transfer functions in 2D or 3D are changed.
 	void cropBoxChanged();
 
@@ -173,6 +181,7 @@ protected:
 //	vtkMatrix4x4Ptr mOrientatorMatrix;
 //	vtkImageDataPtr mReferenceImageData; ///< imagedata after filtering through the orientatior, given in reference space
 	vtkImageAccumulatePtr mHistogramPtr;///< Histogram
+	ImageStatisticsPtr mStatistics;
 	ImagePtr mUnsigned; ///< version of this containing unsigned data.
 
 //	LandmarksPtr mLandmarks;
@@ -186,6 +195,8 @@ protected:
 	IMAGE_SUBTYPE mImageType; ///< type of the image, defined as DICOM tag (0008,0008) (mainly value 3, but might be a merge of value 4), Section 3, C.7.6.1.1.2
 	double mMaxRGBIntensity;
 	int mInterpolationType; ///< mirror the interpolationType in vtkVolumeProperty
+	bool mPartiallyModified;
+	IntBoundingBox3D mModifiedExtent;
 
 
 private:
@@ -22,8 +22,6 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include <QDomDocument>
 #include <vtkLookupTable.h>
 #include <vtkImageData.h>
-#include <vtkColorTransferFunction.h>
-#include <vtkPiecewiseFunction.h>
 
 #include "cxVector3D.h"
 
@@ -116,61 +114,14 @@ void ImageLUT2D::internalsHaveChanged()
 	emit transferFunctionsChanged();
 }
 
-std::pair<int,int> ImageLUT2D::getMapsRange()
-{
-	if (!mColorMap.empty() && !mOpacityMap.empty())
-	{
-		int imin = std::min(mColorMap.begin()->first, mOpacityMap.begin()->first);
-		int imax = std::max(mColorMap.rbegin()->first, mOpacityMap.rbegin()->first);
-		return std::make_pair(imin,imax);
-	}
-	else if (!mColorMap.empty())
-	{
-		int imin = mColorMap.begin()->first;
-		int imax = mColorMap.rbegin()->first;
-		return std::make_pair(imin,imax);
-	}
-	else if (!mOpacityMap.empty())
-	{
-		int imin = mOpacityMap.begin()->first;
-		int imax = mOpacityMap.rbegin()->first;
-		return std::make_pair(imin,imax);
-	}
-	else
-	{
-		return std::make_pair(0,0);
-	}
-}
-
 void ImageLUT2D::refreshOutputLUT()
 {
 	if (!mOutputLUT)
 		return;
 
-	std::pair<int,int> range = this->getMapsRange();
-	int imin = range.first;
-	int imax = range.second;
-	if (imin==imax)
-		imax = imin+1;
-	int icount = imax - imin + 1;
-
 	vtkLookupTablePtr lut = mOutputLUT;
 	lut->Build();
-	lut->SetNumberOfTableValues(icount);
-	lut->SetTableRange(imin, imax);
-
-	vtkColorTransferFunctionPtr colorFunc = this->generateColorTF();
-	vtkPiecewiseFunctionPtr opacityFunc = this->generateOpacityTF();
-
-	for (int i = 0; i < icount; ++i)
-	{
-		double* rgb = colorFunc->GetColor(i + imin);
-		double alpha = opacityFunc->GetValue(i + imin);
-		lut->SetTableValue(i, rgb[0], rgb[1], rgb[2], alpha);
-	}
-
-	lut->Modified();
-	lut->GetTable()->Modified();
+	mOutputLUTBuilder.update(mColorMap, mOpacityMap, lut);
 
 	// HACK WARNING!!!!!
 	// Setting vtkLookupTable::SetNumberOfTableValues > 256 causes
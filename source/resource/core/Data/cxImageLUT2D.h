@@ -24,6 +24,7 @@ class QDomNode;
 #include <QObject>
 #include "vtkForwardDeclarations.h"
 #include "cxImageTFData.h"
+#include "cxLookupTableBuilder.h"
 
 namespace cx
 {
@@ -59,11 +60,11 @@ protected:
 	virtual void internalsHaveChanged();
 
 private:
-	std::pair<int,int> getMapsRange();
 	void buildOpacityMapFromLLRAlpha();
 	void refreshOutputLUT();
 
-	vtkLookupTablePtr mOutputLUT; ///< the sum of all internal values
+	vtkLookupTablePtr mOutputLUT; ///< the sum of all internal values, shared by all views of the image
+	LookupTableBuilder mOutputLUTBuilder;
 };
 
 }
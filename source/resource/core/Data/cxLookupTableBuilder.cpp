@@ -0,0 +1,264 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#include "cxLookupTableBuilder.h"
+
+#include <algorithm>
+#include <vtkLookupTable.h>
+#include <vtkUnsignedCharArray.h>
+
+namespace cx
+{
+
+namespace
+{
+
+/** Entries outside a ramp are clamped to its end nodes, so a changed end
+ *  node changes the table outside the dirty span of the ramp.
+ */
+std::pair<int,int> addClampedRegions(std::pair<int,int> dirty, const LookupTableRamp& ramp, std::pair<int,int> range)
+{
+	if (dirty.first > dirty.second)
+		return dirty;
+	if (ramp.empty() || dirty.first <= ramp.getFirst())
+		dirty.first = range.first;
+	if (ramp.empty() || dirty.second >= ramp.getLast())
+		dirty.second = range.second;
+	return dirty;
+}
+
+} // namespace
+
+LookupTableRamp::LookupTableRamp(int components) :
+	mComponents(components),
+	mZero(components, 0)
+{
+}
+
+std::pair<int,int> LookupTableRamp::setNodes(const std::vector<int>& keys, const std::vector<float>& values)
+{
+	std::pair<int,int> unchanged(1, 0);
+	int n = keys.size();
+
+	if (keys.empty())
+	{
+		if (mKeys.empty())
+			return unchanged;
+		std::pair<int,int> retval(this->getFirst(), this->getLast());
+		mKeys.clear();
+		mValues.clear();
+		mEntries.clear();
+		return retval;
+	}
+
+	bool sameLayout = (int(mKeys.size()) == n);
+	for (int i=0; sameLayout && i<n; ++i)
+		sameLayout = (keys[i]-keys[0] == mKeys[i]-mKeys[0]);
+
+	if (!sameLayout)
+	{
+		mKeys = keys;
+		mValues = values;
+		mEntries.resize(mComponents*(keys.back()-keys.front()+1));
+		this->fillSegments(0, n-1);
+		return std::make_pair(this->getFirst(), this->getLast());
+	}
+
+	// Same node layout, possibly moved: find nodes with new values
+	int firstChanged = n;
+	int lastChanged = -1;
+	for (int i=0; i<n; ++i)
+	{
+		for (int c=0; c<mComponents; ++c)
+		{
+			if (values[i*mComponents+c] != mValues[i*mComponents+c])
+			{
+				firstChanged = std::min(firstChanged, i);
+				lastChanged = std::max(lastChanged, i);
+			}
+		}
+	}
+
+	int shift = keys[0] - mKeys[0];
+	mKeys = keys;
+	mValues = values;
+
+	if (lastChanged < 0)
+	{
+		if (shift == 0)
+			return unchanged;
+		return std::make_pair(this->getFirst(), this->getLast());
+	}
+
+	int beginNode = std::max(firstChanged-1, 0);
+	int endNode = std::min(lastChanged+1, n-1);
+	this->fillSegments(beginNode, endNode);
+	if (shift != 0)
+		return std::make_pair(this->getFirst(), this->getLast());
+	return std::make_pair(mKeys[beginNode], mKeys[endNode]);
+}
+
+/** Sample the ramp between the given nodes, inclusive.
+ */
+void LookupTableRamp::fillSegments(int beginNode, int endNode)
+{
+	int first = mKeys.front();
+	for (int c=0; c<mComponents; ++c)
+		mEntries[(mKeys[beginNode]-first)*mComponents+c] = static_cast<unsigned char>(mValues[beginNode*mComponents+c] + 0.5f);
+
+	for (int node=beginNode; node<endNode; ++node)
+	{
+		int x0 = mKeys[node];
+		int length = mKeys[node+1] - x0;
+		float scale = 1.0f/length;
+		for (int c=0; c<mComponents; ++c)
+		{
+			float v0 = mValues[node*mComponents+c];
+			float dv = (mValues[(node+1)*mComponents+c] - v0)*scale;
+			unsigned char* out = &mEntries[(x0-first+1)*mComponents+c];
+			for (int i=1; i<=length; ++i)
+				out[(i-1)*mComponents] = static_cast<unsigned char>(v0 + dv*i + 0.5f);
+		}
+	}
+}
+
+const unsigned char* LookupTableRamp::getEntry(int value) const
+{
+	if (mKeys.empty())
+		return &mZero[0];
+	int index = std::min(std::max(value, mKeys.front()), mKeys.back()) - mKeys.front();
+	return &mEntries[index*mComponents];
+}
+
+///--------------------------------------------------------
+
+LookupTableBuilder::LookupTableBuilder() :
+	mColor(3),
+	mOpacity(1),
+	mRange(0, -1),
+	mLastLut(NULL),
+	mLastUpdateCount(0)
+{
+}
+
+std::pair<int,int> LookupTableBuilder::getMapsRange(const ColorMap& colors, const IntIntMap& opacity)
+{
+	std::pair<int,int> retval(0, 0);
+	if (!colors.empty() && !opacity.empty())
+	{
+		retval.first = std::min(colors.begin()->first, opacity.begin()->first);
+		retval.second = std::max(colors.rbegin()->first, opacity.rbegin()->first);
+	}
+	else if (!colors.empty())
+	{
+		retval = std::make_pair(colors.begin()->first, colors.rbegin()->first);
+	}
+	else if (!opacity.empty())
+	{
+		retval = std::make_pair(opacity.begin()->first, opacity.rbegin()->first);
+	}
+
+	if (retval.first == retval.second)
+		retval.second = retval.first+1;
+	return retval;
+}
+
+void LookupTableBuilder::update(const ColorMap& colors, const IntIntMap& opacity, vtkLookupTablePtr lut)
+{
+	std::vector<int> keys;
+	std::vector<float> values;
+	for (ColorMap::const_iterator iter = colors.begin(); iter != colors.end(); ++iter)
+	{
+		keys.push_back(iter->first);
+		values.push_back(iter->second.redF()*255);
+		values.push_back(iter->second.greenF()*255);
+		values.push_back(iter->second.blueF()*255);
+	}
+	std::pair<int,int> colorDirty = mColor.setNodes(keys, values);
+
+	keys.clear();
+	values.clear();
+	for (IntIntMap::const_iterator iter = opacity.begin(); iter != opacity.end(); ++iter)
+	{
+		keys.push_back(iter->first);
+		values.push_back(std::min(std::max(iter->second, 0), 255));
+	}
+	std::pair<int,int> opacityDirty = mOpacity.setNodes(keys, values);
+
+	std::pair<int,int> range = getMapsRange(colors, opacity);
+	int count = range.second - range.first + 1;
+
+	bool full = (range != mRange)
+			|| (lut.GetPointer() != mLastLut)
+			|| (lut->GetNumberOfTableValues() != count);
+	mRange = range;
+	mLastLut = lut.GetPointer();
+
+	if (full)
+	{
+		lut->SetNumberOfTableValues(count);
+		lut->SetTableRange(range.first, range.second);
+		this->compose(lut, range.first, range.second);
+		return;
+	}
+
+	colorDirty = addClampedRegions(colorDirty, mColor, range);
+	opacityDirty = addClampedRegions(opacityDirty, mOpacity, range);
+
+	int first = range.second+1;
+	int last = range.first-1;
+	if (colorDirty.first <= colorDirty.second)
+	{
+		first = std::min(first, colorDirty.first);
+		last = std::max(last, colorDirty.second);
+	}
+	if (opacityDirty.first <= opacityDirty.second)
+	{
+		first = std::min(first, opacityDirty.first);
+		last = std::max(last, opacityDirty.second);
+	}
+	first = std::max(first, range.first);
+	last = std::min(last, range.second);
+
+	if (first > last)
+	{
+		mLastUpdateCount = 0;
+		return;
+	}
+	this->compose(lut, first, last);
+}
+
+/** Write table entries for values [first,last].
+ */
+void LookupTableBuilder::compose(vtkLookupTablePtr lut, int first, int last)
+{
+	unsigned char* table = lut->GetPointer(0);
+	for (int value=first; value<=last; ++value)
+	{
+		unsigned char* entry = table + 4*(value-mRange.first);
+		const unsigned char* color = mColor.getEntry(value);
+		entry[0] = color[0];
+		entry[1] = color[1];
+		entry[2] = color[2];
+		entry[3] = mOpacity.getEntry(value)[0];
+	}
+	mLastUpdateCount = last-first+1;
+
+	// Writing through the pointer bypasses vtkLookupTable's bookkeeping: Set one
+	// entry to itself to mark the table as user defined, so that Build() will not
+	// overwrite it, and update the out-of-range colors from the table ends.
+	unsigned char* entry = table + 4*(first-mRange.first);
+	lut->SetTableValue(first-mRange.first, entry[0]/255.0, entry[1]/255.0, entry[2]/255.0, entry[3]/255.0);
+	lut->BuildSpecialColors();
+	lut->Modified();
+	lut->GetTable()->Modified();
+}
+
+} // namespace cx
@@ -0,0 +1,92 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#ifndef CXLOOKUPTABLEBUILDER_H_
+#define CXLOOKUPTABLEBUILDER_H_
+
+#include "cxResourceExport.h"
+
+#include <vector>
+#include <utility>
+#include "vtkForwardDeclarations.h"
+#include "cxImageTFData.h"
+
+namespace cx
+{
+
+/** \brief Piecewise linear ramp between integer nodes, sampled at every integer.
+ *
+ * Entries are stored relative to the first node, so moving all nodes
+ * (e.g. a level change) does not change the entries.
+ *
+ * \ingroup cx_resource_core_data
+ * \date Oct 19, 2026
+ */
+class cxResource_EXPORT LookupTableRamp
+{
+public:
+	explicit LookupTableRamp(int components);
+	/** Set new nodes, with components values in [0,255] per node.
+	 *  Return the span of values [first,second] where entries changed,
+	 *  first>second if no entries changed.
+	 */
+	std::pair<int,int> setNodes(const std::vector<int>& keys, const std::vector<float>& values);
+	bool empty() const { return mKeys.empty(); }
+	int getFirst() const { return mKeys.empty() ? 0 : mKeys.front(); }
+	int getLast() const { return mKeys.empty() ? 0 : mKeys.back(); }
+	/** Entry for value, clamped to the end nodes. */
+	const unsigned char* getEntry(int value) const;
+
+private:
+	void fillSegments(int beginNode, int endNode);
+	int mComponents;
+	std::vector<int> mKeys;
+	std::vector<float> mValues;
+	std::vector<unsigned char> mEntries;
+	std::vector<unsigned char> mZero;
+};
+
+/** \brief Builds the 2D output lookup table from the color and opacity maps.
+ *
+ * The color and opacity maps are sampled into separate ramps that are
+ * kept between updates. A change to one map only resamples that map,
+ * and only the segments around changed nodes. Level and LLR changes,
+ * which move all nodes of one map, only move the cached ramp.
+ *
+ * The table holds one entry per integer in the union of the map ranges,
+ * as before. If the range is unchanged, only entries where a ramp changed
+ * are written to the table.
+ *
+ * \ingroup cx_resource_core_data
+ * \date Oct 19, 2026
+ */
+class cxResource_EXPORT LookupTableBuilder
+{
+public:
+	LookupTableBuilder();
+	void update(const ColorMap& colors, const IntIntMap& opacity, vtkLookupTablePtr lut);
+	std::pair<int,int> getRange() const { return mRange; }
+	int getLastUpdateCount() const { return mLastUpdateCount; } ///< number of table entries written by the last update()
+
+	static std::pair<int,int> getMapsRange(const ColorMap& colors, const IntIntMap& opacity);
+
+private:
+	void compose(vtkLookupTablePtr lut, int first, int last);
+
+	LookupTableRamp mColor;
+	LookupTableRamp mOpacity;
+	std::pair<int,int> mRange;
+	vtkLookupTable* mLastLut; ///< only used for comparison, not owned
+	int mLastUpdateCount;
+};
+
+} // namespace cx
+
+#endif /* CXLOOKUPTABLEBUILDER_H_ */
@@ -19,9 +19,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 
 #include "cxImage.h"
 
-#include <vtkImageResample.h>
-#include <vtkImageClip.h>
-#include "vtkImageShiftScale.h"
+#include "cxUnsignedImageConverter.h"
 
 #include "cxImage.h"
 #include "cxUtilHelpers.h"
@@ -45,7 +43,11 @@ ImagePtr UnsignedDerivedImage::create(ImagePtr base)
     return retval;
 }
 
-UnsignedDerivedImage::UnsignedDerivedImage(ImagePtr base) : Image(base->getUid()+"_u", vtkImageDataPtr(), base->getName())
+UnsignedDerivedImage::UnsignedDerivedImage(ImagePtr base) :
+	Image(base->getUid()+"_u", vtkImageDataPtr(), base->getName()),
+	mConvertedFrom(NULL),
+	mConvertedMTime(0),
+	mConvertedShift(0)
 {
     this->mBase = base;
 
@@ -89,9 +91,65 @@ void UnsignedDerivedImage::unsignedTransferFunctionsChangedSlot()
 
 void UnsignedDerivedImage::unsignedImageChangedSlot()
 {
+	ImagePtr base = mBase.lock();
+	if (base && base->isPartiallyModified())
+	{
+		this->updateExtent(base->getModifiedExtent());
+		return;
+	}
+	if (base && this->isConverted(base->getBaseVtkImageData(), this->findShift()))
+		return;
     this->setVtkImageData(this->convertImage());
 }
 
+bool UnsignedDerivedImage::isConverted(vtkImageDataPtr input, int shift) const
+{
+	return mBaseImageData
+			&& input.GetPointer() == mConvertedFrom
+			&& input->GetMTime() == mConvertedMTime
+			&& shift == mConvertedShift;
+}
+
+void UnsignedDerivedImage::updateExtent(const IntBoundingBox3D& extent)
+{
+	ImagePtr base = mBase.lock();
+	if (!base)
+		return;
+	vtkImageDataPtr input = base->getBaseVtkImageData();
+
+	// A new base or a changed range of the base gives a new shift: start over.
+	if (!mBaseImageData || input.GetPointer() != mConvertedFrom || this->findShift() != mConvertedShift)
+	{
+		this->reconvert();
+		return;
+	}
+
+	UnsignedImageConverter converter;
+	converter.setShift(mConvertedShift);
+	converter.setOutputScalarType(mBaseImageData->GetScalarType());
+	bool converted = converter.convertExtent(input, mBaseImageData, extent);
+
+	// New values outside of what the shift and output type can hold: start over.
+	double outputMax = mBaseImageData->GetScalarTypeMax();
+	bool clamped = (converter.getInputMin() + mConvertedShift < 0) || (converter.getInputMax() + mConvertedShift > outputMax);
+	if (!converted || clamped)
+	{
+		this->reconvert();
+		return;
+	}
+
+	mConvertedMTime = input->GetMTime();
+	this->setVtkImageDataModified(extent);
+}
+
+void UnsignedDerivedImage::reconvert()
+{
+	int oldShift = mConvertedShift;
+	this->setVtkImageData(this->convertImage());
+	if (mConvertedShift != oldShift)
+		this->unsignedTransferFunctionsChangedSlot();
+}
+
 int UnsignedDerivedImage::findShift()
 {
     ImagePtr base = mBase.lock();
@@ -102,12 +160,25 @@ int UnsignedDerivedImage::findShift()
     if (input->GetScalarTypeMin() >= 0)
         return 0;
 
-    // start by shifting up to zero
-    int shift = -input->GetScalarRange()[0];
     // if CT: always shift by 1024 (houndsfield units definition)
 		if (base->getModality() == imCT)
-        shift = 1024;
-    return shift;
+        return 1024;
+
+    // else shift up to zero, using the cached range of the base
+    return -base->getMin();
+}
+
+int UnsignedDerivedImage::findOutputScalarType()
+{
+    ImagePtr base = mBase.lock();
+    if (!base)
+        return VTK_UNSIGNED_SHORT;
+    vtkImageDataPtr input = base->getBaseVtkImageData();
+
+    // 8 and 16 bit types always fit in unsigned short, no need to find the range
+    if (input->GetScalarSize() <= 2)
+        return VTK_UNSIGNED_SHORT;
+    return UnsignedImageConverter::findOutputScalarType(base->getMin(), base->getMax());
 }
 
 vtkImageDataPtr UnsignedDerivedImage::convertImage()
@@ -121,29 +192,19 @@ vtkImageDataPtr UnsignedDerivedImage::convertImage()
     int shift = this->findShift();
     vtkImageDataPtr input = base->getBaseVtkImageData();
 
-    vtkImageShiftScalePtr cast = vtkImageShiftScalePtr::New();
-	cast->SetInputData(input);
-    cast->ClampOverflowOn();
-
-    cast->SetShift(shift);
-
-    // total intensity range of voxels:
-    double range = input->GetScalarRange()[1] - input->GetScalarRange()[0];
+    UnsignedImageConverter converter;
+    converter.setShift(shift);
+    converter.setOutputScalarType(this->findOutputScalarType());
+    retval = converter.convert(input);
+    if (!retval)
+        return retval;
 
-    // to to fit within smallest type
-    if (range <= VTK_UNSIGNED_SHORT_MAX-VTK_UNSIGNED_SHORT_MIN)
-        cast->SetOutputScalarType(VTK_UNSIGNED_SHORT);
-    else if (range <= VTK_UNSIGNED_INT_MAX-VTK_UNSIGNED_INT_MIN)
-        cast->SetOutputScalarType(VTK_UNSIGNED_INT);
-//	else if (range <= VTK_UNSIGNED_LONG_MAX-VTK_UNSIGNED_LONG_MIN) // not supported by vtk - it seems (crash in rendering)
-//		cast->SetOutputScalarType(VTK_UNSIGNED_LONG);
-    else
-        cast->SetOutputScalarType(VTK_UNSIGNED_INT);
+    mConvertedFrom = input.GetPointer();
+    mConvertedMTime = input->GetMTime();
+    mConvertedShift = shift;
 
-    cast->Update();
 //		if (verbose)
-      report(QString("Converting image %1 from %2 to %3").arg(this->getName()).arg(input->GetScalarTypeAsString()).arg(cast->GetOutput()->GetScalarTypeAsString()));
-    retval = cast->GetOutput();
+      report(QString("Converting image %1 from %2 to %3").arg(this->getName()).arg(input->GetScalarTypeAsString()).arg(retval->GetScalarTypeAsString()));
     return retval;
 }
 
@@ -17,6 +17,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "cxPrecompiledHeader.h"
 
 #include "cxImage.h"
+#include "cxBoundingBox3D.h"
 
 #define CALL_IN_WEAK_PTR(weak_base, func, defarg)       \
 {                                                       \
@@ -36,6 +37,10 @@ struct CoordinateSystem;
  * Intended for structures that requires unsigned input, such
  * as TextureSlice3DProxy.
  *
+ * The conversion is cached: Changes to the base are only converted if the
+ * base data or shift has changed. Partial changes to the base, notified by
+ * Image::setVtkImageDataModified(), are converted for the changed extent only.
+ *
  * \ingroup cx_resource_core_data
  *   \date Feb 21, 2013
  *   \author christiana
@@ -63,6 +68,12 @@ public:
 		virtual IMAGE_MODALITY getModality() const       { CALL_IN_WEAK_PTR(mBase, getModality, IMAGE_MODALITY()); }
 		virtual IMAGE_SUBTYPE getImageType() const       { CALL_IN_WEAK_PTR(mBase, getImageType, IMAGE_SUBTYPE()); }
 
+	/** Convert only the part of the base image inside extent, assuming the rest
+	 *  is unchanged since the last conversion. Falls back to a full conversion
+	 *  if the shift or output type no longer fit the base.
+	 */
+	void updateExtent(const IntBoundingBox3D& extent);
+
 private slots:
     void unsignedTransferFunctionsChangedSlot();
     void unsignedImageChangedSlot();
@@ -71,10 +82,16 @@ private slots:
 private:
     UnsignedDerivedImage(ImagePtr base);
     int findShift();
+    int findOutputScalarType();
     vtkImageDataPtr convertImage();
+    void reconvert();
+    bool isConverted(vtkImageDataPtr input, int shift) const;
     void convertTransferFunctions();
 
     boost::weak_ptr<Image> mBase;
+    vtkImageData* mConvertedFrom; ///< base data of the current conversion, not owned
+    unsigned long mConvertedMTime; ///< modification time of the base data at the last conversion
+    int mConvertedShift;
 };
 
 }
@@ -0,0 +1,181 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "cxMaskSpans.h"
+
+#include <algorithm>
+#include "vtkImageData.h"
+#include "cxVolumeHelpers.h"
+#include "cxLogger.h"
+
+namespace cx
+{
+
+MaskSpans::MaskSpans(int width, int height) :
+	mWidth(width),
+	mHeight(height),
+	mRowStart(1, 0),
+	mValidPixelCount(0)
+{
+	mRowStart.reserve(height+1);
+}
+
+namespace
+{
+template<class TYPE>
+void appendMaskRows(MaskSpans* spans, const TYPE* ptr, int width, int height, int components)
+{
+	std::vector<MaskSpans::Span> row;
+	for (int y = 0; y < height; ++y)
+	{
+		row.clear();
+		const TYPE* line = ptr + size_t(y)*width*components;
+		int x = 0;
+		while (x < width)
+		{
+			while (x < width && !line[x*components])
+				++x;
+			MaskSpans::Span span;
+			span.begin = x;
+			while (x < width && line[x*components])
+				++x;
+			span.end = x;
+			if (span.begin < span.end)
+				row.push_back(span);
+		}
+		spans->appendRow(row);
+	}
+}
+} // namespace
+
+MaskSpansPtr MaskSpans::createFromMask(vtkImageDataPtr mask)
+{
+	if (!mask)
+		return MaskSpansPtr();
+
+	int* dim = mask->GetDimensions();
+	int components = mask->GetNumberOfScalarComponents();
+	MaskSpansPtr retval(new MaskSpans(dim[0], dim[1]));
+
+	switch (mask->GetScalarType())
+	{
+		vtkTemplateMacro(appendMaskRows(retval.get(), static_cast<VTK_TT*>(mask->GetScalarPointer()), dim[0], dim[1], components));
+	default:
+		CX_LOG_ERROR() << "MaskSpans: Unsupported mask type " << mask->GetScalarTypeAsString();
+		return MaskSpansPtr();
+	}
+	return retval;
+}
+
+void MaskSpans::appendRow(const std::vector<Span>& spans)
+{
+	if (int(mRowStart.size()) > mHeight)
+	{
+		CX_LOG_ERROR() << "MaskSpans: Too many rows";
+		return;
+	}
+
+	for (unsigned i = 0; i < spans.size(); ++i)
+	{
+		Span span;
+		span.begin = std::max(spans[i].begin, 0);
+		span.end = std::min(spans[i].end, mWidth);
+		if (span.begin >= span.end)
+			continue;
+		mSpans.push_back(span);
+		mValidPixelCount += span.end - span.begin;
+	}
+	mRowStart.push_back(mSpans.size());
+}
+
+bool MaskSpans::isInside(int x, int y) const
+{
+	if (y < 0 || y+1 >= int(mRowStart.size()))
+		return false;
+	for (const Span* s = this->rowBegin(y); s != this->rowEnd(y); ++s)
+		if (s->begin <= x && x < s->end)
+			return true;
+	return false;
+}
+
+bool MaskSpans::getBounds(int* xmin, int* xmax, int* ymin, int* ymax) const
+{
+	bool found = false;
+	for (int y = 0; y+1 < int(mRowStart.size()); ++y)
+	{
+		if (this->rowBegin(y) == this->rowEnd(y))
+			continue;
+		int rowMin = this->rowBegin(y)->begin;
+		int rowMax = (this->rowEnd(y)-1)->end - 1;
+		if (!found)
+		{
+			*xmin = rowMin;
+			*xmax = rowMax;
+			*ymin = y;
+			found = true;
+		}
+		*xmin = std::min(*xmin, rowMin);
+		*xmax = std::max(*xmax, rowMax);
+		*ymax = y;
+	}
+	return found;
+}
+
+MaskSpansPtr MaskSpans::createTransposed() const
+{
+	// collect spans per column by walking rows in order: each column
+	// keeps an open span that is extended while consecutive rows cover it.
+	std::vector<std::vector<Span> > columns(mWidth);
+	std::vector<int> openBegin(mWidth, -1);
+	int rows = int(mRowStart.size()) - 1;
+	std::vector<unsigned char> inside(mWidth);
+
+	for (int y = 0; y <= rows; ++y)
+	{
+		std::fill(inside.begin(), inside.end(), 0);
+		if (y < rows)
+			for (const Span* s = this->rowBegin(y); s != this->rowEnd(y); ++s)
+				std::fill(inside.begin() + s->begin, inside.begin() + s->end, 1);
+
+		for (int x = 0; x < mWidth; ++x)
+		{
+			if (inside[x] && openBegin[x] < 0)
+			{
+				openBegin[x] = y;
+			}
+			else if (!inside[x] && openBegin[x] >= 0)
+			{
+				Span span;
+				span.begin = openBegin[x];
+				span.end = y;
+				columns[x].push_back(span);
+				openBegin[x] = -1;
+			}
+		}
+	}
+
+	MaskSpansPtr retval(new MaskSpans(mHeight, mWidth));
+	for (int x = 0; x < mWidth; ++x)
+		retval->appendRow(columns[x]);
+	return retval;
+}
+
+vtkImageDataPtr MaskSpans::createMaskImage(Vector3D spacing) const
+{
+	vtkImageDataPtr retval = generateVtkImageData(Eigen::Array3i(mWidth, mHeight, 1), spacing, 0);
+	unsigned char* ptr = static_cast<unsigned char*>(retval->GetScalarPointer());
+	for (int y = 0; y+1 < int(mRowStart.size()); ++y)
+		for (const Span* s = this->rowBegin(y); s != this->rowEnd(y); ++s)
+			std::fill(ptr + size_t(y)*mWidth + s->begin, ptr + size_t(y)*mWidth + s->end, 1);
+	return retval;
+}
+
+} // namespace cx
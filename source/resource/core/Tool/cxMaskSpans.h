@@ -0,0 +1,87 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#ifndef CXMASKSPANS_H_
+#define CXMASKSPANS_H_
+
+#include "cxResourceExport.h"
+
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include "vtkForwardDeclarations.h"
+#include "cxVector3D.h"
+
+namespace cx
+{
+
+typedef boost::shared_ptr<class MaskSpans> MaskSpansPtr;
+
+/** \brief Run-length representation of a 2D binary mask.
+ *
+ * Each row y holds a sorted list of disjoint spans [begin,end> of
+ * valid x values. Iterate over the spans instead of testing every
+ * pixel of the mask:
+ *
+ * \code
+ * for (int y = 0; y < spans->getHeight(); ++y)
+ *     for (const MaskSpans::Span* s = spans->rowBegin(y); s != spans->rowEnd(y); ++s)
+ *         for (int x = s->begin; x < s->end; ++x)
+ *             ...
+ * \endcode
+ *
+ * Immutable after construction, thus safe to read from several threads.
+ *
+ * \ingroup cx_resource_core_tool
+ * \date Oct 19, 2026
+ */
+class cxResource_EXPORT MaskSpans
+{
+public:
+	struct Span
+	{
+		int begin;
+		int end;
+	};
+
+	MaskSpans(int width, int height);
+	static MaskSpansPtr createFromMask(vtkImageDataPtr mask); ///< spans covering all nonzero pixels of the first component, any scalar type.
+
+	/** Set spans for the next row. Rows must be added in order 0..height-1,
+	 *  spans within a row sorted and non-overlapping. Empty spans are ignored.
+	 */
+	void appendRow(const std::vector<Span>& spans);
+
+	int getWidth() const { return mWidth; }
+	int getHeight() const { return mHeight; }
+	const Span* rowBegin(int y) const { return mSpans.empty() ? 0 : &mSpans[0] + mRowStart[y]; }
+	const Span* rowEnd(int y) const { return mSpans.empty() ? 0 : &mSpans[0] + mRowStart[y+1]; }
+
+	bool isInside(int x, int y) const;
+	int getValidPixelCount() const { return mValidPixelCount; }
+	/** Get the bounding box of the valid pixels as xmin,xmax,ymin,ymax (inclusive).
+	 *  Return false if there are no valid pixels.
+	 */
+	bool getBounds(int* xmin, int* xmax, int* ymin, int* ymax) const;
+
+	MaskSpansPtr createTransposed() const; ///< spans along columns instead of rows: x and y swapped.
+	vtkImageDataPtr createMaskImage(Vector3D spacing) const; ///< unsigned char image, 1 inside spans, 0 elsewhere.
+
+private:
+	int mWidth;
+	int mHeight;
+	std::vector<Span> mSpans;
+	std::vector<int> mRowStart; ///< spans for row y are [mRowStart[y], mRowStart[y+1]>
+	int mValidPixelCount;
+};
+
+} // namespace cx
+
+#endif /* CXMASKSPANS_H_ */
@@ -0,0 +1,114 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "cxPlaybackPoseSampler.h"
+
+#include <algorithm>
+#include "cxUSReconstructInputDataAlgoritms.h"
+
+namespace cx
+{
+
+PlaybackPoseSampler::PlaybackPoseSampler() :
+	mHistory(new History()),
+	mCursor(0),
+	mInterpolation(false),
+	mTimeout(200)
+{
+}
+
+void PlaybackPoseSampler::setHistory(TimedTransformMapPtr history)
+{
+	boost::shared_ptr<History> data(new History());
+	if (history)
+	{
+		data->mTimestamps.reserve(history->size());
+		data->mPoses.reserve(history->size());
+		for (TimedTransformMap::iterator iter = history->begin(); iter != history->end(); ++iter)
+		{
+			data->mTimestamps.push_back(iter->first);
+			data->mPoses.push_back(iter->second);
+		}
+	}
+	mHistory = data;
+	mCursor = 0;
+}
+
+bool PlaybackPoseSampler::isStale(TimedTransformMapPtr history) const
+{
+	unsigned size = history ? history->size() : 0;
+	if (size != mHistory->mTimestamps.size())
+		return true;
+	if (!size)
+		return false;
+	return (history->begin()->first != mHistory->mTimestamps.front())
+			|| (history->rbegin()->first != mHistory->mTimestamps.back());
+}
+
+int PlaybackPoseSampler::getNumberOfSamples() const
+{
+	return mHistory->mTimestamps.size();
+}
+
+int PlaybackPoseSampler::findSampleBefore(double time)
+{
+	const std::vector<double>& timestamps = mHistory->mTimestamps;
+	int n = timestamps.size();
+	if (!n)
+		return -1;
+
+	// the sample is i if t[i] < time <= t[i+1]: try the cursor and the next few samples first.
+	int maxSteps = 4;
+	for (int i = mCursor; i < std::min(n, mCursor + maxSteps); ++i)
+	{
+		if (i > 0 && timestamps[i] >= time)
+			break;
+		if ((i + 1 == n) || (timestamps[i + 1] >= time))
+		{
+			mCursor = i;
+			return i;
+		}
+	}
+
+	int index = std::lower_bound(timestamps.begin(), timestamps.end(), time) - timestamps.begin();
+	mCursor = std::max(index - 1, 0);
+	return mCursor;
+}
+
+PlaybackPoseSampler::Pose PlaybackPoseSampler::sample(double time)
+{
+	Pose retval;
+	int i = this->findSampleBefore(time);
+	if (i < 0)
+		return retval;
+
+	const std::vector<double>& timestamps = mHistory->mTimestamps;
+	const std::vector<Transform3D>& poses = mHistory->mPoses;
+
+	retval.visible = fabs(time - timestamps[i]) < mTimeout;
+	retval.timestamp = timestamps[i];
+	retval.prMt = poses[i];
+
+	bool canInterpolate = mInterpolation
+			&& (i + 1 < int(timestamps.size()))
+			&& (timestamps[i] <= time) && (time <= timestamps[i + 1])
+			&& (timestamps[i + 1] - timestamps[i] < mTimeout);
+	if (retval.visible && canInterpolate)
+	{
+		double t = (time - timestamps[i]) / (timestamps[i + 1] - timestamps[i]);
+		retval.prMt = USReconstructInputDataAlgorithm::slerpInterpolate(poses[i], poses[i + 1], t);
+		retval.timestamp = time;
+	}
+
+	return retval;
+}
+
+} /* namespace cx */
@@ -0,0 +1,78 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#ifndef CXPLAYBACKPOSESAMPLER_H_
+#define CXPLAYBACKPOSESAMPLER_H_
+
+#include "cxResourceExport.h"
+
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include "cxTool.h"
+
+namespace cx
+{
+
+/** \brief Pose lookup in a recorded tool position history.
+ *
+ * The history is copied once into time sorted arrays. Copies of the sampler
+ * share these arrays, but each has its own cursor.
+ *
+ * Lookups start at the sample found by the previous lookup, making monotonic
+ * playback O(1), and fall back to binary search for seeks.
+ *
+ * The sample used is the last one before the given time (the first if none),
+ * and is valid if closer than the timeout. With interpolation enabled, the pose
+ * is interpolated between the two samples around the given time (SLERP for
+ * rotation, linear for translation), if they are closer than the timeout.
+ *
+ * \ingroup org_custusx_core_tracking
+ * \date Oct 19, 2026
+ */
+class cxResource_EXPORT PlaybackPoseSampler
+{
+public:
+	struct Pose
+	{
+		Pose() : visible(false), timestamp(0), prMt(Transform3D::Identity()) {}
+		bool visible; ///< a sample was found within the timeout
+		double timestamp; ///< timestamp of the sample, or the lookup time if interpolated
+		Transform3D prMt;
+	};
+
+	PlaybackPoseSampler();
+	void setHistory(TimedTransformMapPtr history);
+	bool isStale(TimedTransformMapPtr history) const; ///< true if history has changed since setHistory()
+	int getNumberOfSamples() const;
+
+	void setInterpolation(bool on) { mInterpolation = on; }
+	bool getInterpolation() const { return mInterpolation; }
+	void setTimeout(double ms) { mTimeout = ms; }
+
+	Pose sample(double time);
+	/** Return index of the last sample before time, 0 if none, -1 if empty.
+	 */
+	int findSampleBefore(double time);
+
+private:
+	struct History
+	{
+		std::vector<double> mTimestamps;
+		std::vector<Transform3D> mPoses;
+	};
+	boost::shared_ptr<const History> mHistory;
+	int mCursor;
+	bool mInterpolation;
+	double mTimeout;
+};
+
+} /* namespace cx */
+
+#endif /* CXPLAYBACKPOSESAMPLER_H_ */
@@ -23,6 +23,7 @@ PlaybackTool::PlaybackTool(ToolPtr base, PlaybackTimePtr time) :
     mTime(time),
     mVisible(false)
 {
+	mSampler.setHistory(mBase->getPositionHistory());
 	connect(mTime.get(), SIGNAL(changed()), this, SLOT(timeChangedSlot()));
 
 	connect(mBase.get(), SIGNAL(toolProbeSector()), this, SIGNAL(toolProbeSector()));
@@ -33,36 +34,38 @@ PlaybackTool::~PlaybackTool()
 {
 }
 
+void PlaybackTool::setPoseInterpolation(bool on)
+{
+	mSampler.setInterpolation(on);
+	this->timeChangedSlot();
+}
+
 void PlaybackTool::timeChangedSlot()
 {
 	QDateTime time = mTime->getTime();
 	qint64 time_ms = time.toMSecsSinceEpoch();
 
 	TimedTransformMapPtr positions = mBase->getPositionHistory();
-	if (positions->empty())
+	if (mSampler.isStale(positions))
+		mSampler.setHistory(positions);
+	if (!mSampler.getNumberOfSamples())
 		return;
 
-	// find last stored time before current time.
-	TimedTransformMap::iterator lastSample = positions->lower_bound(time_ms);
-	if (lastSample!=positions->begin())
-		--lastSample;
-
-	// interpret as hidden if no samples has been received the last time:
-	qint64 timeout = 200;
-	bool visible = (lastSample!=positions->end()) && (fabs(time_ms - lastSample->first) < timeout);
+	// interpreted as hidden if no samples has been received the last time:
+	PlaybackPoseSampler::Pose pose = mSampler.sample(time_ms);
 
 	// change visibility if applicable
-	if (mVisible!=visible)
+	if (mVisible!=pose.visible)
 	{
-		mVisible = visible;
+		mVisible = pose.visible;
 		emit toolVisible(mVisible);
 	}
 
 	// emit new position if visible
 	if (this->getVisible())
 	{
-		m_rMpr = lastSample->second;
-		mTimestamp = lastSample->first;
+		m_rMpr = pose.prMt;
+		mTimestamp = pose.timestamp;
 		emit toolTransformAndTimestamp(m_rMpr, mTimestamp);
 	}
 }
@@ -13,6 +13,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #define CXPLAYBACKTOOL_H_
 
 #include "cxToolImpl.h"
+#include "cxPlaybackPoseSampler.h"
 
 #include "cxResourceExport.h"
 
@@ -64,12 +65,14 @@ public:
 
 	// extensions
 	ToolPtr getBase() { return mBase; }
+	void setPoseInterpolation(bool on); ///< interpolate between recorded samples instead of using the last one
 
 private slots:
 	void timeChangedSlot();
 private:
 	ToolPtr mBase;
 	PlaybackTimePtr mTime;
+	PlaybackPoseSampler mSampler;
 
 	bool mVisible;
 	double mTimestamp;
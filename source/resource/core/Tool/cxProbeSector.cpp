@@ -72,7 +72,123 @@ public:
 		return this->insideClipRect(p_v) && this->insideSector(p_v);
 	}
 
+	/**Return the valid pixels in row y as sorted spans.
+	 *
+	 * Candidate x ranges are computed from the sector geometry, widened by one
+	 * pixel, then the ends are adjusted by evaluating operator() so that
+	 * the result is identical to testing each pixel. Each candidate range
+	 * must contain a single run of valid pixels.
+	 */
+	std::vector<MaskSpans::Span> getRowSpans(int y, int width) const
+	{
+		std::vector<MaskSpans::Span> retval;
+		std::vector<std::pair<double, double> > ranges = this->getCandidateRanges(y);
+
+		for (unsigned i = 0; i < ranges.size(); ++i)
+		{
+			int begin = int(std::max(ceil(ranges[i].first), 0.0));
+			int last = int(std::min(floor(ranges[i].second), double(width - 1)));
+			while (begin <= last && !(*this)(begin, y))
+				++begin;
+			while (begin <= last && !(*this)(last, y))
+				--last;
+			if (begin > last)
+				continue;
+			while (begin > 0 && (*this)(begin - 1, y))
+				--begin;
+			while (last < width - 1 && (*this)(last + 1, y))
+				++last;
+
+			MaskSpans::Span span;
+			span.begin = begin;
+			span.end = last + 1;
+			if (!retval.empty() && retval.back().end >= span.begin)
+				retval.back().end = std::max(retval.back().end, span.end);
+			else
+				retval.push_back(span);
+		}
+		return retval;
+	}
+
 private:
+	/**Return ranges of x (in pixels, inclusive) in row y that might be inside the mask.
+	 * The ranges are sorted and contain all inside pixels.
+	 */
+	std::vector<std::pair<double, double> > getCandidateRanges(int y) const
+	{
+		std::vector<std::pair<double, double> > retval;
+		Vector3D spacing = mData.getSpacing();
+		double margin_x = spacing[0];
+		double margin_y = spacing[1];
+		double dy = y * spacing[1] - mCachedCenter_v[1];
+
+		if (y * spacing[1] < mClipRect_v[2] - margin_y || y * spacing[1] > mClipRect_v[3] + margin_y)
+			return retval;
+
+		// valid |dx| is inside [inner, outer]
+		double inner = 0;
+		double outer = 0;
+
+		if (mData.getType() == ProbeDefinition::tSECTOR)
+		{
+			double depthStart = mData.getDepthStart();
+			double depthEnd = mData.getDepthEnd();
+			if (fabs(dy) > depthEnd + margin_y)
+				return retval;
+			double dz = -mCachedCenter_v[2];
+			double r2 = dy * dy + dz * dz;
+			outer = sqrt(std::max(depthEnd * depthEnd - r2, 0.0)) + margin_x;
+			inner = sqrt(std::max(depthStart * depthStart - r2, 0.0)) - margin_x;
+
+			// angle from the probe axis (+y) is below width/2 <=> dy >= cos(width/2)*|d|
+			double halfWidth = mData.getWidth() / 2.0;
+			double cosHalfWidth = cos(halfWidth);
+			if (halfWidth < M_PI_2)
+			{
+				if (dy < -margin_y)
+					return retval;
+				outer = std::min(outer, std::max(dy, 0.0) * tan(halfWidth) + margin_x);
+			}
+			else if (dy < 0 && halfWidth < M_PI && cosHalfWidth < 0)
+			{
+				inner = std::max(inner, -dy * tan(M_PI - halfWidth) - margin_x);
+			}
+		}
+		else // tLINEAR
+		{
+			if (dy < mData.getDepthStart() - margin_y || dy > mData.getDepthEnd() + margin_y)
+				return retval;
+			outer = mData.getWidth() / 2.0 + margin_x;
+		}
+
+		double center = mCachedCenter_v[0];
+		double clipMin = mClipRect_v[0] - margin_x;
+		double clipMax = mClipRect_v[1] + margin_x;
+
+		// Split at the center: the valid pixels on each side are contiguous,
+		// which getRowSpans() relies on.
+		std::vector<std::pair<double, double> > dxRanges;
+		if (mData.getType() != ProbeDefinition::tSECTOR)
+		{
+			dxRanges.push_back(std::make_pair(center - outer, center + outer));
+		}
+		else if (inner < outer)
+		{
+			inner = std::max(inner, 0.0);
+			dxRanges.push_back(std::make_pair(center - outer, center - inner));
+			dxRanges.push_back(std::make_pair(center + inner, center + outer));
+		}
+
+		for (unsigned i = 0; i < dxRanges.size(); ++i)
+		{
+			double lo = std::max(dxRanges[i].first, clipMin);
+			double hi = std::min(dxRanges[i].second, clipMax);
+			if (lo <= hi)
+				retval.push_back(std::make_pair(lo / spacing[0], hi / spacing[0]));
+		}
+		return retval;
+	}
+
 	/**return true if p_v, given in the upper-left space v,
 	 * is inside the us beam sector
 	 *
@@ -130,24 +246,38 @@ private:
  */
 vtkImageDataPtr ProbeSector::getMask()
 {
-	if (mData.getType()==ProbeDefinition::tNONE)
+	MaskSpansPtr spans = this->getMaskSpans();
+	if (!spans)
 		return vtkImageDataPtr();
+	return spans->createMaskImage(mData.getSpacing());
+}
+
+/** Return the US beam inside the image data stream as spans of valid pixels per row.
+ *  Same pixels as getMask().
+ */
+MaskSpansPtr ProbeSector::getMaskSpans()
+{
+	if (mData.getType()==ProbeDefinition::tNONE)
+		return MaskSpansPtr();
 	InsideMaskFunctor checkInside(mData, this->get_uMv());
-	vtkImageDataPtr retval;
-	retval = generateVtkImageData(Eigen::Array3i(mData.getSize().width(), mData.getSize().height(), 1),
-																mData.getSpacing(), 0);
-
-	int* dim(retval->GetDimensions());
-	unsigned char* dataPtr = static_cast<unsigned char*> (retval->GetScalarPointer());
-	for (int x = 0; x < dim[0]; x++)
-		for (int y = 0; y < dim[1]; y++)
-		{
-			dataPtr[x + y * dim[0]] = checkInside(x, y) ? 1 : 0;
-		}
+
+	int width = mData.getSize().width();
+	int height = mData.getSize().height();
+	MaskSpansPtr retval(new MaskSpans(width, height));
+	for (int y = 0; y < height; y++)
+		retval->appendRow(checkInside.getRowSpans(y, width));
 
 	return retval;
 }
 
+bool ProbeSector::isInsideMask(int x, int y) const
+{
+	if (mData.getType()==ProbeDefinition::tNONE)
+		return false;
+	InsideMaskFunctor checkInside(mData, this->get_uMv());
+	return checkInside(x, y);
+}
+
 void ProbeSector::test()
 {
 	Transform3D tMu = this->get_tMu();
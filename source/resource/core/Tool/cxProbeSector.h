@@ -21,6 +21,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "vtkForwardDeclarations.h"
 #include "cxProbeDefinition.h"
 #include "cxTransform3D.h"
+#include "cxMaskSpans.h"
 
 typedef vtkSmartPointer<class vtkImageData> vtkImageDataPtr;
 typedef vtkSmartPointer<class vtkPolyData> vtkPolyDataPtr;
@@ -42,6 +43,8 @@ public:
 	void setData(ProbeDefinition data);
 
 	vtkImageDataPtr getMask();
+	MaskSpansPtr getMaskSpans(); ///< get the mask as spans of valid pixels per row
+	bool isInsideMask(int x, int y) const; ///< test a single pixel against the sector geometry. Slow, use getMaskSpans() for many pixels.
 	vtkPolyDataPtr getSector(); ///< get a polydata representation of the us sector
 	vtkPolyDataPtr getSectorLinesOnly(); ///< get a polydata representation of the us sector
 	vtkPolyDataPtr getSectorSectorOnlyLinesOnly(); ///< get a polydata representation of the us sector
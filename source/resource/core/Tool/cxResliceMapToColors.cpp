@@ -0,0 +1,311 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#include "cxResliceMapToColors.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <boost/bind.hpp>
+#include <vtkObjectFactory.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkStreamingDemandDrivenPipeline.h>
+#include <vtkImageData.h>
+#include <vtkLookupTable.h>
+#include <vtkMatrix4x4.h>
+
+#include "cxParallelFor.h"
+
+namespace cx
+{
+
+vtkStandardNewMacro(ResliceMapToColors);
+
+namespace
+{
+
+/** Geometry of one slice, in input voxel index space.
+ */
+struct SliceGeometry
+{
+	int outDim[2];
+	double start[3]; ///< index of output pixel (0,0)
+	double stepX[3]; ///< index increment along output x
+	double stepY[3]; ///< index increment along output y
+	int inDim[3];
+	vtkIdType inStride[3];
+	const unsigned char* table; ///< RGBA per value, starting at the type minimum
+	int tableOffset; ///< minus the type minimum
+	unsigned int background; ///< RGBA
+};
+
+template<class TYPE>
+inline int roundToType(float value)
+{
+	int retval = int(std::floor(value + 0.5f));
+	retval = std::max<int>(retval, std::numeric_limits<TYPE>::min());
+	return std::min<int>(retval, std::numeric_limits<TYPE>::max());
+}
+
+/** Sample row [begin,end) of the slice, write RGBA to output.
+ */
+template<class TYPE>
+void sliceRows(const TYPE* input, unsigned int* output, const SliceGeometry* g, int begin, int end)
+{
+	const float lower[3] = { -0.5f, -0.5f, -0.5f };
+	const float upper[3] = { g->inDim[0]-0.5f, g->inDim[1]-0.5f, g->inDim[2]-0.5f };
+
+	for (int j=begin; j<end; ++j)
+	{
+		unsigned int* out = output + vtkIdType(j)*g->outDim[0];
+		float c[3];
+		for (int k=0; k<3; ++k)
+			c[k] = g->start[k] + j*g->stepY[k];
+
+		for (int i=0; i<g->outDim[0]; ++i)
+		{
+			float x = c[0] + i*float(g->stepX[0]);
+			float y = c[1] + i*float(g->stepX[1]);
+			float z = c[2] + i*float(g->stepX[2]);
+
+			if (x < lower[0] || x > upper[0] || y < lower[1] || y > upper[1] || z < lower[2] || z > upper[2])
+			{
+				out[i] = g->background;
+				continue;
+			}
+
+			// clamp the border region, find the lower corner and weights
+			float p[3] = { x, y, z };
+			vtkIdType offset = 0;
+			vtkIdType step[3];
+			float t[3];
+			for (int k=0; k<3; ++k)
+			{
+				float v = std::min(std::max(p[k], 0.0f), float(g->inDim[k]-1));
+				int f = int(v);
+				if (f >= g->inDim[k]-1)
+				{
+					f = g->inDim[k]-1;
+					step[k] = 0;
+					t[k] = 0;
+				}
+				else
+				{
+					step[k] = g->inStride[k];
+					t[k] = v - f;
+				}
+				offset += f*g->inStride[k];
+			}
+
+			const TYPE* s = input + offset;
+			float v00 = s[0] + t[0]*(s[step[0]] - s[0]);
+			float v10 = s[step[1]] + t[0]*(s[step[1]+step[0]] - s[step[1]]);
+			float v01 = s[step[2]] + t[0]*(s[step[2]+step[0]] - s[step[2]]);
+			float v11 = s[step[2]+step[1]] + t[0]*(s[step[2]+step[1]+step[0]] - s[step[2]+step[1]]);
+			float v0 = v00 + t[1]*(v10 - v00);
+			float v1 = v01 + t[1]*(v11 - v01);
+			float value = v0 + t[2]*(v1 - v0);
+
+			int index = roundToType<TYPE>(value) + g->tableOffset;
+			memcpy(out+i, g->table + 4*index, 4);
+		}
+	}
+}
+
+template<class TYPE>
+void buildTable(vtkLookupTable* lut, int vtkType, std::vector<unsigned char>* table)
+{
+	int count = int(std::numeric_limits<TYPE>::max()) - int(std::numeric_limits<TYPE>::min()) + 1;
+	std::vector<TYPE> values(count);
+	for (int i=0; i<count; ++i)
+		values[i] = TYPE(int(std::numeric_limits<TYPE>::min()) + i);
+	table->resize(4*count);
+	lut->MapScalarsThroughTable2(&values[0], &(*table)[0], vtkType, count, 1, VTK_RGBA);
+}
+
+template<class TYPE>
+void executeSlice(vtkImageData* input, unsigned int* output, SliceGeometry* g, double background)
+{
+	g->tableOffset = -int(std::numeric_limits<TYPE>::min());
+	int bg = roundToType<TYPE>(background) + g->tableOffset;
+	memcpy(&g->background, g->table + 4*bg, 4);
+
+	const TYPE* inPtr = static_cast<const TYPE*>(input->GetScalarPointer());
+	// small chunks: a row is cheap, and rows outside the volume even more so.
+	parallelFor(0, g->outDim[1], boost::bind(&sliceRows<TYPE>, inPtr, output, g, _1, _2), 8);
+}
+
+} // namespace
+
+ResliceMapToColors::ResliceMapToColors() :
+	mBackgroundLevel(0),
+	mOrigin(0, 0, 0),
+	mDim(0, 0, 0),
+	mSpacing(1, 1, 1),
+	mTableScalarType(-1),
+	mTableTime(0)
+{
+	this->SetNumberOfInputPorts(0);
+}
+
+bool ResliceMapToColors::canExecute(vtkImageDataPtr image)
+{
+	if (!image || image->GetNumberOfScalarComponents() != 1)
+		return false;
+	switch (image->GetScalarType())
+	{
+	case VTK_CHAR:
+	case VTK_SIGNED_CHAR:
+	case VTK_UNSIGNED_CHAR:
+	case VTK_SHORT:
+	case VTK_UNSIGNED_SHORT:
+		return true;
+	default:
+		return false;
+	}
+}
+
+void ResliceMapToColors::setInputImage(vtkImageDataPtr image)
+{
+	if (mInput == image)
+		return;
+	mInput = image;
+	this->Modified();
+}
+
+void ResliceMapToColors::setLookupTable(vtkLookupTablePtr lut)
+{
+	if (mLut == lut)
+		return;
+	mLut = lut;
+	mTableScalarType = -1;
+	this->Modified();
+}
+
+void ResliceMapToColors::setResliceAxes(vtkMatrix4x4Ptr axes)
+{
+	mAxes = axes;
+	this->Modified();
+}
+
+void ResliceMapToColors::setBackgroundLevel(double value)
+{
+	if (mBackgroundLevel == value)
+		return;
+	mBackgroundLevel = value;
+	this->Modified();
+}
+
+void ResliceMapToColors::setOutputFormat(Vector3D origin, Eigen::Array3i dim, Vector3D spacing)
+{
+	mOrigin = origin;
+	mDim = dim;
+	mSpacing = spacing;
+	this->Modified();
+}
+
+vtkMTimeType ResliceMapToColors::GetMTime()
+{
+	vtkMTimeType retval = this->Superclass::GetMTime();
+	if (mInput)
+		retval = std::max(retval, mInput->GetMTime());
+	if (mLut)
+		retval = std::max(retval, mLut->GetMTime());
+	if (mAxes)
+		retval = std::max(retval, mAxes->GetMTime());
+	return retval;
+}
+
+int ResliceMapToColors::RequestInformation(vtkInformation*, vtkInformationVector**, vtkInformationVector* outputVector)
+{
+	vtkInformation* outInfo = outputVector->GetInformationObject(0);
+	int extent[6] = { 0, mDim[0], 0, mDim[1], 0, 0 };
+	outInfo->Set(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), extent, 6);
+	outInfo->Set(vtkDataObject::SPACING(), mSpacing.data(), 3);
+	outInfo->Set(vtkDataObject::ORIGIN(), mOrigin.data(), 3);
+	vtkDataObject::SetPointDataActiveScalarInfo(outInfo, VTK_UNSIGNED_CHAR, 4);
+	return 1;
+}
+
+void ResliceMapToColors::updateTable()
+{
+	int type = mInput->GetScalarType();
+	if (type == mTableScalarType && mLut->GetMTime() <= mTableTime)
+		return;
+
+	switch (type)
+	{
+	case VTK_CHAR: buildTable<char>(mLut, type, &mTable); break;
+	case VTK_SIGNED_CHAR: buildTable<signed char>(mLut, type, &mTable); break;
+	case VTK_UNSIGNED_CHAR: buildTable<unsigned char>(mLut, type, &mTable); break;
+	case VTK_SHORT: buildTable<short>(mLut, type, &mTable); break;
+	case VTK_UNSIGNED_SHORT: buildTable<unsigned short>(mLut, type, &mTable); break;
+	default: break;
+	}
+	mTableScalarType = type;
+	mTableTime = mLut->GetMTime();
+}
+
+int ResliceMapToColors::RequestData(vtkInformation*, vtkInformationVector**, vtkInformationVector* outputVector)
+{
+	vtkImageData* output = vtkImageData::GetData(outputVector);
+	output->SetExtent(0, mDim[0], 0, mDim[1], 0, 0);
+	output->SetSpacing(mSpacing.data());
+	output->SetOrigin(mOrigin.data());
+	output->AllocateScalars(VTK_UNSIGNED_CHAR, 4);
+	unsigned int* outPtr = static_cast<unsigned int*>(output->GetScalarPointer());
+	vtkIdType outSize = output->GetNumberOfPoints();
+
+	if (!mLut || !canExecute(mInput))
+	{
+		std::fill(outPtr, outPtr+outSize, 0);
+		return 1;
+	}
+	this->updateTable();
+
+	SliceGeometry g;
+	g.outDim[0] = mDim[0]+1;
+	g.outDim[1] = mDim[1]+1;
+	g.table = &mTable[0];
+
+	int* inExtent = mInput->GetExtent();
+	double* inOrigin = mInput->GetOrigin();
+	double* inSpacing = mInput->GetSpacing();
+	mInput->GetDimensions(g.inDim);
+	g.inStride[0] = 1;
+	g.inStride[1] = g.inDim[0];
+	g.inStride[2] = vtkIdType(g.inDim[0])*g.inDim[1];
+
+	vtkMatrix4x4Ptr axes = mAxes ? mAxes : vtkMatrix4x4Ptr::New();
+	double point[4] = { mOrigin[0], mOrigin[1], mOrigin[2], 1 };
+	double start[4];
+	axes->MultiplyPoint(point, start);
+	for (int k=0; k<3; ++k)
+	{
+		g.start[k] = (start[k]-inOrigin[k])/inSpacing[k] - inExtent[2*k];
+		g.stepX[k] = axes->GetElement(k, 0)*mSpacing[0]/inSpacing[k];
+		g.stepY[k] = axes->GetElement(k, 1)*mSpacing[1]/inSpacing[k];
+	}
+
+	switch (mInput->GetScalarType())
+	{
+	case VTK_CHAR: executeSlice<char>(mInput, outPtr, &g, mBackgroundLevel); break;
+	case VTK_SIGNED_CHAR: executeSlice<signed char>(mInput, outPtr, &g, mBackgroundLevel); break;
+	case VTK_UNSIGNED_CHAR: executeSlice<unsigned char>(mInput, outPtr, &g, mBackgroundLevel); break;
+	case VTK_SHORT: executeSlice<short>(mInput, outPtr, &g, mBackgroundLevel); break;
+	case VTK_UNSIGNED_SHORT: executeSlice<unsigned short>(mInput, outPtr, &g, mBackgroundLevel); break;
+	default: break;
+	}
+
+	return 1;
+}
+
+} // namespace cx
@@ -0,0 +1,92 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#ifndef CXRESLICEMAPTOCOLORS_H_
+#define CXRESLICEMAPTOCOLORS_H_
+
+#include "cxResourceExport.h"
+
+#include <vector>
+#include <vtkImageAlgorithm.h>
+#include "vtkForwardDeclarations.h"
+#include "cxVector3D.h"
+
+namespace cx
+{
+
+/** \brief Slice a volume and apply a lookup table in a single pass.
+ *
+ * Replaces the vtkImageReslice -> vtkImageMapToColors chain used for
+ * software slicing of grayscale images: Each output pixel is sampled
+ * from the volume using trilinear interpolation, rounded to the input
+ * scalar type as vtkImageReslice does, and written as RGBA using the
+ * lookup table. No intermediate slice image is created.
+ *
+ * The lookup table is expanded into a table covering every value of
+ * the input scalar type, rebuilt when the lookup table is modified.
+ * Thus only 8 and 16 bit single component images are handled, see
+ * canExecute(). Output rows are processed in parallel.
+ *
+ * The output geometry follows vtkImageReslice: resliceAxes maps output
+ * coordinates to input coordinates, samples within half a voxel outside
+ * the volume are clamped to the border, and samples further away get
+ * the background level.
+ *
+ * \ingroup cx_resource_core_tool
+ * \date Oct 19, 2026
+ */
+class cxResource_EXPORT ResliceMapToColors : public vtkImageAlgorithm
+{
+public:
+	static ResliceMapToColors* New();
+	vtkTypeMacro(ResliceMapToColors, vtkImageAlgorithm);
+
+	static bool canExecute(vtkImageDataPtr image);
+
+	void setInputImage(vtkImageDataPtr image);
+	void setLookupTable(vtkLookupTablePtr lut);
+	void setResliceAxes(vtkMatrix4x4Ptr axes); ///< modifications of axes are tracked
+	void setBackgroundLevel(double value);
+	/** Output points are origin + (i,j,0)*spacing, for i in [0,dim[0]] and j in [0,dim[1]],
+	 *  matching the output extent set by SlicedImageProxy.
+	 */
+	void setOutputFormat(Vector3D origin, Eigen::Array3i dim, Vector3D spacing);
+
+	virtual vtkMTimeType GetMTime();
+
+protected:
+	ResliceMapToColors();
+	virtual ~ResliceMapToColors() {}
+
+	virtual int RequestInformation(vtkInformation*, vtkInformationVector**, vtkInformationVector*);
+	virtual int RequestData(vtkInformation*, vtkInformationVector**, vtkInformationVector*);
+
+private:
+	void updateTable();
+
+	vtkImageDataPtr mInput;
+	vtkLookupTablePtr mLut;
+	vtkMatrix4x4Ptr mAxes;
+	double mBackgroundLevel;
+	Vector3D mOrigin;
+	Eigen::Array3i mDim;
+	Vector3D mSpacing;
+
+	std::vector<unsigned char> mTable; ///< RGBA for every value of the input scalar type
+	int mTableScalarType;
+	vtkMTimeType mTableTime;
+
+	ResliceMapToColors(const ResliceMapToColors&);  // Not implemented.
+	void operator=(const ResliceMapToColors&);  // Not implemented.
+};
+
+} // namespace cx
+
+#endif /* CXRESLICEMAPTOCOLORS_H_ */
@@ -26,6 +26,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "cxSliceProxy.h"
 #include "cxImageLUT2D.h"
 #include "cxTypeConversions.h"
+#include "cxResliceMapToColors.h"
 
 
 namespace cx
@@ -120,7 +121,9 @@ vtkImageDataPtr ApplyLUTToImage2DProxy::getOutput()
 ///--------------------------------------------------------
 
 
-SlicedImageProxy::SlicedImageProxy()
+SlicedImageProxy::SlicedImageProxy() :
+	mAllowSinglePassSlicer(true),
+	mUsingSinglePassSlicer(false)
 {
 	mMatrixAxes = vtkMatrix4x4Ptr::New();
 
@@ -133,7 +136,12 @@ SlicedImageProxy::SlicedImageProxy()
 
 	mImageWithLUTProxy.reset(new ApplyLUTToImage2DProxy());
 
+	mSinglePassSlicer = ResliceMapToColorsPtr::New();
+	mSinglePassSlicer->setResliceAxes(mMatrixAxes);
+
 	mRedirecter = vtkImageChangeInformationPtr::New();
+	mOutputRedirecter = vtkImageChangeInformationPtr::New();
+	mOutputRedirecter->SetInputConnection(mImageWithLUTProxy->getOutputPort()->GetOutputPort());
 }
 
 SlicedImageProxy::~SlicedImageProxy()
@@ -148,6 +156,19 @@ void SlicedImageProxy::setOutputFormat(Vector3D origin, Eigen::Array3i dim, Vect
 	// TODO investigate
 //	mReslicer->SetOutputExtent(0, dim[0]-1, 0, dim[1]-1, 0, 0);
 	mReslicer->SetOutputSpacing(spacing.data());
+	mSinglePassSlicer->setOutputFormat(origin, dim, spacing);
+}
+
+void SlicedImageProxy::setUseSinglePassSlicer(bool on)
+{
+	mAllowSinglePassSlicer = on;
+	if (mImage)
+		this->transferFunctionsChangedSlot();
+}
+
+bool SlicedImageProxy::useSinglePassSlicer() const
+{
+	return mAllowSinglePassSlicer && mImage && ResliceMapToColors::canExecute(mImage->getBaseVtkImageData());
 }
 
 void SlicedImageProxy::setSliceProxy(SliceProxyInterfacePtr slicer)
@@ -168,12 +189,29 @@ void SlicedImageProxy::transferFunctionsChangedSlot()
 {
 	mReslicer->SetInputData(mImage->getBaseVtkImageData());
 	mReslicer->SetBackgroundLevel(mImage->getMin());
-	mImageWithLUTProxy->setInput(mRedirecter, mImage->getLookupTable2D()->getOutputLookupTable());
+
+	mUsingSinglePassSlicer = this->useSinglePassSlicer();
+	if (mUsingSinglePassSlicer)
+	{
+		mSinglePassSlicer->setInputImage(mImage->getBaseVtkImageData());
+		mSinglePassSlicer->setLookupTable(mImage->getLookupTable2D()->getOutputLookupTable());
+		mSinglePassSlicer->setBackgroundLevel(mImage->getMin());
+		mOutputRedirecter->SetInputConnection(mSinglePassSlicer->GetOutputPort());
+	}
+	else
+	{
+		mImageWithLUTProxy->setInput(mRedirecter, mImage->getLookupTable2D()->getOutputLookupTable());
+		mOutputRedirecter->SetInputConnection(mImageWithLUTProxy->getOutputPort()->GetOutputPort());
+	}
 }
 
 void SlicedImageProxy::updateRedirecterSlot()
 {
 	mRedirecter->SetInputConnection(mReslicer->GetOutputPort());
+	if (mUsingSinglePassSlicer != this->useSinglePassSlicer())
+		this->transferFunctionsChangedSlot();
+	else if (mUsingSinglePassSlicer)
+		mSinglePassSlicer->setInputImage(mImage->getBaseVtkImageData());
 	update();
 }
 
@@ -202,7 +240,9 @@ void SlicedImageProxy::setImage(ImagePtr image)
 	}
 	else // no image
 	{
+		mUsingSinglePassSlicer = false;
 		mImageWithLUTProxy->setInput(vtkImageAlgorithmPtr(), vtkLookupTablePtr());
+		mOutputRedirecter->SetInputConnection(mImageWithLUTProxy->getOutputPort()->GetOutputPort());
 	}
 
 	this->update();
@@ -215,12 +255,12 @@ ImagePtr SlicedImageProxy::getImage() const
 
 vtkImageDataPtr SlicedImageProxy::getOutput()
 {
-	return mImageWithLUTProxy->getOutput();
+	return mOutputRedirecter->GetOutput();
 }
 
 vtkImageAlgorithmPtr SlicedImageProxy::getOutputPort()
 {
-	return mImageWithLUTProxy->getOutputPort();
+	return mOutputRedirecter;
 }
 
 vtkImageDataPtr SlicedImageProxy::getOutputWithoutLUT()
@@ -29,6 +29,7 @@ typedef boost::shared_ptr<class SliceProxyInterface> SliceProxyInterfacePtr;
 
 typedef boost::shared_ptr<class SlicedImageProxy> SlicedImageProxyPtr;
 typedef boost::shared_ptr<class ApplyLUTToImage2DProxy> ApplyLUTToImage2DProxyPtr;
+typedef vtkSmartPointer<class ResliceMapToColors> ResliceMapToColorsPtr;
 
 /** \brief Helper class for applying sscLUT2D to an image.
  *
@@ -66,6 +67,10 @@ private:
  * The image is sliced in software using the slice definition from
  * the SliceProxy
  *
+ * Grayscale 8 and 16 bit images are sliced and colored in one pass
+ * using ResliceMapToColors, other images use a vtkImageReslice followed
+ * by ApplyLUTToImage2DProxy.
+ *
  * Used internally by BlendedSliceRep and SlicerRepSW as the slice engine.
  * 
  * Used by Sonowand 2.1
@@ -83,6 +88,7 @@ public:
 	void setImage(ImagePtr image);
 	ImagePtr getImage() const;
 	void setOutputFormat(Vector3D origin, Eigen::Array3i dim, Vector3D spacing);
+	void setUseSinglePassSlicer(bool on); ///< use ResliceMapToColors when possible, default on
 	void update();
 	vtkImageDataPtr getOutput(); ///< output 2D sliced image
 	vtkImageAlgorithmPtr getOutputPort(); ///< output 2D sliced image
@@ -96,7 +102,11 @@ private slots:
 	void updateRedirecterSlot();
 
 private: 
+	bool useSinglePassSlicer() const;
 	ApplyLUTToImage2DProxyPtr mImageWithLUTProxy;
+	ResliceMapToColorsPtr mSinglePassSlicer;
+	bool mAllowSinglePassSlicer;
+	bool mUsingSinglePassSlicer;
 
 	SliceProxyInterfacePtr mSlicer;
 	ImagePtr mImage;
@@ -105,6 +115,7 @@ private:
 	vtkMatrix4x4Ptr mMatrixAxes;
 
 	vtkImageChangeInformationPtr mRedirecter;
+	vtkImageChangeInformationPtr mOutputRedirecter; ///< output with LUT, from either slicing path
 };
 
 //---------------------------------------------------------
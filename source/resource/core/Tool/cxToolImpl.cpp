@@ -13,6 +13,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 
 #include <vtkSTLReader.h>
 #include <QDir>
+#include <QTimer>
 #include <vtkConeSource.h>
 
 #include "cxTypeConversions.h"
@@ -26,8 +27,14 @@ ToolImpl::ToolImpl(const QString& uid, const QString& name) :
 	mPositionHistory(new TimedTransformMap()),
 	m_prMt(Transform3D::Identity()),
 	mPolyData(NULL),
-	mTooltipOffset(0)
+	mTooltipOffset(0),
+	mTrackingBatchInterval(15), // about one render frame
+	mTrackingTimestamp(0)
 {
+	mPendingSamples.reserve(64);
+	mTrackingBatchTimer = new QTimer(this);
+	mTrackingBatchTimer->setSingleShot(true);
+	connect(mTrackingBatchTimer, &QTimer::timeout, this, &ToolImpl::trackingBatchTimeoutSlot);
 }
 
 ToolImpl::~ToolImpl()
@@ -109,6 +116,64 @@ void ToolImpl::set_prMt(const Transform3D& prMt, double timestamp)
 	emit toolTransformAndTimestamp(m_prMt, timestamp);
 }
 
+void ToolImpl::setTrackingBatchInterval(int ms)
+{
+	mTrackingBatchInterval = ms;
+	if (ms<=0)
+		this->commitTrackingSamples();
+}
+
+void ToolImpl::addTrackingSample(const Transform3D& prMt, const Transform3D& prMt_filtered, double timestamp, bool storeInHistory)
+{
+	TrackingSample sample;
+	sample.timestamp = timestamp;
+	sample.prMt = prMt;
+	sample.prMt_filtered = prMt_filtered;
+	sample.storeInHistory = storeInHistory;
+	mPendingSamples.push_back(sample);
+	++mTrackingCounters.samplesIngested;
+
+	if (mTrackingBatchTimer->isActive())
+		return; // a batch is already scheduled
+
+	// commit at once unless the last commit was less than one interval ago
+	qint64 sinceCommit = mLastTrackingCommit.isValid() ? mLastTrackingCommit.elapsed() : mTrackingBatchInterval;
+	if (sinceCommit >= mTrackingBatchInterval)
+		this->commitTrackingSamples();
+	else
+		mTrackingBatchTimer->start(int(mTrackingBatchInterval - sinceCommit));
+}
+
+void ToolImpl::trackingBatchTimeoutSlot()
+{
+	this->commitTrackingSamples();
+}
+
+void ToolImpl::commitTrackingSamples()
+{
+	mTrackingBatchTimer->stop();
+	if (mPendingSamples.empty())
+		return;
+
+	// samples arrive in time order: hint at end gives constant time insertion
+	for (unsigned i=0; i<mPendingSamples.size(); ++i)
+	{
+		const TrackingSample& sample = mPendingSamples[i];
+		if (!sample.storeInHistory)
+			continue;
+		TimedTransformMap::iterator iter = mPositionHistory->insert(mPositionHistory->end(), std::make_pair(sample.timestamp, sample.prMt));
+		iter->second = sample.prMt;
+	}
+
+	m_prMt = mPendingSamples.back().prMt_filtered;
+	mTrackingTimestamp = mPendingSamples.back().timestamp;
+	mPendingSamples.clear();
+	mLastTrackingCommit.start();
+
+	++mTrackingCounters.batchesCommitted;
+	emit toolTransformAndTimestamp(m_prMt, mTrackingTimestamp);
+}
+
 void ToolImpl::resetTrackingPositionFilter(TrackingPositionFilterPtr filter)
 {
     mTrackingPositionFilter = filter;
@@ -13,15 +13,25 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 
 #include "cxResourceExport.h"
 
+#include <vector>
+#include <QElapsedTimer>
 #include "cxTool.h"
 #include "cxToolFileParser.h"
 
+class QTimer;
+
 namespace cx
 {
 typedef boost::shared_ptr<class TrackingPositionFilter> TrackingPositionFilterPtr;
 
 /** \brief Common functionality for Tool subclasses
  *
+ * Subclasses receiving tracking data at high rates add samples using
+ * addTrackingSample(). A sample arriving at least one batch interval after
+ * the last commit is committed immediately. Samples arriving faster are
+ * buffered and committed to the position history in batches at the end of
+ * the interval, with a single toolTransformAndTimestamp() for the latest
+ * sample in each batch.
  *
  * \ingroup cx_resource_core_tool
  * \date 2014-02-21
@@ -52,8 +62,24 @@ public:
 
 	virtual vtkPolyDataPtr getGraphicsPolyData() const;
 	virtual bool hasReferencePointWithId(int id);
+
+	struct TrackingCounters
+	{
+		TrackingCounters() : samplesIngested(0), batchesCommitted(0) {}
+		long samplesIngested;
+		long batchesCommitted; ///< each emits one toolTransformAndTimestamp()
+	};
+	TrackingCounters getTrackingCounters() const { return mTrackingCounters; }
+	void setTrackingBatchInterval(int ms); ///< min time between commits, 0 commits each sample immediately
+	void commitTrackingSamples(); ///< commit buffered samples now
+
 protected:
 	virtual void set_prMt(const Transform3D& prMt, double timestamp);
+	/** Buffer a tracking sample. When committed, prMt is stored in the position history
+	 *  if storeInHistory is set, and prMt_filtered becomes the tool position.
+	 */
+	void addTrackingSample(const Transform3D& prMt, const Transform3D& prMt_filtered, double timestamp, bool storeInHistory);
+	double getTrackingTimestamp() const { return mTrackingTimestamp; } ///< timestamp of the last committed sample
 	void createToolGraphic();
 
 	TimedTransformMapPtr mPositionHistory;
@@ -65,8 +91,23 @@ protected:
 	virtual std::set<Type> getTypes() const;
 	virtual std::map<int, Vector3D> getReferencePoints() const;
 	virtual ToolFileParser::ToolInternalStructurePtr getToolFileToolStructure() const { return ToolFileParser::ToolInternalStructurePtr(); }
+private slots:
+	void trackingBatchTimeoutSlot();
 private:
+	struct TrackingSample
+	{
+		double timestamp;
+		Transform3D prMt;
+		Transform3D prMt_filtered;
+		bool storeInHistory;
+	};
 	double mTooltipOffset;
+	std::vector<TrackingSample> mPendingSamples; ///< capacity is kept between batches
+	QTimer* mTrackingBatchTimer;
+	int mTrackingBatchInterval;
+	QElapsedTimer mLastTrackingCommit;
+	double mTrackingTimestamp;
+	TrackingCounters mTrackingCounters;
 };
 typedef boost::shared_ptr<ToolImpl> cxToolPtr;
 
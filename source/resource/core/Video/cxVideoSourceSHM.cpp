@@ -14,6 +14,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 
 #include <boost/array.hpp>
 #include <vector>
+#include <algorithm>
 
 #include <vtkImageData.h>
 #include <vtkImageImport.h>
@@ -21,6 +22,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 
 
 #include <qtimer.h>
+#include "cxLogger.h"
 
 namespace cx
 {
@@ -36,6 +38,7 @@ VideoSourceSHM::VideoSourceSHM(int width, int height, int depth)
 
 	mConnected = false;
 	mStreaming = false;
+	mUsingRing = false;
 
 	mPollTimer = new QTimer(this);
 	mPollTimer->setInterval(40);	// Polling interval (currently set @ 25 fps)
@@ -53,6 +56,8 @@ VideoSourceSHM::~VideoSourceSHM()
 
 QString VideoSourceSHM::getUid()
 {
+	if (mUsingRing)
+		return mRing.key();
 	return mSource.key();
 }
 
@@ -68,13 +73,22 @@ vtkImageDataPtr VideoSourceSHM::getVtkImageData()
 
 double VideoSourceSHM::getTimestamp()
 {
+	if (mUsingRing)
+		return mTimeStamp;
 	return (double) mSource.timestamp().toMSecsSinceEpoch();
 }
 
 /// Returns a short info message
 QString VideoSourceSHM::getInfoString() const
 {
-	return "NOT YET IMPLEMENTED";
+	if (!mUsingRing)
+		return "NOT YET IMPLEMENTED";
+	if (mProbeDefinition.getType()==ProbeDefinition::tNONE)
+		return "";
+	return QString("%1 probe, depth %2-%3 mm")
+			.arg(mProbeDefinition.getType()==ProbeDefinition::tSECTOR ? "Sector" : "Linear")
+			.arg(mProbeDefinition.getDepthStart())
+			.arg(mProbeDefinition.getDepthEnd());
 }
 
 /// Returns a short status message
@@ -118,6 +132,8 @@ void VideoSourceSHM::stop()
 bool VideoSourceSHM::validData() const
 {
 	// return (isConnected() && isStreaming()); // Currently only check available
+	if (mUsingRing && !mRing.isValid(mRingFrame))
+		return false; // the writer has reused the slot of the imported frame
 	return isConnected() && mImportInitialized;
 }
 
@@ -137,6 +153,12 @@ bool VideoSourceSHM::isStreaming() const
  */
 void VideoSourceSHM::update()
 {
+	if (mUsingRing)
+	{
+		this->updateFromRing();
+		return;
+	}
+
 	unsigned char* buffer = (unsigned char*) mSource.isNew(); // Fetch new data from server - NULL if no new data present
 	if (!buffer)
 		return;
@@ -156,13 +178,85 @@ void VideoSourceSHM::update()
 	emit newFrame();
 }
 
+/**
+ * Maps the newest frame in the ring into the image import, skipping
+ * frames that arrived since the last poll.
+ *
+ * The image is not copied: it is valid until the writer reuses the slot,
+ * and validData() returns false after that. The writer should keep
+ * at least the frames written during two poll intervals in the ring.
+ */
+void VideoSourceSHM::updateFromRing()
+{
+	// frames with dimensions that do not fit in the ring slot are dropped here
+	SharedMemoryFrame frame;
+	if (!mRing.acquireLatest(&frame))
+		return;
+
+	const SharedMemoryFrameInfo& info = frame.info;
+	mImageImport->SetDataScalarType(info.scalarType);
+	mImageImport->SetNumberOfScalarComponents(info.components);
+	mImageImport->SetDataSpacing(info.spacing[0], info.spacing[1], info.spacing[2]);
+	mImageImport->SetWholeExtent(0, info.dim[0] - 1, 0, info.dim[1] - 1, 0, std::max(info.dim[2], 1) - 1);
+	mImageImport->SetDataExtentToWholeExtent();
+	mImageImport->SetImportVoidPointer(const_cast<void*>(frame.data));
+	mImageImport->Update();
+	mRingFrame = frame;
+
+	// drop the frame if the writer passed us while importing
+	if (!mRing.isValid(frame))
+		return;
+
+	mImageWidth = info.dim[0];
+	mImageHeight = info.dim[1];
+	mImageColorDepth = 8 * info.components;
+	mTimeStamp = info.timestamp;
+	mImportInitialized = true;
+	this->updateProbeDefinition(info);
+
+	emit newFrame();
+}
+
+void VideoSourceSHM::updateProbeDefinition(const SharedMemoryFrameInfo& info)
+{
+	ProbeDefinition probe(static_cast<ProbeDefinition::TYPE>(info.probeType));
+	if (probe.getType()!=ProbeDefinition::tNONE)
+	{
+		probe.setUid(this->getUid());
+		probe.setSize(QSize(info.dim[0], info.dim[1]));
+		probe.setSpacing(Vector3D(info.spacing));
+		probe.setOrigin_p(Vector3D(info.probeOrigin));
+		probe.setSector(info.probeDepthStart, info.probeDepthEnd, info.probeWidth);
+		probe.setClipRect_p(DoubleBoundingBox3D(0, info.dim[0]-1, 0, info.dim[1]-1, 0, 0));
+	}
+
+	bool changed = (probe.getType()!=mProbeDefinition.getType())
+			|| (probe.getSize()!=mProbeDefinition.getSize())
+			|| !similar(probe.getSpacing(), mProbeDefinition.getSpacing())
+			|| !similar(probe.getOrigin_p(), mProbeDefinition.getOrigin_p())
+			|| !similar(probe.getDepthStart(), mProbeDefinition.getDepthStart())
+			|| !similar(probe.getDepthEnd(), mProbeDefinition.getDepthEnd())
+			|| !similar(probe.getWidth(), mProbeDefinition.getWidth());
+	mProbeDefinition = probe;
+	if (changed)
+		emit probeDefinitionChanged();
+}
+
 /**
  * Connects to a shared memory server end, described by a unique key string.
  * Connects signals and slots on success.
  */
 void VideoSourceSHM::connectServer(const QString& key)
 {
-	mConnected = mSource.attach(key);
+	mUsingRing = mRing.attach(key);
+	if (mUsingRing && mRing.slotCount() < MIN_RING_SLOTS)
+	{
+		reportWarning(QString("Shared memory frame ring %1 has %2 slots, at least %3 are required")
+					  .arg(key).arg(mRing.slotCount()).arg(MIN_RING_SLOTS));
+		mRing.detach();
+		mUsingRing = false;
+	}
+	mConnected = mUsingRing || mSource.attach(key);
 
 	if (mConnected)
 	{
@@ -186,9 +280,14 @@ void VideoSourceSHM::disconnectServer()
 	if (mConnected)
 	{
 		disconnect(mPollTimer, SIGNAL(timeout()), this, SLOT(serverPollSlot()));
-		mSource.release();
+		if (!mUsingRing)
+			mSource.release();
 	}
 
+	mRing.detach();
+	mUsingRing = false;
+	mRingFrame = SharedMemoryFrame();
+	mProbeDefinition = ProbeDefinition();
 	mSource.detach();
 	mConnected = false;
 }
@@ -34,6 +34,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 
 #include "cxVideoSource.h"
 #include "cxSharedMemory.h"
+#include "cxProbeDefinition.h"
 
 typedef vtkSmartPointer<class vtkImageImport> vtkImageImportPtr;
 
@@ -45,7 +46,13 @@ namespace cx
 
 /** \brief VideoSource for connecting to shared memory.
  *
- * Contains data assosiated with a shared memory video stream
+ * Contains data assosiated with a shared memory video stream.
+ * If the key refers to a SharedMemoryFrameRingWriter, frames are mapped
+ * from the ring without copying, and size, spacing and timestamp are
+ * taken from the frame headers. Otherwise a SharedMemoryServer is used.
+ * The ring must have at least MIN_RING_SLOTS slots, and should hold the
+ * frames written during two poll intervals (80 ms): a frame overwritten while
+ * it is shown makes validData() return false until the next frame.
  *
  * \ingroup cx_resource_core_video
  */
@@ -80,9 +87,17 @@ public:
 	void connectServer(const QString& key);
 	void disconnectServer();
 	virtual void setResolution(double resolution);
+	ProbeDefinition getProbeDefinition() const { return mProbeDefinition; } ///< probe status sent with the frames, tNONE if none
+
+	static const int MIN_RING_SLOTS = 4; ///< frame rings with fewer slots are rejected
+
+signals:
+	void probeDefinitionChanged();
 
 protected:
 	void update();
+	void updateFromRing();
+	void updateProbeDefinition(const SharedMemoryFrameInfo& info);
 
 protected:
 	int			mImageWidth;
@@ -92,6 +107,10 @@ protected:
 private:
 
 	SharedMemoryClient mSource;
+	SharedMemoryFrameRingReader mRing;
+	SharedMemoryFrame mRingFrame; ///< the frame in mImageImport
+	bool mUsingRing;
+	ProbeDefinition mProbeDefinition;
 
 	vtkImageDataPtr mImageData;
 	vtkImageImportPtr mImageImport;
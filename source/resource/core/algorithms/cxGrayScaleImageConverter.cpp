@@ -0,0 +1,184 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#include "cxGrayScaleImageConverter.h"
+
+#include <algorithm>
+#include <vector>
+#include <boost/bind.hpp>
+#include <vtkImageData.h>
+
+#include "cxParallelFor.h"
+
+namespace cx
+{
+
+namespace
+{
+
+vtkImageDataPtr createOutput(vtkImageDataPtr input, int scalarType, int components)
+{
+	vtkImageDataPtr output = vtkImageDataPtr::New();
+	output->SetExtent(input->GetExtent());
+	output->SetSpacing(input->GetSpacing());
+	output->SetOrigin(input->GetOrigin());
+	output->AllocateScalars(scalarType, components);
+	return output;
+}
+
+vtkIdType getSliceSize(vtkImageDataPtr image)
+{
+	int* dim = image->GetDimensions();
+	return vtkIdType(dim[0])*dim[1];
+}
+
+template<class T>
+void luminanceSlices(const T* input, T* output, vtkIdType sliceSize, int components, int zBegin, int zEnd)
+{
+	const T* in = input + sliceSize*zBegin*components;
+	T* out = output + sliceSize*zBegin;
+	vtkIdType count = sliceSize*(zEnd-zBegin);
+	for (vtkIdType i=0; i<count; ++i, in+=components)
+	{
+		// same operations and precision as vtkImageLuminance
+		float luminance = 0.30 * in[0];
+		luminance += 0.59 * in[1];
+		luminance += 0.11 * in[2];
+		out[i] = static_cast<T>(luminance);
+	}
+}
+
+template<class T>
+void luminance(vtkImageDataPtr input, vtkImageDataPtr output)
+{
+	const T* in = static_cast<const T*>(input->GetScalarPointer());
+	T* out = static_cast<T*>(output->GetScalarPointer());
+	parallelFor(0, input->GetDimensions()[2],
+				boost::bind(&luminanceSlices<T>, in, out, getSliceSize(input), input->GetNumberOfScalarComponents(), _1, _2));
+}
+
+template<class T>
+void shiftScaleSlices(const T* input, unsigned char* output, vtkIdType sliceValues, double shift, double scale, int zBegin, int zEnd)
+{
+	vtkIdType end = sliceValues*zEnd;
+	for (vtkIdType i=sliceValues*zBegin; i<end; ++i)
+	{
+		// same operations as vtkImageShiftScale with ClampOverflow on
+		double value = (static_cast<double>(input[i]) + shift) * scale;
+		value = std::min(std::max(value, 0.0), 255.0);
+		output[i] = static_cast<unsigned char>(value);
+	}
+}
+
+template<class T>
+void shiftScale(vtkImageDataPtr input, vtkImageDataPtr output, double shift, double scale)
+{
+	const T* in = static_cast<const T*>(input->GetScalarPointer());
+	unsigned char* out = static_cast<unsigned char*>(output->GetScalarPointer());
+	vtkIdType sliceValues = getSliceSize(input)*input->GetNumberOfScalarComponents();
+	parallelFor(0, input->GetDimensions()[2],
+				boost::bind(&shiftScaleSlices<T>, in, out, sliceValues, shift, scale, _1, _2));
+}
+
+template<class T>
+void rgbMaxSlices(const T* input, std::vector<double>* sliceMax, vtkIdType sliceSize, int components, int zBegin, int zEnd)
+{
+	for (int z=zBegin; z<zEnd; ++z)
+	{
+		const T* ptr = input + sliceSize*z*components;
+		double max = 0;
+		for (vtkIdType i=0; i<sliceSize; ++i, ptr+=components)
+			max = std::max(max, double(ptr[0]) + double(ptr[1]) + double(ptr[2]));
+		(*sliceMax)[z] = max;
+	}
+}
+
+template<class T>
+int rgbMax(vtkImageDataPtr input)
+{
+	int depth = input->GetDimensions()[2];
+	std::vector<double> sliceMax(depth, 0);
+	const T* in = static_cast<const T*>(input->GetScalarPointer());
+	parallelFor(0, depth, boost::bind(&rgbMaxSlices<T>, in, &sliceMax, getSliceSize(input), input->GetNumberOfScalarComponents(), _1, _2));
+
+	double max = 0;
+	for (unsigned i=0; i<sliceMax.size(); ++i)
+		max = std::max(max, sliceMax[i]);
+	return int(max)/3;
+}
+
+} // namespace
+
+bool GrayScaleImageConverter::canConvert(vtkImageDataPtr input)
+{
+	if (!input)
+		return false;
+	switch (input->GetScalarType())
+	{
+	case VTK_UNSIGNED_CHAR:
+	case VTK_UNSIGNED_SHORT:
+	case VTK_SHORT:
+	case VTK_FLOAT:
+		return true;
+	default:
+		return false;
+	}
+}
+
+vtkImageDataPtr GrayScaleImageConverter::toGrayScale(vtkImageDataPtr input)
+{
+	if (!canConvert(input))
+		return vtkImageDataPtr();
+	if (input->GetNumberOfScalarComponents() < 3)
+		return input;
+
+	vtkImageDataPtr output = createOutput(input, input->GetScalarType(), 1);
+	switch (input->GetScalarType())
+	{
+	case VTK_UNSIGNED_CHAR: luminance<unsigned char>(input, output); break;
+	case VTK_UNSIGNED_SHORT: luminance<unsigned short>(input, output); break;
+	case VTK_SHORT: luminance<short>(input, output); break;
+	case VTK_FLOAT: luminance<float>(input, output); break;
+	}
+	return output;
+}
+
+vtkImageDataPtr GrayScaleImageConverter::to8bit(vtkImageDataPtr input, double shift, double scale)
+{
+	if (!canConvert(input))
+		return vtkImageDataPtr();
+
+	vtkImageDataPtr output = createOutput(input, VTK_UNSIGNED_CHAR, input->GetNumberOfScalarComponents());
+	switch (input->GetScalarType())
+	{
+	case VTK_UNSIGNED_CHAR: shiftScale<unsigned char>(input, output, shift, scale); break;
+	case VTK_UNSIGNED_SHORT: shiftScale<unsigned short>(input, output, shift, scale); break;
+	case VTK_SHORT: shiftScale<short>(input, output, shift, scale); break;
+	case VTK_FLOAT: shiftScale<float>(input, output, shift, scale); break;
+	}
+	return output;
+}
+
+int GrayScaleImageConverter::findRGBMax(vtkImageDataPtr input)
+{
+	if (!canConvert(input) || input->GetNumberOfScalarComponents() < 3)
+		return 0;
+
+	switch (input->GetScalarType())
+	{
+	case VTK_UNSIGNED_CHAR: return rgbMax<unsigned char>(input);
+	case VTK_UNSIGNED_SHORT: return rgbMax<unsigned short>(input);
+	case VTK_SHORT: return rgbMax<short>(input);
+	case VTK_FLOAT: return rgbMax<float>(input);
+	}
+	return 0;
+}
+
+} // namespace cx
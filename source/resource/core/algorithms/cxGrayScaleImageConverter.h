@@ -0,0 +1,58 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#ifndef CXGRAYSCALEIMAGECONVERTER_H_
+#define CXGRAYSCALEIMAGECONVERTER_H_
+
+#include "cxResourceExport.h"
+
+#include "vtkForwardDeclarations.h"
+
+namespace cx
+{
+
+/** \brief Multithreaded grayscale and 8 bit conversion of images.
+ *
+ * Replaces the VTK filter chains used by Image and USFrameData for the
+ * common scalar types unsigned char, unsigned short, short and float.
+ * The results are identical to the filters they replace:
+ *  - toGrayScale(): vtkImageLuminance on the first three components.
+ *  - to8bit(): vtkImageShiftScale with clamping to unsigned char.
+ *
+ * The volume is split into z slabs that are converted in parallel. The
+ * inner loops are plain arrays without branches on the scalar type, and
+ * are left to the compiler to vectorize.
+ *
+ * \ingroup cx_resource_core_algorithms
+ * \date Oct 19, 2026
+ */
+class cxResource_EXPORT GrayScaleImageConverter
+{
+public:
+	static bool canConvert(vtkImageDataPtr input); ///< true if the scalar type is handled here
+
+	/** Return the luminance 0.30R+0.59G+0.11B of an image with 3 or 4 components,
+	 *  in the scalar type of the input. Other images are returned unchanged.
+	 *  Return null for unsupported scalar types.
+	 */
+	static vtkImageDataPtr toGrayScale(vtkImageDataPtr input);
+
+	/** Return unsigned char data, clamp((input+shift)*scale), truncated.
+	 *  Return null for unsupported scalar types.
+	 */
+	static vtkImageDataPtr to8bit(vtkImageDataPtr input, double shift, double scale);
+
+	/** Return the max of (R+G+B)/3 over an image with 3 or 4 components. */
+	static int findRGBMax(vtkImageDataPtr input);
+};
+
+} // namespace cx
+
+#endif /* CXGRAYSCALEIMAGECONVERTER_H_ */
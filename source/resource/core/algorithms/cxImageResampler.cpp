@@ -0,0 +1,220 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#include "cxImageResampler.h"
+
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <boost/bind.hpp>
+#include <vtkImageData.h>
+#include "cxParallelFor.h"
+#include "cxLogger.h"
+
+namespace cx
+{
+
+namespace
+{
+
+/** Sample positions along one axis: output voxel i is the sum over the taps k
+ *  of weight[k][i] * input[index[k][i]].
+ */
+struct AxisSamples
+{
+	int taps;
+	std::vector<int> index[4];
+	std::vector<double> weight[4];
+};
+
+AxisSamples createAxisSamples(int inDim, int outDim, double factor, ImageResampler::INTERPOLATION interpolation)
+{
+	AxisSamples retval;
+	retval.taps = (interpolation==ImageResampler::iNEAREST) ? 1 : ((interpolation==ImageResampler::iLINEAR) ? 2 : 4);
+	for (int k=0; k<retval.taps; ++k)
+	{
+		retval.index[k].resize(outDim);
+		retval.weight[k].resize(outDim);
+	}
+
+	for (int i=0; i<outDim; ++i)
+	{
+		double p = std::min(i/factor, double(inDim-1));
+		double w[4] = {1, 0, 0, 0};
+		int first = 0;
+
+		if (interpolation==ImageResampler::iNEAREST)
+		{
+			first = int(std::floor(p+0.5));
+		}
+		else if (interpolation==ImageResampler::iLINEAR)
+		{
+			first = int(std::floor(p));
+			double t = p-first;
+			w[0] = 1-t;
+			w[1] = t;
+		}
+		else
+		{
+			int i0 = int(std::floor(p));
+			double t = p-i0;
+			first = i0-1;
+			w[0] = ((-0.5*t + 1.0)*t - 0.5)*t;
+			w[1] = (1.5*t - 2.5)*t*t + 1.0;
+			w[2] = ((-1.5*t + 2.0)*t + 0.5)*t;
+			w[3] = (0.5*t - 0.5)*t*t;
+		}
+
+		for (int k=0; k<retval.taps; ++k)
+		{
+			retval.index[k][i] = std::max(0, std::min(inDim-1, first+k));
+			retval.weight[k][i] = w[k];
+		}
+	}
+	return retval;
+}
+
+template<class T>
+inline T convertToScalar(double value)
+{
+	if (!std::numeric_limits<T>::is_integer)
+		return static_cast<T>(value);
+	value = std::floor(value + 0.5);
+	value = std::max<double>(value, std::numeric_limits<T>::min());
+	value = std::min<double>(value, std::numeric_limits<T>::max());
+	return static_cast<T>(value);
+}
+
+/** Accumulate weight*src into dst. Kept as a plain loop over contiguous
+ *  memory so the compiler can vectorize it.
+ */
+template<class S>
+inline void addWeighted(double* dst, const S* src, double weight, size_t count)
+{
+	for (size_t i=0; i<count; ++i)
+		dst[i] += weight*src[i];
+}
+
+/** Resample the output z slices [zBegin,zEnd>.
+ */
+template<class T>
+void resampleSlices(const T* input, T* output, Eigen::Array3i inDim, Eigen::Array3i outDim, int components,
+					const AxisSamples* x, const AxisSamples* y, const AxisSamples* z, int zBegin, int zEnd)
+{
+	size_t inRow = size_t(inDim[0])*components;
+	size_t inSlice = inRow*inDim[1];
+	size_t outRow = size_t(outDim[0])*components;
+	size_t outSlice = outRow*outDim[1];
+
+	std::vector<double> zPlane(inSlice); // input slice interpolated along z
+	std::vector<double> yPlane(inRow*outDim[1]); // then along y
+
+	for (int k=zBegin; k<zEnd; ++k)
+	{
+		std::fill(zPlane.begin(), zPlane.end(), 0);
+		for (int t=0; t<z->taps; ++t)
+			if (z->weight[t][k] != 0)
+				addWeighted(&zPlane[0], input + z->index[t][k]*inSlice, z->weight[t][k], inSlice);
+
+		std::fill(yPlane.begin(), yPlane.end(), 0);
+		for (int j=0; j<outDim[1]; ++j)
+			for (int t=0; t<y->taps; ++t)
+				if (y->weight[t][j] != 0)
+					addWeighted(&yPlane[j*inRow], &zPlane[y->index[t][j]*inRow], y->weight[t][j], inRow);
+
+		T* dst = output + k*outSlice;
+		for (int j=0; j<outDim[1]; ++j)
+		{
+			const double* src = &yPlane[j*inRow];
+			for (int i=0; i<outDim[0]; ++i)
+			{
+				for (int c=0; c<components; ++c)
+				{
+					double value = 0;
+					for (int t=0; t<x->taps; ++t)
+						value += x->weight[t][i] * src[x->index[t][i]*components + c];
+					*dst++ = convertToScalar<T>(value);
+				}
+			}
+		}
+	}
+}
+
+}
+
+ImageResampler::ImageResampler() :
+	mInterpolation(iLINEAR),
+	mFactors(1, 1, 1)
+{
+}
+
+Eigen::Array3i ImageResampler::getOutputDimensions(vtkImageDataPtr input) const
+{
+	Eigen::Array3i inDim(input->GetDimensions());
+	Eigen::Array3i retval;
+	for (int i=0; i<3; ++i)
+		retval[i] = std::max(1, int(std::floor((inDim[i]-1)*mFactors[i] + 1.0E-6)) + 1);
+	return retval;
+}
+
+vtkImageDataPtr ImageResampler::execute(vtkImageDataPtr input) const
+{
+	if (!input)
+		return vtkImageDataPtr();
+
+	Eigen::Array3i inDim(input->GetDimensions());
+	Eigen::Array3i outDim = this->getOutputDimensions(input);
+	int components = input->GetNumberOfScalarComponents();
+	Vector3D inSpacing(input->GetSpacing());
+	Vector3D origin(input->GetOrigin());
+	int* inExtent = input->GetExtent();
+	for (int i=0; i<3; ++i)
+		origin[i] += inExtent[2*i]*inSpacing[i];
+
+	vtkImageDataPtr output = vtkImageDataPtr::New();
+	output->SetExtent(0, outDim[0]-1, 0, outDim[1]-1, 0, outDim[2]-1);
+	output->SetSpacing(inSpacing[0]/mFactors[0], inSpacing[1]/mFactors[1], inSpacing[2]/mFactors[2]);
+	output->SetOrigin(origin.data());
+	output->AllocateScalars(input->GetScalarType(), components);
+
+	AxisSamples x = createAxisSamples(inDim[0], outDim[0], mFactors[0], mInterpolation);
+	AxisSamples y = createAxisSamples(inDim[1], outDim[1], mFactors[1], mInterpolation);
+	AxisSamples z = createAxisSamples(inDim[2], outDim[2], mFactors[2], mInterpolation);
+
+	void* inPtr = input->GetScalarPointer();
+	void* outPtr = output->GetScalarPointer();
+
+#define CX_RESAMPLE_CASE(VTK_TYPE, TYPE) \
+	case VTK_TYPE: \
+		parallelFor(0, outDim[2], boost::bind(&resampleSlices<TYPE>, static_cast<const TYPE*>(inPtr), static_cast<TYPE*>(outPtr), \
+											  inDim, outDim, components, &x, &y, &z, _1, _2)); \
+		break;
+
+	switch (input->GetScalarType())
+	{
+	CX_RESAMPLE_CASE(VTK_CHAR, char)
+	CX_RESAMPLE_CASE(VTK_SIGNED_CHAR, signed char)
+	CX_RESAMPLE_CASE(VTK_UNSIGNED_CHAR, unsigned char)
+	CX_RESAMPLE_CASE(VTK_SHORT, short)
+	CX_RESAMPLE_CASE(VTK_UNSIGNED_SHORT, unsigned short)
+	CX_RESAMPLE_CASE(VTK_INT, int)
+	CX_RESAMPLE_CASE(VTK_UNSIGNED_INT, unsigned int)
+	CX_RESAMPLE_CASE(VTK_FLOAT, float)
+	CX_RESAMPLE_CASE(VTK_DOUBLE, double)
+	default:
+		CX_LOG_ERROR() << "ImageResampler: Unhandled scalar type " << input->GetScalarTypeAsString();
+		return vtkImageDataPtr();
+	}
+#undef CX_RESAMPLE_CASE
+
+	return output;
+}
+
+} // namespace cx
@@ -0,0 +1,436 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#include "cxImageStatistics.h"
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <boost/bind.hpp>
+#include <vtkImageData.h>
+#include <vtkPointData.h>
+#include <vtkDataArray.h>
+#include "cxParallelFor.h"
+#include "cxLogger.h"
+
+namespace cx
+{
+
+namespace
+{
+const int gMaxBinCount = 1<<20;
+const int gMaxSlabCount = 16;
+const long long gMaxSlabHistogramBytes = 16*1024*1024;
+
+struct SlabAccumulator
+{
+	double min;
+	double max;
+	double sum;
+	long long count;
+	long long outOfBins;
+};
+
+template<class T>
+void accumulateVoxels(const T* ptr, size_t voxelCount, int components,
+					  double binOrigin, double binSpacing, int binCount, bool ignoreZero,
+					  unsigned int* histogram, SlabAccumulator* acc)
+{
+	double minVal = std::numeric_limits<double>::max();
+	double maxVal = -std::numeric_limits<double>::max();
+	double sum = 0;
+	long long count = 0;
+	long long outOfBins = 0;
+	double invSpacing = 1.0/binSpacing;
+
+	for (size_t i=0; i<voxelCount; ++i, ptr+=components)
+	{
+		double value = *ptr;
+		if (!std::isfinite(value)) // NaN and +-inf
+			continue;
+		minVal = std::min(minVal, value);
+		maxVal = std::max(maxVal, value);
+		sum += value;
+		++count;
+
+		if (!histogram)
+			continue;
+		if (ignoreZero && value==0)
+			continue;
+		double bin = std::floor((value-binOrigin)*invSpacing);
+		if (bin<0 || bin>=binCount) // before int conversion: value can be far outside the bins
+		{
+			++outOfBins;
+			continue;
+		}
+		++histogram[static_cast<int>(bin)];
+	}
+
+	acc->min = minVal;
+	acc->max = maxVal;
+	acc->sum = sum;
+	acc->count = count;
+	acc->outOfBins = outOfBins;
+}
+
+/** Run accumulateVoxels on the z-range [zBegin,zEnd> of image.
+ */
+void accumulateSlices(vtkImageDataPtr image, int zBegin, int zEnd,
+					  double binOrigin, double binSpacing, int binCount, bool ignoreZero,
+					  unsigned int* histogram, SlabAccumulator* acc)
+{
+	int* dim = image->GetDimensions();
+	int components = image->GetNumberOfScalarComponents();
+	size_t sliceSize = size_t(dim[0])*dim[1];
+	size_t offset = sliceSize*zBegin*components;
+	size_t voxelCount = sliceSize*(zEnd-zBegin);
+	void* data = image->GetScalarPointer();
+
+#define CX_ACCUMULATE_CASE(VTK_TYPE, TYPE) \
+	case VTK_TYPE: \
+		accumulateVoxels(static_cast<TYPE*>(data)+offset, voxelCount, components, binOrigin, binSpacing, binCount, ignoreZero, histogram, acc); \
+		break;
+
+	switch (image->GetScalarType())
+	{
+	CX_ACCUMULATE_CASE(VTK_CHAR, char)
+	CX_ACCUMULATE_CASE(VTK_SIGNED_CHAR, signed char)
+	CX_ACCUMULATE_CASE(VTK_UNSIGNED_CHAR, unsigned char)
+	CX_ACCUMULATE_CASE(VTK_SHORT, short)
+	CX_ACCUMULATE_CASE(VTK_UNSIGNED_SHORT, unsigned short)
+	CX_ACCUMULATE_CASE(VTK_INT, int)
+	CX_ACCUMULATE_CASE(VTK_UNSIGNED_INT, unsigned int)
+	CX_ACCUMULATE_CASE(VTK_FLOAT, float)
+	CX_ACCUMULATE_CASE(VTK_DOUBLE, double)
+	default:
+		CX_LOG_ERROR() << "ImageStatistics: Unhandled scalar type " << image->GetScalarTypeAsString();
+		acc->min = 0;
+		acc->max = 0;
+		acc->sum = 0;
+		acc->count = 0;
+		acc->outOfBins = 0;
+		break;
+	}
+#undef CX_ACCUMULATE_CASE
+}
+
+void accumulateSliceRanges(vtkImageDataPtr image, std::vector<SlabAccumulator>* slices, int begin, int end)
+{
+	for (int z=begin; z<end; ++z)
+		accumulateSlices(image, z, z+1, 0, 1, 0, false, NULL, &slices->at(z));
+}
+
+void sumHistograms(const std::vector<std::vector<unsigned int>* >* input, std::vector<unsigned int>* output, int begin, int end)
+{
+	for (int i=begin; i<end; ++i)
+	{
+		unsigned int sum = 0;
+		for (unsigned j=0; j<input->size(); ++j)
+			sum += (*input->at(j))[i];
+		(*output)[i] = sum;
+	}
+}
+
+} // namespace
+
+
+ImageStatistics::ImageStatistics() :
+	mIgnoreZero(false),
+	mImage(NULL),
+	mImageMTime(0),
+	mScalarType(0),
+	mBinOrigin(0),
+	mBinSpacing(1),
+	mBinCount(0),
+	mComputedSlabCount(0)
+{
+	mDim[0] = mDim[1] = mDim[2] = 0;
+	this->invalidate();
+}
+
+void ImageStatistics::setIgnoreZeroInHistogram(bool on)
+{
+	if (mIgnoreZero == on)
+		return;
+	mIgnoreZero = on;
+	this->invalidate();
+}
+
+void ImageStatistics::invalidate()
+{
+	mValid = false;
+	mImage = NULL;
+	mSlabs.clear();
+	mMin = 0;
+	mMax = 0;
+	mSum = 0;
+	mCount = 0;
+	mHistogram.clear();
+	mHistogramOrigin = 0;
+	mHistogramTotal = 0;
+}
+
+double ImageStatistics::getMean() const
+{
+	if (mCount==0)
+		return 0;
+	return mSum/mCount;
+}
+
+double ImageStatistics::getPercentile(double fraction) const
+{
+	if (mHistogramTotal==0)
+		return mMin;
+
+	double target = std::max(0.0, std::min(1.0, fraction)) * mHistogramTotal;
+	long long cumulative = 0;
+	for (unsigned i=0; i<mHistogram.size(); ++i)
+	{
+		cumulative += mHistogram[i];
+		if (cumulative > 0 && cumulative >= target)
+			return mHistogramOrigin + i*mBinSpacing;
+	}
+	return mHistogramOrigin + (mHistogram.size()-1)*mBinSpacing;
+}
+
+unsigned int ImageStatistics::getHistogramCount(double value) const
+{
+	int bin = static_cast<int>(std::floor((value-mHistogramOrigin)/mBinSpacing));
+	if (bin<0 || bin>=int(mHistogram.size()))
+		return 0;
+	return mHistogram[bin];
+}
+
+unsigned int ImageStatistics::getMaxHistogramCount() const
+{
+	if (mHistogram.empty())
+		return 0;
+	return *std::max_element(mHistogram.begin(), mHistogram.end());
+}
+
+bool ImageStatistics::sameImageLayout(vtkImageDataPtr image) const
+{
+	if (!mValid || image.GetPointer()!=mImage)
+		return false;
+	int* dim = image->GetDimensions();
+	return (dim[0]==mDim[0]) && (dim[1]==mDim[1]) && (dim[2]==mDim[2])
+			&& (image->GetScalarType()==mScalarType);
+}
+
+void ImageStatistics::update(vtkImageDataPtr image)
+{
+	if (!image)
+	{
+		this->invalidate();
+		return;
+	}
+	if (this->sameImageLayout(image) && image->GetMTime()==mImageMTime)
+		return;
+	this->fullUpdate(image);
+}
+
+void ImageStatistics::updateExtent(vtkImageDataPtr image, const IntBoundingBox3D& extent)
+{
+	if (!image || !this->sameImageLayout(image))
+	{
+		this->update(image);
+		return;
+	}
+
+	int zOffset = image->GetExtent()[4];
+	int z0 = std::max(0, extent[4]-zOffset);
+	int z1 = std::min(mDim[2]-1, extent[5]-zOffset);
+
+	std::vector<int> changed;
+	for (unsigned i=0; i<mSlabs.size(); ++i)
+		if (mSlabs[i].zBegin <= z1 && mSlabs[i].zEnd > z0)
+			changed.push_back(i);
+
+	this->computeSlabs(image, changed, false);
+
+	for (unsigned i=0; i<changed.size(); ++i)
+	{
+		if (mSlabs[changed[i]].outOfBins)
+		{
+			// new values outside of the histogram range: must rebin everything.
+			this->fullUpdate(image);
+			return;
+		}
+	}
+
+	this->merge();
+	mImageMTime = image->GetMTime();
+}
+
+void ImageStatistics::fullUpdate(vtkImageDataPtr image)
+{
+	this->invalidate();
+
+	image->GetDimensions(mDim);
+	mScalarType = image->GetScalarType();
+	if (!image->GetPointData()->GetScalars() || mDim[0]*mDim[1]*mDim[2]==0)
+		return;
+
+	if (!this->computeBinsFromType(mScalarType))
+		this->computeBinsFromRange(image);
+
+	this->createSlabs(image);
+
+	std::vector<int> all(mSlabs.size());
+	for (unsigned i=0; i<all.size(); ++i)
+		all[i] = i;
+	this->computeSlabs(image, all, false);
+
+	mImage = image.GetPointer();
+	mImageMTime = image->GetMTime();
+	mValid = true;
+	this->merge();
+}
+
+/** Small integer types get one bin per possible value,
+ *  the histogram is then valid for any modification of the image.
+ */
+bool ImageStatistics::computeBinsFromType(int scalarType)
+{
+	switch (scalarType)
+	{
+	case VTK_CHAR:
+	case VTK_SIGNED_CHAR:
+	case VTK_UNSIGNED_CHAR:
+	case VTK_SHORT:
+	case VTK_UNSIGNED_SHORT:
+		break;
+	default:
+		return false;
+	}
+
+	double typeMin = vtkDataArray::GetDataTypeMin(scalarType);
+	double typeMax = vtkDataArray::GetDataTypeMax(scalarType);
+	mBinOrigin = typeMin;
+	mBinSpacing = 1;
+	mBinCount = int(typeMax - typeMin) + 1;
+	return true;
+}
+
+/** Larger types get bins covering the current value range,
+ *  found using a parallel range-only pass.
+ */
+void ImageStatistics::computeBinsFromRange(vtkImageDataPtr image)
+{
+	std::vector<SlabAccumulator> slices(mDim[2]);
+	parallelFor(0, mDim[2], boost::bind(&accumulateSliceRanges, image, &slices, _1, _2));
+
+	double minVal = std::numeric_limits<double>::max();
+	double maxVal = -std::numeric_limits<double>::max();
+	for (unsigned i=0; i<slices.size(); ++i)
+	{
+		if (!slices[i].count)
+			continue;
+		minVal = std::min(minVal, slices[i].min);
+		maxVal = std::max(maxVal, slices[i].max);
+	}
+	if (minVal > maxVal)
+		minVal = maxVal = 0;
+
+	mBinOrigin = std::floor(minVal);
+	double range = std::floor(maxVal) - mBinOrigin + 1;
+	mBinSpacing = std::max(1.0, std::ceil(range/gMaxBinCount));
+	if (!std::isfinite(mBinSpacing)) // range overflows for values near the double limits
+		mBinSpacing = std::numeric_limits<double>::max();
+	double binCount = std::floor((maxVal-mBinOrigin)/mBinSpacing) + 1;
+	mBinCount = int(std::max(1.0, std::min<double>(gMaxBinCount, binCount)));
+}
+
+void ImageStatistics::createSlabs(vtkImageDataPtr image)
+{
+	long long histogramBytes = (long long)(mBinCount)*sizeof(unsigned int);
+	int slabCount = std::min(gMaxSlabCount, mDim[2]);
+	slabCount = std::min<long long>(slabCount, std::max<long long>(1, gMaxSlabHistogramBytes/histogramBytes));
+	slabCount = std::max(1, slabCount);
+
+	mSlabs.resize(slabCount);
+	for (int i=0; i<slabCount; ++i)
+	{
+		Slab& slab = mSlabs[i];
+		slab.zBegin = (long long)(mDim[2])*i/slabCount;
+		slab.zEnd = (long long)(mDim[2])*(i+1)/slabCount;
+		slab.min = 0;
+		slab.max = 0;
+		slab.sum = 0;
+		slab.count = 0;
+		slab.outOfBins = 0;
+		slab.histogram.assign(mBinCount, 0);
+	}
+}
+
+void ImageStatistics::computeSlabs(vtkImageDataPtr image, const std::vector<int>& slabIndices, bool rangeOnly)
+{
+	parallelFor(0, slabIndices.size(),
+				boost::bind(&ImageStatistics::computeSlabRange, this, image, &slabIndices, rangeOnly, _1, _2));
+	mComputedSlabCount += slabIndices.size();
+}
+
+void ImageStatistics::computeSlabRange(vtkImageDataPtr image, const std::vector<int>* slabIndices, bool rangeOnly, int begin, int end)
+{
+	for (int i=begin; i<end; ++i)
+	{
+		Slab& slab = mSlabs[slabIndices->at(i)];
+		unsigned int* histogram = NULL;
+		if (!rangeOnly)
+		{
+			std::fill(slab.histogram.begin(), slab.histogram.end(), 0);
+			histogram = &slab.histogram[0];
+		}
+
+		SlabAccumulator acc;
+		accumulateSlices(image, slab.zBegin, slab.zEnd, mBinOrigin, mBinSpacing, mBinCount, mIgnoreZero, histogram, &acc);
+		slab.min = acc.min;
+		slab.max = acc.max;
+		slab.sum = acc.sum;
+		slab.count = acc.count;
+		slab.outOfBins = acc.outOfBins;
+	}
+}
+
+void ImageStatistics::merge()
+{
+	mMin = std::numeric_limits<double>::max();
+	mMax = -std::numeric_limits<double>::max();
+	mSum = 0;
+	mCount = 0;
+	std::vector<std::vector<unsigned int>* > histograms;
+	for (unsigned i=0; i<mSlabs.size(); ++i)
+	{
+		histograms.push_back(&mSlabs[i].histogram);
+		if (!mSlabs[i].count)
+			continue;
+		mMin = std::min(mMin, mSlabs[i].min);
+		mMax = std::max(mMax, mSlabs[i].max);
+		mSum += mSlabs[i].sum;
+		mCount += mSlabs[i].count;
+	}
+	if (!mCount)
+		mMin = mMax = 0;
+
+	std::vector<unsigned int> total(mBinCount);
+	parallelFor(0, mBinCount, boost::bind(&sumHistograms, &histograms, &total, _1, _2), 4096);
+
+	// trim the histogram to the actual value range
+	int first = std::max(0, int(std::floor((mMin-mBinOrigin)/mBinSpacing)));
+	int last = std::min(mBinCount-1, int(std::floor((mMax-mBinOrigin)/mBinSpacing)));
+	mHistogram.assign(total.begin()+first, total.begin()+std::max(first, last+1));
+	mHistogramOrigin = mBinOrigin + first*mBinSpacing;
+
+	mHistogramTotal = 0;
+	for (unsigned i=0; i<mHistogram.size(); ++i)
+		mHistogramTotal += mHistogram[i];
+}
+
+} // namespace cx
@@ -0,0 +1,128 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#ifndef CXIMAGESTATISTICS_H_
+#define CXIMAGESTATISTICS_H_
+
+#include "cxResourceExport.h"
+
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include "vtkForwardDeclarations.h"
+#include "cxBoundingBox3D.h"
+
+namespace cx
+{
+
+typedef boost::shared_ptr<class ImageStatistics> ImageStatisticsPtr;
+
+/** \brief Histogram, range, mean and percentiles of an image.
+ *
+ * All statistics are computed in one parallel pass over the first scalar
+ * component. The volume is split into slabs along z, each slab keeping
+ * its own partial result. The merged result is cached and keyed on the
+ * image modification time, thus calling update() on an unchanged image is free.
+ *
+ * When only a part of the image has changed, updateExtent() recomputes the
+ * slabs intersecting the changed extent only.
+ *
+ * Histogram bins have unit width, starting at floor(min), except when the
+ * value range of float/int data is too large: Then the bin width is increased.
+ *
+ * NaN and infinite values are ignored.
+ *
+ * \ingroup cx_resource_core_algorithms
+ * \date 2026-10-19
+ */
+class cxResource_EXPORT ImageStatistics
+{
+public:
+	static ImageStatisticsPtr create() { return ImageStatisticsPtr(new ImageStatistics()); }
+	ImageStatistics();
+
+	/** Exclude zero-valued voxels from the histogram and percentiles.
+	 * min, max and mean still includes all voxels. */
+	void setIgnoreZeroInHistogram(bool on);
+
+	/** Recompute if image or its modification time has changed since last update. */
+	void update(vtkImageDataPtr image);
+	/** Recompute statistics for the part of image inside extent only, assuming
+	 *  the rest of the image is unchanged since the last update.
+	 *  Falls back to a full update if this is not possible. */
+	void updateExtent(vtkImageDataPtr image, const IntBoundingBox3D& extent);
+	/** Force a full recomputation on the next update. */
+	void invalidate();
+
+	bool isValid() const { return mValid; }
+	double getMin() const { return mMin; }
+	double getMax() const { return mMax; }
+	double getMean() const;
+	long long getVoxelCount() const { return mCount; }
+
+	/** Value below which the given fraction [0,1] of the histogram voxels are found. */
+	double getPercentile(double fraction) const;
+
+	const std::vector<unsigned int>& getHistogram() const { return mHistogram; } ///< bin i contains values in [origin+i*spacing, origin+(i+1)*spacing>
+	double getHistogramOrigin() const { return mHistogramOrigin; }
+	double getHistogramSpacing() const { return mBinSpacing; }
+	unsigned int getHistogramCount(double value) const; ///< number of voxels in the bin containing value
+	unsigned int getMaxHistogramCount() const; ///< number of voxels in the largest bin
+	long long getHistogramTotal() const { return mHistogramTotal; } ///< number of voxels in the histogram
+
+	unsigned long getComputedSlabCount() const { return mComputedSlabCount; } ///< number of slab computations so far, for testing.
+
+private:
+	struct Slab
+	{
+		int zBegin;
+		int zEnd;
+		double min;
+		double max;
+		double sum;
+		long long count;
+		long long outOfBins;
+		std::vector<unsigned int> histogram;
+	};
+
+	void fullUpdate(vtkImageDataPtr image);
+	void createSlabs(vtkImageDataPtr image);
+	bool computeBinsFromType(int scalarType);
+	void computeBinsFromRange(vtkImageDataPtr image);
+	void computeSlabs(vtkImageDataPtr image, const std::vector<int>& slabIndices, bool rangeOnly);
+	void computeSlabRange(vtkImageDataPtr image, const std::vector<int>* slabIndices, bool rangeOnly, int begin, int end);
+	void merge();
+	bool sameImageLayout(vtkImageDataPtr image) const;
+
+	bool mIgnoreZero;
+	bool mValid;
+	vtkImageData* mImage; ///< identity of the last image, not owned
+	unsigned long mImageMTime;
+	int mDim[3];
+	int mScalarType;
+
+	double mBinOrigin; ///< value of bin 0 in the slab histograms
+	double mBinSpacing;
+	int mBinCount;
+	std::vector<Slab> mSlabs;
+
+	double mMin;
+	double mMax;
+	double mSum;
+	long long mCount;
+	std::vector<unsigned int> mHistogram;
+	double mHistogramOrigin;
+	long long mHistogramTotal;
+	unsigned long mComputedSlabCount;
+};
+
+} // namespace cx
+
+#endif /* CXIMAGESTATISTICS_H_ */
@@ -0,0 +1,63 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#include "cxParallelFor.h"
+
+#include <vector>
+#include <algorithm>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentMap>
+
+namespace cx
+{
+
+namespace
+{
+typedef std::pair<int, int> IndexRange;
+
+struct RangeTask
+{
+	typedef void result_type;
+	RangeTask(boost::function<void(int, int)> body) : mBody(body) {}
+	void operator()(const IndexRange& range) const { mBody(range.first, range.second); }
+	boost::function<void(int, int)> mBody;
+};
+} // namespace
+
+int getParallelForThreadCount()
+{
+	return std::max(1, QThreadPool::globalInstance()->maxThreadCount());
+}
+
+void parallelFor(int begin, int end, boost::function<void(int, int)> body, int minChunkSize)
+{
+	int size = end - begin;
+	if (size <= 0)
+		return;
+
+	// a few chunks per thread gives load balancing when ranges have different cost.
+	int chunks = std::min(4*getParallelForThreadCount(), size/std::max(1, minChunkSize));
+	if (chunks <= 1)
+	{
+		body(begin, end);
+		return;
+	}
+
+	std::vector<IndexRange> ranges(chunks);
+	for (int i=0; i<chunks; ++i)
+	{
+		ranges[i].first = begin + (long long)(size)*i/chunks;
+		ranges[i].second = begin + (long long)(size)*(i+1)/chunks;
+	}
+
+	QtConcurrent::blockingMap(ranges, RangeTask(body));
+}
+
+} // namespace cx
@@ -0,0 +1,51 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#ifndef CXPARALLELFOR_H_
+#define CXPARALLELFOR_H_
+
+#include "cxResourceExport.h"
+
+#include <boost/function.hpp>
+
+namespace cx
+{
+
+/**
+ * \file
+ *
+ * Helpers for splitting loops over images and point sets into ranges
+ * that are processed in parallel on the global QThreadPool.
+ *
+ * \addtogroup cx_resource_core_algorithms
+ * @{
+ */
+
+/** Call body(rangeBegin, rangeEnd) for disjoint subranges covering [begin, end),
+ *  in parallel on the global thread pool. Blocks until all ranges are processed.
+ *
+ *  The range is split into a few chunks per thread, each at least minChunkSize
+ *  long. If only one chunk results, body is called directly in the calling thread.
+ *  body must be safe to call concurrently for disjoint ranges.
+ */
+cxResource_EXPORT void parallelFor(int begin, int end, boost::function<void(int, int)> body, int minChunkSize = 1);
+
+/** Number of threads used by parallelFor().
+ */
+cxResource_EXPORT int getParallelForThreadCount();
+
+/**
+ * @}
+ */
+
+} // namespace cx
+
+#endif /* CXPARALLELFOR_H_ */
@@ -0,0 +1,212 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#include "cxUnsignedImageConverter.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include <boost/bind.hpp>
+#include <vtkImageData.h>
+
+#include "cxParallelFor.h"
+#include "cxLogger.h"
+
+namespace cx
+{
+
+namespace
+{
+
+struct ConvertRegion
+{
+	int extent[6]; ///< voxel indices relative to the image start, inclusive
+	int dim[3];
+	int components;
+	double shift;
+};
+
+struct SlabRange
+{
+	SlabRange() : min(std::numeric_limits<double>::max()), max(-std::numeric_limits<double>::max()) {}
+	double min;
+	double max;
+};
+
+template<class IN, class OUT>
+void convertSlices(const IN* input, OUT* output, const ConvertRegion* region, std::vector<SlabRange>* ranges, int zBegin, int zEnd)
+{
+	const double outMax = std::numeric_limits<OUT>::max();
+	const double shift = region->shift;
+	const int components = region->components;
+	const int x0 = region->extent[0];
+	const int lineLength = (region->extent[1]-region->extent[0]+1)*components;
+	IN lineMin = std::numeric_limits<IN>::max();
+	IN lineMax = std::numeric_limits<IN>::lowest();
+
+	for (int z=zBegin; z<zEnd; ++z)
+	{
+		for (int y=region->extent[2]; y<=region->extent[3]; ++y)
+		{
+			vtkIdType offset = ((vtkIdType(z)*region->dim[1] + y)*region->dim[0] + x0)*components;
+			const IN* in = input + offset;
+			OUT* out = output + offset;
+			for (int i=0; i<lineLength; ++i)
+			{
+				IN value = in[i];
+				lineMin = std::min(lineMin, value);
+				lineMax = std::max(lineMax, value);
+				double v = double(value) + shift;
+				v = std::min(std::max(v, 0.0), outMax);
+				out[i] = static_cast<OUT>(v);
+			}
+		}
+	}
+
+	SlabRange& range = (*ranges)[zBegin - region->extent[4]];
+	range.min = lineMin;
+	range.max = lineMax;
+}
+
+template<class IN, class OUT>
+void convertRegion(vtkImageData* input, vtkImageData* output, const ConvertRegion& region, std::vector<SlabRange>* ranges)
+{
+	const IN* inPtr = static_cast<const IN*>(input->GetScalarPointer());
+	OUT* outPtr = static_cast<OUT*>(output->GetScalarPointer());
+	// Ranges are stored at the first slice of each chunk, chunk size is at least 1.
+	parallelFor(region.extent[4], region.extent[5]+1,
+				boost::bind(&convertSlices<IN,OUT>, inPtr, outPtr, &region, ranges, _1, _2));
+}
+
+template<class IN>
+bool convertRegionToOutputType(vtkImageData* input, vtkImageData* output, const ConvertRegion& region, std::vector<SlabRange>* ranges)
+{
+	switch (output->GetScalarType())
+	{
+	case VTK_UNSIGNED_SHORT:
+		convertRegion<IN, unsigned short>(input, output, region, ranges);
+		return true;
+	case VTK_UNSIGNED_INT:
+		convertRegion<IN, unsigned int>(input, output, region, ranges);
+		return true;
+	default:
+		return false;
+	}
+}
+
+} // namespace
+
+UnsignedImageConverter::UnsignedImageConverter() :
+	mShift(0),
+	mOutputScalarType(VTK_UNSIGNED_SHORT),
+	mInputMin(0),
+	mInputMax(0)
+{
+}
+
+int UnsignedImageConverter::findOutputScalarType(double min, double max)
+{
+	// unsigned long is not supported by vtk - it seems (crash in rendering)
+	if (max - min <= VTK_UNSIGNED_SHORT_MAX-VTK_UNSIGNED_SHORT_MIN)
+		return VTK_UNSIGNED_SHORT;
+	return VTK_UNSIGNED_INT;
+}
+
+vtkImageDataPtr UnsignedImageConverter::convert(vtkImageDataPtr input)
+{
+	if (!input)
+		return vtkImageDataPtr();
+
+	vtkImageDataPtr output = vtkImageDataPtr::New();
+	output->SetExtent(input->GetExtent());
+	output->SetSpacing(input->GetSpacing());
+	output->SetOrigin(input->GetOrigin());
+	output->AllocateScalars(mOutputScalarType, input->GetNumberOfScalarComponents());
+
+	if (!this->execute(input, output, input->GetExtent()))
+		return vtkImageDataPtr();
+	return output;
+}
+
+bool UnsignedImageConverter::convertExtent(vtkImageDataPtr input, vtkImageDataPtr output, const IntBoundingBox3D& extent)
+{
+	if (!input || !output)
+		return false;
+	int* inExtent = input->GetExtent();
+	int* outExtent = output->GetExtent();
+	if (!std::equal(inExtent, inExtent+6, outExtent))
+		return false;
+	if (input->GetNumberOfScalarComponents() != output->GetNumberOfScalarComponents())
+		return false;
+	if (output->GetScalarType() != mOutputScalarType)
+		return false;
+
+	int clipped[6];
+	for (int i=0; i<3; ++i)
+	{
+		clipped[2*i] = std::max(extent[2*i], inExtent[2*i]);
+		clipped[2*i+1] = std::min(extent[2*i+1], inExtent[2*i+1]);
+		if (clipped[2*i] > clipped[2*i+1])
+		{
+			mInputMin = mInputMax = 0;
+			return true; // nothing to convert
+		}
+	}
+
+	bool success = this->execute(input, output, clipped);
+	output->Modified();
+	return success;
+}
+
+bool UnsignedImageConverter::execute(vtkImageDataPtr input, vtkImageDataPtr output, const int* extent)
+{
+	ConvertRegion region;
+	int* imageExtent = input->GetExtent();
+	for (int i=0; i<6; ++i)
+		region.extent[i] = extent[i] - imageExtent[2*(i/2)];
+	input->GetDimensions(region.dim);
+	region.components = input->GetNumberOfScalarComponents();
+	region.shift = mShift;
+
+	std::vector<SlabRange> ranges(region.extent[5]-region.extent[4]+1);
+
+	bool success = false;
+	switch (input->GetScalarType())
+	{
+	case VTK_CHAR: success = convertRegionToOutputType<char>(input, output, region, &ranges); break;
+	case VTK_SIGNED_CHAR: success = convertRegionToOutputType<signed char>(input, output, region, &ranges); break;
+	case VTK_UNSIGNED_CHAR: success = convertRegionToOutputType<unsigned char>(input, output, region, &ranges); break;
+	case VTK_SHORT: success = convertRegionToOutputType<short>(input, output, region, &ranges); break;
+	case VTK_UNSIGNED_SHORT: success = convertRegionToOutputType<unsigned short>(input, output, region, &ranges); break;
+	case VTK_INT: success = convertRegionToOutputType<int>(input, output, region, &ranges); break;
+	case VTK_UNSIGNED_INT: success = convertRegionToOutputType<unsigned int>(input, output, region, &ranges); break;
+	case VTK_FLOAT: success = convertRegionToOutputType<float>(input, output, region, &ranges); break;
+	case VTK_DOUBLE: success = convertRegionToOutputType<double>(input, output, region, &ranges); break;
+	default: break;
+	}
+	if (!success)
+	{
+		CX_LOG_ERROR() << "UnsignedImageConverter: Unhandled conversion from " << input->GetScalarTypeAsString()
+					   << " to " << output->GetScalarTypeAsString();
+		return false;
+	}
+
+	SlabRange total;
+	for (unsigned i=0; i<ranges.size(); ++i)
+	{
+		total.min = std::min(total.min, ranges[i].min);
+		total.max = std::max(total.max, ranges[i].max);
+	}
+	mInputMin = total.min;
+	mInputMax = total.max;
+	return true;
+}
+
+} // namespace cx
@@ -0,0 +1,65 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#ifndef CXUNSIGNEDIMAGECONVERTER_H_
+#define CXUNSIGNEDIMAGECONVERTER_H_
+
+#include "cxResourceExport.h"
+
+#include "vtkForwardDeclarations.h"
+#include "cxBoundingBox3D.h"
+
+namespace cx
+{
+
+/** \brief Multithreaded conversion of an image to an unsigned type.
+ *
+ * Replaces vtkImageShiftScale with clamping for the unsigned conversion
+ * done by UnsignedDerivedImage: output = clamp(input + shift), truncated
+ * to the output type.
+ *
+ * The volume is split into z slabs that are converted in parallel. The
+ * range of the converted input voxels is found in the same pass, and can
+ * be used to check whether the shift is still valid after a partial update.
+ *
+ * \ingroup cx_resource_core_algorithms
+ * \date Oct 19, 2026
+ */
+class cxResource_EXPORT UnsignedImageConverter
+{
+public:
+	UnsignedImageConverter();
+	void setShift(double shift) { mShift = shift; }
+	void setOutputScalarType(int vtkType) { mOutputScalarType = vtkType; } ///< VTK_UNSIGNED_SHORT or VTK_UNSIGNED_INT
+
+	/** Smallest supported unsigned type holding the range [min,max] after shifting to zero. */
+	static int findOutputScalarType(double min, double max);
+
+	vtkImageDataPtr convert(vtkImageDataPtr input);
+	/** Convert the part of input inside extent into output, which must
+	 *  have been created by convert() from an input with the same layout.
+	 *  Return false if this is not possible.
+	 */
+	bool convertExtent(vtkImageDataPtr input, vtkImageDataPtr output, const IntBoundingBox3D& extent);
+
+	double getInputMin() const { return mInputMin; } ///< min of the input voxels converted by the last call
+	double getInputMax() const { return mInputMax; } ///< max of the input voxels converted by the last call
+
+private:
+	bool execute(vtkImageDataPtr input, vtkImageDataPtr output, const int* extent);
+	double mShift;
+	int mOutputScalarType;
+	double mInputMin;
+	double mInputMax;
+};
+
+} // namespace cx
+
+#endif /* CXUNSIGNEDIMAGECONVERTER_H_ */
@@ -50,6 +50,7 @@ typedef boost::shared_ptr<class TrackedStream> TrackedStreamPtr;
 typedef boost::shared_ptr<class ImageTF3D> ImageTF3DPtr;
 typedef boost::shared_ptr<class ImageLUT2D> ImageLUT2DPtr;
 typedef boost::shared_ptr<class ImageTFData> ImageTFDataPtr;
+typedef boost::shared_ptr<class ImageStatistics> ImageStatisticsPtr;
 typedef boost::shared_ptr<class GPUImageDataBuffer> GPUImageDataBufferPtr;
 typedef boost::weak_ptr<class GPUImageDataBuffer> GPUImageDataBufferWeakPtr;
 typedef boost::shared_ptr<class GPUImageLutBuffer> GPUImageLutBufferPtr;
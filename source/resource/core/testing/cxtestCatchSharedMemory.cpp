@@ -11,6 +11,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 
 #include "cxSharedMemory.h"
 #include "catch.hpp"
+#include <string.h>
 
 using namespace cx;
 
@@ -39,5 +40,163 @@ TEST_CASE("SharedMemory works", "[unit][resource][core]")
 	}
 }
 
+namespace
+{
+SharedMemoryFrameInfo createFrameInfo(qint64 timestamp)
+{
+	SharedMemoryFrameInfo info;
+	info.dim[0] = 4;
+	info.dim[1] = 3;
+	info.dim[2] = 1;
+	info.spacing[0] = info.spacing[1] = info.spacing[2] = 0.5;
+	info.scalarType = 3; // VTK_UNSIGNED_CHAR
+	info.components = 1;
+	info.size = 12;
+	info.timestamp = timestamp;
+	info.probeType = 1;
+	info.probeDepthEnd = 100;
+	return info;
+}
+}
+
+TEST_CASE("SharedMemoryFrameRing: Readers map the latest frame", "[unit][resource][core]")
+{
+	SharedMemoryFrameRingWriter writer("test_ring_latest", 4, 12);
+	REQUIRE(writer.isValid());
+	SharedMemoryFrameRingReader reader1;
+	SharedMemoryFrameRingReader reader2;
+	REQUIRE(reader1.attach(writer.key()));
+	REQUIRE(reader2.attach(writer.key()));
+	CHECK(reader1.slotCount() == 4);
+
+	SharedMemoryFrame frame;
+	CHECK_FALSE(reader1.acquireLatest(&frame));
+
+	char* dst = static_cast<char*>(writer.beginFrame());
+	REQUIRE(dst);
+	strcpy(dst, "frame one");
+	CHECK_FALSE(reader1.acquireLatest(&frame)); // not committed
+	REQUIRE(writer.commitFrame(createFrameInfo(1000)));
 
+	REQUIRE(reader1.acquireLatest(&frame));
+	CHECK(strcmp(static_cast<const char*>(frame.data), "frame one") == 0);
+	CHECK(frame.info.dim[0] == 4);
+	CHECK(frame.info.spacing[1] == 0.5);
+	CHECK(frame.info.timestamp == 1000);
+	CHECK(frame.info.probeDepthEnd == 100);
+	CHECK(reader1.isValid(frame));
+	CHECK_FALSE(reader1.acquireLatest(&frame)); // nothing new
+
+	SharedMemoryFrame frame2;
+	REQUIRE(reader2.acquireLatest(&frame2));
+	CHECK(frame2.data == frame.data); // mapped, not copied
+}
+
+TEST_CASE("SharedMemoryFrameRing: Overwritten frames are detected", "[unit][resource][core]")
+{
+	SharedMemoryFrameRingWriter writer("test_ring_lag", 3, 12);
+	REQUIRE(writer.isValid());
+	SharedMemoryFrameRingReader reader;
+	REQUIRE(reader.attach(writer.key()));
+
+	char data[12] = "frame";
+	REQUIRE(writer.write(createFrameInfo(0), data));
+	SharedMemoryFrame frame;
+	REQUIRE(reader.acquireNext(&frame));
+	CHECK(frame.index == 0);
+
+	for (int i = 1; i < 6; ++i)
+		REQUIRE(writer.write(createFrameInfo(i), data));
+	CHECK(writer.published() == 6);
+	CHECK(reader.getLag() == 5);
+	CHECK_FALSE(reader.isValid(frame)); // slot 0 reused by frame 3
+
+	REQUIRE(reader.acquireNext(&frame));
+	CHECK(frame.index == 4); // frames 1-3 are lost
+	CHECK(reader.getLostFrames() == 3);
+	CHECK(frame.info.timestamp == 4);
+	REQUIRE(reader.acquireNext(&frame));
+	CHECK(frame.index == 5);
+	CHECK(reader.getLag() == 0);
+	CHECK_FALSE(reader.acquireNext(&frame));
+
+	char big[13];
+	SharedMemoryFrameInfo info = createFrameInfo(6);
+	info.size = writer.slotSize() + 1;
+	CHECK_FALSE(writer.write(info, big));
+}
+
+TEST_CASE("SharedMemoryFrameRing: Frames larger than their data are rejected", "[unit][resource][core]")
+{
+	SharedMemoryFrameRingWriter writer("test_ring_bad_info", 4, 12);
+	REQUIRE(writer.isValid());
+	SharedMemoryFrameRingReader reader;
+	REQUIRE(reader.attach(writer.key()));
+	char data[12] = "frame";
+	SharedMemoryFrame frame;
 
+	SECTION("Dimensions exceed size")
+	{
+		SharedMemoryFrameInfo info = createFrameInfo(0);
+		info.dim[0] = 1000;
+		info.dim[1] = 1000;
+		REQUIRE(writer.write(info, data));
+	}
+	SECTION("Default size")
+	{
+		SharedMemoryFrameInfo info = createFrameInfo(0);
+		info.size = 0;
+		REQUIRE(writer.write(info, data));
+	}
+	SECTION("Unknown scalar type")
+	{
+		SharedMemoryFrameInfo info = createFrameInfo(0);
+		info.scalarType = 1000;
+		REQUIRE(writer.write(info, data));
+	}
+	SECTION("Overflowing dimensions")
+	{
+		SharedMemoryFrameInfo info = createFrameInfo(0);
+		info.dim[0] = info.dim[1] = info.dim[2] = 0x7fffffff;
+		REQUIRE(writer.write(info, data));
+	}
+
+	CHECK_FALSE(reader.acquireLatest(&frame));
+	CHECK(frame.data == NULL);
+	CHECK(reader.getRejectedFrames() == 1);
+
+	// the reader continues with the next valid frame
+	REQUIRE(writer.write(createFrameInfo(1), data));
+	REQUIRE(reader.acquireNext(&frame));
+	CHECK(frame.index == 1);
+	CHECK(frame.info.timestamp == 1);
+}
+
+TEST_CASE("SharedMemoryFrameRing: Reader rejects other shared memory", "[unit][resource][core]")
+{
+	SharedMemoryServer srv("test_ring_other", 2, 100);
+	SharedMemoryFrameRingReader reader;
+	CHECK_FALSE(reader.attach(srv.key()));
+}
+
+TEST_CASE("SharedMemoryFrameRing: Reader rejects ring larger than the shared memory", "[unit][resource][core]")
+{
+	QSharedMemory buffer("test_ring_truncated");
+	REQUIRE(buffer.create(256));
+	char* header = static_cast<char*>(buffer.data());
+	memset(header, 0, 256);
+	qint32 magic = 0x43585246;
+	qint32 numSlots = 1000;
+	qint64 slotSize = 1000;
+	qint32 headerSize = 64;
+	qint32 slotHeaderSize = 256;
+	memcpy(header, &magic, 4);
+	memcpy(header + 4, &numSlots, 4);
+	memcpy(header + 8, &slotSize, 8);
+	memcpy(header + 16, &headerSize, 4);
+	memcpy(header + 20, &slotHeaderSize, 4);
+
+	SharedMemoryFrameRingReader reader;
+	CHECK_FALSE(reader.attach(buffer.key()));
+	CHECK_FALSE(reader.isAttached());
+}
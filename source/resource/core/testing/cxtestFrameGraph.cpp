@@ -0,0 +1,149 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#include "catch.hpp"
+#include "cxFrameGraph.h"
+#include "cxFrameForest.h"
+#include "cxMesh.h"
+#include "cxRegistrationTransform.h"
+
+namespace
+{
+
+class FrameGraphFixture
+{
+public:
+	cx::DataPtr createData(QString frame, QString parentFrame)
+	{
+		cx::MeshPtr mesh = cx::Mesh::create(frame);
+		mesh->get_rMd_History()->setParentSpace(parentFrame);
+		mData[mesh->getUid()] = mesh;
+		return mesh;
+	}
+
+	bool isAncestorOf(QString frame, QString ancestor)
+	{
+		return mGraph->isAncestorOf(mGraph->getNode(frame), mGraph->getNode(ancestor));
+	}
+
+	QString getOldestAncestor(QString frame)
+	{
+		return mGraph->getFrame(mGraph->getOldestAncestor(mGraph->getNode(frame)));
+	}
+
+	std::map<QString, cx::DataPtr> mData;
+	cx::FrameGraphPtr mGraph;
+};
+
+} // namespace
+
+TEST_CASE("FrameGraph: Ancestors and descendants", "[unit][resource][core]")
+{
+	FrameGraphFixture fixture;
+	fixture.createData("MR1", "A");
+	fixture.createData("S1", "MR1");
+	fixture.createData("S2", "MR1");
+	fixture.createData("CT1", "A");
+	fixture.createData("MR2", "B");
+	fixture.mGraph = cx::FrameGraph::create();
+	fixture.mGraph->update(fixture.mData);
+
+	CHECK(fixture.mGraph->getNumberOfNodes() == 7);
+	CHECK(fixture.mGraph->getRoots().size() == 2);
+	CHECK(fixture.isAncestorOf("S1", "A"));
+	CHECK(fixture.isAncestorOf("S1", "S1"));
+	CHECK_FALSE(fixture.isAncestorOf("A", "S1"));
+	CHECK_FALSE(fixture.isAncestorOf("CT1", "MR1"));
+	CHECK_FALSE(fixture.isAncestorOf("MR2", "A"));
+	CHECK(fixture.getOldestAncestor("S2") == "A");
+	CHECK(fixture.getOldestAncestor("MR2") == "B");
+
+	int mr1 = fixture.mGraph->getNode("MR1");
+	std::vector<int> nodes = fixture.mGraph->getDescendantsAndSelf(mr1);
+	REQUIRE(nodes.size() == 3);
+	CHECK(fixture.mGraph->getFrame(nodes[0]) == "MR1");
+}
+
+TEST_CASE("FrameGraph: Update applies reparenting and removal", "[unit][resource][core]")
+{
+	FrameGraphFixture fixture;
+	cx::DataPtr mr1 = fixture.createData("MR1", "A");
+	fixture.createData("S1", "MR1");
+	fixture.createData("MR2", "B");
+	fixture.mGraph = cx::FrameGraph::create();
+	fixture.mGraph->update(fixture.mData);
+	CHECK(fixture.getOldestAncestor("S1") == "A");
+
+	mr1->get_rMd_History()->setParentSpace("MR2");
+	fixture.mGraph->update(fixture.mData);
+	CHECK(fixture.getOldestAncestor("S1") == "B");
+	CHECK(fixture.mGraph->getNode("A") < 0); // unused pure space is removed
+
+	fixture.mData.erase("MR1");
+	fixture.mGraph->update(fixture.mData);
+	CHECK(fixture.mGraph->getNode("MR1") >= 0); // still referenced by S1
+	CHECK(fixture.getOldestAncestor("S1") == "MR1");
+	CHECK_FALSE(fixture.isAncestorOf("S1", "B"));
+
+	fixture.mData.erase("S1");
+	fixture.mGraph->update(fixture.mData);
+	CHECK(fixture.mGraph->getNode("MR1") < 0);
+	CHECK(fixture.mGraph->getNode("S1") < 0);
+	CHECK(fixture.mGraph->getNumberOfNodes() == 2);
+}
+
+TEST_CASE("FrameGraph: Cycles are rejected", "[unit][resource][core]")
+{
+	cx::FrameGraph graph;
+	CHECK(graph.setParent("B", "A"));
+	CHECK(graph.setParent("C", "B"));
+	CHECK_FALSE(graph.setParent("A", "C"));
+	CHECK(graph.getParent(graph.getNode("A")) == -1);
+}
+
+TEST_CASE("FrameGraph: Data parent rejected as a cycle is applied when the cycle is gone", "[unit][resource][core]")
+{
+	FrameGraphFixture fixture;
+	fixture.createData("A", "B");
+	fixture.createData("B", "A");
+	fixture.mGraph = cx::FrameGraph::create();
+	fixture.mGraph->update(fixture.mData);
+
+	CHECK(fixture.mGraph->getParent(fixture.mGraph->getNode("A")) == fixture.mGraph->getNode("B"));
+	CHECK(fixture.mGraph->getParent(fixture.mGraph->getNode("B")) == -1);
+
+	fixture.mData["A"]->get_rMd_History()->setParentSpace("");
+	fixture.mGraph->update(fixture.mData);
+
+	CHECK(fixture.mGraph->getParent(fixture.mGraph->getNode("A")) == -1);
+	CHECK(fixture.mGraph->getParent(fixture.mGraph->getNode("B")) == fixture.mGraph->getNode("A"));
+}
+
+TEST_CASE("FrameForest: Same results from indexed queries and document", "[unit][resource][core]")
+{
+	FrameGraphFixture fixture;
+	fixture.createData("MR1", "A");
+	fixture.createData("S1", "MR1");
+	fixture.createData("CT1", "A");
+	fixture.createData("MR2", "B");
+	cx::FrameForest forest(fixture.mData);
+
+	CHECK(forest.getOldestAncestorNotCommonToRef("S1", "CT1") == "MR1");
+	CHECK(forest.getOldestAncestorNotCommonToRef("S1", "MR2") == "A");
+	CHECK(forest.getOldestAncestorNotCommonToRef("MR1", "S1") == "");
+	CHECK(forest.getDataFromDescendantsAndSelf("A").size() == 3);
+
+	QDomNode s1 = forest.getNode("S1");
+	REQUIRE_FALSE(s1.isNull());
+	CHECK(forest.getOldestAncestor(s1).toElement().tagName() == "A");
+	CHECK(forest.getOldestAncestorNotCommonToRef(s1, forest.getNode("CT1")).toElement().tagName() == "MR1");
+	CHECK(forest.getDescendantsAndSelf(forest.getNode("A")).size() == 4);
+	CHECK(forest.getDocument().documentElement().childNodes().size() == 2);
+}
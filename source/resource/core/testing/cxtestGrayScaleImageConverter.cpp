@@ -0,0 +1,129 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#include "catch.hpp"
+#include <vtkImageData.h>
+#include <vtkPointData.h>
+#include <vtkDataArray.h>
+#include <vtkImageLuminance.h>
+#include <vtkImageShiftScale.h>
+#include <vtkImageExtractComponents.h>
+#include "cxGrayScaleImageConverter.h"
+#include "vtkForwardDeclarations.h"
+
+namespace
+{
+
+vtkImageDataPtr createImage(int scalarType, int components)
+{
+	vtkImageDataPtr image = vtkImageDataPtr::New();
+	image->SetExtent(0, 22, 0, 17, 3, 15);
+	image->SetSpacing(0.5, 0.5, 1.0);
+	image->SetOrigin(1, 2, 3);
+	image->AllocateScalars(scalarType, components);
+
+	int values = image->GetNumberOfPoints()*components;
+	for (int i=0; i<values; ++i)
+	{
+		double value = (i*7919)%1000 - 200;
+		if (scalarType==VTK_UNSIGNED_CHAR)
+			value = (i*31)%256;
+		else if (scalarType==VTK_UNSIGNED_SHORT)
+			value = (i*7919)%60000;
+		else if (scalarType==VTK_FLOAT)
+			value = value/3.0;
+		image->GetPointData()->GetScalars()->SetComponent(i/components, i%components, value);
+	}
+	return image;
+}
+
+void checkEqual(vtkImageDataPtr actual, vtkImageDataPtr expected)
+{
+	REQUIRE(actual);
+	REQUIRE(actual->GetScalarType() == expected->GetScalarType());
+	REQUIRE(actual->GetNumberOfScalarComponents() == expected->GetNumberOfScalarComponents());
+	for (int i=0; i<6; ++i)
+		REQUIRE(actual->GetExtent()[i] == expected->GetExtent()[i]);
+	CHECK(actual->GetSpacing()[0] == expected->GetSpacing()[0]);
+	CHECK(actual->GetOrigin()[2] == expected->GetOrigin()[2]);
+	int bytes = expected->GetNumberOfPoints()*expected->GetScalarSize()*expected->GetNumberOfScalarComponents();
+	CHECK(memcmp(actual->GetScalarPointer(), expected->GetScalarPointer(), bytes) == 0);
+}
+
+vtkImageDataPtr luminanceWithVtk(vtkImageDataPtr input)
+{
+	vtkSmartPointer<vtkImageExtractComponents> rgb = vtkSmartPointer<vtkImageExtractComponents>::New();
+	rgb->SetInputData(input);
+	rgb->SetComponents(0, 1, 2);
+	vtkSmartPointer<vtkImageLuminance> luminance = vtkSmartPointer<vtkImageLuminance>::New();
+	luminance->SetInputConnection(rgb->GetOutputPort());
+	luminance->Update();
+	return luminance->GetOutput();
+}
+
+vtkImageDataPtr shiftScaleWithVtk(vtkImageDataPtr input, double shift, double scale)
+{
+	vtkImageShiftScalePtr cast = vtkImageShiftScalePtr::New();
+	cast->SetInputData(input);
+	cast->SetShift(shift);
+	cast->SetScale(scale);
+	cast->SetOutputScalarTypeToUnsignedChar();
+	cast->ClampOverflowOn();
+	cast->Update();
+	return cast->GetOutput();
+}
+
+} // namespace
+
+TEST_CASE("GrayScaleImageConverter: Luminance equals vtkImageLuminance", "[unit][resource][core]")
+{
+	int types[] = {VTK_UNSIGNED_CHAR, VTK_UNSIGNED_SHORT, VTK_SHORT, VTK_FLOAT};
+	for (int t=0; t<4; ++t)
+	{
+		for (int components=3; components<=4; ++components)
+		{
+			INFO("type " << types[t] << ", components " << components);
+			vtkImageDataPtr input = createImage(types[t], components);
+			checkEqual(cx::GrayScaleImageConverter::toGrayScale(input), luminanceWithVtk(input));
+		}
+	}
+}
+
+TEST_CASE("GrayScaleImageConverter: Grayscale images are returned unchanged", "[unit][resource][core]")
+{
+	vtkImageDataPtr input = createImage(VTK_SHORT, 1);
+	CHECK(cx::GrayScaleImageConverter::toGrayScale(input) == input);
+	CHECK_FALSE(cx::GrayScaleImageConverter::toGrayScale(createImage(VTK_DOUBLE, 3)));
+}
+
+TEST_CASE("GrayScaleImageConverter: 8 bit conversion equals vtkImageShiftScale", "[unit][resource][core]")
+{
+	int types[] = {VTK_UNSIGNED_CHAR, VTK_UNSIGNED_SHORT, VTK_SHORT, VTK_FLOAT};
+	for (int t=0; t<4; ++t)
+	{
+		INFO("type " << types[t]);
+		vtkImageDataPtr input = createImage(types[t], 1);
+		double shift = 150.3;
+		double scale = 255.0/700;
+		checkEqual(cx::GrayScaleImageConverter::to8bit(input, shift, scale), shiftScaleWithVtk(input, shift, scale));
+	}
+}
+
+TEST_CASE("GrayScaleImageConverter: RGB max is the max mean of the color components", "[unit][resource][core]")
+{
+	vtkImageDataPtr input = createImage(VTK_UNSIGNED_CHAR, 3);
+	unsigned char* ptr = static_cast<unsigned char*>(input->GetScalarPointer());
+	for (int i=0; i<input->GetNumberOfPoints()*3; ++i)
+		ptr[i] = 10;
+	ptr[30] = 250;
+	ptr[31] = 251;
+	ptr[32] = 252;
+	CHECK(cx::GrayScaleImageConverter::findRGBMax(input) == 251);
+}
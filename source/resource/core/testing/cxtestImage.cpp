@@ -301,4 +301,33 @@ TEST_CASE("Image: Changed initial window is kept after using addXml and parseXml
 	cx::LogicManager::shutdown();
 }
 
+TEST_CASE("Image: Partial modification updates statistics and unsigned image", "[unit][resource][core]")
+{
+	vtkImageDataPtr data = cx::generateVtkImageDataSignedShort(Eigen::Array3i(20, 20, 20), cx::Vector3D(1, 1, 1), 0);
+	short* ptr = static_cast<short*>(data->GetScalarPointer());
+	for (int i=0; i<data->GetNumberOfPoints(); ++i)
+		ptr[i] = i%100 - 50;
+
+	cx::ImagePtr image = cx::Image::create("image", "image");
+	image->setVtkImageData(data);
+	cx::ImagePtr unsignedImage = image->getUnsigned(image);
+	vtkImageDataPtr converted = unsignedImage->getBaseVtkImageData();
+	REQUIRE(image->getMax() == 49);
+	CHECK_FALSE(image->isPartiallyModified());
+
+	*static_cast<short*>(data->GetScalarPointer(4, 5, 6)) = 40;
+	*static_cast<short*>(data->GetScalarPointer(5, 5, 6)) = 500;
+	image->setVtkImageDataModified(cx::IntBoundingBox3D(4, 5, 5, 5, 6, 6));
+
+	CHECK_FALSE(image->isPartiallyModified());
+	CHECK(image->getBaseVtkImageData() == data);
+	CHECK(image->getMax() == 500);
+	CHECK(image->getMin() == -50);
+
+	REQUIRE(unsignedImage->getBaseVtkImageData() == converted);
+	CHECK(*static_cast<unsigned short*>(converted->GetScalarPointer(4, 5, 6)) == 90);
+	CHECK(*static_cast<unsigned short*>(converted->GetScalarPointer(5, 5, 6)) == 550);
+	CHECK(*static_cast<unsigned short*>(converted->GetScalarPointer(0, 0, 0)) == 0);
+}
+
 } // namespace cxtest
@@ -0,0 +1,178 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "catch.hpp"
+#include <cmath>
+#include <algorithm>
+#include <iostream>
+#include <QElapsedTimer>
+#include <vtkImageData.h>
+#include <vtkImageResample.h>
+#include "cxImageResampler.h"
+#include "cxVolumeHelpers.h"
+
+namespace
+{
+
+vtkImageDataPtr createRampImage(Eigen::Array3i dim, cx::Vector3D spacing)
+{
+	vtkImageDataPtr image = cx::generateVtkImageDataDouble(dim, spacing, 0);
+	double* ptr = static_cast<double*>(image->GetScalarPointer());
+	for (int z=0; z<dim[2]; ++z)
+		for (int y=0; y<dim[1]; ++y)
+			for (int x=0; x<dim[0]; ++x)
+				*ptr++ = 2*x - 3*y + 0.5*z + 10;
+	return image;
+}
+
+double rampValue(cx::Vector3D index)
+{
+	return 2*index[0] - 3*index[1] + 0.5*index[2] + 10;
+}
+
+void checkRampReproduced(cx::ImageResampler::INTERPOLATION interpolation)
+{
+	Eigen::Array3i dim(20, 17, 11);
+	vtkImageDataPtr input = createRampImage(dim, cx::Vector3D(1, 2, 3));
+
+	cx::ImageResampler resampler;
+	resampler.setInterpolation(interpolation);
+	resampler.setMagnificationFactors(cx::Vector3D(0.7, 1.6, 0.45));
+	vtkImageDataPtr output = resampler.execute(input);
+	REQUIRE(output);
+
+	int* outDim = output->GetDimensions();
+	double* outSpacing = output->GetSpacing();
+	double* inSpacing = input->GetSpacing();
+	for (int z=0; z<outDim[2]; ++z)
+		for (int y=0; y<outDim[1]; ++y)
+			for (int x=0; x<outDim[0]; ++x)
+			{
+				cx::Vector3D index(x*outSpacing[0]/inSpacing[0], y*outSpacing[1]/inSpacing[1], z*outSpacing[2]/inSpacing[2]);
+				// cubic repeats border voxels, giving deviations in the outermost voxels
+				bool interior = index.minCoeff() >= 1 && (index[0] <= dim[0]-2) && (index[1] <= dim[1]-2) && (index[2] <= dim[2]-2);
+				if (interpolation==cx::ImageResampler::iCUBIC && !interior)
+					continue;
+				double value = output->GetScalarComponentAsDouble(x, y, z, 0);
+				INFO("voxel " << x << " " << y << " " << z);
+				CHECK(value == Approx(rampValue(index)));
+			}
+}
+
+}
+
+namespace cxtest
+{
+
+TEST_CASE("ImageResampler: Output geometry", "[unit][resource][core]")
+{
+	vtkImageDataPtr input = cx::generateVtkImageDataSignedShort(Eigen::Array3i(100, 50, 9), cx::Vector3D(0.5, 1, 2), 0);
+	input->SetOrigin(1, 2, 3);
+
+	cx::ImageResampler resampler;
+	resampler.setMagnificationFactor(0.5);
+	vtkImageDataPtr output = resampler.execute(input);
+	REQUIRE(output);
+
+	CHECK(output->GetScalarType() == VTK_SHORT);
+	CHECK(Eigen::Array3i(output->GetDimensions()).isApprox(Eigen::Array3i(50, 25, 5)));
+	CHECK(cx::Vector3D(output->GetSpacing()).isApprox(cx::Vector3D(1, 2, 4)));
+	CHECK(cx::Vector3D(output->GetOrigin()).isApprox(cx::Vector3D(1, 2, 3)));
+}
+
+TEST_CASE("ImageResampler: Nearest neighbour picks input voxels", "[unit][resource][core]")
+{
+	Eigen::Array3i dim(13, 8, 6);
+	vtkImageDataPtr input = cx::generateVtkImageDataSignedShort(dim, cx::Vector3D(1, 1, 1), 0);
+	short* ptr = static_cast<short*>(input->GetScalarPointer());
+	for (int i=0; i<dim.prod(); ++i)
+		ptr[i] = (i*37)%2000 - 1000;
+
+	cx::ImageResampler resampler;
+	resampler.setInterpolation(cx::ImageResampler::iNEAREST);
+	resampler.setMagnificationFactors(cx::Vector3D(0.5, 2, 1));
+	vtkImageDataPtr output = resampler.execute(input);
+	REQUIRE(output);
+
+	int* outDim = output->GetDimensions();
+	for (int z=0; z<outDim[2]; ++z)
+		for (int y=0; y<outDim[1]; ++y)
+			for (int x=0; x<outDim[0]; ++x)
+			{
+				int xi = std::min(int(std::floor(x/0.5+0.5)), dim[0]-1);
+				int yi = std::min(int(std::floor(y/2.0+0.5)), dim[1]-1);
+				CHECK(output->GetScalarComponentAsDouble(x, y, z, 0) == input->GetScalarComponentAsDouble(xi, yi, z, 0));
+			}
+}
+
+TEST_CASE("ImageResampler: Linear interpolation reproduces linear ramp", "[unit][resource][core]")
+{
+	checkRampReproduced(cx::ImageResampler::iLINEAR);
+}
+
+TEST_CASE("ImageResampler: Cubic interpolation reproduces linear ramp", "[unit][resource][core]")
+{
+	checkRampReproduced(cx::ImageResampler::iCUBIC);
+}
+
+TEST_CASE("ImageResampler: Cubic overshoot is clamped to scalar range", "[unit][resource][core]")
+{
+	Eigen::Array3i dim(16, 4, 4);
+	vtkImageDataPtr input = cx::generateVtkImageData(dim, cx::Vector3D(1, 1, 1), 0);
+	unsigned char* ptr = static_cast<unsigned char*>(input->GetScalarPointer());
+	for (int i=0; i<dim.prod(); ++i)
+		ptr[i] = ((i%dim[0]) < dim[0]/2) ? 0 : 255;
+
+	cx::ImageResampler resampler;
+	resampler.setInterpolation(cx::ImageResampler::iCUBIC);
+	resampler.setMagnificationFactors(cx::Vector3D(3.3, 1, 1));
+	vtkImageDataPtr output = resampler.execute(input);
+	REQUIRE(output);
+
+	double range[2];
+	output->GetScalarRange(range);
+	CHECK(range[0] == 0);
+	CHECK(range[1] == 255);
+}
+
+TEST_CASE("Speed: ImageResampler vs vtkImageResample", "[speed][resource][core]")
+{
+	Eigen::Array3i dim(512, 512, 200);
+	vtkImageDataPtr input = cx::generateVtkImageDataSignedShort(dim, cx::Vector3D(0.5, 0.5, 1), 0);
+	short* ptr = static_cast<short*>(input->GetScalarPointer());
+	for (int i=0; i<dim.prod(); ++i)
+		ptr[i] = i%3000;
+	double factor = 0.6;
+
+	QElapsedTimer timer;
+	timer.start();
+	vtkImageResamplePtr vtkResampler = vtkImageResamplePtr::New();
+	vtkResampler->SetInterpolationModeToLinear();
+	for (int i=0; i<3; ++i)
+		vtkResampler->SetAxisMagnificationFactor(i, factor);
+	vtkResampler->SetInputData(input);
+	vtkResampler->Update();
+	double vtkTime = timer.restart()/1000.0;
+
+	cx::ImageResampler resampler;
+	resampler.setMagnificationFactor(factor);
+	vtkImageDataPtr output = resampler.execute(input);
+	double cxTime = timer.restart()/1000.0;
+
+	REQUIRE(output);
+	CHECK(Eigen::Array3i(output->GetDimensions()).isApprox(Eigen::Array3i(vtkResampler->GetOutput()->GetDimensions())));
+
+	double outputVoxels = double(output->GetNumberOfPoints())/1.0E6;
+	std::cout << "vtkImageResample: " << vtkTime << "s, " << outputVoxels/vtkTime << " Mvoxels/s" << std::endl;
+	std::cout << "ImageResampler:   " << cxTime << "s, " << outputVoxels/cxTime << " Mvoxels/s" << std::endl;
+}
+
+} // namespace cxtest
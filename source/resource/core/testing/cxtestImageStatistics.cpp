@@ -0,0 +1,184 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "catch.hpp"
+#include <map>
+#include <limits>
+#include <vtkImageData.h>
+#include <vtkImageAccumulate.h>
+#include "cxImageStatistics.h"
+#include "cxVolumeHelpers.h"
+#include "cxImage.h"
+
+namespace
+{
+
+vtkImageDataPtr createShortTestImage()
+{
+	Eigen::Array3i dim(31, 17, 43);
+	vtkImageDataPtr image = cx::generateVtkImageDataSignedShort(dim, cx::Vector3D(1,1,1), 0);
+	short* ptr = static_cast<short*>(image->GetScalarPointer());
+	for (int i=0; i<dim.prod(); ++i)
+		ptr[i] = (i*7)%1000 - 200;
+	cx::setDeepModified(image);
+	return image;
+}
+
+void checkAgainstBruteForce(cx::ImageStatisticsPtr statistics, vtkImageDataPtr image)
+{
+	int* dim = image->GetDimensions();
+	short* ptr = static_cast<short*>(image->GetScalarPointer());
+	double minVal = ptr[0];
+	double maxVal = ptr[0];
+	double sum = 0;
+	int n = dim[0]*dim[1]*dim[2];
+	std::map<int, unsigned int> histogram;
+	for (int i=0; i<n; ++i)
+	{
+		minVal = std::min<double>(minVal, ptr[i]);
+		maxVal = std::max<double>(maxVal, ptr[i]);
+		sum += ptr[i];
+		histogram[ptr[i]]++;
+	}
+
+	CHECK(statistics->getMin() == Approx(minVal));
+	CHECK(statistics->getMax() == Approx(maxVal));
+	CHECK(statistics->getMean() == Approx(sum/n));
+	CHECK(statistics->getVoxelCount() == n);
+	CHECK(statistics->getHistogramTotal() == n);
+	CHECK(statistics->getHistogramOrigin() == Approx(minVal));
+	CHECK(statistics->getHistogram().size() == maxVal-minVal+1);
+	for (std::map<int, unsigned int>::iterator iter=histogram.begin(); iter!=histogram.end(); ++iter)
+		CHECK(statistics->getHistogramCount(iter->first) == iter->second);
+}
+
+} // namespace
+
+TEST_CASE("ImageStatistics: Computes range, mean and histogram", "[unit][resource][core]")
+{
+	vtkImageDataPtr image = createShortTestImage();
+	cx::ImageStatisticsPtr statistics = cx::ImageStatistics::create();
+	statistics->update(image);
+	checkAgainstBruteForce(statistics, image);
+
+	CHECK(statistics->getPercentile(0) == Approx(statistics->getMin()));
+	CHECK(statistics->getPercentile(1) == Approx(statistics->getMax()));
+	CHECK(statistics->getPercentile(0.5) == Approx(300).margin(10));
+}
+
+TEST_CASE("ImageStatistics: Result is cached until the image changes", "[unit][resource][core]")
+{
+	vtkImageDataPtr image = createShortTestImage();
+	cx::ImageStatisticsPtr statistics = cx::ImageStatistics::create();
+	statistics->update(image);
+	unsigned long computed = statistics->getComputedSlabCount();
+	REQUIRE(computed > 0);
+
+	statistics->update(image);
+	CHECK(statistics->getComputedSlabCount() == computed);
+
+	static_cast<short*>(image->GetScalarPointer())[0] = 2000;
+	cx::setDeepModified(image);
+	statistics->update(image);
+	CHECK(statistics->getComputedSlabCount() == 2*computed);
+	checkAgainstBruteForce(statistics, image);
+}
+
+TEST_CASE("ImageStatistics: Sub-extent update recomputes affected slabs only", "[unit][resource][core]")
+{
+	vtkImageDataPtr image = createShortTestImage();
+	cx::ImageStatisticsPtr statistics = cx::ImageStatistics::create();
+	statistics->update(image);
+	unsigned long computed = statistics->getComputedSlabCount();
+
+	int* dim = image->GetDimensions();
+	int z = dim[2]-1;
+	short* slice = static_cast<short*>(image->GetScalarPointer(0, 0, z));
+	for (int i=0; i<dim[0]*dim[1]; ++i)
+		slice[i] = 5000;
+	cx::setDeepModified(image);
+
+	statistics->updateExtent(image, cx::IntBoundingBox3D(0, dim[0]-1, 0, dim[1]-1, z, z));
+	CHECK(statistics->getComputedSlabCount() == computed+1);
+	checkAgainstBruteForce(statistics, image);
+
+	statistics->update(image);
+	CHECK(statistics->getComputedSlabCount() == computed+1);
+}
+
+TEST_CASE("ImageStatistics: Histogram equals vtkImageAccumulate", "[unit][resource][core]")
+{
+	vtkImageDataPtr image = createShortTestImage();
+	cx::ImageStatisticsPtr statistics = cx::ImageStatistics::create();
+	statistics->setIgnoreZeroInHistogram(true);
+	statistics->update(image);
+
+	vtkImageAccumulatePtr accumulate = vtkImageAccumulatePtr::New();
+	accumulate->SetInputData(image);
+	accumulate->IgnoreZeroOn();
+	accumulate->SetComponentExtent(0, statistics->getMax()-statistics->getMin(), 0, 0, 0, 0);
+	accumulate->SetComponentOrigin(statistics->getMin(), 0, 0);
+	accumulate->SetComponentSpacing(1, 0, 0);
+	accumulate->Update();
+
+	for (int i=statistics->getMin(); i<=statistics->getMax(); ++i)
+	{
+		int expected = static_cast<int*>(accumulate->GetOutput()->GetScalarPointer(i-statistics->getMin(), 0, 0))[0];
+		CHECK(statistics->getHistogramCount(i) == expected);
+	}
+}
+
+TEST_CASE("ImageStatistics: Image min and max uses statistics", "[unit][resource][core]")
+{
+	vtkImageDataPtr data = createShortTestImage();
+	cx::ImagePtr image(new cx::Image("stat_image", data));
+
+	CHECK(image->getMin() == -200);
+	CHECK(image->getMax() == 799);
+	CHECK(image->getStatistics()->getMin() == -200);
+}
+
+TEST_CASE("ImageStatistics: Ignores NaN and infinite values in float images", "[unit][resource][core]")
+{
+	vtkImageDataPtr image = vtkImageDataPtr::New();
+	image->SetDimensions(10, 10, 4);
+	image->AllocateScalars(VTK_FLOAT, 1);
+	float* ptr = static_cast<float*>(image->GetScalarPointer());
+	int n = 10*10*4;
+	for (int i=0; i<n; ++i)
+		ptr[i] = 0.5f*(i%20);
+	ptr[3] = std::numeric_limits<float>::infinity();
+	ptr[150] = -std::numeric_limits<float>::infinity();
+	ptr[399] = std::numeric_limits<float>::quiet_NaN();
+	cx::setDeepModified(image);
+
+	cx::ImageStatisticsPtr statistics = cx::ImageStatistics::create();
+	statistics->update(image);
+
+	REQUIRE(statistics->isValid());
+	CHECK(statistics->getMin() == Approx(0));
+	CHECK(statistics->getMax() == Approx(9.5));
+	CHECK(statistics->getVoxelCount() == n-3);
+	CHECK(statistics->getHistogramTotal() == n-3);
+	CHECK(statistics->getHistogramOrigin() == Approx(0));
+	CHECK(statistics->getHistogram().size() == 10);
+	CHECK(statistics->getHistogramSpacing() == Approx(1));
+
+	SECTION("Sub-extent update with a new infinite value")
+	{
+		ptr[0] = std::numeric_limits<float>::infinity();
+		cx::setDeepModified(image);
+		statistics->updateExtent(image, cx::IntBoundingBox3D(0, 9, 0, 9, 0, 0));
+		CHECK(statistics->getMax() == Approx(9.5));
+		CHECK(statistics->getVoxelCount() == n-4);
+		CHECK(statistics->getHistogram().size() == 10);
+	}
+}
@@ -0,0 +1,160 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#include "catch.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <QElapsedTimer>
+#include <vtkLookupTable.h>
+#include <vtkColorTransferFunction.h>
+#include <vtkPiecewiseFunction.h>
+#include "cxLookupTableBuilder.h"
+#include "cxImageLUT2D.h"
+
+namespace
+{
+
+/** Compare the table to the color/opacity functions generated from the maps,
+ *  as the table was built before LookupTableBuilder was introduced.
+ */
+void checkTableMatchesFunctions(vtkLookupTablePtr lut, cx::ImageTFData* tf)
+{
+	vtkColorTransferFunctionPtr color = tf->generateColorTF();
+	vtkPiecewiseFunctionPtr opacity = tf->generateOpacityTF();
+	int first = lut->GetTableRange()[0];
+	int count = lut->GetNumberOfTableValues();
+	REQUIRE(count == int(lut->GetTableRange()[1]) - first + 1);
+
+	int errors = 0;
+	for (int i=0; i<count; ++i)
+	{
+		double* rgb = color->GetColor(first+i);
+		double expected[4] = { rgb[0], rgb[1], rgb[2], opacity->GetValue(first+i) };
+		unsigned char* actual = lut->GetPointer(i);
+		for (int c=0; c<4; ++c)
+			if (std::abs(int(actual[c]) - int(expected[c]*255+0.5)) > 1)
+				++errors;
+	}
+	CHECK(errors == 0);
+}
+
+cx::ImageLUT2DPtr createLUT()
+{
+	cx::ImageLUT2DPtr lut(new cx::ImageLUT2D());
+	cx::ColorMap colors;
+	colors[0] = QColor(Qt::black);
+	colors[300] = QColor(200, 20, 40);
+	colors[1000] = QColor(Qt::white);
+	lut->resetColor(colors);
+	cx::IntIntMap opacity;
+	opacity[99] = 0;
+	opacity[100] = 255;
+	lut->resetAlpha(opacity);
+	return lut;
+}
+
+} // namespace
+
+TEST_CASE("LookupTableBuilder: Table matches the transfer functions after window, level, LLR and alpha changes", "[unit][resource][core]")
+{
+	cx::ImageLUT2DPtr tf = createLUT();
+	vtkLookupTablePtr lut = tf->getOutputLookupTable();
+	checkTableMatchesFunctions(lut, tf.get());
+
+	tf->setLevel(700);
+	checkTableMatchesFunctions(lut, tf.get());
+	tf->setWindow(300);
+	checkTableMatchesFunctions(lut, tf.get());
+	tf->setLLR(650);
+	checkTableMatchesFunctions(lut, tf.get());
+	tf->setAlpha(0.5);
+	checkTableMatchesFunctions(lut, tf.get());
+	tf->addColorPoint(710, QColor(Qt::green));
+	checkTableMatchesFunctions(lut, tf.get());
+	tf->removeAlphaPoint(tf->getOpacityMap().begin()->first);
+	checkTableMatchesFunctions(lut, tf.get());
+}
+
+TEST_CASE("LookupTableBuilder: Only entries affected by a change are written", "[unit][resource][core]")
+{
+	cx::ColorMap colors;
+	colors[0] = QColor(Qt::black);
+	colors[500] = QColor(Qt::red);
+	colors[1000] = QColor(Qt::white);
+	cx::IntIntMap opacity;
+	opacity[0] = 255;
+	opacity[1000] = 255;
+
+	vtkLookupTablePtr lut = vtkLookupTablePtr::New();
+	cx::LookupTableBuilder builder;
+	builder.update(colors, opacity, lut);
+	CHECK(builder.getLastUpdateCount() == 1001);
+
+	builder.update(colors, opacity, lut);
+	CHECK(builder.getLastUpdateCount() == 0);
+
+	colors[500] = QColor(Qt::blue);
+	builder.update(colors, opacity, lut);
+	CHECK(builder.getLastUpdateCount() == 1001); // both neighbours are end nodes
+
+	colors[250] = QColor(Qt::green);
+	builder.update(colors, opacity, lut);
+	colors[250] = QColor(Qt::yellow);
+	builder.update(colors, opacity, lut);
+	CHECK(builder.getLastUpdateCount() == 501); // between nodes 0 and 500
+
+	opacity[600] = 100;
+	builder.update(colors, opacity, lut);
+	opacity[600] = 50;
+	builder.update(colors, opacity, lut);
+	CHECK(builder.getLastUpdateCount() == 1001);
+}
+
+TEST_CASE("Speed: LookupTableBuilder window/level drag on 16 bit range", "[speed][resource][core]")
+{
+	cx::ImageLUT2DPtr tf(new cx::ImageLUT2D());
+	cx::ColorMap colors;
+	colors[0] = QColor(Qt::black);
+	colors[65535] = QColor(Qt::white);
+	tf->resetColor(colors);
+	cx::IntIntMap opacity;
+	opacity[0] = 0;
+	opacity[1] = 255;
+	opacity[65535] = 255;
+	tf->resetAlpha(opacity);
+	tf->getOutputLookupTable();
+
+	int iterations = 200;
+	QElapsedTimer timer;
+	timer.start();
+	for (int i=0; i<iterations; ++i)
+	{
+		tf->setLevel(20000 + 10*i);
+		tf->setLLR(100 + i);
+	}
+	double lutTime = double(timer.restart())/iterations;
+
+	for (int i=0; i<iterations/10; ++i)
+	{
+		vtkColorTransferFunctionPtr color = tf->generateColorTF();
+		vtkPiecewiseFunctionPtr alpha = tf->generateOpacityTF();
+		vtkLookupTablePtr lut = vtkLookupTablePtr::New();
+		lut->SetNumberOfTableValues(65536);
+		for (int v=0; v<65536; ++v)
+		{
+			double* rgb = color->GetColor(v);
+			lut->SetTableValue(v, rgb[0], rgb[1], rgb[2], alpha->GetValue(v));
+		}
+	}
+	double functionTime = double(timer.restart())/(iterations/10);
+
+	std::cout << "LookupTableBuilder:        " << lutTime/2 << " ms/change" << std::endl;
+	std::cout << "Function evaluation:       " << functionTime << " ms/change" << std::endl;
+}
@@ -0,0 +1,160 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "catch.hpp"
+#include "vtkImageData.h"
+#include "cxMaskSpans.h"
+#include "cxProbeSector.h"
+#include "cxDummyTool.h"
+#include "cxVolumeHelpers.h"
+
+namespace cxtest
+{
+
+namespace
+{
+vtkImageDataPtr createRandomMask(int width, int height)
+{
+	vtkImageDataPtr retval = cx::generateVtkImageData(Eigen::Array3i(width, height, 1), cx::Vector3D(0.5, 0.5, 1), 0);
+	unsigned char* ptr = static_cast<unsigned char*>(retval->GetScalarPointer());
+	srand(0);
+	for (int i = 0; i < width*height; ++i)
+		ptr[i] = (rand() % 3) ? 1 : 0;
+	return retval;
+}
+
+void checkSameMask(vtkImageDataPtr mask, cx::MaskSpansPtr spans)
+{
+	int* dim = mask->GetDimensions();
+	REQUIRE(spans->getWidth() == dim[0]);
+	REQUIRE(spans->getHeight() == dim[1]);
+	unsigned char* ptr = static_cast<unsigned char*>(mask->GetScalarPointer());
+	int count = 0;
+	int mismatch = 0;
+	for (int y = 0; y < dim[1]; ++y)
+		for (int x = 0; x < dim[0]; ++x)
+		{
+			bool inside = ptr[x + y*dim[0]] != 0;
+			if (inside != spans->isInside(x, y))
+				++mismatch;
+			if (inside)
+				++count;
+		}
+	CHECK(mismatch == 0);
+	CHECK(spans->getValidPixelCount() == count);
+}
+}
+
+TEST_CASE("MaskSpans: Created from mask contains the same pixels", "[unit][resource][core][MaskSpans]")
+{
+	vtkImageDataPtr mask = createRandomMask(37, 23);
+	cx::MaskSpansPtr spans = cx::MaskSpans::createFromMask(mask);
+	REQUIRE(spans);
+	checkSameMask(mask, spans);
+	checkSameMask(spans->createMaskImage(cx::Vector3D(0.5, 0.5, 1)), spans);
+}
+
+TEST_CASE("MaskSpans: Created from non unsigned char mask", "[unit][resource][core][MaskSpans]")
+{
+	vtkImageDataPtr mask = createRandomMask(37, 23);
+	vtkImageDataPtr shortMask = cx::generateVtkImageDataSignedShort(Eigen::Array3i(37, 23, 1), cx::Vector3D(0.5, 0.5, 1), 0);
+	unsigned char* src = static_cast<unsigned char*>(mask->GetScalarPointer());
+	short* dst = static_cast<short*>(shortMask->GetScalarPointer());
+	for (int i = 0; i < 37*23; ++i)
+		dst[i] = src[i] ? -1000 : 0;
+
+	cx::MaskSpansPtr spans = cx::MaskSpans::createFromMask(shortMask);
+	REQUIRE(spans);
+	checkSameMask(mask, spans);
+}
+
+TEST_CASE("MaskSpans: Transposed swaps rows and columns", "[unit][resource][core][MaskSpans]")
+{
+	vtkImageDataPtr mask = createRandomMask(37, 23);
+	cx::MaskSpansPtr spans = cx::MaskSpans::createFromMask(mask);
+	cx::MaskSpansPtr transposed = spans->createTransposed();
+
+	CHECK(transposed->getWidth() == spans->getHeight());
+	CHECK(transposed->getHeight() == spans->getWidth());
+	CHECK(transposed->getValidPixelCount() == spans->getValidPixelCount());
+	int mismatch = 0;
+	for (int y = 0; y < spans->getHeight(); ++y)
+		for (int x = 0; x < spans->getWidth(); ++x)
+			if (spans->isInside(x, y) != transposed->isInside(y, x))
+				++mismatch;
+	CHECK(mismatch == 0);
+}
+
+TEST_CASE("MaskSpans: Bounds of valid pixels", "[unit][resource][core][MaskSpans]")
+{
+	cx::MaskSpansPtr spans(new cx::MaskSpans(10, 8));
+	std::vector<cx::MaskSpans::Span> row;
+	int xmin, xmax, ymin, ymax;
+
+	for (int y = 0; y < 8; ++y)
+	{
+		row.clear();
+		cx::MaskSpans::Span span;
+		if (y == 2)
+		{
+			span.begin = 3;
+			span.end = 5;
+			row.push_back(span);
+		}
+		if (y == 5)
+		{
+			span.begin = 1;
+			span.end = 2;
+			row.push_back(span);
+			span.begin = 7;
+			span.end = 9;
+			row.push_back(span);
+		}
+		spans->appendRow(row);
+	}
+
+	REQUIRE(spans->getBounds(&xmin, &xmax, &ymin, &ymax));
+	CHECK(xmin == 1);
+	CHECK(xmax == 8);
+	CHECK(ymin == 2);
+	CHECK(ymax == 5);
+	CHECK(spans->getValidPixelCount() == 5);
+
+	cx::MaskSpansPtr empty(new cx::MaskSpans(10, 8));
+	CHECK_FALSE(empty->getBounds(&xmin, &xmax, &ymin, &ymax));
+}
+
+TEST_CASE("MaskSpans: ProbeSector spans equals mask", "[unit][resource][core][MaskSpans]")
+{
+	cx::ProbeDefinition::TYPE types[] = { cx::ProbeDefinition::tLINEAR, cx::ProbeDefinition::tSECTOR };
+	for (unsigned i = 0; i < 2; ++i)
+	{
+		cx::ProbeDefinition definition = cx::DummyToolTestUtilities::createProbeDefinition(types[i], 40, (i==0) ? 50 : M_PI/2, Eigen::Array2i(80, 40));
+		definition.setSector(5, definition.getDepthEnd(), definition.getWidth());
+		cx::ProbeSector sector;
+		sector.setData(definition);
+
+		cx::MaskSpansPtr spans = sector.getMaskSpans();
+		REQUIRE(spans);
+		CHECK(spans->getValidPixelCount() > 0);
+
+		// reference: evaluate the sector geometry for each pixel
+		int mismatch = 0;
+		for (int y = 0; y < spans->getHeight(); ++y)
+			for (int x = 0; x < spans->getWidth(); ++x)
+				if (sector.isInsideMask(x, y) != spans->isInside(x, y))
+					++mismatch;
+		CHECK(mismatch == 0);
+		checkSameMask(sector.getMask(), spans);
+	}
+}
+
+} // namespace cxtest
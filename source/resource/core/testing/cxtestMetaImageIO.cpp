@@ -0,0 +1,155 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "catch.hpp"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include "vtkImageData.h"
+#include "cxMetaImageIO.h"
+#include "cxMetaImageHeader.h"
+#include "cxCustomMetaImage.h"
+#include "cxDataLocations.h"
+#include "cxVolumeHelpers.h"
+
+namespace cxtest
+{
+
+namespace
+{
+QString getTestPath()
+{
+	QString path = cx::DataLocations::getTestDataPath() + "/temp/MetaImageIO/";
+	QDir().mkpath(path);
+	return path;
+}
+
+vtkImageDataPtr createTestImage()
+{
+	vtkImageDataPtr retval = cx::generateVtkImageDataSignedShort(Eigen::Array3i(31, 17, 11), cx::Vector3D(0.5, 0.25, 2), 0);
+	short* ptr = static_cast<short*>(retval->GetScalarPointer());
+	for (int i = 0; i < 31*17*11; ++i)
+		ptr[i] = short((i*7919) % 3001 - 1000);
+	return retval;
+}
+
+void checkEqualImages(vtkImageDataPtr a, vtkImageDataPtr b)
+{
+	REQUIRE(a);
+	REQUIRE(b);
+	CHECK(Eigen::Array3i(a->GetDimensions()).isApprox(Eigen::Array3i(b->GetDimensions())));
+	CHECK(cx::Vector3D(a->GetSpacing()).isApprox(cx::Vector3D(b->GetSpacing())));
+	REQUIRE(a->GetScalarType() == b->GetScalarType());
+	REQUIRE(a->GetNumberOfScalarComponents() == b->GetNumberOfScalarComponents());
+	int bytes = a->GetNumberOfPoints() * a->GetNumberOfScalarComponents() * a->GetScalarSize();
+	CHECK(memcmp(a->GetScalarPointer(), b->GetScalarPointer(), bytes) == 0);
+}
+}
+
+TEST_CASE("MetaImageIO: Write and read uncompressed image", "[unit][resource][core][MetaImageIO]")
+{
+	QString filename = getTestPath() + "uncompressed.mhd";
+	vtkImageDataPtr image = createTestImage();
+
+	cx::MetaImageHeader keys;
+	keys.setValue("Modality", "CT");
+	cx::MetaImageIO writer;
+	REQUIRE(writer.write(image, filename, keys));
+	CHECK(QFileInfo(getTestPath() + "uncompressed.raw").size() == 31*17*11*2);
+
+	cx::MetaImageIO reader;
+	checkEqualImages(image, reader.read(filename));
+	CHECK(reader.getHeader().getValue("Modality") == "CT");
+	CHECK(reader.getHeader().getEntries().back().first == "ElementDataFile");
+}
+
+TEST_CASE("MetaImageIO: Write and read chunked compressed image", "[unit][resource][core][MetaImageIO]")
+{
+	QString filename = getTestPath() + "compressed.mhd";
+	vtkImageDataPtr image = createTestImage();
+
+	cx::MetaImageIO writer;
+	writer.setCompression(true);
+	writer.setChunkSize(1000);
+	REQUIRE(writer.write(image, filename));
+	CHECK(writer.getHeader().getValue("CompressedDataChunkSize") == "1000");
+
+	checkEqualImages(image, cx::MetaImageIO().read(filename));
+}
+
+TEST_CASE("MetaImageIO: Write and read image with local data", "[unit][resource][core][MetaImageIO]")
+{
+	QString filename = getTestPath() + "local.mha";
+	vtkImageDataPtr image = cx::generateVtkImageData(Eigen::Array3i(5, 6, 7), cx::Vector3D(1, 1, 1), 3, 3);
+
+	REQUIRE(cx::MetaImageIO().write(image, filename));
+	checkEqualImages(image, cx::MetaImageIO().read(filename));
+
+	// changing the header keeps the data
+	cx::CustomMetaImagePtr custom = cx::CustomMetaImage::create(filename);
+	custom->setModality(cx::imMR);
+	custom->setKey("WindowLevel", "100");
+	checkEqualImages(image, cx::MetaImageIO().read(filename));
+	CHECK(cx::CustomMetaImage::create(filename)->readModality() == cx::imMR);
+}
+
+TEST_CASE("MetaImageIO: Write and read compressed image with local data", "[unit][resource][core][MetaImageIO]")
+{
+	QString filename = getTestPath() + "compressed_local.mha";
+	vtkImageDataPtr image = createTestImage();
+
+	cx::MetaImageIO writer;
+	writer.setCompression(true);
+	writer.setChunkSize(1000);
+	REQUIRE(writer.write(image, filename));
+	checkEqualImages(image, cx::MetaImageIO().read(filename));
+}
+
+TEST_CASE("MetaImageIO: Read single stream compressed image with local data", "[unit][resource][core][MetaImageIO]")
+{
+	QString filename = getTestPath() + "zlib_local.mha";
+	vtkImageDataPtr image = createTestImage();
+	int bytes = 31*17*11*2;
+
+	cx::MetaImageHeader header;
+	header.setValue("ObjectType", "Image");
+	header.setValue("NDims", "3");
+	header.setValue("BinaryData", "True");
+	header.setValue("BinaryDataByteOrderMSB", Q_BYTE_ORDER == Q_BIG_ENDIAN ? "True" : "False");
+	header.setValue("CompressedData", "True");
+	header.setValue("ElementSpacing", "0.5 0.25 2");
+	header.setValue("DimSize", "31 17 11");
+	header.setValue("ElementType", "MET_SHORT");
+	header.setValue("ElementDataFile", "LOCAL");
+
+	QFile file(filename);
+	REQUIRE(file.open(QIODevice::WriteOnly));
+	file.write(header.toByteArray());
+	// qCompress() prefixes the zlib stream with the uncompressed size
+	file.write(qCompress(static_cast<const uchar*>(image->GetScalarPointer()), bytes).mid(4));
+	file.close();
+
+	checkEqualImages(image, cx::MetaImageIO().read(filename));
+}
+
+TEST_CASE("MetaImageHeader: Transform is stored in header", "[unit][resource][core][MetaImageIO]")
+{
+	cx::Transform3D M = cx::createTransformRotateZ(M_PI/3) * cx::createTransformTranslate(cx::Vector3D(1, 2, 3));
+	cx::MetaImageHeader header;
+	header.setValue("ElementDataFile", "LOCAL");
+	header.setTransform(M);
+
+	CHECK(header.getTransform().isApprox(M, 1.0E-5));
+	CHECK(header.getEntries().back().first == "ElementDataFile");
+	CHECK_FALSE(header.hasKey("Position"));
+}
+
+} // namespace cxtest
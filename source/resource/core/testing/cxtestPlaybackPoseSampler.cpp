@@ -0,0 +1,111 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "catch.hpp"
+#include "cxPlaybackPoseSampler.h"
+
+namespace cxtest
+{
+
+namespace
+{
+cx::TimedTransformMapPtr createHistory(int count, double spacing)
+{
+	cx::TimedTransformMapPtr retval(new cx::TimedTransformMap());
+	for (int i = 0; i < count; ++i)
+		(*retval)[1000 + i*spacing] = cx::createTransformTranslate(cx::Vector3D(i, 0, 0));
+	return retval;
+}
+
+int findSampleBeforeInMap(cx::TimedTransformMapPtr history, double time)
+{
+	cx::TimedTransformMap::iterator iter = history->lower_bound(time);
+	if (iter != history->begin())
+		--iter;
+	return std::distance(history->begin(), iter);
+}
+}
+
+TEST_CASE("PlaybackPoseSampler: Empty history gives invisible pose", "[unit]")
+{
+	cx::PlaybackPoseSampler sampler;
+	sampler.setHistory(cx::TimedTransformMapPtr(new cx::TimedTransformMap()));
+	CHECK(sampler.findSampleBefore(0) == -1);
+	CHECK_FALSE(sampler.sample(0).visible);
+}
+
+TEST_CASE("PlaybackPoseSampler: Cursor search equals map lookup", "[unit]")
+{
+	cx::TimedTransformMapPtr history = createHistory(100, 10);
+	cx::PlaybackPoseSampler sampler;
+	sampler.setHistory(history);
+
+	// monotonic playback, both directions, and random seeks
+	for (double t = 900; t < 2200; t += 3)
+		REQUIRE(sampler.findSampleBefore(t) == findSampleBeforeInMap(history, t));
+	for (double t = 2200; t > 900; t -= 7)
+		REQUIRE(sampler.findSampleBefore(t) == findSampleBeforeInMap(history, t));
+	for (int i = 0; i < 500; ++i)
+	{
+		double t = 900 + rand() % 1300;
+		REQUIRE(sampler.findSampleBefore(t) == findSampleBeforeInMap(history, t));
+	}
+}
+
+TEST_CASE("PlaybackPoseSampler: Uses the last sample before time and times out", "[unit]")
+{
+	cx::PlaybackPoseSampler sampler;
+	sampler.setHistory(createHistory(10, 20));
+
+	cx::PlaybackPoseSampler::Pose pose = sampler.sample(1025);
+	CHECK(pose.visible);
+	CHECK(pose.timestamp == Approx(1020));
+	CHECK(cx::similar(pose.prMt, cx::createTransformTranslate(cx::Vector3D(1, 0, 0))));
+
+	CHECK_FALSE(sampler.sample(1180 + 300).visible);
+	CHECK_FALSE(sampler.sample(1000 - 300).visible);
+}
+
+TEST_CASE("PlaybackPoseSampler: Interpolates between samples", "[unit]")
+{
+	cx::TimedTransformMapPtr history(new cx::TimedTransformMap());
+	(*history)[1000] = cx::Transform3D::Identity();
+	(*history)[1100] = cx::createTransformTranslate(cx::Vector3D(10, 0, 0)) * cx::createTransformRotateZ(M_PI/2);
+
+	cx::PlaybackPoseSampler sampler;
+	sampler.setInterpolation(true);
+	sampler.setHistory(history);
+
+	cx::PlaybackPoseSampler::Pose pose = sampler.sample(1050);
+	cx::Transform3D expected = cx::createTransformTranslate(cx::Vector3D(5, 0, 0)) * cx::createTransformRotateZ(M_PI/4);
+	CHECK(pose.visible);
+	CHECK(pose.timestamp == Approx(1050));
+	INFO(expected << " == " << pose.prMt);
+	CHECK(cx::similar(pose.prMt, expected));
+}
+
+TEST_CASE("PlaybackPoseSampler: Detects changed history", "[unit]")
+{
+	cx::TimedTransformMapPtr history = createHistory(10, 20);
+	cx::PlaybackPoseSampler sampler;
+	sampler.setHistory(history);
+	CHECK_FALSE(sampler.isStale(history));
+
+	(*history)[5000] = cx::Transform3D::Identity();
+	CHECK(sampler.isStale(history));
+
+	cx::PlaybackPoseSampler copy = sampler;
+	sampler.setHistory(history);
+	CHECK(sampler.getNumberOfSamples() == 11);
+	CHECK(copy.getNumberOfSamples() == 10);
+}
+
+} // namespace cxtest
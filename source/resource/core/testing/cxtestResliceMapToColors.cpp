@@ -0,0 +1,209 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#include "catch.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <QElapsedTimer>
+#include <vtkImageData.h>
+#include <vtkImageReslice.h>
+#include <vtkImageMapToColors.h>
+#include <vtkLookupTable.h>
+#include <vtkMatrix4x4.h>
+#include "cxResliceMapToColors.h"
+#include "cxVolumeHelpers.h"
+#include "cxTransform3D.h"
+
+namespace
+{
+
+vtkImageDataPtr createTestVolume(Eigen::Array3i dim)
+{
+	vtkImageDataPtr image = cx::generateVtkImageDataSignedShort(dim, cx::Vector3D(0.5, 0.6, 0.8), 0);
+	short* ptr = static_cast<short*>(image->GetScalarPointer());
+	for (int z=0; z<dim[2]; ++z)
+		for (int y=0; y<dim[1]; ++y)
+			for (int x=0; x<dim[0]; ++x)
+				*ptr++ = 7*x - 5*y + 11*z + 100;
+	return image;
+}
+
+vtkLookupTablePtr createTestLUT()
+{
+	// same layout as ImageLUT2D::refreshOutputLUT()
+	vtkLookupTablePtr lut = vtkLookupTablePtr::New();
+	int imin = 0;
+	int imax = 1000;
+	lut->Build();
+	lut->SetNumberOfTableValues(imax-imin+1);
+	lut->SetTableRange(imin, imax);
+	for (int i=0; i<=imax-imin; ++i)
+		lut->SetTableValue(i, double(i)/(imax-imin), 1.0-double(i)/(imax-imin), 0.5, 1);
+	return lut;
+}
+
+/** Reference: the vtkImageReslice -> vtkImageMapToColors chain used by SlicedImageProxy.
+ */
+vtkImageDataPtr createReference(vtkImageDataPtr input, vtkLookupTablePtr lut, vtkMatrix4x4Ptr axes,
+								cx::Vector3D origin, Eigen::Array3i dim, cx::Vector3D spacing, double background)
+{
+	vtkImageReslicePtr reslicer = vtkImageReslicePtr::New();
+	reslicer->SetInterpolationModeToLinear();
+	reslicer->SetOutputDimensionality(2);
+	reslicer->SetResliceAxes(axes);
+	reslicer->SetInputData(input);
+	reslicer->SetBackgroundLevel(background);
+	reslicer->SetOutputOrigin(origin.data());
+	reslicer->SetOutputExtent(0, dim[0], 0, dim[1], 0, 0);
+	reslicer->SetOutputSpacing(spacing.data());
+
+	vtkImageMapToColorsPtr mapper = vtkImageMapToColorsPtr::New();
+	mapper->SetOutputFormatToRGBA();
+	mapper->SetInputConnection(reslicer->GetOutputPort());
+	mapper->SetLookupTable(lut);
+	mapper->Update();
+	return mapper->GetOutput();
+}
+
+vtkMatrix4x4Ptr createObliqueAxes()
+{
+	cx::Transform3D M = cx::createTransformTranslate(cx::Vector3D(10, 12, 9))
+			* cx::createTransformRotateZ(0.3)
+			* cx::createTransformRotateX(0.7);
+	return M.getVtkMatrix();
+}
+
+/** Return fraction of color channels differing by more than tolerance.
+ */
+double compareRGBA(vtkImageDataPtr a, vtkImageDataPtr b, int tolerance)
+{
+	REQUIRE(a->GetNumberOfPoints() == b->GetNumberOfPoints());
+	REQUIRE(a->GetNumberOfScalarComponents() == 4);
+	REQUIRE(b->GetNumberOfScalarComponents() == 4);
+	unsigned char* pa = static_cast<unsigned char*>(a->GetScalarPointer());
+	unsigned char* pb = static_cast<unsigned char*>(b->GetScalarPointer());
+	int n = 4*a->GetNumberOfPoints();
+	int errors = 0;
+	for (int i=0; i<n; ++i)
+		if (std::abs(int(pa[i])-int(pb[i])) > tolerance)
+			++errors;
+	return double(errors)/n;
+}
+
+} // namespace
+
+TEST_CASE("ResliceMapToColors: Oblique slice matches vtkImageReslice and vtkImageMapToColors", "[unit][resource][core]")
+{
+	vtkImageDataPtr input = createTestVolume(Eigen::Array3i(40, 30, 20));
+	vtkLookupTablePtr lut = createTestLUT();
+	vtkMatrix4x4Ptr axes = createObliqueAxes();
+	cx::Vector3D origin(-10, -8, 0);
+	Eigen::Array3i dim(60, 50, 1);
+	cx::Vector3D spacing(0.4, 0.4, 1);
+
+	vtkImageDataPtr expected = createReference(input, lut, axes, origin, dim, spacing, 0);
+
+	vtkSmartPointer<cx::ResliceMapToColors> slicer = vtkSmartPointer<cx::ResliceMapToColors>::New();
+	slicer->setInputImage(input);
+	slicer->setLookupTable(lut);
+	slicer->setResliceAxes(axes);
+	slicer->setOutputFormat(origin, dim, spacing);
+	slicer->setBackgroundLevel(0);
+	slicer->Update();
+	vtkImageDataPtr actual = slicer->GetOutput();
+
+	CHECK(Eigen::Array3i(actual->GetDimensions()).isApprox(Eigen::Array3i(expected->GetDimensions())));
+	// rounding differences between float and double interpolation, and along the volume border
+	CHECK(compareRGBA(actual, expected, 2) < 0.01);
+}
+
+TEST_CASE("ResliceMapToColors: Output follows changes in axes and lookup table", "[unit][resource][core]")
+{
+	vtkImageDataPtr input = createTestVolume(Eigen::Array3i(20, 20, 20));
+	vtkLookupTablePtr lut = createTestLUT();
+	vtkMatrix4x4Ptr axes = vtkMatrix4x4Ptr::New();
+	cx::Vector3D origin(0, 0, 2);
+	Eigen::Array3i dim(10, 10, 1);
+	cx::Vector3D spacing(0.5, 0.5, 1);
+
+	vtkSmartPointer<cx::ResliceMapToColors> slicer = vtkSmartPointer<cx::ResliceMapToColors>::New();
+	slicer->setInputImage(input);
+	slicer->setLookupTable(lut);
+	slicer->setResliceAxes(axes);
+	slicer->setOutputFormat(origin, dim, spacing);
+
+	axes->DeepCopy(cx::createTransformTranslate(cx::Vector3D(1, 2, 3)).getVtkMatrix());
+	slicer->Update();
+	CHECK(compareRGBA(slicer->GetOutput(), createReference(input, lut, axes, origin, dim, spacing, 0), 2) == 0);
+
+	lut->SetTableValue(500, 1, 1, 1, 1);
+	lut->SetTableRange(200, 600);
+	lut->Modified();
+	slicer->Update();
+	CHECK(compareRGBA(slicer->GetOutput(), createReference(input, lut, axes, origin, dim, spacing, 0), 2) == 0);
+}
+
+TEST_CASE("ResliceMapToColors: Only single component 8 and 16 bit images are handled", "[unit][resource][core]")
+{
+	CHECK(cx::ResliceMapToColors::canExecute(cx::generateVtkImageDataSignedShort(Eigen::Array3i(3, 3, 3), cx::Vector3D(1, 1, 1), 0)));
+	CHECK(cx::ResliceMapToColors::canExecute(cx::generateVtkImageData(Eigen::Array3i(3, 3, 3), cx::Vector3D(1, 1, 1), 0)));
+	CHECK_FALSE(cx::ResliceMapToColors::canExecute(cx::generateVtkImageData(Eigen::Array3i(3, 3, 3), cx::Vector3D(1, 1, 1), 0, 3)));
+	CHECK_FALSE(cx::ResliceMapToColors::canExecute(cx::generateVtkImageDataDouble(Eigen::Array3i(3, 3, 3), cx::Vector3D(1, 1, 1), 0)));
+	CHECK_FALSE(cx::ResliceMapToColors::canExecute(vtkImageDataPtr()));
+}
+
+TEST_CASE("Speed: ResliceMapToColors vs vtkImageReslice and vtkImageMapToColors", "[speed][resource][core]")
+{
+	vtkImageDataPtr input = createTestVolume(Eigen::Array3i(512, 512, 300));
+	vtkLookupTablePtr lut = createTestLUT();
+	vtkMatrix4x4Ptr axes = vtkMatrix4x4Ptr::New();
+	cx::Vector3D origin(-20, -20, 0);
+	Eigen::Array3i dim(800, 800, 1);
+	cx::Vector3D spacing(0.4, 0.4, 1);
+	int iterations = 50;
+
+	vtkImageReslicePtr reslicer = vtkImageReslicePtr::New();
+	reslicer->SetInterpolationModeToLinear();
+	reslicer->SetOutputDimensionality(2);
+	reslicer->SetResliceAxes(axes);
+	reslicer->SetInputData(input);
+	reslicer->SetOutputOrigin(origin.data());
+	reslicer->SetOutputExtent(0, dim[0], 0, dim[1], 0, 0);
+	reslicer->SetOutputSpacing(spacing.data());
+	vtkImageMapToColorsPtr mapper = vtkImageMapToColorsPtr::New();
+	mapper->SetOutputFormatToRGBA();
+	mapper->SetInputConnection(reslicer->GetOutputPort());
+	mapper->SetLookupTable(lut);
+
+	vtkSmartPointer<cx::ResliceMapToColors> slicer = vtkSmartPointer<cx::ResliceMapToColors>::New();
+	slicer->setInputImage(input);
+	slicer->setLookupTable(lut);
+	slicer->setResliceAxes(axes);
+	slicer->setOutputFormat(origin, dim, spacing);
+
+	QElapsedTimer timer;
+	timer.start();
+	for (int i=0; i<iterations; ++i)
+	{
+		axes->DeepCopy((cx::createTransformTranslate(cx::Vector3D(50, 50, 20+i)) * cx::createTransformRotateX(0.01*i)).getVtkMatrix());
+		mapper->Update();
+	}
+	double vtkTime = double(timer.restart())/iterations;
+
+	for (int i=0; i<iterations; ++i)
+	{
+		axes->DeepCopy((cx::createTransformTranslate(cx::Vector3D(50, 50, 20+i)) * cx::createTransformRotateX(0.01*i)).getVtkMatrix());
+		slicer->Update();
+	}
+	double cxTime = double(timer.restart())/iterations;
+
+	std::cout << "vtkImageReslice+vtkImageMapToColors: " << vtkTime << " ms/slice" << std::endl;
+	std::cout << "ResliceMapToColors:                  " << cxTime << " ms/slice" << std::endl;
+}
@@ -0,0 +1,154 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "catch.hpp"
+#include "cxSpaceProviderImpl.h"
+#include "cxDummyToolManager.h"
+#include "cxDummyTool.h"
+#include "cxRegistrationTransform.h"
+#include "cxSpaceListener.h"
+#include "cxtestPatientModelServiceMock.h"
+
+namespace cxtest
+{
+
+namespace
+{
+struct SpaceProviderFixture
+{
+	SpaceProviderFixture() :
+		t(cx::csTOOL, "tool1"),
+		to(cx::csTOOL_OFFSET, "tool1"),
+		pr(cx::csPATIENTREF),
+		r(cx::csREF)
+	{
+		tracking = cx::DummyToolManager::create();
+		tool.reset(new cx::DummyTool("tool1"));
+		tracking->addTool(tool);
+		patient.reset(new PatientModelServiceMock());
+		cached.reset(new cx::SpaceProviderImpl(tracking, patient));
+		uncached.reset(new cx::SpaceProviderImpl(tracking, patient));
+		uncached->setCacheEnabled(false);
+	}
+
+	void checkEqualToUncached(cx::CoordinateSystem from, cx::CoordinateSystem to)
+	{
+		CHECK(cx::similar(cached->get_toMfrom(from, to), uncached->get_toMfrom(from, to)));
+	}
+
+	cx::DummyToolManager::DummyToolManagerPtr tracking;
+	cx::DummyToolPtr tool;
+	PatientModelServiceMockPtr patient;
+	boost::shared_ptr<cx::SpaceProviderImpl> cached;
+	boost::shared_ptr<cx::SpaceProviderImpl> uncached;
+	cx::CoordinateSystem t, to, pr, r;
+};
+} // namespace
+
+TEST_CASE("SpaceProviderImpl: Repeated lookups are served from cache", "[unit][resource][core]")
+{
+	SpaceProviderFixture fixture;
+	fixture.tool->set_prMt(cx::createTransformTranslate(cx::Vector3D(1,2,3)));
+
+	fixture.cached->get_toMfrom(fixture.t, fixture.r);
+	CHECK(fixture.cached->getCacheMissCount() == 2);
+	CHECK(fixture.cached->getCacheHitCount() == 0);
+
+	for (int i=0; i<10; ++i)
+		fixture.checkEqualToUncached(fixture.t, fixture.r);
+	CHECK(fixture.cached->getCacheMissCount() == 2);
+	CHECK(fixture.cached->getCacheHitCount() == 20);
+
+	CHECK(fixture.uncached->getCacheHitCount() == 0);
+}
+
+TEST_CASE("SpaceProviderImpl: Tool movement invalidates the tool spaces only", "[unit][resource][core]")
+{
+	SpaceProviderFixture fixture;
+	fixture.tool->set_prMt(cx::createTransformTranslate(cx::Vector3D(1,2,3)));
+	fixture.checkEqualToUncached(fixture.t, fixture.pr);
+	fixture.checkEqualToUncached(fixture.to, fixture.pr);
+	unsigned long misses = fixture.cached->getCacheMissCount();
+
+	fixture.tool->set_prMt(cx::createTransformTranslate(cx::Vector3D(4,5,6)));
+	fixture.checkEqualToUncached(fixture.t, fixture.pr);
+	fixture.checkEqualToUncached(fixture.to, fixture.pr);
+	CHECK(fixture.cached->getCacheMissCount() == misses+2);
+
+	fixture.tool->setTooltipOffset(7);
+	fixture.checkEqualToUncached(fixture.to, fixture.pr);
+	CHECK(fixture.cached->getCacheMissCount() == misses+3);
+}
+
+TEST_CASE("SpaceProviderImpl: Patient registration invalidates tool and patient spaces", "[unit][resource][core]")
+{
+	SpaceProviderFixture fixture;
+	fixture.tool->set_prMt(cx::createTransformTranslate(cx::Vector3D(1,2,3)));
+	fixture.checkEqualToUncached(fixture.t, fixture.r);
+	fixture.checkEqualToUncached(fixture.pr, fixture.r);
+	unsigned long misses = fixture.cached->getCacheMissCount();
+
+	fixture.patient->get_rMpr_History()->setRegistration(cx::createTransformRotateZ(M_PI/4));
+	fixture.checkEqualToUncached(fixture.t, fixture.r);
+	fixture.checkEqualToUncached(fixture.pr, fixture.r);
+	CHECK(fixture.cached->getCacheMissCount() == misses+2);
+}
+
+namespace
+{
+class LookupOnChange : public QObject
+{
+public:
+	LookupOnChange(cx::SpaceProviderPtr spaces, cx::CoordinateSystem from, cx::CoordinateSystem to) :
+		mSpaces(spaces), mFrom(from), mTo(to)
+	{
+		mListener = spaces->createListener();
+		mListener->setSpace(from);
+		connect(mListener.get(), &cx::SpaceListener::changed, this, &LookupOnChange::onChanged);
+	}
+	cx::Transform3D mLastLookup;
+private:
+	void onChanged() { mLastLookup = mSpaces->get_toMfrom(mFrom, mTo); }
+	cx::SpaceProviderPtr mSpaces;
+	cx::SpaceListenerPtr mListener;
+	cx::CoordinateSystem mFrom, mTo;
+};
+} // namespace
+
+TEST_CASE("SpaceProviderImpl: Listeners connected before the first lookup see the new transform", "[unit][resource][core]")
+{
+	SpaceProviderFixture fixture;
+	LookupOnChange lookup(fixture.cached, fixture.t, fixture.pr);
+
+	cx::Transform3D prMt1 = cx::createTransformTranslate(cx::Vector3D(1,2,3));
+	fixture.tool->set_prMt(prMt1);
+	CHECK(cx::similar(lookup.mLastLookup, prMt1));
+
+	cx::Transform3D prMt2 = cx::createTransformTranslate(cx::Vector3D(4,5,6));
+	fixture.tool->set_prMt(prMt2);
+	CHECK(cx::similar(lookup.mLastLookup, prMt2));
+}
+
+TEST_CASE("SpaceProviderImpl: Tools added without notification are not cached", "[unit][resource][core]")
+{
+	SpaceProviderFixture fixture;
+	cx::DummyToolPtr tool2(new cx::DummyTool("tool2"));
+	fixture.tracking->addTool(tool2);
+	cx::CoordinateSystem t2(cx::csTOOL, "tool2");
+
+	tool2->set_prMt(cx::createTransformTranslate(cx::Vector3D(1,2,3)));
+	fixture.checkEqualToUncached(t2, fixture.pr);
+	fixture.checkEqualToUncached(t2, fixture.pr);
+	CHECK(fixture.cached->getCacheHitCount() == 1); // pr
+	CHECK(fixture.cached->getCacheMissCount() == 3); // pr once, t2 twice
+}
+
+} // namespace cxtest
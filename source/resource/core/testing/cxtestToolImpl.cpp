@@ -0,0 +1,96 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "catch.hpp"
+#include "cxDummyTool.h"
+
+namespace cxtest
+{
+
+namespace
+{
+class BatchingTool : public cx::DummyTool
+{
+public:
+	BatchingTool() : cx::DummyTool("batching"), mSignals(0), mLastTimestamp(0)
+	{
+		connect(this, &cx::Tool::toolTransformAndTimestamp, [this](cx::Transform3D, double timestamp)
+		{
+			++mSignals;
+			mLastTimestamp = timestamp;
+		});
+	}
+	void addSample(double timestamp, bool store)
+	{
+		cx::Transform3D prMt = cx::createTransformTranslate(cx::Vector3D(timestamp, 0, 0));
+		cx::Transform3D filtered = cx::createTransformTranslate(cx::Vector3D(timestamp, 1, 0));
+		this->addTrackingSample(prMt, filtered, timestamp, store);
+	}
+	int mSignals;
+	double mLastTimestamp;
+};
+} // namespace
+
+TEST_CASE("ToolImpl: First tracking sample is committed immediately", "[unit][resource][core]")
+{
+	BatchingTool tool;
+	tool.setTrackingBatchInterval(1000);
+
+	tool.addSample(1, true);
+	CHECK(tool.mSignals == 1);
+	CHECK(tool.mLastTimestamp == 1);
+	CHECK(cx::similar(tool.get_prMt(), cx::createTransformTranslate(cx::Vector3D(1, 1, 0))));
+	CHECK(tool.getPositionHistory()->count(1) == 1);
+}
+
+TEST_CASE("ToolImpl: Tracking samples within the interval are committed in batches", "[unit][resource][core]")
+{
+	BatchingTool tool;
+	tool.setTrackingBatchInterval(1000);
+	tool.addSample(1, true);
+	size_t initialHistory = tool.getPositionHistory()->size();
+
+	for (int i=2; i<=10; ++i)
+		tool.addSample(i, i!=5);
+
+	CHECK(tool.getPositionHistory()->size() == initialHistory);
+	CHECK(tool.mSignals == 1);
+	CHECK(tool.getTrackingCounters().samplesIngested == 10);
+
+	tool.commitTrackingSamples();
+
+	cx::TimedTransformMapPtr history = tool.getPositionHistory();
+	CHECK(history->size() == initialHistory+8);
+	CHECK(history->count(5) == 0);
+	CHECK(cx::similar(history->find(7)->second, cx::createTransformTranslate(cx::Vector3D(7, 0, 0))));
+	CHECK(cx::similar(tool.get_prMt(), cx::createTransformTranslate(cx::Vector3D(10, 1, 0))));
+	CHECK(tool.mSignals == 2);
+	CHECK(tool.mLastTimestamp == 10);
+	CHECK(tool.getTrackingCounters().batchesCommitted == 2);
+
+	tool.commitTrackingSamples();
+	CHECK(tool.mSignals == 2);
+}
+
+TEST_CASE("ToolImpl: Zero batch interval commits each tracking sample", "[unit][resource][core]")
+{
+	BatchingTool tool;
+	tool.setTrackingBatchInterval(0);
+
+	tool.addSample(1, true);
+	tool.addSample(2, true);
+
+	CHECK(tool.mSignals == 2);
+	CHECK(tool.getPositionHistory()->count(2) == 1);
+	CHECK(tool.getTrackingCounters().batchesCommitted == 2);
+}
+
+} // namespace cxtest
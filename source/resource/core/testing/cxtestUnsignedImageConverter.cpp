@@ -0,0 +1,116 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#include "catch.hpp"
+#include <vtkImageData.h>
+#include <vtkImageShiftScale.h>
+#include "cxUnsignedImageConverter.h"
+#include "cxUnsignedDerivedImage.h"
+#include "cxVolumeHelpers.h"
+#include "cxImage.h"
+
+namespace
+{
+
+vtkImageDataPtr createSignedVolume(Eigen::Array3i dim)
+{
+	vtkImageDataPtr image = cx::generateVtkImageDataSignedShort(dim, cx::Vector3D(1, 1, 1), 0);
+	short* ptr = static_cast<short*>(image->GetScalarPointer());
+	for (int i=0; i<dim.prod(); ++i)
+		ptr[i] = (i*37)%3000 - 1200;
+	image->Modified();
+	return image;
+}
+
+void checkEqual(vtkImageDataPtr actual, vtkImageDataPtr expected)
+{
+	REQUIRE(actual);
+	REQUIRE(actual->GetScalarType() == expected->GetScalarType());
+	REQUIRE(actual->GetNumberOfPoints() == expected->GetNumberOfPoints());
+	int bytes = expected->GetNumberOfPoints()*expected->GetScalarSize()*expected->GetNumberOfScalarComponents();
+	CHECK(memcmp(actual->GetScalarPointer(), expected->GetScalarPointer(), bytes) == 0);
+}
+
+vtkImageDataPtr convertWithVtk(vtkImageDataPtr input, double shift, int type)
+{
+	vtkImageShiftScalePtr cast = vtkImageShiftScalePtr::New();
+	cast->SetInputData(input);
+	cast->ClampOverflowOn();
+	cast->SetShift(shift);
+	cast->SetOutputScalarType(type);
+	cast->Update();
+	return cast->GetOutput();
+}
+
+} // namespace
+
+TEST_CASE("UnsignedImageConverter: Output equals vtkImageShiftScale with clamping", "[unit][resource][core]")
+{
+	vtkImageDataPtr input = createSignedVolume(Eigen::Array3i(31, 20, 17));
+
+	cx::UnsignedImageConverter converter;
+	converter.setShift(1024); // CT shift, clamps the lowest values
+	converter.setOutputScalarType(VTK_UNSIGNED_SHORT);
+	vtkImageDataPtr output = converter.convert(input);
+
+	checkEqual(output, convertWithVtk(input, 1024, VTK_UNSIGNED_SHORT));
+	CHECK(converter.getInputMin() == Approx(input->GetScalarRange()[0]));
+	CHECK(converter.getInputMax() == Approx(input->GetScalarRange()[1]));
+}
+
+TEST_CASE("UnsignedImageConverter: Converting an extent updates that extent only", "[unit][resource][core]")
+{
+	Eigen::Array3i dim(20, 20, 20);
+	vtkImageDataPtr input = createSignedVolume(dim);
+
+	cx::UnsignedImageConverter converter;
+	converter.setShift(1200);
+	converter.setOutputScalarType(VTK_UNSIGNED_SHORT);
+	vtkImageDataPtr output = converter.convert(input);
+
+	short* in = static_cast<short*>(input->GetScalarPointer(5, 6, 7));
+	*in = -1000;
+	short* outside = static_cast<short*>(input->GetScalarPointer(15, 15, 15));
+	*outside = -1000;
+	input->Modified();
+
+	REQUIRE(converter.convertExtent(input, output, cx::IntBoundingBox3D(4, 6, 5, 7, 7, 7)));
+	CHECK(converter.getInputMin() <= -1000);
+	CHECK(*static_cast<unsigned short*>(output->GetScalarPointer(5, 6, 7)) == 200);
+	CHECK(*static_cast<unsigned short*>(output->GetScalarPointer(15, 15, 15)) != 200);
+}
+
+TEST_CASE("UnsignedDerivedImage: Partial update gives the same result as a full conversion", "[unit][resource][core]")
+{
+	vtkImageDataPtr data = createSignedVolume(Eigen::Array3i(20, 20, 20));
+	cx::ImagePtr image = cx::Image::create("image", "image");
+	image->setVtkImageData(data);
+
+	cx::ImagePtr unsignedImage = image->getUnsigned(image);
+	boost::shared_ptr<cx::UnsignedDerivedImage> derived = boost::dynamic_pointer_cast<cx::UnsignedDerivedImage>(unsignedImage);
+	REQUIRE(derived);
+	vtkImageDataPtr converted = derived->getBaseVtkImageData();
+	int shift = -image->getMin();
+
+	short* ptr = static_cast<short*>(data->GetScalarPointer(3, 4, 5));
+	ptr[0] = 100;
+	ptr[1] = 200;
+	data->Modified();
+	derived->updateExtent(cx::IntBoundingBox3D(3, 4, 4, 4, 5, 5));
+
+	CHECK(derived->getBaseVtkImageData() == converted); // updated in place
+	checkEqual(derived->getBaseVtkImageData(), convertWithVtk(data, shift, VTK_UNSIGNED_SHORT));
+
+	// a value below the current shift forces a full conversion with a new shift
+	ptr[0] = -1500;
+	data->Modified();
+	derived->updateExtent(cx::IntBoundingBox3D(3, 3, 4, 4, 5, 5));
+	checkEqual(derived->getBaseVtkImageData(), convertWithVtk(data, 1500, VTK_UNSIGNED_SHORT));
+}
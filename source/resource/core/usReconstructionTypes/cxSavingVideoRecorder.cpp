@@ -38,6 +38,8 @@ VideoRecorderSaveThread::VideoRecorderSaveThread(QObject* parent, QString saveFo
 	mPrefix(prefix),
 	mImageIndex(0),
 	mMutex(QMutex::Recursive),
+	mMaxPendingFrames(200),
+	mDroppedFrames(0),
 	mStop(false),
 	mCancel(false),
 	mTimestampsFile(saveFolder+"/"+prefix+".fts"),
@@ -56,6 +58,15 @@ QString VideoRecorderSaveThread::addData(TimeInfo timestamp, vtkImageDataPtr ima
 	if (!image)
 		return "";
 
+	{
+		QMutexLocker sentry(&mMutex);
+		if (int(mPendingData.size()) >= mMaxPendingFrames)
+		{
+			++mDroppedFrames;
+			return "";
+		}
+	}
+
 	DataType data;
 	data.mTimestamp = timestamp;
 	data.mImage = vtkImageDataPtr::New();
@@ -202,6 +213,13 @@ void SavingVideoRecorder::startRecord()
 void SavingVideoRecorder::stopRecord()
 {
 	disconnect(mSource.get(), &VideoSource::newFrame, this, &SavingVideoRecorder::newFrameSlot);
+
+	int dropped = this->getNumberOfDroppedFrames();
+	if (dropped)
+		reportWarning(QString("Dropped %1 of %2 frames from %3, the write queue was full.")
+					  .arg(dropped)
+					  .arg(dropped + int(mTimestamps.size()))
+					  .arg(mSource->getName()));
 }
 
 void SavingVideoRecorder::newFrameSlot()
@@ -212,11 +230,22 @@ void SavingVideoRecorder::newFrameSlot()
 	vtkImageDataPtr image = mSource->getVtkImageData();
 	TimeInfo timestamp = mSource->getAdvancedTimeInfo();
 	QString filename = mSaveThread->addData(timestamp, image);
+	if (filename.isEmpty())
+	{
+		if (this->getNumberOfDroppedFrames()==1)
+			reportWarning(QString("Write queue for %1 is full, dropping frames.").arg(mSource->getName()));
+		return;
+	}
 
 	mImages->append(filename);
 	mTimestamps.push_back(timestamp);
 }
 
+int SavingVideoRecorder::getNumberOfDroppedFrames() const
+{
+	return mSaveThread->getNumberOfDroppedFrames();
+}
+
 CachedImageDataContainerPtr SavingVideoRecorder::getImageData()
 {
 	return mImages;
@@ -39,6 +39,9 @@ typedef boost::shared_ptr<class CachedImageDataContainer> CachedImageDataContain
   * If stop() is called, the thread will continue to write all remaining data,
   * then close files and return from run().
   *
+  * At most getMaxPendingFrames() frames are held in memory waiting to be written.
+  * Frames added to a full queue are dropped, see getNumberOfDroppedFrames().
+  *
   * Note: quit() will not work on this thread, use stop() instead.
   *
   * \date Dwc 2, 2012
@@ -55,11 +58,15 @@ public:
 	VideoRecorderSaveThread(QObject* parent, QString saveFolder, QString prefix, bool compressed, bool writeColor);
 	virtual ~VideoRecorderSaveThread();
 	/**
-	  * Add data to be saved.
+	  * Add data to be saved. Return the filename the data will be written to,
+	  * or empty if the data was dropped.
 	  */
 	QString addData(TimeInfo timestamp, vtkImageDataPtr data);
 	void stop();
 	void cancel();
+	void setMaxPendingFrames(int count) { mMaxPendingFrames = count; }
+	int getMaxPendingFrames() const { return mMaxPendingFrames; }
+	int getNumberOfDroppedFrames() const { return mDroppedFrames; } ///< frames not saved because the queue was full
 
 protected:
 	struct DataType
@@ -73,6 +80,8 @@ protected:
 	int mImageIndex;
 	std::list<DataType> mPendingData;
 	QMutex mMutex; ///< protects the mPendingData
+	int mMaxPendingFrames;
+	int mDroppedFrames;
 	bool mStop;
 	bool mCancel;
 	QFile mTimestampsFile;
@@ -116,6 +125,7 @@ public:
 	CachedImageDataContainerPtr getImageData();
 	std::vector<TimeInfo> getTimestamps();
 	QString getSaveFolder() { return mSaveFolder; }
+	int getNumberOfDroppedFrames() const;
 
 	/** Call to force complete the writing of data to disk.
 	  */
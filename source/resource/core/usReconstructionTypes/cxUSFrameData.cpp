@@ -26,6 +26,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "cxLogger.h"
 #include "cxFileManagerService.h"
 #include "cxImage.h"
+#include "cxGrayScaleImageConverter.h"
 
 
 typedef vtkSmartPointer<vtkImageAppend> vtkImageAppendPtr;
@@ -40,6 +41,7 @@ ProcessedUSInputData::ProcessedUSInputData(std::vector<vtkImageDataPtr> frames,
 	mPath(path),
 	mUid(uid)
 {
+	mMaskSpans = MaskSpans::createFromMask(mMask);
 	this->validate();
 }
 
@@ -61,6 +63,12 @@ bool ProcessedUSInputData::validate() const
 		return false;
 	}
 
+	if (!mMaskSpans)
+	{
+		reportWarning("Missing mask in US input data");
+		return false;
+	}
+
 	return true;
 }
 
@@ -99,6 +107,11 @@ vtkImageDataPtr ProcessedUSInputData::getMask()
 	return mMask;
 }
 
+MaskSpansPtr ProcessedUSInputData::getMaskSpans() const
+{
+	return mMaskSpans;
+}
+
 QString ProcessedUSInputData::getFilePath()
 {
 	return mPath;
@@ -206,6 +219,20 @@ void USFrameData::removeFrame(unsigned int index)
 	mReducedToFull.erase(mReducedToFull.begin()+index);
 }
 
+/**
+ * Dimensions will be changed after this
+ */
+void USFrameData::removeFrames(const std::vector<bool>& remove)
+{
+	unsigned count = 0;
+	for (unsigned i=0; i<mReducedToFull.size() && i<remove.size(); ++i)
+		if (!remove[i])
+			mReducedToFull[count++] = mReducedToFull[i];
+	for (unsigned i=remove.size(); i<mReducedToFull.size(); ++i)
+		mReducedToFull[count++] = mReducedToFull[i];
+	mReducedToFull.resize(count);
+}
+
 Eigen::Array3i USFrameData::getDimensions() const
 {
 	vtkImageDataPtr image = mImageContainer->get(0);
@@ -286,6 +313,10 @@ vtkImageDataPtr USFrameData::to8bitGrayscaleAndEffectuateCropping(vtkImageDataPt
 
 	vtkImageDataPtr outData = this->convertTo8bit(grayScaleData);
 
+	// converted data are already a standalone copy
+	if (outData != input && GrayScaleImageConverter::canConvert(input))
+		return outData;
+
 	vtkImageDataPtr copy = vtkImageDataPtr::New();
 	copy->DeepCopy(outData);
 	return copy;
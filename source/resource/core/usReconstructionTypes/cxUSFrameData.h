@@ -51,6 +51,7 @@ public:
 	Vector3D getSpacing() const;
 	std::vector<TimedPosition> getFrames() const;
 	vtkImageDataPtr getMask();
+	MaskSpansPtr getMaskSpans() const; ///< the mask as spans of valid pixels per row
 
 	QString getFilePath();
 	QString getUid();
@@ -60,6 +61,7 @@ private:
 	std::vector<vtkImageDataPtr> mProcessedImage;
 	std::vector<TimedPosition> mFrames;
 	vtkImageDataPtr mMask;///< Clipping mask for the input data
+	MaskSpansPtr mMaskSpans;
 	QString mPath;
 	QString mUid;
 };
@@ -101,6 +103,7 @@ public:
 
 	void resetRemovedFrames();
 	void removeFrame(unsigned int index);
+	void removeFrames(const std::vector<bool>& remove); ///< remove all frames i with remove[i] set, in one pass
 	void setCropBox(IntBoundingBox3D mCropbox);
 	void fillImageImport(vtkImageImportPtr import, int index); ///< fill import with a single frame
 	void setPurgeInputDataAfterInitialize(bool value);
@@ -21,6 +21,11 @@ vtkImageDataPtr USReconstructInputData::getMask()
 	return retval;
 }
 
+MaskSpansPtr USReconstructInputData::getMaskSpans()
+{
+	return mProbeDefinition.getMaskSpans();
+}
+
 bool USReconstructInputData::isValid() const
 {
 	if (mFrames.empty() || !mUsRaw || mPositions.empty())
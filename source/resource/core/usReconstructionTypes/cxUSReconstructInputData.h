@@ -59,6 +59,7 @@ struct cxResource_EXPORT USReconstructInputData
 	Transform3D rMpr; ///< patient registration
 
 	vtkImageDataPtr getMask();
+	MaskSpansPtr getMaskSpans();
 	bool isValid() const;
 	bool is8bit() const;
 };
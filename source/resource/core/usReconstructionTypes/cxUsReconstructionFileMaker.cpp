@@ -29,6 +29,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "cxImageDataContainer.h"
 #include "cxUSReconstructInputDataAlgoritms.h"
 #include "cxCustomMetaImage.h"
+#include "cxMetaImageHeader.h"
 #include "cxErrorObserver.h"
 
 
@@ -38,7 +39,8 @@ namespace cx
 {
 
 UsReconstructionFileMaker::UsReconstructionFileMaker(QString sessionDescription) :
-    mSessionDescription(sessionDescription)
+    mSessionDescription(sessionDescription),
+	mCopiedImages(0)
 {
 }
 
@@ -331,22 +333,35 @@ void UsReconstructionFileMaker::report()
 	}
 }
 
+/** Write all frames as separate files.
+ *  Frames recorded to file in the requested format are copied without decoding,
+ *  other frames are loaded and written.
+ */
 void UsReconstructionFileMaker::writeUSImages(QString path, ImageDataContainerPtr images, bool compression, std::vector<TimedPosition> pos)
 {
 	CX_ASSERT(images->size()==pos.size());
 	vtkMetaImageWriterPtr writer = vtkMetaImageWriterPtr::New();
+	CachedImageDataContainerPtr recorded = boost::dynamic_pointer_cast<CachedImageDataContainer>(images);
+	mCopiedImages = 0;
 
 	for (unsigned i=0; i<images->size(); ++i)
 	{
-		vtkImageDataPtr currentImage = images->get(i);
 		QString filename = QString("%1/%2_%3.mhd").arg(path).arg(mSessionDescription).arg(i);
 
-		writer->SetInputData(currentImage);
-		writer->SetFileName(cstring_cast(filename));
-		writer->SetCompression(compression);
+		if (recorded && this->copyRecordedImage(recorded->getFilename(i), filename, compression))
+		{
+			++mCopiedImages;
+		}
+		else
 		{
-			StaticMutexVtkLocker lock;
-			writer->Write();
+			vtkImageDataPtr currentImage = images->get(i);
+			writer->SetInputData(currentImage);
+			writer->SetFileName(cstring_cast(filename));
+			writer->SetCompression(compression);
+			{
+				StaticMutexVtkLocker lock;
+				writer->Write();
+			}
 		}
 
 		CustomMetaImagePtr customReader = CustomMetaImage::create(filename);
@@ -356,6 +371,46 @@ void UsReconstructionFileMaker::writeUSImages(QString path, ImageDataContainerPt
 	}
 }
 
+/** Copy the .mhd file source and its data file to target, if source has the
+ *  requested compression. Return false if nothing was copied.
+ */
+bool UsReconstructionFileMaker::copyRecordedImage(QString source, QString target, bool compression)
+{
+	if (!QFileInfo(source).exists())
+		return false;
+
+	MetaImageHeader header;
+	if (!header.read(source))
+		return false;
+	bool sourceCompressed = header.getValue("CompressedData").compare("True", Qt::CaseInsensitive) == 0;
+	QString dataFile = header.getValue("ElementDataFile");
+	if (sourceCompressed != compression)
+		return false;
+	if (header.hasKey("CompressedDataChunkSize")) // only readable by MetaImageIO
+		return false;
+	if (dataFile.isEmpty() || (dataFile == "LOCAL") || dataFile.contains("%") || dataFile.startsWith("LIST"))
+		return false;
+
+	QFileInfo targetInfo(target);
+	QString sourceData = QFileInfo(source).absolutePath() + "/" + dataFile;
+	QString targetDataFile = targetInfo.completeBaseName() + "." + QFileInfo(dataFile).suffix();
+	QString targetData = targetInfo.absolutePath() + "/" + targetDataFile;
+
+	QFile::remove(targetData);
+	if (!QFile::copy(sourceData, targetData))
+		return false;
+
+	header.setValue("ElementDataFile", targetDataFile);
+	QFile file(target);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		QFile::remove(targetData);
+		return false;
+	}
+	file.write(header.toByteArray());
+	return true;
+}
+
 void UsReconstructionFileMaker::writeMask(QString path, QString session, vtkImageDataPtr mask)
 {
 	QString filename = QString("%1/%2.mask.mhd").arg(path).arg(session);
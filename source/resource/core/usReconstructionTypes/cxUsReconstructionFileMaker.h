@@ -61,6 +61,7 @@ public:
 	QString writeToNewFolder(QString path, bool compression);
 
 	QString getSessionName() const { return mSessionDescription; }
+	int getNumberOfCopiedImages() const { return mCopiedImages; } ///< frames copied from the recorded files by the last write, the rest were converted
 
 
 	/**
@@ -94,6 +95,7 @@ private:
 	bool writeTrackerTimestamps(QString reconstructionFolder, QString session, std::vector<TimedPosition> ts);
 	void writeProbeConfiguration(QString reconstructionFolder, QString session, ProbeDefinition data, QString uid);
 	void writeUSImages(QString path, ImageDataContainerPtr images, bool compression, std::vector<TimedPosition> pos);
+	bool copyRecordedImage(QString source, QString target, bool compression);
 	void writeMask(QString path, QString session, vtkImageDataPtr mask);
 	void writeREADMEFile(QString reconstructionFolder, QString session);
 	bool writeTimestamps(QString filename, std::vector<TimedPosition> ts, QString type, TimeStampType timeStampType = Modified);
@@ -106,6 +108,7 @@ private:
 	USReconstructInputData mReconstructData;
 	QString mSessionDescription;
 	QStringList mReport;
+	int mCopiedImages;
 };
 
 typedef boost::shared_ptr<UsReconstructionFileMaker> UsReconstructionFileMakerPtr;
@@ -33,6 +33,24 @@ UsReconstructionFileReader::UsReconstructionFileReader(FileManagerServicePtr fil
 }
 
 USReconstructInputData UsReconstructionFileReader::readAllFiles(QString fileName, QString calFilesPath)
+{
+  USReconstructInputData retval = this->readFramesAndProbe(fileName, calFilesPath);
+  if (!retval.mUsRaw)
+    return retval;
+
+  retval.mPositions = this->readPositions(fileName);
+
+	//mPos is now prMs
+  if (!retval.mFrames.empty())
+  {
+	  double msecs = (retval.mFrames.rbegin()->mTime - retval.mFrames.begin()->mTime);
+	  report(QString("Read %1 seconds of us data from %2.").arg(msecs/1000, 0, 'g', 3).arg(fileName));
+  }
+
+  return retval;
+}
+
+USReconstructInputData UsReconstructionFileReader::readFramesAndProbe(QString fileName, QString calFilesPath)
 {
   if (calFilesPath.isEmpty())
   {
@@ -77,20 +95,12 @@ USReconstructInputData UsReconstructionFileReader::readAllFiles(QString fileName
   retval.mProbeUid = probeDefinitionFull.first;
 
   retval.mFrames = this->readFrameTimestamps(fileName);
-  retval.mPositions = this->readPositions(fileName);
 
 	if (!this->valid(retval))
 	{
 		return USReconstructInputData();
 	}
 
-	//mPos is now prMs
-  if (!retval.mFrames.empty())
-  {
-	  double msecs = (retval.mFrames.rbegin()->mTime - retval.mFrames.begin()->mTime);
-	  report(QString("Read %1 seconds of us data from %2.").arg(msecs/1000, 0, 'g', 3).arg(fileName));
-  }
-
   return retval;
 }
 
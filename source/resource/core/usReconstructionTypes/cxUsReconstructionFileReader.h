@@ -138,6 +138,11 @@ public:
 	 * the mMask var is filled with data from ProbeDefinition, or from file if present.
 	 */
 	USReconstructInputData readAllFiles(QString fileName, QString calFilesPath = "");
+	/** Read the US frames, frame timestamps and probe definition only,
+	 *  as needed for playback. Frames stored as one file per frame are
+	 *  not loaded, only their filenames are listed.
+	 */
+	USReconstructInputData readFramesAndProbe(QString fileName, QString calFilesPath = "");
 
 	std::vector<TimedPosition> readFrameTimestamps(QString fileName);
 	/**
@@ -15,6 +15,8 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 
 #include "cxUsReconstructionFileMaker.h"
 #include "cxUsReconstructionFileReader.h"
+#include "cxSavingVideoRecorder.h"
+#include "cxImageDataContainer.h"
 #include "cxUSFrameData.h"
 #include "cxDataLocations.h"
 #include "cxLogicManager.h"
@@ -79,3 +81,47 @@ TEST_CASE_METHOD(cxtest::USReconstructionFileFixture, "USReconstructionFile: Sav
 	this->assertCorrespondence(input, hasBeenRead);
 	cx::LogicManager::shutdown();
 }
+
+TEST_CASE_METHOD(cxtest::USReconstructionFileFixture, "USReconstructionFile: Save recorded frames by copy or conversion", "[integration][resource][usReconstructionTypes]")
+{
+	cx::LogicManager::initialize();
+	cx::FileManagerServicePtr filemanager = cx::FileManagerServiceProxy::create(cx::logicManager()->getPluginContext());
+	ReconstructionData input = this->createSampleReconstructData();
+
+	bool recordCompressed = true;
+	int expectedCopies = 0;
+	SECTION("Copy frames recorded with the requested compression")
+	{
+		recordCompressed = true;
+		expectedCopies = input.imageData->size();
+	}
+	SECTION("Convert frames recorded without compression")
+	{
+		recordCompressed = false;
+		expectedCopies = 0;
+	}
+	input.imageData = this->createRecordedFrames(input.imageData, recordCompressed, filemanager);
+
+	int copiedImages = -1;
+	QString filename = this->write(input, true, &copiedImages);
+	CHECK(copiedImages == expectedCopies);
+
+	cx::USReconstructInputData hasBeenRead = this->read(filename, filemanager);
+	this->assertCorrespondence(input, hasBeenRead);
+	cx::LogicManager::shutdown();
+}
+
+TEST_CASE_METHOD(cxtest::USReconstructionFileFixture, "USReconstructionFile: Recorder write queue drops frames when full", "[unit][resource][usReconstructionTypes]")
+{
+	ReconstructionData input = this->createSampleReconstructData();
+	vtkImageDataPtr image = input.imageData->get(0);
+
+	// not started: nothing is taken from the queue
+	cx::VideoRecorderSaveThread saveThread(NULL, this->getDataPath(), "queue", true, true);
+	saveThread.setMaxPendingFrames(2);
+
+	CHECK(!saveThread.addData(cx::TimeInfo(0), image).isEmpty());
+	CHECK(!saveThread.addData(cx::TimeInfo(1), image).isEmpty());
+	CHECK(saveThread.addData(cx::TimeInfo(2), image).isEmpty());
+	CHECK(saveThread.getNumberOfDroppedFrames() == 1);
+}
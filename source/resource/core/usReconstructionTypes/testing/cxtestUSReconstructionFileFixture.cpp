@@ -12,6 +12,8 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "cxtestUSReconstructionFileFixture.h"
 
 #include <QFileInfo>
+#include <QDir>
+#include "vtkMetaImageWriter.h"
 #include "cxFileHelpers.h"
 #include "cxDataLocations.h"
 #include "cxUsReconstructionFileMaker.h"
@@ -54,15 +56,38 @@ void USReconstructionFileFixture::assertValidFolderForSession(QString path, QStr
 	CHECK(info.absoluteFilePath().contains(sessionName));
 }
 
-QString USReconstructionFileFixture::write(ReconstructionData input)
+/** Write frames to separate files, as done by the recorder,
+ *  and return a container backed by the files.
+ */
+cx::ImageDataContainerPtr USReconstructionFileFixture::createRecordedFrames(cx::ImageDataContainerPtr frames, bool compress, cx::FileManagerServicePtr filemanagerservice)
+{
+	QString path = this->getDataPath() + "/recorded";
+	QDir().mkpath(path);
+
+	std::vector<QString> filenames;
+	vtkMetaImageWriterPtr writer = vtkMetaImageWriterPtr::New();
+	for (unsigned i=0; i<frames->size(); ++i)
+	{
+		QString filename = QString("%1/frame_%2.mhd").arg(path).arg(i);
+		writer->SetInputData(frames->get(i));
+		writer->SetFileName(cstring_cast(filename));
+		writer->SetCompression(compress);
+		writer->Write();
+		filenames.push_back(filename);
+	}
+	return cx::ImageDataContainerPtr(new cx::CachedImageDataContainer(filenames, filemanagerservice));
+}
+
+QString USReconstructionFileFixture::write(ReconstructionData input, bool compress, int* copiedImages)
 {
 	QString path = cx::UsReconstructionFileMaker::createFolder(this->getDataPath(), input.sessionName);
 	cx::USReconstructInputData toBeWritten = this->createUSReconstructData(input);
 
 	cx::UsReconstructionFileMakerPtr fileMaker(new cx::UsReconstructionFileMaker(input.sessionName));
 	fileMaker->setReconstructData(toBeWritten);
-	bool compress = true;
 	fileMaker->writeToNewFolder(path, compress);
+	if (copiedImages)
+		*copiedImages = fileMaker->getNumberOfCopiedImages();
 	return fileMaker->getReconstructData().mFilename;
 }
 
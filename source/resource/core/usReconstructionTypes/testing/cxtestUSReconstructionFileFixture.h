@@ -54,7 +54,8 @@ protected:
 
 	cx::USReconstructInputData createUSReconstructData(ReconstructionData input);
 
-	QString write(ReconstructionData input);
+	cx::ImageDataContainerPtr createRecordedFrames(cx::ImageDataContainerPtr frames, bool compress, cx::FileManagerServicePtr filemanagerservice);
+	QString write(ReconstructionData input, bool compress = true, int* copiedImages = NULL);
 	cx::USReconstructInputData read(QString filename, cx::FileManagerServicePtr filemanagerservice);
 	void assertCorrespondence(ReconstructionData input, cx::USReconstructInputData output);
 };
@@ -82,36 +82,23 @@ IMAGE_SUBTYPE convertToImageSubType(QString imageTypeSubString)
 
 
 CustomMetaImage::CustomMetaImage(QString filename) :
-    mFilename(filename)
+    mFilename(filename),
+    mHeaderRead(false)
 {}
 
-QString CustomMetaImage::readKey(QString key)
+MetaImageHeader CustomMetaImage::getHeader()
 {
-	QFile file(mFilename);
-
-	QString line;
-	if (file.open(QIODevice::ReadOnly))
+	if (!mHeaderRead)
 	{
-		QTextStream t(&file);
-		while (!t.atEnd())
-		{
-			line.clear();
-			line = t.readLine();
-			// do something with the line
-			if (line.startsWith(key, Qt::CaseInsensitive))
-			{
-				QStringList list = line.split("=", QString::SkipEmptyParts);
-				if (list.size() >= 2)
-				{
-					list = list.mid(1);
-					return list.join("=");
-				}
-			}
-		}
-		file.close();
+		mHeader.read(mFilename);
+		mHeaderRead = true;
 	}
+	return mHeader;
+}
 
-	return "";
+QString CustomMetaImage::readKey(QString key)
+{
+	return this->getHeader().getValue(key);
 }
 
 IMAGE_MODALITY CustomMetaImage::readModality()
@@ -126,30 +113,11 @@ IMAGE_SUBTYPE CustomMetaImage::readImageType()
 	return convertToImageSubType(imageTypeString);
 }
 
-/** Remove all lines starting with a key from data.
-  *
-  */
-void CustomMetaImage::remove(QStringList* data, QStringList keys)
-{
-	QRegExp regexp(QString("(^%1)").arg(keys.join("|^")));
-	QStringList removeThese = data->filter(regexp);
-	for (int i=0; i<removeThese.size(); ++i)
-		data->removeAll(removeThese[i]);
-}
-
-/** Append key, value pair to data.
-  * The line is added last, but BEFORE the "ElementDataFile" key,
-  * which is required to be last.
+/** Write the header back to file.
+  * For files with data in the same file (.mha), the data is kept after the header.
   *
   */
-void CustomMetaImage::append(QStringList* data, QString key, QString value)
-{
-	// find index of ElementDataFile - this is the last element according to MHD standard (but we might have appended something else after it).
-    int last = data->lastIndexOf(QRegExp("^ElementDataFile.*"));
-	data->insert(last, QString("%1 = %2").arg(key).arg(value));
-}
-
-void CustomMetaImage::setKey(QString key, QString value)
+void CustomMetaImage::writeHeader()
 {
 	QFile file(mFilename);
 
@@ -159,13 +127,31 @@ void CustomMetaImage::setKey(QString key, QString value)
 	  return;
 	}
 
-	QStringList data = QTextStream(&file).readAll().split("\n");
-
-	this->remove(&data, QStringList()<<key);
-	this->append(&data, key, value);
+	QByteArray data;
+	bool local = mHeader.getValue("ElementDataFile").compare("LOCAL", Qt::CaseInsensitive) == 0;
+	if (local)
+	{
+		file.seek(mHeader.getHeaderSize());
+		data = file.readAll();
+	}
 
+	QByteArray header = mHeader.toByteArray();
 	file.resize(0);
-	file.write(data.join("\n").toLatin1());
+	file.seek(0);
+	file.write(header);
+	file.write(data);
+	file.close();
+
+	// the new header size is needed if the header is written again
+	if (local)
+		mHeaderRead = false;
+}
+
+void CustomMetaImage::setKey(QString key, QString value)
+{
+	this->getHeader();
+	mHeader.setValue(key, value);
+	this->writeHeader();
 }
 
 void CustomMetaImage::setModality(IMAGE_MODALITY value)
@@ -178,94 +164,16 @@ void CustomMetaImage::setImageType(IMAGE_SUBTYPE value)
 	this->setKey("ImageType3", enum2string(value));
 }
 
-
 Transform3D CustomMetaImage::readTransform()
 {
-  //read the specific TransformMatrix-tag from the header
-  Vector3D p_r(0, 0, 0);
-  Vector3D e_x(1, 0, 0);
-  Vector3D e_y(0, 1, 0);
-  Vector3D e_z(0, 0, 1);
-
-  QFile file(mFilename);
-
-  QString line;
-  if (file.open(QIODevice::ReadOnly))
-  {
-    QTextStream t(&file);
-    while (!t.atEnd())
-    {
-      line.clear();
-      line = t.readLine();
-      // do something with the line
-      if (line.startsWith("Position", Qt::CaseInsensitive) || line.startsWith("Offset", Qt::CaseInsensitive))
-      {
-        QStringList list = line.split(" ", QString::SkipEmptyParts);
-        if (list.size()>=5)
-          p_r = Vector3D(list[2].toDouble(), list[3].toDouble(), list[4].toDouble());
-      }
-      else if (line.startsWith("TransformMatrix", Qt::CaseInsensitive) || line.startsWith("Orientation",
-          Qt::CaseInsensitive))
-      {
-        QStringList list = line.split(" ", QString::SkipEmptyParts);
-
-        if (list.size()>=8)
-        {
-          e_x = Vector3D(list[2].toDouble(), list[3].toDouble(), list[4].toDouble());
-          e_y = Vector3D(list[5].toDouble(), list[6].toDouble(), list[7].toDouble());
-          e_z = cross(e_x, e_y);
-        }
-      }
-    }
-    file.close();
-  }
-
-  Transform3D rMd = Transform3D::Identity();
-
-  // add rotational part
-  for (unsigned i = 0; i < 3; ++i)
-  {
-    rMd(i,0) = e_x[i];
-    rMd(i,1) = e_y[i];
-    rMd(i,2) = e_z[i];
-  }
-
-
-  // add translational part
-  rMd(0,3) = p_r[0];
-  rMd(1,3) = p_r[1];
-  rMd(2,3) = p_r[2];
-  return rMd;
+	return this->getHeader().getTransform();
 }
 
 void CustomMetaImage::setTransform(const Transform3D M)
 {
-  QFile file(mFilename);
-
-  if (!file.open(QIODevice::ReadWrite))
-  {
-    reportWarning("Could not save transform because: Failed to open file " + mFilename);
-    return;
-  }
-
-  QStringList data = QTextStream(&file).readAll().split("\n");
-
-  this->remove(&data, QStringList()<<"TransformMatrix"<<"Offset"<<"Position"<<"Orientation");
-
-  int dim = 3; // hardcoded - will fail for 2d images
-  std::stringstream tmList;
-  for (int c=0; c<dim; ++c)
-    for (int r=0; r<dim; ++r)
-      tmList << " " << M(r,c);
-  this->append(&data, "TransformMatrix", qstring_cast(tmList.str()));
-
-  std::stringstream posList;
-  for (int r=0; r<dim; ++r)
-    posList << " " << M(r,3);
-  this->append(&data, "Offset", qstring_cast(posList.str()));
-
-  file.resize(0);
-  file.write(data.join("\n").toLatin1());
+	this->getHeader();
+	mHeader.setTransform(M);
+	this->writeHeader();
 }
 
 }
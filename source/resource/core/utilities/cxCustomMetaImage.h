@@ -16,6 +16,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include <QString>
 #include "cxTransform3D.h"
 #include "cxDefinitions.h"
+#include "cxMetaImageHeader.h"
 
 namespace cx
 {
@@ -30,6 +31,9 @@ typedef boost::shared_ptr<class CustomMetaImage> CustomMetaImagePtr;
  * This is meant as a supplement to vtkMetaImageReader/Writer,
  * extending that interface.
  *
+ * The header is parsed on first access and kept in memory,
+ * changes are written to file immediately.
+ *
  * \ingroup cx_resource_core_utilities
  */
 class cxResource_EXPORT CustomMetaImage
@@ -49,11 +53,14 @@ public:
   QString readKey(QString key);
   void setKey(QString key, QString value);
 
+  MetaImageHeader getHeader();
+
 private:
   QString mFilename;
+  MetaImageHeader mHeader;
+  bool mHeaderRead;
 
-  void remove(QStringList* data, QStringList keys);
-  void append(QStringList* data, QString key, QString value);
+  void writeHeader();
 
 };
 
@@ -0,0 +1,169 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#include "cxMetaImageHeader.h"
+
+#include <QFile>
+#include <QRegExp>
+#include "cxLogger.h"
+
+namespace cx
+{
+
+MetaImageHeader::MetaImageHeader() :
+	mHeaderSize(0)
+{
+}
+
+bool MetaImageHeader::read(QString filename)
+{
+	mEntries.clear();
+	mHeaderSize = 0;
+
+	QFile file(filename);
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		reportError("Failed to open file " + filename + ".");
+		return false;
+	}
+
+	// Read line by line: for .mha the binary data follows directly after ElementDataFile.
+	while (!file.atEnd())
+	{
+		QString line = QString::fromLatin1(file.readLine()).trimmed();
+		int separator = line.indexOf("=");
+		if (separator < 0)
+			continue;
+		QString key = line.left(separator).trimmed();
+		QString value = line.mid(separator+1).trimmed();
+		if (key.isEmpty())
+			continue;
+		mEntries.push_back(std::make_pair(key, value));
+
+		if (key.compare("ElementDataFile", Qt::CaseInsensitive) == 0)
+			break;
+	}
+	mHeaderSize = file.pos();
+	return true;
+}
+
+QByteArray MetaImageHeader::toByteArray() const
+{
+	QByteArray retval;
+	for (unsigned i = 0; i < mEntries.size(); ++i)
+		retval += QString("%1 = %2\n").arg(mEntries[i].first).arg(mEntries[i].second).toLatin1();
+	return retval;
+}
+
+int MetaImageHeader::find(QString key) const
+{
+	for (unsigned i = 0; i < mEntries.size(); ++i)
+		if (mEntries[i].first.compare(key, Qt::CaseInsensitive) == 0)
+			return i;
+	return -1;
+}
+
+bool MetaImageHeader::hasKey(QString key) const
+{
+	return this->find(key) >= 0;
+}
+
+QString MetaImageHeader::getValue(QString key) const
+{
+	int index = this->find(key);
+	if (index < 0)
+		return "";
+	return mEntries[index].second;
+}
+
+QStringList MetaImageHeader::getValues(QString key) const
+{
+	return this->getValue(key).split(QRegExp("\\s+"), QString::SkipEmptyParts);
+}
+
+void MetaImageHeader::setValue(QString key, QString value)
+{
+	int index = this->find(key);
+	if (index >= 0)
+	{
+		mEntries[index].second = value;
+		return;
+	}
+
+	int last = this->find("ElementDataFile");
+	if (last < 0)
+		mEntries.push_back(std::make_pair(key, value));
+	else
+		mEntries.insert(mEntries.begin() + last, std::make_pair(key, value));
+}
+
+void MetaImageHeader::remove(QString key)
+{
+	int index = this->find(key);
+	while (index >= 0)
+	{
+		mEntries.erase(mEntries.begin() + index);
+		index = this->find(key);
+	}
+}
+
+Transform3D MetaImageHeader::getTransform() const
+{
+	Vector3D p_r(0, 0, 0);
+	Vector3D e_x(1, 0, 0);
+	Vector3D e_y(0, 1, 0);
+	Vector3D e_z(0, 0, 1);
+
+	QStringList position = this->getValues("Offset");
+	if (position.isEmpty())
+		position = this->getValues("Position");
+	if (position.size() >= 3)
+		p_r = Vector3D(position[0].toDouble(), position[1].toDouble(), position[2].toDouble());
+
+	QStringList matrix = this->getValues("TransformMatrix");
+	if (matrix.isEmpty())
+		matrix = this->getValues("Orientation");
+	if (matrix.size() >= 6)
+	{
+		e_x = Vector3D(matrix[0].toDouble(), matrix[1].toDouble(), matrix[2].toDouble());
+		e_y = Vector3D(matrix[3].toDouble(), matrix[4].toDouble(), matrix[5].toDouble());
+		e_z = cross(e_x, e_y);
+	}
+
+	Transform3D rMd = Transform3D::Identity();
+	for (unsigned i = 0; i < 3; ++i)
+	{
+		rMd(i,0) = e_x[i];
+		rMd(i,1) = e_y[i];
+		rMd(i,2) = e_z[i];
+		rMd(i,3) = p_r[i];
+	}
+	return rMd;
+}
+
+void MetaImageHeader::setTransform(const Transform3D& M)
+{
+	this->remove("Position");
+	this->remove("Orientation");
+
+	int dim = 3; // hardcoded - will fail for 2d images
+	QStringList matrix;
+	for (int c=0; c<dim; ++c)
+		for (int r=0; r<dim; ++r)
+			matrix << QString::number(M(r,c));
+	this->setValue("TransformMatrix", matrix.join(" "));
+
+	QStringList position;
+	for (int r=0; r<dim; ++r)
+		position << QString::number(M(r,3));
+	this->setValue("Offset", position.join(" "));
+}
+
+} // namespace cx
@@ -0,0 +1,66 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#ifndef CXMETAIMAGEHEADER_H_
+#define CXMETAIMAGEHEADER_H_
+
+#include "cxResourceExport.h"
+
+#include <vector>
+#include <utility>
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include "cxTransform3D.h"
+
+namespace cx
+{
+
+/**\brief The key/value pairs of a MetaImage (.mhd/.mha) header.
+ *
+ * The header is parsed once, lookups are then done in memory.
+ * Key order is kept, with ElementDataFile always last as
+ * required by the format.
+ *
+ * \ingroup cx_resource_core_utilities
+ * \date Oct 19, 2026
+ */
+class cxResource_EXPORT MetaImageHeader
+{
+public:
+	MetaImageHeader();
+
+	/** Parse the header of filename. For .mha files, reading stops after
+	 *  ElementDataFile, and getHeaderSize() gives the start of the data.
+	 */
+	bool read(QString filename);
+	QByteArray toByteArray() const;
+
+	bool hasKey(QString key) const; ///< case insensitive
+	QString getValue(QString key) const; ///< value of key, empty if not present
+	QStringList getValues(QString key) const; ///< value of key split on whitespace
+	void setValue(QString key, QString value); ///< replace existing value, or add new key before ElementDataFile
+	void remove(QString key);
+	std::vector<std::pair<QString, QString> > getEntries() const { return mEntries; }
+
+	Transform3D getTransform() const; ///< from Offset/Position and TransformMatrix/Orientation
+	void setTransform(const Transform3D& M);
+
+	qint64 getHeaderSize() const { return mHeaderSize; } ///< bytes read by read()
+
+private:
+	int find(QString key) const;
+	std::vector<std::pair<QString, QString> > mEntries;
+	qint64 mHeaderSize;
+};
+
+} // namespace cx
+
+#endif /* CXMETAIMAGEHEADER_H_ */
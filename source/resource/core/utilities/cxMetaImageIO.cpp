@@ -0,0 +1,443 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#include "cxMetaImageIO.h"
+
+#include <algorithm>
+#include <limits>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QtEndian>
+#include <boost/bind.hpp>
+#include <vtkImageData.h>
+#include "cxParallelFor.h"
+#include "cxLogger.h"
+
+namespace cx
+{
+
+namespace
+{
+const int DEFAULT_CHUNK_SIZE = 4*1024*1024;
+
+struct ElementTypeName
+{
+	int vtkType;
+	const char* metType;
+};
+
+// MET_LONG/MET_ULONG are not included: their size depends on the writer platform.
+const ElementTypeName ELEMENT_TYPES[] =
+{
+	{ VTK_UNSIGNED_CHAR, "MET_UCHAR" },
+	{ VTK_SIGNED_CHAR, "MET_CHAR" },
+	{ VTK_CHAR, "MET_CHAR" },
+	{ VTK_UNSIGNED_SHORT, "MET_USHORT" },
+	{ VTK_SHORT, "MET_SHORT" },
+	{ VTK_UNSIGNED_INT, "MET_UINT" },
+	{ VTK_INT, "MET_INT" },
+	{ VTK_UNSIGNED_LONG_LONG, "MET_ULONG_LONG" },
+	{ VTK_LONG_LONG, "MET_LONG_LONG" },
+	{ VTK_FLOAT, "MET_FLOAT" },
+	{ VTK_DOUBLE, "MET_DOUBLE" }
+};
+const int ELEMENT_TYPE_COUNT = sizeof(ELEMENT_TYPES)/sizeof(ElementTypeName);
+
+int getVtkScalarType(QString metType)
+{
+	for (int i = 0; i < ELEMENT_TYPE_COUNT; ++i)
+		if (metType.compare(ELEMENT_TYPES[i].metType, Qt::CaseInsensitive) == 0)
+			return ELEMENT_TYPES[i].vtkType;
+	return -1;
+}
+
+QString getMetType(int vtkType)
+{
+	for (int i = 0; i < ELEMENT_TYPE_COUNT; ++i)
+		if (ELEMENT_TYPES[i].vtkType == vtkType)
+			return ELEMENT_TYPES[i].metType;
+	return "";
+}
+
+int getScalarSize(int vtkType)
+{
+	switch (vtkType)
+	{
+	case VTK_UNSIGNED_CHAR:
+	case VTK_SIGNED_CHAR:
+	case VTK_CHAR:
+		return 1;
+	case VTK_UNSIGNED_SHORT:
+	case VTK_SHORT:
+		return 2;
+	case VTK_UNSIGNED_INT:
+	case VTK_INT:
+	case VTK_FLOAT:
+		return 4;
+	case VTK_UNSIGNED_LONG_LONG:
+	case VTK_LONG_LONG:
+	case VTK_DOUBLE:
+		return 8;
+	default:
+		return 0;
+	}
+}
+
+bool isTrue(QString value)
+{
+	return value.compare("True", Qt::CaseInsensitive) == 0 || value == "1";
+}
+
+bool hostIsMSB()
+{
+	return Q_BYTE_ORDER == Q_BIG_ENDIAN;
+}
+
+QString toString(const double* values, int count)
+{
+	QStringList retval;
+	for (int i = 0; i < count; ++i)
+		retval << QString::number(values[i], 'g', 15);
+	return retval.join(" ");
+}
+
+void swapBytes(char* buffer, qint64 count, int size)
+{
+	for (qint64 i = 0; i < count; ++i)
+		std::reverse(buffer + i*size, buffer + (i+1)*size);
+}
+
+void uncompressChunks(int begin, int end, const QByteArray* data, const std::vector<qint64>* offsets, int chunkSize,
+					  char* buffer, qint64 bytes, std::vector<char>* ok)
+{
+	for (int i = begin; i < end; ++i)
+	{
+		qint64 start = (*offsets)[i] + 4;
+		int length = int((*offsets)[i+1] - start);
+		qint64 expected = std::min<qint64>(chunkSize, bytes - qint64(i)*chunkSize);
+		QByteArray chunk = qUncompress(reinterpret_cast<const uchar*>(data->constData() + start), length);
+		(*ok)[i] = (chunk.size() == expected);
+		if ((*ok)[i])
+			memcpy(buffer + qint64(i)*chunkSize, chunk.constData(), expected);
+	}
+}
+
+void compressChunkRange(int begin, int end, const char* buffer, qint64 bytes, int chunkSize, std::vector<QByteArray>* chunks)
+{
+	for (int i = begin; i < end; ++i)
+	{
+		qint64 start = qint64(i)*chunkSize;
+		int length = int(std::min<qint64>(chunkSize, bytes - start));
+		(*chunks)[i] = qCompress(reinterpret_cast<const uchar*>(buffer + start), length);
+	}
+}
+
+qint64 getDataSize(const MetaImageHeader& header)
+{
+	QStringList dimSize = header.getValues("DimSize");
+	int components = header.hasKey("ElementNumberOfChannels") ? header.getValue("ElementNumberOfChannels").toInt() : 1;
+	qint64 retval = qint64(components) * getScalarSize(getVtkScalarType(header.getValue("ElementType")));
+	for (int i = 0; i < dimSize.size(); ++i)
+		retval *= dimSize[i].toLongLong();
+	return retval;
+}
+
+} // namespace
+
+MetaImageIO::MetaImageIO() :
+	mCompression(false),
+	mChunkSize(DEFAULT_CHUNK_SIZE)
+{
+}
+
+bool MetaImageIO::canRead(const MetaImageHeader& header)
+{
+	QString objectType = header.getValue("ObjectType");
+	if (!objectType.isEmpty() && objectType.compare("Image", Qt::CaseInsensitive) != 0)
+		return false;
+	if (header.hasKey("BinaryData") && !isTrue(header.getValue("BinaryData")))
+		return false;
+	if (getVtkScalarType(header.getValue("ElementType")) < 0)
+		return false;
+
+	QStringList dimSize = header.getValues("DimSize");
+	if (dimSize.size() < 2 || dimSize.size() > 3)
+		return false;
+	if (header.hasKey("ElementNumberOfChannels") && header.getValue("ElementNumberOfChannels").toInt() < 1)
+		return false;
+
+	QString dataFile = header.getValue("ElementDataFile");
+	if (dataFile.isEmpty() || dataFile.compare("LIST", Qt::CaseInsensitive) == 0 || dataFile.contains("%"))
+		return false;
+
+	if (isTrue(header.getValue("CompressedData")))
+	{
+		// compressed data cannot be located from the end of the file
+		if (header.hasKey("HeaderSize") && header.getValue("HeaderSize").toLongLong() < 0)
+			return false;
+		// a single zlib stream is uncompressed with qUncompress(), limited to int sizes
+		if (!header.hasKey("CompressedDataChunkSize") && getDataSize(header) >= std::numeric_limits<int>::max())
+			return false;
+	}
+
+	return true;
+}
+
+bool MetaImageIO::canWrite(vtkImageDataPtr image)
+{
+	return image && !getMetType(image->GetScalarType()).isEmpty();
+}
+
+vtkImageDataPtr MetaImageIO::read(QString filename)
+{
+	MetaImageHeader header;
+	if (!header.read(filename))
+		return vtkImageDataPtr();
+	return this->read(filename, header);
+}
+
+vtkImageDataPtr MetaImageIO::read(QString filename, const MetaImageHeader& header)
+{
+	mHeader = header;
+	if (!canRead(header))
+	{
+		CX_LOG_ERROR() << "MetaImageIO: Unsupported MetaImage header in " << filename;
+		return vtkImageDataPtr();
+	}
+
+	int scalarType = getVtkScalarType(header.getValue("ElementType"));
+	int components = header.hasKey("ElementNumberOfChannels") ? header.getValue("ElementNumberOfChannels").toInt() : 1;
+
+	QStringList dimSize = header.getValues("DimSize");
+	QStringList spacingValues = header.hasKey("ElementSpacing") ? header.getValues("ElementSpacing") : header.getValues("ElementSize");
+	int dim[3] = {1, 1, 1};
+	double spacing[3] = {1, 1, 1};
+	for (int i = 0; i < dimSize.size(); ++i)
+	{
+		dim[i] = dimSize[i].toInt();
+		if (i < spacingValues.size())
+			spacing[i] = spacingValues[i].toDouble();
+	}
+
+	vtkImageDataPtr retval = vtkImageDataPtr::New();
+	retval->SetDimensions(dim);
+	retval->SetSpacing(spacing);
+	retval->SetOrigin(0, 0, 0);
+	retval->AllocateScalars(scalarType, components);
+
+	int scalarSize = getScalarSize(scalarType);
+	qint64 elements = qint64(dim[0]) * dim[1] * dim[2] * components;
+	qint64 bytes = elements * scalarSize;
+	char* buffer = static_cast<char*>(retval->GetScalarPointer());
+
+	QString dataFile = header.getValue("ElementDataFile");
+	qint64 offset = 0;
+	if (dataFile.compare("LOCAL", Qt::CaseInsensitive) == 0)
+	{
+		dataFile = filename;
+		offset = header.getHeaderSize();
+	}
+	else
+	{
+		dataFile = QFileInfo(filename).absoluteDir().absoluteFilePath(dataFile);
+		if (header.hasKey("HeaderSize"))
+			offset = header.getValue("HeaderSize").toLongLong(); // -1 means data at end of file
+	}
+
+	bool ok = false;
+	if (!isTrue(header.getValue("CompressedData")))
+		ok = this->readRaw(dataFile, offset, buffer, bytes);
+	else if (header.hasKey("CompressedDataChunkSize"))
+		ok = this->readChunked(dataFile, offset, header.getValue("CompressedDataChunkSize").toInt(), buffer, bytes);
+	else
+		ok = this->readCompressed(dataFile, offset, buffer, bytes);
+
+	if (!ok)
+	{
+		CX_LOG_ERROR() << "MetaImageIO: Failed to read image data from " << dataFile;
+		return vtkImageDataPtr();
+	}
+
+	QString msb = header.hasKey("BinaryDataByteOrderMSB") ? header.getValue("BinaryDataByteOrderMSB") : header.getValue("ElementByteOrderMSB");
+	if (scalarSize > 1 && isTrue(msb) != hostIsMSB())
+		swapBytes(buffer, elements, scalarSize);
+
+	return retval;
+}
+
+bool MetaImageIO::readRaw(QString dataFile, qint64 offset, char* buffer, qint64 bytes) const
+{
+	QFile file(dataFile);
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+	if (offset < 0)
+		offset = file.size() - bytes;
+	if (!file.seek(offset))
+		return false;
+
+	qint64 done = 0;
+	while (done < bytes)
+	{
+		qint64 count = file.read(buffer + done, bytes - done);
+		if (count <= 0)
+			return false;
+		done += count;
+	}
+	return true;
+}
+
+bool MetaImageIO::readCompressed(QString dataFile, qint64 offset, char* buffer, qint64 bytes) const
+{
+	QFile file(dataFile);
+	if (!file.open(QIODevice::ReadOnly) || !file.seek(offset))
+		return false;
+
+	// qUncompress expects the uncompressed size as a 4 byte big endian prefix
+	QByteArray data(4, 0);
+	qToBigEndian<quint32>(quint32(bytes), reinterpret_cast<uchar*>(data.data()));
+	data += file.readAll();
+
+	QByteArray uncompressed = qUncompress(data);
+	if (uncompressed.size() != bytes)
+		return false;
+	memcpy(buffer, uncompressed.constData(), bytes);
+	return true;
+}
+
+bool MetaImageIO::readChunked(QString dataFile, qint64 offset, int chunkSize, char* buffer, qint64 bytes) const
+{
+	if (chunkSize <= 0)
+		return false;
+	QFile file(dataFile);
+	if (!file.open(QIODevice::ReadOnly) || !file.seek(offset))
+		return false;
+	QByteArray data = file.readAll();
+
+	int chunkCount = int((bytes + chunkSize - 1) / chunkSize);
+	std::vector<qint64> offsets(chunkCount + 1, 0);
+	for (int i = 0; i < chunkCount; ++i)
+	{
+		if (offsets[i] + 4 > data.size())
+			return false;
+		quint32 length = qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(data.constData() + offsets[i]));
+		offsets[i+1] = offsets[i] + 4 + length;
+	}
+	if (offsets[chunkCount] > data.size())
+		return false;
+
+	std::vector<char> ok(chunkCount, 0);
+	parallelFor(0, chunkCount, boost::bind(&uncompressChunks, _1, _2, &data, &offsets, chunkSize, buffer, bytes, &ok));
+	return std::find(ok.begin(), ok.end(), 0) == ok.end();
+}
+
+QByteArray MetaImageIO::compressChunks(const char* buffer, qint64 bytes) const
+{
+	int chunkCount = int((bytes + mChunkSize - 1) / mChunkSize);
+	std::vector<QByteArray> chunks(chunkCount);
+	parallelFor(0, chunkCount, boost::bind(&compressChunkRange, _1, _2, buffer, bytes, mChunkSize, &chunks));
+
+	QByteArray retval;
+	for (int i = 0; i < chunkCount; ++i)
+	{
+		uchar length[4];
+		qToLittleEndian<quint32>(quint32(chunks[i].size()), length);
+		retval.append(reinterpret_cast<const char*>(length), 4);
+		retval.append(chunks[i]);
+	}
+	return retval;
+}
+
+MetaImageHeader MetaImageIO::createHeader(vtkImageDataPtr image) const
+{
+	int* dim = image->GetDimensions();
+	double identity[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+	double zero[3] = {0, 0, 0};
+
+	MetaImageHeader retval;
+	retval.setValue("ObjectType", "Image");
+	retval.setValue("NDims", "3");
+	retval.setValue("BinaryData", "True");
+	retval.setValue("BinaryDataByteOrderMSB", hostIsMSB() ? "True" : "False");
+	retval.setValue("CompressedData", mCompression ? "True" : "False");
+	retval.setValue("TransformMatrix", toString(identity, 9));
+	retval.setValue("Offset", toString(image->GetOrigin(), 3));
+	retval.setValue("CenterOfRotation", toString(zero, 3));
+	retval.setValue("AnatomicalOrientation", "RAI");
+	retval.setValue("ElementSpacing", toString(image->GetSpacing(), 3));
+	retval.setValue("DimSize", QString("%1 %2 %3").arg(dim[0]).arg(dim[1]).arg(dim[2]));
+	if (image->GetNumberOfScalarComponents() > 1)
+		retval.setValue("ElementNumberOfChannels", QString::number(image->GetNumberOfScalarComponents()));
+	retval.setValue("ElementType", getMetType(image->GetScalarType()));
+	return retval;
+}
+
+bool MetaImageIO::write(vtkImageDataPtr image, QString filename, const MetaImageHeader& extraKeys)
+{
+	if (!canWrite(image))
+	{
+		CX_LOG_ERROR() << "MetaImageIO: Cannot write image to " << filename;
+		return false;
+	}
+
+	QFileInfo info(filename);
+	bool local = info.suffix().compare("mha", Qt::CaseInsensitive) == 0;
+	QString dataFile = info.completeBaseName() + (mCompression ? ".zraw" : ".raw");
+	QDir().mkpath(info.path());
+
+	int* dim = image->GetDimensions();
+	qint64 bytes = qint64(dim[0]) * dim[1] * dim[2] * image->GetNumberOfScalarComponents() * image->GetScalarSize();
+	const char* buffer = static_cast<const char*>(image->GetScalarPointer());
+
+	QByteArray compressed;
+	MetaImageHeader header = this->createHeader(image);
+	if (mCompression)
+	{
+		compressed = this->compressChunks(buffer, bytes);
+		header.setValue("CompressedDataSize", QString::number(compressed.size()));
+		header.setValue("CompressedDataChunkSize", QString::number(mChunkSize));
+	}
+	std::vector<std::pair<QString, QString> > extra = extraKeys.getEntries();
+	for (unsigned i = 0; i < extra.size(); ++i)
+		if (extra[i].first.compare("ElementDataFile", Qt::CaseInsensitive) != 0)
+			header.setValue(extra[i].first, extra[i].second);
+	header.setValue("ElementDataFile", local ? "LOCAL" : dataFile);
+	mHeader = header;
+
+	QFile headerFile(filename);
+	if (!headerFile.open(QIODevice::WriteOnly))
+	{
+		reportError("Failed to open file " + filename + ".");
+		return false;
+	}
+	headerFile.write(header.toByteArray());
+
+	QFile separateDataFile(info.absoluteDir().absoluteFilePath(dataFile));
+	QFile* data = &headerFile;
+	if (!local)
+	{
+		if (!separateDataFile.open(QIODevice::WriteOnly))
+		{
+			reportError("Failed to open file " + separateDataFile.fileName() + ".");
+			return false;
+		}
+		data = &separateDataFile;
+	}
+
+	qint64 written = mCompression ? data->write(compressed) : data->write(buffer, bytes);
+	if (written != (mCompression ? compressed.size() : bytes))
+	{
+		reportError("Failed to write image data to " + data->fileName() + ".");
+		return false;
+	}
+	return true;
+}
+
+} // namespace cx
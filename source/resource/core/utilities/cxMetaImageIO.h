@@ -0,0 +1,78 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#ifndef CXMETAIMAGEIO_H_
+#define CXMETAIMAGEIO_H_
+
+#include "cxResourceExport.h"
+
+#include <QString>
+#include "vtkForwardDeclarations.h"
+#include "cxMetaImageHeader.h"
+
+namespace cx
+{
+
+/**\brief Native reader/writer for MetaImage (.mhd/.raw and .mha) files.
+ *
+ * The header is parsed once, and the raw data is read with a single
+ * read directly into the buffer of the returned vtkImageData.
+ * The origin of the returned image is zero, the position is available
+ * from the header transform.
+ *
+ * Uncompressed files are standard MetaImage files. Standard compressed
+ * files (one zlib stream) can be read as well.
+ *
+ * With compression enabled, the data is written as independently
+ * compressed chunks, which are compressed and decompressed in parallel.
+ * The header then contains CompressedDataChunkSize, and the .zraw file
+ * holds each chunk as a 32-bit little endian byte count followed by the
+ * chunk data. This variant is only readable by MetaImageIO.
+ *
+ * Files using features not supported here (ASCII data, lists of data files,
+ * more than 3 dimensions) are rejected by canRead(): use vtkMetaImageReader for those.
+ *
+ * \ingroup cx_resource_core_utilities
+ * \date Oct 19, 2026
+ */
+class cxResource_EXPORT MetaImageIO
+{
+public:
+	MetaImageIO();
+	void setCompression(bool on) { mCompression = on; }
+	void setChunkSize(int bytes) { mChunkSize = bytes; } ///< uncompressed bytes per compressed chunk
+
+	static bool canRead(const MetaImageHeader& header);
+	static bool canWrite(vtkImageDataPtr image);
+
+	vtkImageDataPtr read(QString filename);
+	vtkImageDataPtr read(QString filename, const MetaImageHeader& header); ///< use an already parsed header
+	MetaImageHeader getHeader() const { return mHeader; } ///< header of the last read or write
+
+	/** Write image to filename (.mhd or .mha). Keys in extraKeys are added to
+	 *  the header, replacing the default values.
+	 */
+	bool write(vtkImageDataPtr image, QString filename, const MetaImageHeader& extraKeys = MetaImageHeader());
+
+private:
+	MetaImageHeader createHeader(vtkImageDataPtr image) const;
+	bool readRaw(QString dataFile, qint64 offset, char* buffer, qint64 bytes) const;
+	bool readCompressed(QString dataFile, qint64 offset, char* buffer, qint64 bytes) const;
+	bool readChunked(QString dataFile, qint64 offset, int chunkSize, char* buffer, qint64 bytes) const;
+	QByteArray compressChunks(const char* buffer, qint64 bytes) const;
+
+	bool mCompression;
+	int mChunkSize;
+	MetaImageHeader mHeader;
+};
+
+} // namespace cx
+
+#endif /* CXMETAIMAGEIO_H_ */
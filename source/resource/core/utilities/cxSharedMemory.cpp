@@ -10,6 +10,12 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 =========================================================================*/
 #include "cxSharedMemory.h"
 
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <string.h>
+#include <vtkType.h>
+
 namespace cx
 {
 
@@ -201,4 +207,377 @@ SharedMemoryClient::~SharedMemoryClient()
 	release();
 }
 
+// Shared header of a frame ring, kept first in shared memory area.
+// Frame n is stored in slot n % numSlots.
+struct shm_ring_header
+{
+	qint32 magic;		// identifies a frame ring
+	qint32 numSlots;	// number of slots
+	qint64 slotSize;	// max bytes of frame data in each slot
+	qint32 headerSize;	// size of this header, padded
+	qint32 slotHeaderSize;	// size of shm_ring_slot, padded
+	std::atomic<qint64> published;	// number of frames published
+};
+
+// Header of each slot, followed by the frame data.
+struct shm_ring_slot
+{
+	std::atomic<qint64> sequence;	// odd while the slot is written
+	qint64 index;		// number of the frame in the slot
+	SharedMemoryFrameInfo info;
+};
+
+namespace
+{
+const qint32 RING_MAGIC = 0x43585246;
+
+// The ring counters are shared between processes: this requires
+// address-free, lock-free atomics. A lock-based implementation would
+// also write to the read-only mapping of the readers.
+bool hasLockFreeCounters()
+{
+	std::atomic<qint64> counter(0);
+	return counter.is_lock_free();
+}
+
+int paddedSize(int size)
+{
+	const int alignment = 64; // keep frame data cache line aligned
+	return (size + alignment - 1) / alignment * alignment;
+}
+
+shm_ring_slot* getSlot(const QSharedMemory& buffer, qint64 index)
+{
+	shm_ring_header* header = (shm_ring_header*)buffer.constData();
+	qint64 offset = header->headerSize + (index % header->numSlots) * (header->slotHeaderSize + header->slotSize);
+	return (shm_ring_slot*)((char*)header + offset);
+}
+
+void* getSlotData(const QSharedMemory& buffer, shm_ring_slot* slot)
+{
+	const shm_ring_header* header = (const shm_ring_header*)buffer.constData();
+	return (char*)slot + header->slotHeaderSize;
+}
+
+int getScalarSize(int vtkScalarType)
+{
+	switch (vtkScalarType)
+	{
+	case VTK_CHAR:
+	case VTK_SIGNED_CHAR:
+	case VTK_UNSIGNED_CHAR:
+		return 1;
+	case VTK_SHORT:
+	case VTK_UNSIGNED_SHORT:
+		return 2;
+	case VTK_INT:
+	case VTK_UNSIGNED_INT:
+	case VTK_FLOAT:
+		return 4;
+	case VTK_DOUBLE:
+		return 8;
+	default:
+		return 0;
+	}
+}
+
+// The frame info is written by another process: check that the image it
+// describes lies within the frame data, which lies within the slot.
+bool isFrameInSlot(const SharedMemoryFrameInfo& info, qint64 slotSize)
+{
+	int scalarSize = getScalarSize(info.scalarType);
+	if (scalarSize == 0 || info.components < 1 || info.dim[0] < 1 || info.dim[1] < 1 || info.dim[2] < 0)
+		return false;
+	if (info.size < 0 || info.size > slotSize)
+		return false;
+
+	// multiply stepwise, dividing to avoid overflow
+	qint64 bytes = qint64(scalarSize) * info.components;
+	qint64 factors[3] = { info.dim[0], info.dim[1], std::max<qint64>(info.dim[2], 1) };
+	for (int i = 0; i < 3; ++i)
+	{
+		if (bytes > info.size / factors[i])
+			return false;
+		bytes *= factors[i];
+	}
+	return bytes <= info.size;
+}
+}
+
+SharedMemoryFrameInfo::SharedMemoryFrameInfo()
+{
+	memset(this, 0, sizeof(SharedMemoryFrameInfo));
+}
+
+SharedMemoryFrameRingWriter::SharedMemoryFrameRingWriter(QString key, int slotCount, qint64 slotSize, QObject *parent) :
+	mBuffer(key, parent),
+	mSlots(slotCount),
+	mSlotSize(paddedSize(slotSize)),
+	mWriting(-1)
+{
+	if (!hasLockFreeCounters())
+	{
+		qWarning("Shared memory frame ring requires lock-free 64 bit atomics");
+		return;
+	}
+
+	int headerSize = paddedSize(sizeof(shm_ring_header));
+	int slotHeaderSize = paddedSize(sizeof(shm_ring_slot));
+	qint64 size = headerSize + mSlots * (slotHeaderSize + mSlotSize);
+	if (!mBuffer.create(size))
+	{
+		if (mBuffer.error() == QSharedMemory::AlreadyExists)
+		{
+			qWarning("Reusing existing buffer -- this should generally not happen");
+			// reuse and overwrite; hopefully it was made by previous run of same program that crashed
+			mBuffer.attach();
+		}
+		if (!mBuffer.isAttached() || mBuffer.size() < size)
+		{
+			qWarning("Failed to create shared memory frame ring of size %lld: %s",
+					 size, mBuffer.errorString().toLatin1().constData());
+			mBuffer.detach();
+			return;
+		}
+	}
+
+	shm_ring_header* header = (shm_ring_header*)mBuffer.data();
+	header->magic = 0; // hide from readers while initializing
+	header->numSlots = mSlots;
+	header->slotSize = mSlotSize;
+	header->headerSize = headerSize;
+	header->slotHeaderSize = slotHeaderSize;
+	new (&header->published) std::atomic<qint64>(0);
+	for (int i = 0; i < mSlots; i++)
+	{
+		shm_ring_slot* slot = getSlot(mBuffer, i);
+		new (&slot->sequence) std::atomic<qint64>(0);
+		slot->index = -1;
+		slot->info = SharedMemoryFrameInfo();
+	}
+	std::atomic_thread_fence(std::memory_order_release);
+	header->magic = RING_MAGIC;
+}
+
+SharedMemoryFrameRingWriter::~SharedMemoryFrameRingWriter()
+{
+}
+
+qint64 SharedMemoryFrameRingWriter::published() const
+{
+	if (!this->isValid())
+		return 0;
+	const shm_ring_header* header = (const shm_ring_header*)mBuffer.constData();
+	return header->published.load(std::memory_order_acquire);
+}
+
+void *SharedMemoryFrameRingWriter::beginFrame()
+{
+	if (!this->isValid())
+		return NULL;
+
+	shm_ring_slot* slot;
+	if (mWriting < 0)
+	{
+		mWriting = this->published();
+		slot = getSlot(mBuffer, mWriting);
+		// odd sequence: readers of the previous frame in this slot will see it as invalid
+		slot->sequence.store(slot->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+	}
+	slot = getSlot(mBuffer, mWriting);
+	return getSlotData(mBuffer, slot);
+}
+
+bool SharedMemoryFrameRingWriter::commitFrame(const SharedMemoryFrameInfo& info)
+{
+	if (!this->isValid() || mWriting < 0)
+		return false;
+	if (info.size > mSlotSize)
+	{
+		qWarning("Frame of %lld bytes does not fit in frame ring slot of %lld bytes", info.size, mSlotSize);
+		return false; // slot stays odd, and is reused by the next frame
+	}
+
+	shm_ring_slot* slot = getSlot(mBuffer, mWriting);
+	slot->index = mWriting;
+	slot->info = info;
+	slot->sequence.store(slot->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+
+	shm_ring_header* header = (shm_ring_header*)mBuffer.data();
+	header->published.store(mWriting + 1, std::memory_order_release);
+	mWriting = -1;
+	return true;
+}
+
+bool SharedMemoryFrameRingWriter::write(const SharedMemoryFrameInfo& info, const void* data)
+{
+	if (info.size > mSlotSize)
+	{
+		qWarning("Frame of %lld bytes does not fit in frame ring slot of %lld bytes", info.size, mSlotSize);
+		return false;
+	}
+	void* buffer = this->beginFrame();
+	if (!buffer)
+		return false;
+	memcpy(buffer, data, info.size);
+	return this->commitFrame(info);
+}
+
+SharedMemoryFrameRingReader::SharedMemoryFrameRingReader(QObject *parent) :
+	mBuffer(parent),
+	mSlots(0),
+	mSlotSize(0),
+	mLastIndex(-1),
+	mLostFrames(0),
+	mRejectedFrames(0)
+{
+}
+
+bool SharedMemoryFrameRingReader::attach(const QString &key)
+{
+	if (!hasLockFreeCounters())
+		return false;
+	mBuffer.setKey(key);
+	// readers never write to the ring
+	if (!mBuffer.attach(QSharedMemory::ReadOnly))
+		return false;
+
+	const shm_ring_header* header = (const shm_ring_header*)mBuffer.constData();
+	if (mBuffer.size() < int(sizeof(shm_ring_header)) || header->magic != RING_MAGIC)
+	{
+		mBuffer.detach();
+		return false;
+	}
+	std::atomic_thread_fence(std::memory_order_acquire);
+
+	// the header is written by another process: check it before using it
+	bool validLayout = (header->numSlots > 0)
+			&& (header->slotSize >= 0)
+			&& (header->headerSize >= int(sizeof(shm_ring_header)))
+			&& (header->slotHeaderSize >= int(sizeof(shm_ring_slot)))
+			&& (qint64(mBuffer.size()) >= header->headerSize + qint64(header->numSlots) * (header->slotHeaderSize + header->slotSize));
+	if (!validLayout)
+	{
+		qWarning("Shared memory frame ring %s has an invalid header", key.toLatin1().constData());
+		mBuffer.detach();
+		return false;
+	}
+	mSlots = header->numSlots;
+	mSlotSize = header->slotSize;
+	mLastIndex = -1;
+	mLostFrames = 0;
+	mRejectedFrames = 0;
+	return true;
+}
+
+bool SharedMemoryFrameRingReader::detach()
+{
+	return mBuffer.detach();
+}
+
+qint64 SharedMemoryFrameRingReader::published() const
+{
+	if (!this->isAttached())
+		return 0;
+	const shm_ring_header* header = (const shm_ring_header*)mBuffer.constData();
+	return header->published.load(std::memory_order_acquire);
+}
+
+qint64 SharedMemoryFrameRingReader::getLag() const
+{
+	return this->published() - (mLastIndex + 1);
+}
+
+bool SharedMemoryFrameRingReader::acquireLatest(SharedMemoryFrame* frame)
+{
+	// retry if the writer passes us while reading
+	for (int attempt = 0; attempt < 3; ++attempt)
+	{
+		qint64 index = this->published() - 1;
+		if (index < 0 || index <= mLastIndex)
+			return false;
+		if (this->acquire(index, frame))
+		{
+			mLastIndex = index;
+			return this->checkFrame(frame);
+		}
+	}
+	return false;
+}
+
+bool SharedMemoryFrameRingReader::acquireNext(SharedMemoryFrame* frame)
+{
+	for (int attempt = 0; attempt < 3; ++attempt)
+	{
+		qint64 published = this->published();
+		qint64 index = mLastIndex + 1;
+		if (index >= published)
+			return false;
+
+		// the slot of the frame after the newest may be under writing
+		qint64 oldest = std::max<qint64>(0, published - mSlots + 1);
+		if (index < oldest)
+		{
+			mLostFrames += oldest - index;
+			mLastIndex = oldest - 1;
+			index = oldest;
+		}
+
+		if (this->acquire(index, frame))
+		{
+			mLastIndex = index;
+			return this->checkFrame(frame);
+		}
+	}
+	return false;
+}
+
+bool SharedMemoryFrameRingReader::checkFrame(SharedMemoryFrame* frame)
+{
+	if (isFrameInSlot(frame->info, mSlotSize))
+		return true;
+
+	qWarning("Dropped frame %lld from frame ring %s: image of %dx%dx%d, %d components, type %d does not fit in %lld bytes",
+			 frame->index, this->key().toLatin1().constData(),
+			 frame->info.dim[0], frame->info.dim[1], frame->info.dim[2],
+			 frame->info.components, frame->info.scalarType, frame->info.size);
+	++mRejectedFrames;
+	*frame = SharedMemoryFrame();
+	return false;
+}
+
+bool SharedMemoryFrameRingReader::acquire(qint64 index, SharedMemoryFrame* frame) const
+{
+	if (!this->isAttached())
+		return false;
+
+	const shm_ring_slot* slot = getSlot(mBuffer, index);
+	qint64 sequence = slot->sequence.load(std::memory_order_acquire);
+	if (sequence & 1)
+		return false; // being written
+
+	qint64 slotIndex = slot->index;
+	SharedMemoryFrameInfo info = slot->info;
+
+	std::atomic_thread_fence(std::memory_order_acquire);
+	if (slot->sequence.load(std::memory_order_relaxed) != sequence || slotIndex != index)
+		return false;
+
+	frame->data = getSlotData(mBuffer, const_cast<shm_ring_slot*>(slot));
+	frame->info = info;
+	frame->index = index;
+	frame->sequence = sequence;
+	return true;
+}
+
+bool SharedMemoryFrameRingReader::isValid(const SharedMemoryFrame& frame) const
+{
+	if (!this->isAttached() || frame.index < 0)
+		return false;
+	const shm_ring_slot* slot = getSlot(mBuffer, frame.index);
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return slot->sequence.load(std::memory_order_relaxed) == frame.sequence;
+}
+
 }
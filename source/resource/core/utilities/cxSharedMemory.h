@@ -104,6 +104,135 @@ public:
 	QDateTime timestamp() { return mTimestamp; }
 };
 
+/**\brief Description of one frame in a SharedMemoryFrameRing slot.
+ *
+ * Stored as is in shared memory: plain data only.
+ *
+ * \ingroup cx_resource_core_utilities
+ */
+struct cxResource_EXPORT SharedMemoryFrameInfo
+{
+	SharedMemoryFrameInfo();
+	qint32 dim[3];
+	double spacing[3];
+	qint32 scalarType;	///< vtk scalar type
+	qint32 components;
+	qint64 size;		///< bytes of frame data
+	qint64 timestamp;	///< ms since epoch
+	qint32 probeType;	///< ProbeDefinition::TYPE, tNONE if no probe status is given
+	double probeOrigin[3];	///< origin of sector in image coordinates
+	double probeDepthStart;	///< start of sector in mm from origin
+	double probeDepthEnd;	///< end of sector in mm from origin
+	double probeWidth;	///< width of sector in mm for LINEAR, radians for SECTOR
+};
+
+/**\brief A frame mapped from a SharedMemoryFrameRing, without copying.
+ *
+ * data points into shared memory, and may be overwritten by the writer
+ * at any time. Check SharedMemoryFrameRingReader::isValid() after using
+ * the data, and discard the result if it returns false.
+ *
+ * \ingroup cx_resource_core_utilities
+ */
+struct cxResource_EXPORT SharedMemoryFrame
+{
+	SharedMemoryFrame() : data(NULL), index(-1), sequence(0) {}
+	const void* data;
+	SharedMemoryFrameInfo info;
+	qint64 index;		///< number of the frame since the writer started
+	qint64 sequence;	///< slot sequence counter when the frame was mapped
+};
+
+/**\brief Writer of a shared memory frame ring.
+ *
+ * One writer and any number of reader processes share a ring of fixed size
+ * slots. Frame n is written to slot n % slotCount. Each slot has a sequence
+ * counter (a seqlock), which is odd while the slot is written. Readers
+ * never lock anything, thus a slow reader cannot block the writer:
+ * it detects that its frame was overwritten instead.
+ *
+ * Write a frame either by filling the buffer returned by beginFrame() and
+ * calling commitFrame(), or by copying it with write().
+ *
+ * The sequence counters require lock-free 64 bit atomics: isValid() is
+ * false on platforms without them.
+ *
+ * \sa SharedMemoryFrameRingReader
+ * \ingroup cx_resource_core_utilities
+ * \date Oct 19, 2026
+ */
+class cxResource_EXPORT SharedMemoryFrameRingWriter
+{
+public:
+	/**
+	 * \param key A string identifying this resource. Must be unique system wide
+	 * \param slotCount The number of frames kept. Readers can lag at most slotCount-1 frames behind.
+	 * \param slotSize Max bytes of data in each frame.
+	 * \param parent The Qt parent object
+	 */
+	SharedMemoryFrameRingWriter(QString key, int slotCount, qint64 slotSize, QObject *parent = 0);
+	~SharedMemoryFrameRingWriter();
+	bool isValid() const { return mBuffer.isAttached(); }
+	QString key() const { return mBuffer.key(); }
+	int slotCount() const { return mSlots; }
+	qint64 slotSize() const { return mSlotSize; }
+	qint64 published() const; ///< number of frames published
+
+	void *beginFrame();	///< Return the data buffer of the next frame, which is hidden from readers until committed
+	bool commitFrame(const SharedMemoryFrameInfo& info); ///< Publish the frame started by beginFrame()
+	bool write(const SharedMemoryFrameInfo& info, const void* data); ///< Copy info.size bytes of data into the next frame and publish it
+
+private:
+	QSharedMemory mBuffer;
+	int mSlots;
+	qint64 mSlotSize;
+	qint64 mWriting; ///< index of the frame being written, -1 if none
+};
+
+/**\brief Reader of a shared memory frame ring.
+ *
+ * Use acquireLatest() to follow the stream at display rate, or
+ * acquireNext() to process every frame. In both cases the frame data are
+ * mapped, not copied: check isValid() after using them.
+ *
+ * Frames with an info that does not fit in the slot (unknown scalar type,
+ * or dimensions larger than the frame data) are dropped.
+ *
+ * \sa SharedMemoryFrameRingWriter
+ * \ingroup cx_resource_core_utilities
+ * \date Oct 19, 2026
+ */
+class cxResource_EXPORT SharedMemoryFrameRingReader
+{
+public:
+	SharedMemoryFrameRingReader(QObject *parent = 0);
+	bool attach(const QString &key); ///< false if key is not a valid frame ring
+	bool detach();
+	bool isAttached() const { return mBuffer.isAttached(); }
+	QString key() const { return mBuffer.key(); }
+	int slotCount() const { return mSlots; }
+	qint64 slotSize() const { return mSlotSize; }
+
+	bool acquireLatest(SharedMemoryFrame* frame); ///< Map the newest frame, false if there is none newer than the last acquired
+	bool acquireNext(SharedMemoryFrame* frame); ///< Map the frame after the last acquired, or the oldest available if that is lost
+	bool isValid(const SharedMemoryFrame& frame) const; ///< true if frame has not been overwritten since it was acquired
+
+	qint64 getLag() const; ///< number of published frames newer than the last acquired
+	qint64 getLostFrames() const { return mLostFrames; } ///< frames overwritten before acquireNext() could get them
+	qint64 getRejectedFrames() const { return mRejectedFrames; } ///< frames dropped because their info does not fit in the slot
+
+private:
+	bool acquire(qint64 index, SharedMemoryFrame* frame) const;
+	bool checkFrame(SharedMemoryFrame* frame);
+	qint64 published() const;
+	QSharedMemory mBuffer;
+	int mSlots;
+	qint64 mSlotSize;
+	qint64 mLastIndex;
+	qint64 mLostFrames;
+	qint64 mRejectedFrames;
+};
+
 }
 
 #endif
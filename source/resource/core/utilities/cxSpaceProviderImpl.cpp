@@ -26,11 +26,20 @@ namespace cx
 
 SpaceProviderImpl::SpaceProviderImpl(TrackingServicePtr trackingService, PatientModelServicePtr dataManager) :
 	mTrackingService(trackingService),
-	mDataManager(dataManager)
+	mDataManager(dataManager),
+	mCacheEnabled(true),
+	mCacheHits(0),
+	mCacheMisses(0)
 {
 //	connect(mTrackingService.get(), SIGNAL(stateChanged()), this, SIGNAL(spaceAddedOrRemoved()));
 	connect(mTrackingService.get(), &TrackingService::stateChanged, this, &SpaceProvider::spaceAddedOrRemoved);
 	connect(mDataManager.get(), &PatientModelService::dataAddedOrRemoved, this, &SpaceProvider::spaceAddedOrRemoved);
+
+	connect(this, &SpaceProvider::spaceAddedOrRemoved, this, &SpaceProviderImpl::connectToSpaceSources);
+	connect(this, &SpaceProvider::spaceAddedOrRemoved, this, &SpaceProviderImpl::clearCache);
+	connect(mDataManager.get(), &PatientModelService::patientChanged, this, &SpaceProviderImpl::clearCache);
+	connect(mDataManager.get(), &PatientModelService::rMprChanged, this, &SpaceProviderImpl::invalidatePatientReferenceDependents);
+	this->connectToSpaceSources();
 }
 
 SpaceListenerPtr SpaceProviderImpl::createListener()
@@ -132,7 +141,172 @@ Transform3D SpaceProviderImpl::get_toMfrom(CoordinateSystem from, CoordinateSyst
 	return to_M_from;
 }
 
+void SpaceProviderImpl::setCacheEnabled(bool on)
+{
+	mCacheEnabled = on;
+	this->clearCache();
+}
+
+void SpaceProviderImpl::clearCache()
+{
+	QMutexLocker lock(&mCacheMutex);
+	m_rMfromCache.clear();
+}
+
+/** Remove all cached spaces referring to uid.
+ */
+void SpaceProviderImpl::invalidateSpacesOf(QString uid)
+{
+	QMutexLocker lock(&mCacheMutex);
+	std::map<SpaceKey, Transform3D>::iterator iter = m_rMfromCache.begin();
+	while (iter!=m_rMfromCache.end())
+	{
+		if (iter->first.second == uid)
+			m_rMfromCache.erase(iter++);
+		else
+			++iter;
+	}
+}
+
+/** Remove all cached spaces depending on rMpr: the patient reference and all tools.
+ */
+void SpaceProviderImpl::invalidatePatientReferenceDependents()
+{
+	QMutexLocker lock(&mCacheMutex);
+	std::map<SpaceKey, Transform3D>::iterator iter = m_rMfromCache.begin();
+	while (iter!=m_rMfromCache.end())
+	{
+		int id = iter->first.first;
+		if (id==csPATIENTREF || id==csTOOL || id==csTOOL_OFFSET)
+			m_rMfromCache.erase(iter++);
+		else
+			++iter;
+	}
+}
+
+void SpaceProviderImpl::onDataChanged()
+{
+	Data* data = dynamic_cast<Data*>(this->sender());
+	if (data)
+		this->invalidateSpacesOf(data->getUid());
+}
+
+void SpaceProviderImpl::onToolChanged()
+{
+	Tool* tool = dynamic_cast<Tool*>(this->sender());
+	if (tool)
+		this->invalidateSpacesOf(tool->getUid());
+}
+
+bool SpaceProviderImpl::isCacheable(const CoordinateSystem& space) const
+{
+	if (!mCacheEnabled)
+		return false;
+	if (space.mRefObject=="active")
+		return false;
+
+	switch(space.mId)
+	{
+	case csREF:
+	case csPATIENTREF:
+	case csDATA:
+	case csDATA_VOXEL:
+	case csTOOL:
+	case csTOOL_OFFSET:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/** Listen to changes in all data and tools not already listened to.
+ *  Called when spaces are added, before any other listener can connect
+ *  to the new objects, thus the cache is always invalidated first.
+ */
+void SpaceProviderImpl::connectToSpaceSources()
+{
+	std::map<QString, DataPtr> data = mDataManager->getDatas();
+	for (std::map<QString, DataPtr>::iterator i=data.begin(); i!=data.end(); ++i)
+	{
+		if (!i->second || mConnectedSources.count(i->second.get()))
+			continue;
+		connect(i->second.get(), &Data::transformChanged, this, &SpaceProviderImpl::onDataChanged);
+		ImagePtr image = boost::dynamic_pointer_cast<Image>(i->second);
+		if (image)
+			connect(image.get(), &Image::vtkImageDataChanged, this, &SpaceProviderImpl::onDataChanged);
+		this->connectToSpaceSource(i->second.get());
+	}
+
+	std::map<QString, ToolPtr> tools = mTrackingService->getTools();
+	for (std::map<QString, ToolPtr>::iterator i=tools.begin(); i!=tools.end(); ++i)
+	{
+		if (!i->second || mConnectedSources.count(i->second.get()))
+			continue;
+		connect(i->second.get(), &Tool::toolTransformAndTimestamp, this, &SpaceProviderImpl::onToolChanged);
+		connect(i->second.get(), &Tool::tooltipOffset, this, &SpaceProviderImpl::onToolChanged);
+		this->connectToSpaceSource(i->second.get());
+	}
+}
+
+void SpaceProviderImpl::connectToSpaceSource(QObject* source)
+{
+	mConnectedSources.insert(source);
+	connect(source, &QObject::destroyed, this, &SpaceProviderImpl::onSpaceSourceDestroyed);
+}
+
+void SpaceProviderImpl::onSpaceSourceDestroyed(QObject* source)
+{
+	mConnectedSources.erase(source);
+}
+
+/** Return true if changes in the object defining the space invalidates the cache.
+ *  Objects not listened to since they were added may have listeners that are
+ *  notified before the cache, and are not cached.
+ */
+bool SpaceProviderImpl::isSpaceSourceConnected(const CoordinateSystem& space)
+{
+	if (space.mId==csDATA || space.mId==csDATA_VOXEL)
+	{
+		if (!mDataManager->isPatientValid())
+			return true; // identity until patientChanged
+		DataPtr data = mDataManager->getData(space.mRefObject);
+		return data && mConnectedSources.count(data.get());
+	}
+	if (space.mId==csTOOL || space.mId==csTOOL_OFFSET)
+	{
+		ToolPtr tool = mTrackingService->getTool(space.mRefObject);
+		return tool && mConnectedSources.count(tool.get());
+	}
+	return true;
+}
+
 Transform3D SpaceProviderImpl::get_rMfrom(CoordinateSystem from)
+{
+	if (!this->isCacheable(from))
+		return this->get_rMfromUncached(from);
+
+	SpaceKey key(from.mId, from.mRefObject);
+	{
+		QMutexLocker lock(&mCacheMutex);
+		std::map<SpaceKey, Transform3D>::iterator iter = m_rMfromCache.find(key);
+		if (iter!=m_rMfromCache.end())
+		{
+			++mCacheHits;
+			return iter->second;
+		}
+		++mCacheMisses;
+	}
+
+	Transform3D rMfrom = this->get_rMfromUncached(from);
+	if (this->isSpaceSourceConnected(from))
+	{
+		QMutexLocker lock(&mCacheMutex);
+		m_rMfromCache[key] = rMfrom;
+	}
+	return rMfrom;
+}
+
+Transform3D SpaceProviderImpl::get_rMfromUncached(CoordinateSystem from)
 {
 	Transform3D rMfrom = Transform3D::Identity();
 
@@ -15,12 +15,23 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 
 #include "cxSpaceProvider.h"
 #include "cxForwardDeclarations.h"
+#include <map>
+#include <set>
+#include <QMutex>
 
 namespace cx
 {
 
 /** Provides information about all the coordinate systems in the application.
  *
+ * The ref_M_from transform of each specific data and tool space is cached,
+ * and invalidated when the data or tool reports a change, or when
+ * rMpr or the set of spaces change. "active" aliases and the sensor space
+ * (calibration changes are not signalled) are always computed.
+ *
+ * The cache listens to each data and tool when it is added, so that it is
+ * invalidated before listeners connected later are notified. Objects
+ * not seen when added are never cached.
  *
  * \ingroup cx_resource_core_utilities
  * \date 2014-02-21
@@ -49,8 +60,25 @@ public:
 	virtual CoordinateSystem getR(); ///<data references coordinate system
 	virtual CoordinateSystem convertToSpecific(CoordinateSystem space);
 
+	void setCacheEnabled(bool on); ///< default on. Turn off to use the uncached path, for testing.
+	unsigned long getCacheHitCount() const { return mCacheHits; }
+	unsigned long getCacheMissCount() const { return mCacheMisses; }
+
 private:
-	Transform3D get_rMfrom(CoordinateSystem from); ///< ref_M_from
+	typedef std::pair<int, QString> SpaceKey; ///< (COORDINATE_SYSTEM, mRefObject)
+
+	Transform3D get_rMfrom(CoordinateSystem from); ///< ref_M_from, using the cache if possible
+	Transform3D get_rMfromUncached(CoordinateSystem from); ///< ref_M_from
+	bool isCacheable(const CoordinateSystem& space) const;
+	bool isSpaceSourceConnected(const CoordinateSystem& space);
+	void connectToSpaceSources();
+	void connectToSpaceSource(QObject* source);
+	void onSpaceSourceDestroyed(QObject* source);
+	void clearCache();
+	void invalidateSpacesOf(QString uid);
+	void invalidatePatientReferenceDependents();
+	void onDataChanged();
+	void onToolChanged();
 
 	Transform3D get_rMr(); ///< ref_M_ref
 	Transform3D get_rMd(QString uid);
@@ -64,6 +92,13 @@ private:
 
 	TrackingServicePtr mTrackingService;
 	PatientModelServicePtr mDataManager;
+
+	std::map<SpaceKey, Transform3D> m_rMfromCache;
+	std::set<QObject*> mConnectedSources; ///< data and tools listened to since they were added
+	bool mCacheEnabled;
+	unsigned long mCacheHits;
+	unsigned long mCacheMisses;
+	QMutex mCacheMutex;
 };
 
 } // namespace cx
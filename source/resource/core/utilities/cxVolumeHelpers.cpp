@@ -34,6 +34,8 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "cxCoordinateSystemHelpers.h"
 #include "cxPatientModelService.h"
 #include "cxEnumConversion.h"
+#include "cxImageStatistics.h"
+#include "cxGrayScaleImageConverter.h"
 
 typedef vtkSmartPointer<vtkDoubleArray> vtkDoubleArrayPtr;
 
@@ -303,11 +305,13 @@ void printDisplayFriendlyInfo(std::map<std::string, std::string> map)
 
 int calculateNumVoxelsWithMaxValue(ImagePtr image)
 {
-	return static_cast<int*>(image->getHistogram()->GetOutput()->GetScalarPointer(image->getRange(), 0, 0))[0];
+	ImageStatisticsPtr statistics = image->getStatistics();
+	return statistics->getHistogramCount(statistics->getMax());
 }
 int calculateNumVoxelsWithMinValue(ImagePtr image)
 {
-	return static_cast<int*>(image->getHistogram()->GetOutput()->GetScalarPointer(0,0,0))[0];
+	ImageStatisticsPtr statistics = image->getStatistics();
+	return statistics->getHistogramCount(statistics->getMin());
 }
 
 DoubleBoundingBox3D findEnclosingBoundingBox(std::vector<DataPtr> data, Transform3D qMr)
@@ -346,6 +350,9 @@ DoubleBoundingBox3D findEnclosingBoundingBox(std::vector<ImagePtr> images, Trans
 
 vtkImageDataPtr convertImageDataToGrayScale(vtkImageDataPtr image)
 {
+	if (GrayScaleImageConverter::canConvert(image))
+		return GrayScaleImageConverter::toGrayScale(image);
+
 	vtkImageDataPtr retval = image;
 
 	//vtkImageLuminance demands 3 components
@@ -385,15 +392,17 @@ vtkImageDataPtr convertImageDataTo8Bit(vtkImageDataPtr image, double windowWidth
 	vtkImageDataPtr retval = image;
 	if (image->GetScalarSize() > 1)
 		{
-			vtkImageShiftScalePtr imageCast = vtkImageShiftScalePtr::New();
-			imageCast->SetInputData(image);
-
 //			double scalarMax = windowWidth/2.0 + windowLevel;
 			double scalarMin = windowWidth/2.0 - windowLevel;
 
 			double addToScalarValue = -scalarMin;
 			double multiplyToScalarValue = 255/windowWidth;
 
+			if (GrayScaleImageConverter::canConvert(image))
+				return GrayScaleImageConverter::to8bit(image, addToScalarValue, multiplyToScalarValue);
+
+			vtkImageShiftScalePtr imageCast = vtkImageShiftScalePtr::New();
+			imageCast->SetInputData(image);
 			imageCast->SetShift(addToScalarValue);
 			imageCast->SetScale(multiplyToScalarValue);
 			imageCast->SetOutputScalarTypeToUnsignedChar();
@@ -32,6 +32,8 @@
 #include "vtkFloatArray.h"
 #include "cxMesh.h"
 #include "cxLogger.h"
+#include "cxParallelFor.h"
+#include <boost/bind.hpp>
 
 namespace cx
 {
@@ -805,145 +807,195 @@ void SeansVesselReg::printOutResults(QString fileNamePrefix, vtkGeneralTransform
 	file_out2.close();
 }
 
-/** Input an image representation of centerlines.
- *  Transform to polydata, reject all data outside bounding box,
- *  unknown parameter: p_neighborhoodFilterThreshold
- *
- */
-vtkPolyDataPtr SeansVesselReg::extractPolyData(ImagePtr image, int p_neighborhoodFilterThreshold,
-	double p_BoundingBox[6])
+namespace
 {
-	vtkPolyDataPtr p_thePolyData = vtkPolyDataPtr::New();
-
-	int l_dimensions[3];
-	image->getBaseVtkImageData()->GetDimensions(l_dimensions);
-	Vector3D spacing(image->getBaseVtkImageData()->GetSpacing());
 
-	//set the transform
-	vtkTransformPtr l_dataTransform = vtkTransformPtr::New();
-	l_dataTransform->SetMatrix(image->get_rMd().getVtkMatrix());
+template<class TYPE>
+void fillOccupancy(const TYPE* data, int components, unsigned char* occupancy, size_t begin, size_t end)
+{
+	for (size_t i = begin; i < end; ++i)
+		occupancy[i] = (data[i * components] != 0) ? 1 : 0;
+}
 
-	int l_startPosX, l_startPosY, l_startPosZ; //Beginings of neighborhood offsets
-	int l_stopPosX, l_stopPosY, l_stopPosZ; //Ends of neighborhood offsets
-	int i, j, k, ii, jj, kk, l_counts = 0; //Counter variables
+/** Set occupancy to 1 for voxels in slices [zBegin,zEnd> where the first component is nonzero.
+ */
+void fillOccupancySlices(vtkImageDataPtr image, std::vector<unsigned char>* occupancy, int zBegin, int zEnd)
+{
+	int* dim = image->GetDimensions();
+	size_t sliceSize = size_t(dim[0]) * dim[1];
+	size_t begin = sliceSize * zBegin;
+	size_t end = sliceSize * zEnd;
+	int components = image->GetNumberOfScalarComponents();
+	void* data = image->GetScalarPointer();
+
+#define CX_OCCUPANCY_CASE(VTK_TYPE, TYPE) \
+	case VTK_TYPE: \
+		fillOccupancy(static_cast<TYPE*>(data), components, &occupancy->front(), begin, end); \
+		break;
+
+	switch (image->GetScalarType())
+	{
+	CX_OCCUPANCY_CASE(VTK_CHAR, char)
+	CX_OCCUPANCY_CASE(VTK_SIGNED_CHAR, signed char)
+	CX_OCCUPANCY_CASE(VTK_UNSIGNED_CHAR, unsigned char)
+	CX_OCCUPANCY_CASE(VTK_SHORT, short)
+	CX_OCCUPANCY_CASE(VTK_UNSIGNED_SHORT, unsigned short)
+	CX_OCCUPANCY_CASE(VTK_INT, int)
+	CX_OCCUPANCY_CASE(VTK_UNSIGNED_INT, unsigned int)
+	CX_OCCUPANCY_CASE(VTK_FLOAT, float)
+	CX_OCCUPANCY_CASE(VTK_DOUBLE, double)
+	default:
+		CX_LOG_ERROR() << "SeansVesselReg: Unhandled scalar type " << image->GetScalarTypeAsString();
+		break;
+	}
+#undef CX_OCCUPANCY_CASE
+}
 
-	bool l_isNeighborFound; //Boolean for loop breakout
+/** Sum input over a window of +-radius samples along a line, clipped at the line ends.
+ *  The line has length samples, step apart, starting at lineStart.
+ *  Sums are saturated at 2, as we only need to know if a voxel has a neighbor.
+ *  Saturated input gives the same saturated result as the exact sum.
+ */
+void windowSumAlongAxis(const unsigned char* input, unsigned char* output, int length, size_t step,
+						int radius, size_t lineStart)
+{
+	int sum = 0;
+	for (int i = 0; i < radius && i < length; ++i)
+		sum += input[lineStart + i * step];
+	for (int i = 0; i < length; ++i)
+	{
+		if (i + radius < length)
+			sum += input[lineStart + (i + radius) * step];
+		output[lineStart + i * step] = std::min(sum, 2);
+		if (i - radius >= 0)
+			sum -= input[lineStart + (i - radius) * step];
+	}
+}
 
-	//dimensions, fast if we first deref it in to variables
-	int l_dimX = l_dimensions[0];
-	int l_dimY = l_dimensions[1];
-	int l_dimZ = l_dimensions[2];
+void windowSumX(const std::vector<unsigned char>* input, std::vector<unsigned char>* output, const int* dim, int radius, int zBegin, int zEnd)
+{
+	for (int z = zBegin; z < zEnd; ++z)
+		for (int y = 0; y < dim[1]; ++y)
+			windowSumAlongAxis(&input->front(), &output->front(), dim[0], 1, radius, (size_t(z) * dim[1] + y) * dim[0]);
+}
 
-	double l_tempPoint[3];
-	//Offsets variables
-	int l_offsetI = 0;
-	int l_offsetJ = 0;
-	int l_offsetK = 0;
-	int l_kkjjOffset = 0;
-	int l_kkjjiiOffset = 0;
-	int l_offsetConstIJ = l_dimX * l_dimY;
+void windowSumY(const std::vector<unsigned char>* input, std::vector<unsigned char>* output, const int* dim, int radius, int zBegin, int zEnd)
+{
+	for (int z = zBegin; z < zEnd; ++z)
+		for (int x = 0; x < dim[0]; ++x)
+			windowSumAlongAxis(&input->front(), &output->front(), dim[1], size_t(dim[0]), radius, size_t(z) * dim[1] * dim[0] + x);
+}
 
-	vtkDataArrayPtr l_allTheData = image->getBaseVtkImageData()->GetPointData()->GetScalars();
-	vtkPointsPtr l_dataPoints = vtkPointsPtr::New();
-	vtkCellArrayPtr l_dataCellArray = vtkCellArrayPtr::New();
+void windowSumZ(const std::vector<unsigned char>* input, std::vector<unsigned char>* output, const int* dim, int radius, int yBegin, int yEnd)
+{
+	for (int y = yBegin; y < yEnd; ++y)
+		for (int x = 0; x < dim[0]; ++x)
+			windowSumAlongAxis(&input->front(), &output->front(), dim[2], size_t(dim[1]) * dim[0], radius, size_t(y) * dim[0] + x);
+}
 
-	//Loop through the entire volume and precalculate the offsets for each
-	//point along with the points neighborhood offset
-	for (k = 0; k < l_dimZ; ++k)
+/** Append the transformed position of all voxels in slices [zBegin,zEnd> that are set
+ *  and have at least one other set voxel in their neighborhood, and are inside the optional bounding box.
+ *  The result is stored per slice in order to keep the voxel ordering when merged.
+ */
+void collectNeighboredVoxels(const std::vector<unsigned char>* occupancy, const std::vector<unsigned char>* neighborhoodCount,
+							 const int* dim, Vector3D spacing, const Transform3D* rMd, const double* boundingBox,
+							 std::vector<std::vector<double> >* slicePoints, int zBegin, int zEnd)
+{
+	const Eigen::Matrix4d& M = rMd->matrix();
+	for (int k = zBegin; k < zEnd; ++k)
 	{
-		//the start and stop offsets for the Z neighborhood (a gap in a cube)
-		l_startPosZ = k - p_neighborhoodFilterThreshold;
-		if (l_startPosZ < 0)
-			l_startPosZ = 0;
-		else
-			l_startPosZ *= l_offsetConstIJ;
-
-		l_stopPosZ = k + p_neighborhoodFilterThreshold;
-		if (l_stopPosZ >= l_dimZ)
-			l_stopPosZ = (l_dimZ - 1) * l_offsetConstIJ;
-		else
-			l_stopPosZ *= l_offsetConstIJ;
-
-		l_offsetK = k * l_offsetConstIJ;
-
-		for (j = 0; j < l_dimY; ++j)
+		std::vector<double>& points = slicePoints->at(k);
+		for (int j = 0; j < dim[1]; ++j)
 		{
-			//the start and stop offsets for the Y neighborhood (a hole through a cube)
-			l_startPosY = j - p_neighborhoodFilterThreshold;
-			if (l_startPosY < 0)
-				l_startPosY = 0;
-			else
-				l_startPosY *= l_dimX;
-
-			l_stopPosY = j + p_neighborhoodFilterThreshold;
-			if (l_stopPosY >= l_dimY)
-				l_stopPosY = (l_dimY - 1) * l_dimX;
-			else
-				l_stopPosY *= l_dimX;
-
-			l_offsetJ = l_offsetK + (j * l_dimX);
-
-			for (i = 0; i < l_dimX; ++i)
+			size_t rowStart = (size_t(k) * dim[1] + j) * dim[0];
+			for (int i = 0; i < dim[0]; ++i)
 			{
-				//the start and stop offsets for the X neighborhood (a voxel)
-				l_startPosX = i - p_neighborhoodFilterThreshold;
-				if (l_startPosX < 0)
-					l_startPosX = 0;
-
-				l_stopPosX = i + p_neighborhoodFilterThreshold;
-				if (l_stopPosX >= l_dimX)
-					l_stopPosX = l_dimX - 1;
-
-				l_offsetI = l_offsetJ + i;
-				l_isNeighborFound = 0;
-
-				//See if this voxel contain a vessel center, if so do some more processing
-				if (*(l_allTheData->GetTuple(l_offsetI)))
-				{
-					// added by CA: use spacing when creating point. TODO: check  with Ingrid if any other data are affected.
-					l_tempPoint[0] = spacing[0] * i;
-					l_tempPoint[1] = spacing[1] * j;
-					l_tempPoint[2] = spacing[2] * k;
-					l_dataTransform->TransformPoint(l_tempPoint, l_tempPoint);
-
-					//Do stuff if there is no bounding box, or if there is one check if the
-					//point is in the bounding box
-					if (!p_BoundingBox || (p_BoundingBox[0] < l_tempPoint[0] && p_BoundingBox[1] > l_tempPoint[0]
-						&& p_BoundingBox[2] < l_tempPoint[1] && p_BoundingBox[3] > l_tempPoint[1] && p_BoundingBox[4]
-						< l_tempPoint[2] && p_BoundingBox[5] > l_tempPoint[2]))
-					{
-						//Loop through the neigbors of the point and see if they are vessel centers
-						//if one of them is it then write the point down
-						for (kk = l_startPosZ; kk <= l_stopPosZ && !l_isNeighborFound; kk += l_offsetConstIJ)
-						{
-							for (jj = l_startPosY; jj <= l_stopPosY && !l_isNeighborFound; jj += l_dimX)
-							{
-								l_kkjjOffset = kk + jj;
-
-								for (ii = l_startPosX; ii <= l_stopPosX && !l_isNeighborFound; ++ii)
-								{
-									l_kkjjiiOffset = ii + l_kkjjOffset;
-
-									if (l_offsetI != l_kkjjiiOffset && //ignore if it is the current point
-										*(l_allTheData->GetTuple(l_kkjjiiOffset))) //check if vessel center
-									{
-										l_isNeighborFound = 1;
-										l_dataPoints->InsertNextPoint(l_tempPoint);
-										l_dataCellArray->InsertNextCell(1);
-										l_dataCellArray->InsertCellPoint(l_counts++);
-									}
-								}
-							}
-						}
-					}
-				}
+				size_t index = rowStart + i;
+				// the count includes the voxel itself
+				if (!(*occupancy)[index] || (*neighborhoodCount)[index] < 2)
+					continue;
+
+				// added by CA: use spacing when creating point. TODO: check  with Ingrid if any other data are affected.
+				double p[3] = { spacing[0] * i, spacing[1] * j, spacing[2] * k };
+				// same arithmetic as vtkTransform::TransformPoint
+				double point[3];
+				for (int r = 0; r < 3; ++r)
+					point[r] = M(r, 0) * p[0] + M(r, 1) * p[1] + M(r, 2) * p[2] + M(r, 3);
+
+				//Do stuff if there is no bounding box, or if there is one check if the
+				//point is in the bounding box
+				if (boundingBox && !(boundingBox[0] < point[0] && boundingBox[1] > point[0]
+					&& boundingBox[2] < point[1] && boundingBox[3] > point[1]
+					&& boundingBox[4] < point[2] && boundingBox[5] > point[2]))
+					continue;
+
+				points.insert(points.end(), point, point + 3);
 			}
 		}
 	}
+}
+
+} // namespace
 
+/** Input an image representation of centerlines.
+ *  Transform to polydata, reject all data outside bounding box,
+ *  p_neighborhoodFilterThreshold: Keep only voxels that have at least one other
+ *  nonzero voxel within this many voxels along each axis. This removes isolated points.
+ *
+ *  The neighbor test uses an occupancy mask and a separable window sum over the
+ *  neighborhood cube, computed slab-wise in parallel.
+ */
+vtkPolyDataPtr SeansVesselReg::extractPolyData(ImagePtr image, int p_neighborhoodFilterThreshold,
+	double p_BoundingBox[6])
+{
+	vtkPolyDataPtr p_thePolyData = vtkPolyDataPtr::New();
+	vtkPointsPtr l_dataPoints = vtkPointsPtr::New();
+	vtkCellArrayPtr l_dataCellArray = vtkCellArrayPtr::New();
 	p_thePolyData->SetPoints(l_dataPoints);
 	p_thePolyData->SetVerts(l_dataCellArray);
 
+	vtkImageDataPtr imageData = image->getBaseVtkImageData();
+	int dim[3];
+	imageData->GetDimensions(dim);
+	size_t voxelCount = size_t(dim[0]) * dim[1] * dim[2];
+	if (!voxelCount || p_neighborhoodFilterThreshold <= 0)
+		return p_thePolyData;
+	Vector3D spacing(imageData->GetSpacing());
+	int radius = p_neighborhoodFilterThreshold;
+
+	std::vector<unsigned char> occupancy(voxelCount);
+	parallelFor(0, dim[2], boost::bind(&fillOccupancySlices, imageData, &occupancy, _1, _2));
+
+	// number of set voxels (saturated at 2) in the neighborhood cube of each voxel, by summing along x, y and z in turn.
+	std::vector<unsigned char> sumX(voxelCount);
+	std::vector<unsigned char> sumXY(voxelCount);
+	parallelFor(0, dim[2], boost::bind(&windowSumX, &occupancy, &sumX, dim, radius, _1, _2));
+	parallelFor(0, dim[2], boost::bind(&windowSumY, &sumX, &sumXY, dim, radius, _1, _2));
+	std::vector<unsigned char>& sumXYZ = sumX;
+	parallelFor(0, dim[1], boost::bind(&windowSumZ, &sumXY, &sumXYZ, dim, radius, _1, _2));
+
+	Transform3D rMd = image->get_rMd();
+	std::vector<std::vector<double> > slicePoints(dim[2]);
+	parallelFor(0, dim[2], boost::bind(&collectNeighboredVoxels, &occupancy, &sumXYZ, dim, spacing, &rMd,
+									   p_BoundingBox, &slicePoints, _1, _2));
+
+	size_t pointCount = 0;
+	for (unsigned k = 0; k < slicePoints.size(); ++k)
+		pointCount += slicePoints[k].size() / 3;
+
+	l_dataPoints->SetNumberOfPoints(pointCount);
+	vtkIdType l_counts = 0;
+	for (unsigned k = 0; k < slicePoints.size(); ++k)
+	{
+		const std::vector<double>& points = slicePoints[k];
+		for (unsigned i = 0; i < points.size(); i += 3)
+		{
+			l_dataPoints->SetPoint(l_counts, &points[i]);
+			l_dataCellArray->InsertNextCell(1);
+			l_dataCellArray->InsertCellPoint(l_counts++);
+		}
+	}
+
 	return p_thePolyData;
 }
 
@@ -41,6 +41,7 @@ public:
 	void checkCentroidDifferenceBelow(double val);
 	void checkMassDifferenceBelow(double val);
 	void checkValueWithin(cx::Vector3D p_r, int lowerLimit, int upperLimit);
+	double getRMS() const;
 
 	void saveNominalOutputToFile(QString filename, cx::FileManagerServicePtr port);
 	void saveOutputToFile(QString filename, cx::FileManagerServicePtr port);
@@ -52,7 +53,6 @@ private:
 	double getValue(cx::ImagePtr image, cx::Vector3D p_r);
 	cx::ImagePtr getNominalOutputImage() const;
 	QString addFullPath(QString filename);
-	double getRMS() const;
 
 	cx::cxSyntheticVolumePtr mPhantom;
 	cx::ImagePtr mTestImage;
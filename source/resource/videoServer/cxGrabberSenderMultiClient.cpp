@@ -0,0 +1,176 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#include "cxGrabberSenderMultiClient.h"
+
+#include <algorithm>
+#include <QHostAddress>
+#include "cxIGTLinkConversion.h"
+#include "cxIGTLinkConversionImage.h"
+
+namespace cx
+{
+
+GrabberSendQueue::GrabberSendQueue(int maxSize) :
+	mMaxSize(std::max(1, maxSize)),
+	mDropped(0)
+{
+}
+
+void GrabberSendQueue::push(QByteArray message, bool droppable)
+{
+	Entry entry;
+	entry.message = message;
+	entry.droppable = droppable;
+	mMessages.push_back(entry);
+
+	std::deque<Entry>::iterator iter = mMessages.begin();
+	while (int(mMessages.size()) > mMaxSize && iter != mMessages.end())
+	{
+		if (iter->droppable)
+		{
+			iter = mMessages.erase(iter);
+			++mDropped;
+		}
+		else
+		{
+			++iter;
+		}
+	}
+}
+
+QByteArray GrabberSendQueue::pop()
+{
+	if (mMessages.empty())
+		return QByteArray();
+	QByteArray retval = mMessages.front().message;
+	mMessages.pop_front();
+	return retval;
+}
+
+GrabberSenderMultiClient::GrabberSenderMultiClient()
+{
+	mMaxBufferSize = 1920000; //800(width)*600(height)*4(bytes)*1(image)
+}
+
+void GrabberSenderMultiClient::addClient(QTcpSocket* socket)
+{
+	ClientPtr client(new Client());
+	client->socket = socket;
+	client->messagesSent = 0;
+	client->bytesSent = 0;
+	client->connected.start();
+	mClients.push_back(client);
+	connect(socket, SIGNAL(bytesWritten(qint64)), this, SLOT(bytesWrittenSlot()));
+
+	if (!mLastProbeDefinition.isEmpty())
+	{
+		client->queue.push(mLastProbeDefinition, false);
+		this->flush(client);
+	}
+}
+
+void GrabberSenderMultiClient::removeClient(QTcpSocket* socket)
+{
+	for (unsigned i=0; i<mClients.size(); ++i)
+	{
+		if (mClients[i]->socket != socket)
+			continue;
+		if (socket)
+			disconnect(socket, 0, this, 0);
+		mClients.erase(mClients.begin()+i);
+		return;
+	}
+}
+
+std::vector<GrabberSenderMultiClient::ClientStatistics> GrabberSenderMultiClient::getStatistics() const
+{
+	std::vector<ClientStatistics> retval;
+	for (unsigned i=0; i<mClients.size(); ++i)
+	{
+		ClientPtr client = mClients[i];
+		ClientStatistics stats;
+		stats.name = client->socket ? client->socket->peerAddress().toString() : QString("disconnected");
+		stats.messagesSent = client->messagesSent;
+		stats.framesDropped = client->queue.getDropCount();
+		double seconds = std::max<qint64>(client->connected.elapsed(), 1)/1000.0;
+		stats.bytesPerSecond = client->bytesSent/seconds;
+		retval.push_back(stats);
+	}
+	return retval;
+}
+
+bool GrabberSenderMultiClient::isReady() const
+{
+	return !mClients.empty();
+}
+
+void GrabberSenderMultiClient::send(ImagePtr msg)
+{
+	if (!this->isReady())
+		return;
+
+	IGTLinkConversionImage converter;
+	this->broadcast(this->pack(converter.encode(msg, pcsLPS)), true);
+}
+
+void GrabberSenderMultiClient::send(ProbeDefinitionPtr msg)
+{
+	// always keep the probe definition, clients added later need it
+	IGTLinkConversion converter;
+	mLastProbeDefinition = this->pack(converter.encode(msg));
+	this->broadcast(mLastProbeDefinition, false);
+}
+
+template<class MESSAGE>
+QByteArray GrabberSenderMultiClient::pack(MESSAGE msg) const
+{
+	if (!msg)
+		return QByteArray();
+	msg->Pack();
+	return QByteArray(reinterpret_cast<const char*>(msg->GetPackPointer()), msg->GetPackSize());
+}
+
+void GrabberSenderMultiClient::broadcast(QByteArray message, bool droppable)
+{
+	if (message.isEmpty())
+		return;
+
+	// QByteArray is implicitly shared: all queues refer to the same buffer
+	for (unsigned i=0; i<mClients.size(); ++i)
+	{
+		mClients[i]->queue.push(message, droppable);
+		this->flush(mClients[i]);
+	}
+}
+
+void GrabberSenderMultiClient::bytesWrittenSlot()
+{
+	QTcpSocket* socket = dynamic_cast<QTcpSocket*>(this->sender());
+	for (unsigned i=0; i<mClients.size(); ++i)
+		if (mClients[i]->socket == socket)
+			this->flush(mClients[i]);
+}
+
+void GrabberSenderMultiClient::flush(ClientPtr client)
+{
+	if (!client->socket)
+		return;
+
+	while (!client->queue.empty() && client->socket->bytesToWrite() < mMaxBufferSize)
+	{
+		QByteArray message = client->queue.pop();
+		client->socket->write(message);
+		client->bytesSent += message.size();
+		++client->messagesSent;
+	}
+}
+
+} /* namespace cx */
@@ -0,0 +1,134 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#ifndef CXGRABBERSENDERMULTICLIENT_H_
+#define CXGRABBERSENDERMULTICLIENT_H_
+
+#include "cxGrabberExport.h"
+
+#include "cxSenderImpl.h"
+
+#include <deque>
+#include <vector>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QTcpSocket>
+
+namespace cx
+{
+
+/**
+* \file
+* \addtogroup cx_resource_videoserver
+* @{
+*/
+
+/** Bounded queue of packed messages for one client.
+ *
+ * When the queue is full, the oldest droppable message (image frame) is
+ * dropped, so that the client always receives the latest frame.
+ * Messages that are not droppable (probe definitions) are never dropped.
+ *
+ * \ingroup cx_resource_videoserver
+ * \date Oct 19, 2026
+ */
+class cxGrabber_EXPORT GrabberSendQueue
+{
+public:
+	explicit GrabberSendQueue(int maxSize = 2);
+	void push(QByteArray message, bool droppable);
+	QByteArray pop(); ///< remove and return the oldest message
+	bool empty() const { return mMessages.empty(); }
+	int size() const { return mMessages.size(); }
+	long getDropCount() const { return mDropped; }
+
+private:
+	struct Entry
+	{
+		QByteArray message;
+		bool droppable;
+	};
+	int mMaxSize;
+	std::deque<Entry> mMessages;
+	long mDropped;
+};
+
+/** Send to several QTcpSocket clients.
+ *
+ * Each message is packed once, and the packed buffer is shared by the queues
+ * of all clients. Messages are written to a client when its socket buffer
+ * has room, slow clients drop frames instead of buffering them.
+ * The last probe definition is kept and sent to clients added later.
+ *
+ * The sender does not own the client sockets: the caller must keep them
+ * alive until removeClient() has been called.
+ *
+ * \ingroup cx_resource_videoserver
+ * \date Oct 19, 2026
+ */
+class cxGrabber_EXPORT GrabberSenderMultiClient : public SenderImpl
+{
+	Q_OBJECT
+public:
+	struct ClientStatistics
+	{
+		QString name;
+		long messagesSent;
+		long framesDropped;
+		double bytesPerSecond;
+	};
+
+	GrabberSenderMultiClient();
+	virtual ~GrabberSenderMultiClient() {}
+
+	void addClient(QTcpSocket* socket); ///< add a client, it receives the last probe definition at once
+	void removeClient(QTcpSocket* socket);
+	void setMaxBufferSize(int bytes) { mMaxBufferSize = bytes; }
+	int getNumberOfClients() const { return mClients.size(); }
+	std::vector<ClientStatistics> getStatistics() const;
+
+	bool isReady() const;
+
+protected:
+	virtual void send(ImagePtr msg);
+	virtual void send(ProbeDefinitionPtr msg);
+
+private slots:
+	void bytesWrittenSlot();
+
+private:
+	struct Client
+	{
+		QPointer<QTcpSocket> socket;
+		GrabberSendQueue queue;
+		long messagesSent;
+		qint64 bytesSent;
+		QElapsedTimer connected;
+	};
+	typedef boost::shared_ptr<Client> ClientPtr;
+
+	void broadcast(QByteArray message, bool droppable);
+	void flush(ClientPtr client);
+	template<class MESSAGE>
+	QByteArray pack(MESSAGE msg) const;
+
+	std::vector<ClientPtr> mClients;
+	QByteArray mLastProbeDefinition; ///< packed, sent to new clients
+	int mMaxBufferSize; ///< do not write more to a socket when it has this many bytes pending
+};
+typedef boost::shared_ptr<GrabberSenderMultiClient> GrabberSenderMultiClientPtr;
+
+/**
+* @}
+*/
+
+} /* namespace cx */
+#endif /* CXGRABBERSENDERMULTICLIENT_H_ */
@@ -13,6 +13,9 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "cxIGTLinkConversion.h"
 #include "cxIGTLinkConversionImage.h"
 #include "cxIGTLinkConversionSonixCXLegacy.h"
+#include <string.h>
+#include "igtlStatusMessage.h"
+#include "cxLogger.h"
 
 namespace cx
 {
@@ -21,6 +24,7 @@ GrabberSenderQTcpSocket::GrabberSenderQTcpSocket(QTcpSocket* socket)
 {
 	mMaxBufferSize = 19200000; //800(width)*600(height)*4(bytes)*10(images)
 	mSocket = socket;
+	connect(mSocket, SIGNAL(readyRead()), this, SLOT(readyReadSlot()));
 }
 
 bool GrabberSenderQTcpSocket::isReady() const
@@ -37,9 +41,10 @@ void GrabberSenderQTcpSocket::send(igtl::ImageMessage::Pointer msg)
 	if (!msg || !this->isReady())
 		return;
 
-	// Pack (serialize) and send
-	msg->Pack();
-	mSocket->write(reinterpret_cast<const char*> (msg->GetPackPointer()), msg->GetPackSize());
+	if (mEncoder)
+		this->write(mEncoder->encode(msg).GetPointer());
+	else
+		this->write(msg.GetPointer());
 }
 
 void GrabberSenderQTcpSocket::send(IGTLinkUSStatusMessage::Pointer msg)
@@ -47,11 +52,65 @@ void GrabberSenderQTcpSocket::send(IGTLinkUSStatusMessage::Pointer msg)
 	if (!msg || !this->isReady())
 		return;
 
+	this->write(msg.GetPointer());
+}
+
+void GrabberSenderQTcpSocket::write(igtl::MessageBase::Pointer msg)
+{
+	if (!msg)
+		return;
 	// Pack (serialize) and send
 	msg->Pack();
 	mSocket->write(reinterpret_cast<const char*> (msg->GetPackPointer()), msg->GetPackSize());
 }
 
+/** Read messages sent by the client. Only compression requests are used,
+ *  other messages are discarded.
+ */
+void GrabberSenderQTcpSocket::readyReadSlot()
+{
+	while (true)
+	{
+		if (!mIncomingHeader)
+		{
+			igtl::MessageHeader::Pointer header = igtl::MessageHeader::New();
+			header->InitPack();
+			if (mSocket->bytesAvailable() < header->GetPackSize())
+				return;
+			mSocket->read(reinterpret_cast<char*>(header->GetPackPointer()), header->GetPackSize());
+			header->Unpack();
+			mIncomingHeader = header;
+		}
+
+		if (mSocket->bytesAvailable() < qint64(mIncomingHeader->GetBodySizeToRead()))
+			return;
+		QByteArray body = mSocket->read(mIncomingHeader->GetBodySizeToRead());
+		this->handleIncomingMessage(body);
+		mIncomingHeader = igtl::MessageHeader::Pointer();
+	}
+}
+
+void GrabberSenderQTcpSocket::handleIncomingMessage(QByteArray body)
+{
+	if (QString(mIncomingHeader->GetDeviceType()) != "STATUS")
+		return;
+
+	igtl::StatusMessage::Pointer msg = igtl::StatusMessage::New();
+	msg->SetMessageHeader(mIncomingHeader);
+	msg->AllocatePack();
+	if (msg->GetPackBodySize() != body.size())
+		return;
+	memcpy(msg->GetPackBodyPointer(), body.constData(), body.size());
+	msg->Unpack();
+
+	if (IGTLinkImageStreamEncoder::isCompressionRequest(msg) && !mEncoder)
+	{
+		mEncoder.reset(new IGTLinkImageStreamEncoder());
+		report(QString("Client requested compression, sending %1 image stream.")
+			   .arg(IGTLinkImageStreamEncoder::getCodecName()));
+	}
+}
+
 void GrabberSenderQTcpSocket::send(ImagePtr msg)
 {
 	if (!this->isReady())
@@ -22,6 +22,8 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "igtlImageMessage.h"
 #include "cxIGTLinkImageMessage.h"
 #include "cxIGTLinkUSStatusMessage.h"
+#include "cxIGTLinkImageStreamCodec.h"
+#include "igtlMessageHeader.h"
 #include "cxImage.h"
 #include "cxTool.h"
 
@@ -34,13 +36,22 @@ namespace cx
 * @{
 */
 
+/** Send messages to a single client over a socket.
+ *
+ * If the client requests compression (see IGTLinkImageStreamEncoder),
+ * image messages are sent as compressed messages.
+ *
+ * \ingroup cx_resource_videoserver
+ */
 class cxGrabber_EXPORT GrabberSenderQTcpSocket : public SenderImpl
 {
+	Q_OBJECT
 public:
 	explicit GrabberSenderQTcpSocket(QTcpSocket* socket);
 	virtual ~GrabberSenderQTcpSocket() {}
 
 	bool isReady() const;
+	bool isCompressing() const { return mEncoder.get() != NULL; }
 
 protected:
 	virtual void send(igtl::ImageMessage::Pointer msg);
@@ -48,9 +59,17 @@ protected:
 	virtual void send(ImagePtr msg);
 	virtual void send(ProbeDefinitionPtr msg);
 
+private slots:
+	void readyReadSlot();
+
 private:
+	void handleIncomingMessage(QByteArray body);
+	void write(igtl::MessageBase::Pointer msg);
+
 	QTcpSocket* mSocket;
 	int mMaxBufferSize;
+	igtl::MessageHeader::Pointer mIncomingHeader; ///< header of the message being received, null if waiting for a header
+	boost::shared_ptr<IGTLinkImageStreamEncoder> mEncoder;
 };
 
 /**
@@ -13,7 +13,9 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 
 #include "cxLogger.h"
 #include "cxTypeConversions.h"
+#include "cxStringHelpers.h"
 #include <iostream>
+#include <algorithm>
 #include <QCoreApplication>
 #include <QHostAddress>
 #include <QNetworkInterface>
@@ -21,13 +23,18 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "cxCommandlineImageStreamerFactory.h"
 //#include "cxSender.h"
 #include "cxGrabberSenderQTcpSocket.h"
+#include "cxGrabberSenderMultiClient.h"
 
 namespace cx
 {
 
 ImageServer::ImageServer(QObject* parent) :
-	QTcpServer(parent)
-{}
+	QTcpServer(parent),
+	mMaxClients(1)
+{
+	mStatisticsTimer = new QTimer(this);
+	connect(mStatisticsTimer, SIGNAL(timeout()), this, SLOT(reportStatisticsSlot()));
+}
 
 bool ImageServer::initialize()
 {
@@ -37,6 +44,7 @@ bool ImageServer::initialize()
 	mImageSender = CommandlineImageStreamerFactory().getFromArguments(args);
 	if(!mImageSender)
 		return false;
+	mMaxClients = std::max(1, convertStringWithDefault(args["clients"], 1));
 
 	ok = true;
 
@@ -79,6 +87,15 @@ void ImageServer::incomingConnection(qintptr socketDescriptor)
 {
 	std::cout << "Server: Incoming connection..." << std::endl;
 
+	if (mMaxClients > 1)
+	{
+		// owned by the server, deleted when the client disconnects
+		QTcpSocket* socket = new QTcpSocket(this);
+		socket->setSocketDescriptor(socketDescriptor);
+		this->addMultiClient(socket);
+		return;
+	}
+
 	if (mSocket != 0)
 	{
 		reportError("The image server can only handle a single connection.");
@@ -108,6 +125,69 @@ void ImageServer::socketDisconnectedSlot()
 	}
 }
 
+void ImageServer::addMultiClient(QTcpSocket* socket)
+{
+	QString clientName = socket->peerAddress().toString();
+	if (mMultiClientSender && mMultiClientSender->getNumberOfClients() >= mMaxClients)
+	{
+		reportError(QString("The image server can only handle %1 connections, rejecting %2.").arg(mMaxClients).arg(clientName));
+		socket->disconnectFromHost();
+		socket->deleteLater();
+		return;
+	}
+
+	connect(socket, SIGNAL(disconnected()), this, SLOT(multiClientDisconnectedSlot()));
+	report("Connected to "+clientName+". Session started.");
+
+	if (!mMultiClientSender)
+	{
+		mMultiClientSender.reset(new GrabberSenderMultiClient());
+		mMultiClientSender->addClient(socket);
+		mImageSender->startStreaming(mMultiClientSender);
+		mStatisticsTimer->start(5000);
+	}
+	else
+	{
+		mMultiClientSender->addClient(socket);
+	}
+}
+
+void ImageServer::multiClientDisconnectedSlot()
+{
+	QTcpSocket* socket = dynamic_cast<QTcpSocket*>(this->sender());
+	if (!socket)
+		return;
+
+	report("Disconnected from "+socket->peerAddress().toString()+". Session ended.");
+	if (mMultiClientSender)
+	{
+		mMultiClientSender->removeClient(socket);
+		if (mMultiClientSender->getNumberOfClients() == 0)
+		{
+			mImageSender->stopStreaming();
+			mMultiClientSender.reset();
+			mStatisticsTimer->stop();
+		}
+	}
+	socket->deleteLater();
+}
+
+void ImageServer::reportStatisticsSlot()
+{
+	if (!mMultiClientSender)
+		return;
+
+	std::vector<GrabberSenderMultiClient::ClientStatistics> stats = mMultiClientSender->getStatistics();
+	for (unsigned i=0; i<stats.size(); ++i)
+	{
+		report(QString("Client %1: %2 messages sent, %3 frames dropped, %4 MB/s")
+			   .arg(stats[i].name)
+			   .arg(stats[i].messagesSent)
+			   .arg(stats[i].framesDropped)
+			   .arg(stats[i].bytesPerSecond/1.0E6, 0, 'f', 2));
+	}
+}
+
 void ImageServer::printHelpText()
 {
 	std::cout << getArgumentHelpText(qApp->applicationName());
@@ -124,6 +204,7 @@ QString ImageServer::getArgumentHelpText(QString applicationName)
 
 	ss << "Usage: " << applicationName << " (--arg <argval>)*" << std::endl;
 	ss << "    --port   : Tcp/IP port # (default=18333)" << std::endl;
+	ss << "    --clients: Max number of simultaneous clients (default=1)" << std::endl;
 	ss << "    --type   : Grabber type  (default=" << factory.getDefaultSenderType().toStdString() << ")"
 		<< std::endl;
 	ss << std::endl;
@@ -22,10 +22,14 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 namespace cx
 {
 typedef boost::shared_ptr<class Streamer> StreamerPtr;
+typedef boost::shared_ptr<class GrabberSenderMultiClient> GrabberSenderMultiClientPtr;
 
 /**
  * \brief ImageServer
  *
+ * By default a single client is served. With --clients N, up to N clients
+ * receive the same stream, each with its own bounded send queue.
+ *
  * \ingroup cx_resource_videoserver
  * \date Oct 30, 2010
  * \author Christian Askeland
@@ -46,9 +50,15 @@ protected:
 	void incomingConnection(qintptr socketDescriptor);
 private slots:
 	void socketDisconnectedSlot();
+	void multiClientDisconnectedSlot();
+	void reportStatisticsSlot();
 private:
+	void addMultiClient(QTcpSocket* socket);
 	StreamerPtr mImageSender;
 	QPointer<QTcpSocket> mSocket;
+	int mMaxClients;
+	GrabberSenderMultiClientPtr mMultiClientSender;
+	QTimer* mStatisticsTimer;
 };
 
 } // namespace cx
@@ -0,0 +1,206 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "catch.hpp"
+#include <QTcpServer>
+#include "cxGrabberSenderMultiClient.h"
+#include "cxIGTLinkConversionImage.h"
+#include "cxProbeDefinition.h"
+#include "cxtestUtilities.h"
+
+namespace cxtest
+{
+
+TEST_CASE("GrabberSendQueue: Latest frames are kept when full", "[unit][resource][videoserver]")
+{
+	cx::GrabberSendQueue queue(2);
+	queue.push("frame1", true);
+	queue.push("frame2", true);
+	queue.push("frame3", true);
+
+	CHECK(queue.size() == 2);
+	CHECK(queue.getDropCount() == 1);
+	CHECK(queue.pop() == QByteArray("frame2"));
+	CHECK(queue.pop() == QByteArray("frame3"));
+	CHECK(queue.empty());
+	CHECK(queue.pop().isEmpty());
+}
+
+TEST_CASE("GrabberSendQueue: Non-droppable messages are kept", "[unit][resource][videoserver]")
+{
+	cx::GrabberSendQueue queue(2);
+	queue.push("probe", false);
+	queue.push("frame1", true);
+	queue.push("frame2", true);
+	queue.push("frame3", true);
+
+	CHECK(queue.size() == 2);
+	CHECK(queue.getDropCount() == 2);
+	CHECK(queue.pop() == QByteArray("probe"));
+	CHECK(queue.pop() == QByteArray("frame3"));
+}
+
+TEST_CASE("GrabberSenderMultiClient: Is not ready without clients", "[unit][resource][videoserver]")
+{
+	cx::GrabberSenderMultiClient sender;
+	CHECK(!sender.isReady());
+	CHECK(sender.getNumberOfClients() == 0);
+	CHECK(sender.getStatistics().empty());
+}
+
+namespace
+{
+
+/** Client sockets connected to server sockets on localhost.
+ *  The server sockets are children of the QTcpServer, the client sockets are children of this.
+ */
+class LoopbackConnections : public QObject
+{
+public:
+	LoopbackConnections()
+	{
+		REQUIRE(mServer.listen(QHostAddress::LocalHost));
+	}
+	/** Connect a new client, return the server side socket.
+	 */
+	QTcpSocket* connectClient(QTcpSocket** client)
+	{
+		*client = new QTcpSocket(this);
+		(*client)->connectToHost(QHostAddress::LocalHost, mServer.serverPort());
+		REQUIRE((*client)->waitForConnected(1000));
+		REQUIRE(mServer.waitForNewConnection(1000));
+		QTcpSocket* retval = mServer.nextPendingConnection();
+		REQUIRE(retval);
+		return retval;
+	}
+private:
+	QTcpServer mServer;
+};
+
+/** Read from client until size bytes have arrived, or a timeout.
+ */
+QByteArray readBytes(QTcpSocket* server, QTcpSocket* client, int size)
+{
+	QByteArray retval;
+	for (int i=0; i<100 && retval.size()<size; ++i)
+	{
+		if (server->bytesToWrite() > 0)
+			server->waitForBytesWritten(100);
+		if (client->bytesAvailable() == 0)
+			client->waitForReadyRead(100);
+		retval += client->read(size - retval.size());
+	}
+	return retval;
+}
+
+QByteArray getMessageType(QByteArray message)
+{
+	// igtl header: 2 bytes version followed by 12 bytes type name
+	return message.mid(2, 12).constData();
+}
+
+cx::PackagePtr createImagePackage(int size)
+{
+	cx::PackagePtr package(new cx::Package());
+	package->mImage = Utilities::create3DImage(Eigen::Array3i(size, size, 1));
+	return package;
+}
+
+int getPackedSize(cx::ImagePtr image)
+{
+	igtl::ImageMessage::Pointer message = cx::IGTLinkConversionImage().encode(image, cx::pcsLPS);
+	message->Pack();
+	return message->GetPackSize();
+}
+
+} // namespace
+
+TEST_CASE("GrabberSenderMultiClient: Send one frame to all clients", "[unit][resource][videoserver]")
+{
+	LoopbackConnections connections;
+	QTcpSocket* client1 = NULL;
+	QTcpSocket* client2 = NULL;
+	QTcpSocket* server1 = connections.connectClient(&client1);
+	QTcpSocket* server2 = connections.connectClient(&client2);
+
+	cx::GrabberSenderMultiClient sender;
+	sender.addClient(server1);
+	sender.addClient(server2);
+	REQUIRE(sender.getNumberOfClients() == 2);
+
+	cx::PackagePtr package = createImagePackage(64);
+	int size = getPackedSize(package->mImage);
+	sender.send(package);
+
+	QByteArray received1 = readBytes(server1, client1, size);
+	QByteArray received2 = readBytes(server2, client2, size);
+	REQUIRE(received1.size() == size);
+	CHECK(received1 == received2);
+	CHECK(getMessageType(received1) == QByteArray("IMAGE"));
+
+	std::vector<cx::GrabberSenderMultiClient::ClientStatistics> stats = sender.getStatistics();
+	REQUIRE(stats.size() == 2);
+	CHECK(stats[0].messagesSent == 1);
+	CHECK(stats[1].messagesSent == 1);
+}
+
+TEST_CASE("GrabberSenderMultiClient: Slow client drops frames", "[unit][resource][videoserver]")
+{
+	LoopbackConnections connections;
+	QTcpSocket* fastClient = NULL;
+	QTcpSocket* slowClient = NULL;
+	QTcpSocket* fastServer = connections.connectClient(&fastClient);
+	QTcpSocket* slowServer = connections.connectClient(&slowClient);
+	slowClient->setReadBufferSize(1); // never read, let the buffers fill up
+
+	cx::PackagePtr package = createImagePackage(256);
+	int size = getPackedSize(package->mImage);
+
+	cx::GrabberSenderMultiClient sender;
+	sender.setMaxBufferSize(size);
+	sender.addClient(fastServer);
+	sender.addClient(slowServer);
+
+	int frames = 100;
+	for (int i=0; i<frames; ++i)
+	{
+		sender.send(package);
+		REQUIRE(readBytes(fastServer, fastClient, size).size() == size);
+	}
+
+	std::vector<cx::GrabberSenderMultiClient::ClientStatistics> stats = sender.getStatistics();
+	REQUIRE(stats.size() == 2);
+	CHECK(stats[0].messagesSent == frames);
+	CHECK(stats[0].framesDropped == 0);
+	CHECK(stats[1].messagesSent < frames);
+	CHECK(stats[1].framesDropped > 0);
+	CHECK(stats[1].messagesSent + stats[1].framesDropped <= frames);
+}
+
+TEST_CASE("GrabberSenderMultiClient: Late client receives the last probe definition", "[unit][resource][videoserver]")
+{
+	LoopbackConnections connections;
+	QTcpSocket* client = NULL;
+	QTcpSocket* server = connections.connectClient(&client);
+
+	cx::GrabberSenderMultiClient sender;
+	cx::PackagePtr package(new cx::Package());
+	package->mProbe.reset(new cx::ProbeDefinition(cx::ProbeDefinition::tSECTOR));
+	sender.send(package);
+
+	sender.addClient(server);
+	QByteArray received = readBytes(server, client, 14);
+	REQUIRE(received.size() == 14);
+	CHECK(getMessageType(received) == QByteArray("CX_US_ST"));
+	CHECK(sender.getStatistics()[0].messagesSent == 1);
+}
+
+} // namespace cxtest
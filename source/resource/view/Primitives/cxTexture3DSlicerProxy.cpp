@@ -643,7 +643,10 @@ void Texture3DSlicerProxyImpl::uploadChangedImage(QString uid)
 		ImagePtr image = mImages[i];
 		if(mImages[i]->getUid() == uid)
 		{
-			this->mSharedOpenGLContext->uploadImage(image);
+			if(image->isPartiallyModified())
+				this->mSharedOpenGLContext->uploadImageExtent(image, image->getModifiedExtent());
+			else
+				this->mSharedOpenGLContext->uploadImage(image);
 		}
 	}
 
@@ -23,6 +23,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include <vtkProperty.h>
 #include <QColor>
 #include <vtkMatrix4x4.h>
+#include <algorithm>
 
 #include "cxTool.h"
 #include "cxBoundingBox3D.h"
@@ -66,6 +67,8 @@ ToolTracer::ToolTracer(SpaceProviderPtr spaceProvider)
 	mFirstPoint = false;
 	mMinDistance = -1.0;
 	mSkippedPoints = 0;
+	mMaxPoints = -1;
+	mDecimateOldPoints = false;
 
 	mSpaceListener = mSpaceProvider->createListener();
 	mSpaceListener->setSpace(CoordinateSystem::patientReference());
@@ -150,45 +153,132 @@ bool ToolTracer::isRunning() const
 	return mRunning;
 }
 
+void ToolTracer::setMaxPoints(int maxPoints)
+{
+	mMaxPoints = maxPoints;
+	this->enforceMaxPoints();
+}
+
+int ToolTracer::getNumberOfPoints() const
+{
+	return mPoints->GetNumberOfPoints();
+}
+
 void ToolTracer::receiveTransforms(Transform3D prMt, double timestamp)
 {
 	Vector3D p = prMt.coord(Vector3D(0,0,0));
+	if (!this->acceptPoint(p))
+		return;
+
+	this->appendPointToLine(p);
+	this->enforceMaxPoints();
+	mPolyData->Modified();
+}
 
+/** Apply the min distance criterion, update the previous point if accepted.
+ */
+bool ToolTracer::acceptPoint(const Vector3D& p)
+{
 	if (mMinDistance > 0.0)
 	{
 		if (!mFirstPoint && (mPreviousPoint - p).length() < mMinDistance)
 		{
 			++mSkippedPoints;
-			return;
+			return false;
 		}
 	}
 	mFirstPoint = false;
 	mPreviousPoint = p;
-	mPoints->InsertNextPoint(p.begin());
+	return true;
+}
+
+/** Add a point to the trace and extend the polyline with it,
+ *  without touching the existing cell points.
+ */
+void ToolTracer::appendPointToLine(const Vector3D& p)
+{
+	vtkIdType id = mPoints->InsertNextPoint(p.begin());
+	vtkIdType count = mPoints->GetNumberOfPoints();
+
+	if (count < 2)
+		return;
+
+	if (mLines->GetNumberOfCells() == 0)
+	{
+		vtkIdType ids[2] = { id-1, id };
+		mLines->InsertNextCell(2, ids);
+	}
+	else
+	{
+		mLines->InsertCellPoint(id);
+		mLines->UpdateCellCount(count);
+	}
+	mLines->Modified();
+}
+
+/** Keep the number of points below mMaxPoints.
+ *
+ * When the limit is exceeded, the oldest quarter of the points are discarded,
+ * or the oldest half is decimated by a factor of 2. Both reduce the point
+ * count by a fraction of the limit, thus the O(n) rebuild is amortised to
+ * O(1) per added point.
+ */
+void ToolTracer::enforceMaxPoints()
+{
+	vtkIdType count = mPoints->GetNumberOfPoints();
+	if (mMaxPoints <= 0 || count <= mMaxPoints)
+		return;
+
+	vtkPointsPtr points = vtkPointsPtr::New();
+	points->Allocate(mMaxPoints);
 
-	if (mPoints->GetNumberOfPoints() > 1)
+	if (mDecimateOldPoints)
 	{
-		// fill cell points for the entire polydata.
-		// This is very ineffective, but I have no idea how to update mLines incrementally.
-		mLines->Initialize();
-		std::vector<vtkIdType> ids(mPoints->GetNumberOfPoints());
-		for (unsigned i=0; i<ids.size(); ++i)
-			ids[i] = i;
-		mLines->InsertNextCell(ids.size(), &(*ids.begin()));
-		mLines->Modified();
-		
-		mPolyData->Modified();
+		vtkIdType keepFullResolution = mMaxPoints/2;
+		vtkIdType oldEnd = count - keepFullResolution;
+		for (vtkIdType i=0; i<oldEnd; i+=2)
+			points->InsertNextPoint(mPoints->GetPoint(i));
+		for (vtkIdType i=oldEnd; i<count; ++i)
+			points->InsertNextPoint(mPoints->GetPoint(i));
 	}
+	else
+	{
+		vtkIdType keep = std::max<vtkIdType>(1, mMaxPoints - mMaxPoints/4);
+		for (vtkIdType i=count-keep; i<count; ++i)
+			points->InsertNextPoint(mPoints->GetPoint(i));
+	}
+
+	mPoints->DeepCopy(points);
+	this->rebuildLines();
 }
 
-void ToolTracer::addManyPositions(TimedTransformMap trackerRecordedData_prMt)
+/** Regenerate the polyline from all points in O(n).
+ */
+void ToolTracer::rebuildLines()
 {
-    for(TimedTransformMap::iterator iter=trackerRecordedData_prMt.begin(); iter!=trackerRecordedData_prMt.end(); ++iter)
-        {
-            double timestamp = iter->first;
-            Transform3D prMt = iter->second;
-            this->receiveTransforms(prMt, timestamp);
-        }
+	mLines->Initialize();
+	vtkIdType count = mPoints->GetNumberOfPoints();
+	if (count > 1)
+	{
+		mLines->InsertNextCell(count);
+		for (vtkIdType i=0; i<count; ++i)
+			mLines->InsertCellPoint(i);
+	}
+	mLines->Modified();
+	mPolyData->Modified();
+}
+
+void ToolTracer::addManyPositions(const TimedTransformMap& trackerRecordedData_prMt)
+{
+	for(TimedTransformMap::const_iterator iter=trackerRecordedData_prMt.begin(); iter!=trackerRecordedData_prMt.end(); ++iter)
+	{
+		Vector3D p = iter->second.coord(Vector3D(0,0,0));
+		if (!this->acceptPoint(p))
+			continue;
+		this->appendPointToLine(p);
+		this->enforceMaxPoints();
+	}
+	mPolyData->Modified();
 }
 
 
@@ -40,6 +40,12 @@ typedef boost::shared_ptr<class SpaceListener> SpaceListenerPtr;
  *
  * ToolTracer is used internally by ToolRep3D as an option.
  *
+ * The trace is stored as a single polyline that is extended in place for
+ * each new sample, i.e. O(1) amortised per point. The number of stored
+ * points can be bounded using setMaxPoints(): When the limit is reached,
+ * the oldest part of the trace is either discarded (ring buffer behaviour)
+ * or decimated, keeping the newest part at full resolution.
+ *
  * Used by CustusX.
  *
  * \ingroup cx_resource_view
@@ -61,7 +67,12 @@ public:
 	bool isRunning() const; // true if started and not stopped.
 	void setMinDistance(double distance) { mMinDistance = distance; }
 	int getSkippedPoints() { return mSkippedPoints; }
-	void addManyPositions(TimedTransformMap trackerRecordedData_prMt);
+	void addManyPositions(const TimedTransformMap& trackerRecordedData_prMt);
+
+	void setMaxPoints(int maxPoints); ///< max number of points stored in the trace. <=0 means unlimited (default).
+	int getMaxPoints() const { return mMaxPoints; }
+	void setDecimateOldPoints(bool on) { mDecimateOldPoints = on; } ///< if true, thin out old points instead of discarding them when maxPoints is reached.
+	int getNumberOfPoints() const;
 
 private slots:
 	void receiveTransforms(Transform3D prMt, double timestamp);
@@ -70,6 +81,10 @@ private:
 	void connectTool();
 	void disconnectTool();
 	void onSpaceChanged();
+	bool acceptPoint(const Vector3D& p);
+	void appendPointToLine(const Vector3D& p);
+	void enforceMaxPoints();
+	void rebuildLines();
 
 	bool mRunning;
 	vtkPolyDataPtr mPolyData; ///< polydata representation of the probe, in space u
@@ -85,6 +100,8 @@ private:
 	int mSkippedPoints;
 	Vector3D mPreviousPoint;
 	double mMinDistance;
+	int mMaxPoints;
+	bool mDecimateOldPoints;
 
 	SpaceProviderPtr mSpaceProvider;
 	SpaceListenerPtr mSpaceListener;
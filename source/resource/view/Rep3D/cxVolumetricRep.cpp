@@ -130,9 +130,13 @@ bool VolumetricRep::hasImage(ImagePtr image) const
 
 /**called when the image is changed internally.
  * re-read the lut and vtkimagedata.
+ * In-place changes to data already used as mapper input are picked up by
+ * the mapper through the modification time, thus no resampling is needed.
  */
 void VolumetricRep::vtkImageDataChangedSlot()
 {
+	if (mImage && mImage->isPartiallyModified() && mMapper->GetInput()==mImage->getGrayScaleVtkImageData().GetPointer())
+		return;
 	this->updateVtkImageDataSlot();
 	this->transformChangedSlot();
 }
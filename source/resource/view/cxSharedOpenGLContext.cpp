@@ -16,6 +16,8 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 
 #include "cxSharedOpenGLContext.h"
 
+#include <algorithm>
+
 #include <vtkOpenGLRenderWindow.h>
 #include <vtkNew.h>
 #include <vtkTextureObject.h>
@@ -243,6 +245,72 @@ bool SharedOpenGLContext::uploadImage(ImagePtr image)
 	return success;
 }
 
+/** Replace the part of the texture inside extent, e.g. after an in-place edit of the image.
+ *  Falls back to a full upload if the texture does not match the image.
+ */
+bool SharedOpenGLContext::uploadImageExtent(ImagePtr image, const IntBoundingBox3D& extent)
+{
+	if(!image)
+	{
+		CX_LOG_ERROR() << "Cannot upload en empty image as a 3D texture";
+		return false;
+	}
+
+	vtkImageDataPtr vtkImageData = image->getBaseVtkImageData();
+	int* dims = vtkImageData->GetDimensions();
+	int dataType = vtkImageData->GetScalarType();
+	int numComps = vtkImageData->GetNumberOfScalarComponents();
+
+	vtkTextureObjectPtr texture_object = this->get3DTextureForImage(image->getUid());
+	bool sameLayout = texture_object
+			&& (int(texture_object->GetWidth()) == dims[0])
+			&& (int(texture_object->GetHeight()) == dims[1])
+			&& (int(texture_object->GetDepth()) == dims[2])
+			&& (texture_object->GetComponents() == numComps);
+	if(!sameLayout)
+		return this->uploadImage(image);
+
+	if(!this->makeCurrent())
+	{
+		CX_LOG_ERROR() << "Could not make current for 3D texture";
+		return false;
+	}
+	report_gl_error();
+
+	int* whole = vtkImageData->GetExtent();
+	int offset[3];
+	int size[3];
+	for (int i=0; i<3; ++i)
+	{
+		int lo = std::max(extent[2*i], whole[2*i]);
+		int hi = std::min(extent[2*i+1], whole[2*i+1]);
+		if (lo > hi)
+			return true;
+		offset[i] = lo - whole[2*i];
+		size[i] = hi - lo + 1;
+	}
+	void* data = vtkImageData->GetScalarPointer(offset[0]+whole[0], offset[1]+whole[2], offset[2]+whole[4]);
+
+	// the subvolume is read directly from the full image buffer
+	texture_object->Activate();
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, dims[0]);
+	glPixelStorei(GL_UNPACK_IMAGE_HEIGHT, dims[1]);
+	glTexSubImage3D(GL_TEXTURE_3D, 0,
+					offset[0], offset[1], offset[2],
+					size[0], size[1], size[2],
+					texture_object->GetFormat(dataType, numComps, false),
+					texture_object->GetDataType(dataType),
+					data);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	glPixelStorei(GL_UNPACK_IMAGE_HEIGHT, 0);
+	texture_object->Deactivate();
+	report_gl_error();
+
+	m3DTextureObjects[image->getUid()] = std::make_pair(texture_object, vtkImageData->GetMTime());
+	return true;
+}
+
 bool SharedOpenGLContext::uploadLUT(QString imageUid, vtkUnsignedCharArrayPtr lutTable)
 {
 	report_gl_error();
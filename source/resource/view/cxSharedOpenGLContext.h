@@ -23,6 +23,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 
 #include "cxResourceVisualizationExport.h"
 #include "cxForwardDeclarations.h"
+#include "cxBoundingBox3D.h"
 #include "vtkForwardDeclarations.h"
 
 namespace cx
@@ -54,6 +55,7 @@ public:
 
 	//Image textures are per image
 	bool uploadImage(ImagePtr image);
+	bool uploadImageExtent(ImagePtr image, const IntBoundingBox3D& extent); ///< upload only the voxels in extent to an existing texture
 	bool hasUploadedImage(QString image_uid) const;
 	vtkTextureObjectPtr get3DTextureForImage(QString image_uid) const;
 	bool delete3DTextureForImage(QString image_uid);
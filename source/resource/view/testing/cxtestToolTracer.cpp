@@ -0,0 +1,97 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#include "catch.hpp"
+#include "cxToolTracer.h"
+#include "cxtestSpaceProviderMock.h"
+#include <vtkPolyData.h>
+#include <vtkCellArray.h>
+#include <vtkIdList.h>
+
+namespace cxtest
+{
+
+namespace
+{
+cx::TimedTransformMap createLineOfPositions(int count)
+{
+	cx::TimedTransformMap retval;
+	for (int i=0; i<count; ++i)
+		retval[i] = cx::createTransformTranslate(cx::Vector3D(i, 0, 0));
+	return retval;
+}
+
+vtkIdType getLineLength(cx::ToolTracerPtr tracer)
+{
+	vtkCellArrayPtr lines = tracer->getPolyData()->GetLines();
+	if (lines->GetNumberOfCells()==0)
+		return 0;
+	vtkIdListPtr ids = vtkIdListPtr::New();
+	lines->InitTraversal();
+	lines->GetNextCell(ids);
+	return ids->GetNumberOfIds();
+}
+} // namespace
+
+TEST_CASE("ToolTracer: Incremental and bulk insertion give the same single polyline", "[unit][resource][visualization]")
+{
+	cx::TimedTransformMap positions = createLineOfPositions(100);
+
+	cx::ToolTracerPtr bulk = cx::ToolTracer::create(SpaceProviderMock::create());
+	bulk->addManyPositions(positions);
+
+	cx::ToolTracerPtr incremental = cx::ToolTracer::create(SpaceProviderMock::create());
+	incremental->addManyPositions(createLineOfPositions(1));
+	incremental->addManyPositions(cx::TimedTransformMap());
+	for (cx::TimedTransformMap::iterator iter=++positions.begin(); iter!=positions.end(); ++iter)
+	{
+		cx::TimedTransformMap single;
+		single[iter->first] = iter->second;
+		incremental->addManyPositions(single);
+	}
+
+	CHECK(bulk->getNumberOfPoints() == 100);
+	CHECK(incremental->getNumberOfPoints() == 100);
+	CHECK(getLineLength(bulk) == 100);
+	CHECK(getLineLength(incremental) == 100);
+	CHECK(bulk->getPolyData()->GetLines()->GetNumberOfCells() == 1);
+	CHECK(incremental->getPolyData()->GetLines()->GetNumberOfCells() == 1);
+}
+
+TEST_CASE("ToolTracer: Max points discards the oldest points", "[unit][resource][visualization]")
+{
+	cx::ToolTracerPtr tracer = cx::ToolTracer::create(SpaceProviderMock::create());
+	tracer->setMaxPoints(40);
+	tracer->addManyPositions(createLineOfPositions(1000));
+
+	CHECK(tracer->getNumberOfPoints() <= 40);
+	CHECK(getLineLength(tracer) == tracer->getNumberOfPoints());
+
+	double last[3];
+	tracer->getPolyData()->GetPoint(tracer->getNumberOfPoints()-1, last);
+	CHECK(last[0] == Approx(999));
+}
+
+TEST_CASE("ToolTracer: Max points with decimation keeps the start of the trace", "[unit][resource][visualization]")
+{
+	cx::ToolTracerPtr tracer = cx::ToolTracer::create(SpaceProviderMock::create());
+	tracer->setMaxPoints(40);
+	tracer->setDecimateOldPoints(true);
+	tracer->addManyPositions(createLineOfPositions(1000));
+
+	CHECK(tracer->getNumberOfPoints() <= 40);
+	CHECK(getLineLength(tracer) == tracer->getNumberOfPoints());
+
+	double first[3];
+	tracer->getPolyData()->GetPoint(0, first);
+	CHECK(first[0] == Approx(0));
+}
+
+} // namespace cxtest
@@ -14,7 +14,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include <QVBoxLayout>
 #include <QTreeWidget>
 #include <QTreeWidgetItem>
-#include "cxFrameForest.h"
+#include "cxFrameGraph.h"
 #include "cxData.h"
 #include "cxPatientModelService.h"
 
@@ -23,7 +23,8 @@ namespace cx
 
 FrameTreeWidget::FrameTreeWidget(PatientModelServicePtr patientService, QWidget* parent) :
   BaseWidget(parent, "frame_tree_widget", "Frame Tree"),
-  mPatientService(patientService)
+  mPatientService(patientService),
+  mFrameGraph(FrameGraph::create())
 {
   QVBoxLayout* layout = new QVBoxLayout(this);
 
@@ -63,29 +64,30 @@ void FrameTreeWidget::rebuild()
 {
   mTreeWidget->clear();
 
-  FrameForest forest(mPatientService->getDatas());
-  QDomElement root = forest.getDocument().documentElement();
+  mFrameGraph->update(mPatientService->getDatas());
 
-  this->fill(mTreeWidget->invisibleRootItem(), root);
+  std::vector<int> roots = mFrameGraph->getRoots();
+  for (unsigned i=0; i<roots.size(); ++i)
+    this->fill(mTreeWidget->invisibleRootItem(), roots[i]);
 
   mTreeWidget->expandToDepth(10);
   mTreeWidget->resizeColumnToContents(0);
 }
 
-void FrameTreeWidget::fill(QTreeWidgetItem* parent, QDomNode node)
+void FrameTreeWidget::fill(QTreeWidgetItem* parent, int node)
 {
-  for (QDomNode child = node.firstChild(); !child.isNull(); child = child.nextSibling())
-  {
-    QString frameName = child.toElement().tagName();
+  QString frameName = mFrameGraph->getFrame(node);
 
-    // if frame refers to a data, use its name instead.
-	DataPtr data = mPatientService->getData(frameName);
-    if (data)
-      frameName = data->getName();
+  // if frame refers to a data, use its name instead.
+  DataPtr data = mPatientService->getData(frameName);
+  if (data)
+    frameName = data->getName();
 
-    QTreeWidgetItem* item = new QTreeWidgetItem(parent, QStringList() << frameName);
-    this->fill(item, child);
-  }
+  QTreeWidgetItem* item = new QTreeWidgetItem(parent, QStringList() << frameName);
+
+  const std::vector<int>& children = mFrameGraph->getChildren(node);
+  for (unsigned i=0; i<children.size(); ++i)
+    this->fill(item, children[i]);
 }
 
 }
@@ -22,10 +22,10 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "cxForwardDeclarations.h"
 class QTreeWidget;
 class QTreeWidgetItem;
-class QDomNode;
 
 namespace cx
 {
+typedef boost::shared_ptr<class FrameGraph> FrameGraphPtr;
 
 /**
  * \class FrameTreeWidget
@@ -48,7 +48,8 @@ protected:
 private:
   PatientModelServicePtr mPatientService;
   QTreeWidget* mTreeWidget;
-  void fill(QTreeWidgetItem* parent, QDomNode node);
+  void fill(QTreeWidgetItem* parent, int node);
+  FrameGraphPtr mFrameGraph; ///< kept between rebuilds, updated with the changes only
   std::map<QString, DataPtr> mConnectedData;
 
 private slots: